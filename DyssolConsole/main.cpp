@@ -8,6 +8,7 @@
 #include "StringFunctions.h"
 #include "ThreadPool.h"
 #include "DyssolSystemDefines.h"
+#include "DyssolStringConstants.h"
 #include <chrono>
 
 void RunSimulation(const CConfigFileParser& _parser)
@@ -237,6 +238,14 @@ void RunSimulation(const CConfigFileParser& _parser)
 	flowsheet.SaveToFile(fileHandler, sDstFile);
 
 	std::cout << "Simulation finished in " << std::chrono::duration_cast<std::chrono::seconds>(tEnd - tStart).count() << " [s]" << std::endl;
+
+	// print statistics of solvers
+	for (size_t i = 0; i < flowsheet.GetModelsCount(); ++i)
+	{
+		const SSolverStatistics statistics = flowsheet.GetModel(i)->GetSolverStatistics();
+		if (!statistics.IsEmpty())
+			std::cout << StrConst::Sim_InfoUnitSolverStatistics(flowsheet.GetModel(i)->GetModelName(), flowsheet.GetModel(i)->GetUnitName(), statistics.ToString()) << std::endl;
+	}
 }
 
 int main(int argc, const char *argv[])
@@ -257,6 +266,22 @@ int main(int argc, const char *argv[])
 		std::cout << "Version: " << CURRENT_VERSION_STR << std::endl;
 		//std::cout << "Build: " << CURRENT_BUILD_VERSION << std::endl;
 	}
+	else if (sParam == "-convertmdb" || sParam == "-c")
+	{
+		if (argc < 3)
+		{
+			std::cout << "Error: Path to a materials database file is not specified." << std::endl;
+			return 0;
+		}
+		const std::wstring sSrcFile = StringFunctions::String2WString(argv[2]);
+		const std::wstring sDstFile = argc > 3 ? StringFunctions::String2WString(argv[3]) : sSrcFile.substr(0, sSrcFile.find_last_of(L'.')) + L"." + MDBDescriptors::BINARY_MDB_FILE_EXTENSION;
+		if (!CMaterialsDatabase::ConvertToBinaryFile(sSrcFile, sDstFile))
+		{
+			std::cout << "Error: The specified materials database file can not be converted: " << StringFunctions::WString2String(sSrcFile) << std::endl;
+			return 0;
+		}
+		std::cout << "Materials database converted to: " << StringFunctions::WString2String(sDstFile) << std::endl;
+	}
 	else
 	{
 		CConfigFileParser parser;
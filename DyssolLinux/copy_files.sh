@@ -4,6 +4,7 @@
 CORE_DIR=./src/Core
 UNITS_DIR=./src/Units
 SOLVERS_DIR=./src/Solvers
+TESTS_DIR=./src/Tests
 
 # ================================================================
 # Core libraries
@@ -72,3 +73,7 @@ for DIR in "${SOLVERS_DIRS[@]}"; do
 	mkdir -p $SOLVERS_DIR/$DIR
 	find $PWD/../Solvers/$DIR -maxdepth 1 -type f \( -name '*.cpp' -o -name '*.c' -o -name '*.h' \) -exec cp '{}' ''$PWD'/'$SOLVERS_DIR'/'$DIR'' ';'
 done
+
+rm -rf $TESTS_DIR
+mkdir -p $TESTS_DIR
+find $PWD/../Tests -maxdepth 1 -type f \( -name '*.cpp' -o -name '*.h' \) -exec cp '{}' ''$PWD'/'$TESTS_DIR'' ';'
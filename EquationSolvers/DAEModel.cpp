@@ -1,7 +1,9 @@
 /* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
 
 #include "DAEModel.h"
+#include "ThreadPool.h"
 #include <cfloat>
+#include <algorithm>
 
 CDAEModel::CDAEModel( void )
 {
@@ -9,6 +11,17 @@ CDAEModel::CDAEModel( void )
 	m_dATol = DEFAULT_ATOL;
 
 	m_pUserData = nullptr;
+	m_jacobianType = EJacobianType::DENSE;
+	m_nUpperBandwidth = 0;
+	m_nLowerBandwidth = 0;
+	m_bBandwidthSet = false;
+	m_bColoredJacobian = false;
+	m_nResidualBlocks = 1;
+	m_nRoots = 0;
+	m_bAnalyticalJacobian = false;
+	m_bAnalyticalJacobianTimesVector = false;
+	m_bCheckJacobian = false;
+	m_dCheckJacobianTolerance = 1e-4;
 }
 
 CDAEModel::~CDAEModel( void )
@@ -22,6 +35,18 @@ void CDAEModel::Clear()
 	m_dRTol = DEFAULT_RTOL;
 	m_dATol = DEFAULT_ATOL;
 	m_vATol.clear();
+	m_jacobianType = EJacobianType::DENSE;
+	m_nUpperBandwidth = 0;
+	m_nLowerBandwidth = 0;
+	m_bBandwidthSet = false;
+	m_bColoredJacobian = false;
+	m_nResidualBlocks = 1;
+	m_nRoots = 0;
+	m_bAnalyticalJacobian = false;
+	m_bAnalyticalJacobianTimesVector = false;
+	m_bCheckJacobian = false;
+	m_dCheckJacobianTolerance = 1e-4;
+	m_jacobianPattern.Resize(0);
 }
 
 size_t CDAEModel::AddDAEVariable(bool _bIsDifferentiable, double _dVariableInit, double _dDerivativeInit, double _dConstraint /*= 0.0 */)
@@ -99,6 +124,115 @@ double CDAEModel::GetATol(size_t _dIndex)
 	return DEFAULT_ATOL;
 }
 
+void CDAEModel::SetJacobianType(EJacobianType _type)
+{
+	m_jacobianType = _type;
+}
+
+EJacobianType CDAEModel::GetJacobianType() const
+{
+	return m_jacobianType;
+}
+
+void CDAEModel::SetJacobianBandwidth(size_t _nUpper, size_t _nLower)
+{
+	m_nUpperBandwidth = _nUpper;
+	m_nLowerBandwidth = _nLower;
+	m_bBandwidthSet = true;
+}
+
+size_t CDAEModel::GetUpperBandwidth() const
+{
+	if (m_vVariables.empty()) return 0;
+	if (m_bBandwidthSet) return std::min(m_nUpperBandwidth, m_vVariables.size() - 1);
+	if (m_jacobianPattern.GetSize() == m_vVariables.size() && !m_jacobianPattern.IsEmpty()) return m_jacobianPattern.GetUpperBandwidth();
+	return m_vVariables.size() - 1;
+}
+
+size_t CDAEModel::GetLowerBandwidth() const
+{
+	if (m_vVariables.empty()) return 0;
+	if (m_bBandwidthSet) return std::min(m_nLowerBandwidth, m_vVariables.size() - 1);
+	if (m_jacobianPattern.GetSize() == m_vVariables.size() && !m_jacobianPattern.IsEmpty()) return m_jacobianPattern.GetLowerBandwidth();
+	return m_vVariables.size() - 1;
+}
+
+void CDAEModel::SetJacobianPattern(const CJacobianPattern& _pattern)
+{
+	m_jacobianPattern = _pattern;
+}
+
+const CJacobianPattern& CDAEModel::GetJacobianPattern() const
+{
+	return m_jacobianPattern;
+}
+
+void CDAEModel::SetUseColoredJacobian(bool _bEnable)
+{
+	m_bColoredJacobian = _bEnable;
+}
+
+bool CDAEModel::GetUseColoredJacobian() const
+{
+	return m_bColoredJacobian;
+}
+
+void CDAEModel::SetUseAnalyticalJacobian(bool _bEnable)
+{
+	m_bAnalyticalJacobian = _bEnable;
+}
+
+bool CDAEModel::GetUseAnalyticalJacobian() const
+{
+	return m_bAnalyticalJacobian;
+}
+
+void CDAEModel::SetUseAnalyticalJacobianTimesVector(bool _bEnable)
+{
+	m_bAnalyticalJacobianTimesVector = _bEnable;
+}
+
+bool CDAEModel::GetUseAnalyticalJacobianTimesVector() const
+{
+	return m_bAnalyticalJacobianTimesVector;
+}
+
+void CDAEModel::SetCheckJacobian(bool _bEnable, double _dTolerance /*= 1e-4*/)
+{
+	m_bCheckJacobian = _bEnable;
+	m_dCheckJacobianTolerance = _dTolerance;
+}
+
+bool CDAEModel::GetCheckJacobian() const
+{
+	return m_bCheckJacobian;
+}
+
+double CDAEModel::GetCheckJacobianTolerance() const
+{
+	return m_dCheckJacobianTolerance;
+}
+
+void CDAEModel::SetResidualBlocksNumber(size_t _nBlocks)
+{
+	m_nResidualBlocks = _nBlocks != 0 ? _nBlocks : 1;
+}
+
+size_t CDAEModel::GetResidualBlocksNumber() const
+{
+	return m_nResidualBlocks;
+}
+
+void CDAEModel::SetRootsNumber(size_t _nRoots)
+{
+	m_nRoots = _nRoots;
+}
+
+size_t CDAEModel::GetRootsNumber() const
+{
+	return m_nRoots;
+}
+
 void CDAEModel::SetUserData( void* _pUserData )
 {
 	m_pUserData = _pUserData;
@@ -109,14 +243,53 @@ void CDAEModel::CalculateResiduals( double _dTime, double* _pVars, double* _pDer
 
 }
 
+void CDAEModel::PrepareResiduals(double /*_dTime*/, double* /*_pVars*/, double* /*_pDerivs*/, void* /*_pUserData*/)
+{
+
+}
+
+void CDAEModel::CalculateResidualsBlock(double /*_dTime*/, double* /*_pVars*/, double* /*_pDerivs*/, double* /*_pRes*/, size_t /*_iBlock*/, void* /*_pUserData*/)
+{
+
+}
+
 void CDAEModel::ResultsHandler( double _dTime, double* _pVars, double* _pDerivs, void* _pUserData )
 {
 
 }
 
+void CDAEModel::CalculateRoots(double /*_dTime*/, double* /*_pVars*/, double* /*_pDerivs*/, double* /*_pRoots*/, void* /*_pUserData*/)
+{
+
+}
+
+bool CDAEModel::EventHandler(double /*_dTime*/, double* /*_pVars*/, double* /*_pDerivs*/, const int* /*_pRootsFound*/, void* /*_pUserData*/)
+{
+	return false;
+}
+
+void CDAEModel::CalculateJacobian(double /*_dTime*/, double* /*_pVars*/, double* /*_pDerivs*/, double /*_dAlpha*/, CJacobianMatrix& /*_jacobian*/, void* /*_pUserData*/)
+{
+
+}
+
+void CDAEModel::CalculateJacobianTimesVector(double /*_dTime*/, double* /*_pVars*/, double* /*_pDerivs*/, double /*_dAlpha*/, double* /*_pVector*/, double* /*_pResult*/, void* /*_pUserData*/)
+{
+
+}
+
 bool CDAEModel::GetResiduals( double _dTime, double* _pVars, double* _pDerivs, double* _pRes )
 {
-	CalculateResiduals( _dTime, _pVars, _pDerivs, _pRes, m_pUserData );
+	if (m_nResidualBlocks > 1)
+	{
+		PrepareResiduals(_dTime, _pVars, _pDerivs, m_pUserData);
+		ParallelFor(m_nResidualBlocks, [&](size_t i)
+		{
+			CalculateResidualsBlock(_dTime, _pVars, _pDerivs, _pRes, i, m_pUserData);
+		});
+	}
+	else
+		CalculateResiduals( _dTime, _pVars, _pDerivs, _pRes, m_pUserData );
 	bool bRet = false;
 	if( !m_vVariables.empty() )
 	{
@@ -138,3 +311,23 @@ void CDAEModel::HandleResults( double _dTime, double* _pVars, double* _pDerivs )
 {
 	ResultsHandler( _dTime, _pVars, _pDerivs, m_pUserData );
 }
+
+void CDAEModel::GetRoots(double _dTime, double* _pVars, double* _pDerivs, double* _pRoots)
+{
+	CalculateRoots(_dTime, _pVars, _pDerivs, _pRoots, m_pUserData);
+}
+
+bool CDAEModel::HandleEvent(double _dTime, double* _pVars, double* _pDerivs, const int* _pRootsFound)
+{
+	return EventHandler(_dTime, _pVars, _pDerivs, _pRootsFound, m_pUserData);
+}
+
+void CDAEModel::GetJacobian(double _dTime, double* _pVars, double* _pDerivs, double _dAlpha, CJacobianMatrix& _jacobian)
+{
+	CalculateJacobian(_dTime, _pVars, _pDerivs, _dAlpha, _jacobian, m_pUserData);
+}
+
+void CDAEModel::GetJacobianTimesVector(double _dTime, double* _pVars, double* _pDerivs, double _dAlpha, double* _pVector, double* _pResult)
+{
+	CalculateJacobianTimesVector(_dTime, _pVars, _pDerivs, _dAlpha, _pVector, _pResult, m_pUserData);
+}
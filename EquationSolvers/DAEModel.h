@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "JacobianPattern.h"
 #include <vector>
 
 #define DEFAULT_ATOL 1.0e-6
@@ -39,6 +40,18 @@ private:
 	double m_dRTol;								///< Relative tolerance
 	double m_dATol;								///< Absolute tolerance
 	std::vector<double> m_vATol;				///< Absolute tolerance for each variable
+	EJacobianType m_jacobianType;				///< Type of the Jacobian matrix and of the linear solver
+	size_t m_nUpperBandwidth;					///< Upper bandwidth of the Jacobian, set explicitly
+	size_t m_nLowerBandwidth;					///< Lower bandwidth of the Jacobian, set explicitly
+	bool m_bBandwidthSet;						///< Whether bandwidths were set explicitly
+	CJacobianPattern m_jacobianPattern;			///< Sparsity pattern of the Jacobian
+	bool m_bAnalyticalJacobian;					///< Whether CalculateJacobian is used instead of finite differences
+	bool m_bAnalyticalJacobianTimesVector;		///< Whether CalculateJacobianTimesVector is used instead of finite differences
+	bool m_bCheckJacobian;						///< Whether analytical Jacobian and Jacobian-vector products are compared to finite differences
+	double m_dCheckJacobianTolerance;			///< Relative tolerance to compare analytical and finite-difference Jacobians
+	bool m_bColoredJacobian;					///< Whether colored finite differences are used to calculate the Jacobian
+	size_t m_nResidualBlocks;					///< Number of independent blocks of residuals calculated in parallel
+	size_t m_nRoots;							///< Number of root functions used to locate events
 
 public:
 	/**	Basic constructor.*/
@@ -90,6 +103,72 @@ public:
 	 *	\param _dIndex Index of variable*/
 	double GetATol(size_t _dIndex);
 
+	// ========== Functions to work with Jacobian structure
+
+	/**	Set type of the Jacobian matrix and of the linear solver used to solve the system.
+	 *	\param _type Type of the Jacobian*/
+	void SetJacobianType(EJacobianType _type);
+	/**	Get type of the Jacobian matrix.*/
+	EJacobianType GetJacobianType() const;
+	/**	Set bandwidths of the Jacobian. Used for banded Jacobians and as bandwidths of the preconditioner for sparse ones.
+	 *	\param _nUpper Upper bandwidth
+	 *	\param _nLower Lower bandwidth*/
+	void SetJacobianBandwidth(size_t _nUpper, size_t _nLower);
+	/**	Get upper bandwidth of the Jacobian. Returns the explicitly set value, otherwise the value derived from the sparsity pattern, otherwise full bandwidth.*/
+	size_t GetUpperBandwidth() const;
+	/**	Get lower bandwidth of the Jacobian. Returns the explicitly set value, otherwise the value derived from the sparsity pattern, otherwise full bandwidth.*/
+	size_t GetLowerBandwidth() const;
+	/**	Set sparsity pattern of the Jacobian: entry (i, j) is non-zero if residual i depends on variable j or its derivative.
+	 *	\param _pattern Sparsity pattern*/
+	void SetJacobianPattern(const CJacobianPattern& _pattern);
+	/**	Get sparsity pattern of the Jacobian.*/
+	const CJacobianPattern& GetJacobianPattern() const;
+
+	/**	Calculate finite-difference Jacobian for dense and banded Jacobian types by perturbing groups of structurally independent variables at once.
+	 *	If no sparsity pattern is set, it is detected when the model is set to the solver by perturbing each variable at the initial point.
+	 *	\param _bEnable Enable colored finite differences*/
+	void SetUseColoredJacobian(bool _bEnable);
+	/**	Whether colored finite differences are used to calculate the Jacobian.*/
+	bool GetUseColoredJacobian() const;
+	/**	Use CalculateJacobian to obtain the Jacobian for dense and banded Jacobian types instead of finite differences.
+	 *	\param _bEnable Enable analytical Jacobian*/
+	void SetUseAnalyticalJacobian(bool _bEnable);
+	/**	Whether CalculateJacobian is used to obtain the Jacobian.*/
+	bool GetUseAnalyticalJacobian() const;
+	/**	Use CalculateJacobianTimesVector to obtain Jacobian-vector products for sparse Jacobian type instead of finite differences.
+	 *	\param _bEnable Enable analytical Jacobian-vector products*/
+	void SetUseAnalyticalJacobianTimesVector(bool _bEnable);
+	/**	Whether CalculateJacobianTimesVector is used to obtain Jacobian-vector products.*/
+	bool GetUseAnalyticalJacobianTimesVector() const;
+	/**	Debug mode: compare each analytical Jacobian and Jacobian-vector product with finite differences.
+	 *	The solver stops with an error describing the first entry that differs by more than the relative tolerance.
+	 *	\param _bEnable Enable checking
+	 *	\param _dTolerance Relative tolerance of comparison*/
+	void SetCheckJacobian(bool _bEnable, double _dTolerance = 1e-4);
+	/**	Whether analytical Jacobians are compared with finite differences.*/
+	bool GetCheckJacobian() const;
+	/**	Relative tolerance to compare analytical Jacobians with finite differences.*/
+	double GetCheckJacobianTolerance() const;
+
+	// ========== Functions to work with parallel calculation of residuals
+
+	/**	Set number of independent blocks of residuals. If more than one block is set, residuals are calculated by calling PrepareResiduals
+	 *	followed by parallel calls of CalculateResidualsBlock for each block, instead of CalculateResiduals.
+	 *	Vector operations of the solver are then also executed in parallel for large systems.
+	 *	\param _nBlocks Number of blocks*/
+	void SetResidualBlocksNumber(size_t _nBlocks);
+	/**	Get number of independent blocks of residuals.*/
+	size_t GetResidualBlocksNumber() const;
+
+	// ========== Functions to work with events
+
+	/**	Set number of root functions. If set, the solver locates time points, where any of the functions calculated in CalculateRoots crosses zero,
+	 *	stops there and calls EventHandler. Discontinuities of the model should be described with root functions instead of being placed directly into residuals.
+	 *	\param _nRoots Number of root functions*/
+	void SetRootsNumber(size_t _nRoots);
+	/**	Get number of root functions.*/
+	size_t GetRootsNumber() const;
+
 	/**	Set pointer to user data. This pointer will be returned with functions \a CalculateResiduals and \a ResultsHandler.
 	 *	\param _pUserData Pointer to user data*/
 	void SetUserData( void* _pUserData );
@@ -103,17 +182,75 @@ public:
 	 *	\param _pRes Output residual vector F(t, y, y')
 	 *	\param _pUserData Pointer to user's data*/
 	virtual void CalculateResiduals( double _dTime, double* _pVars, double* _pDerivs, double* _pRes, void* _pUserData );
+	/** Prepare data shared by all blocks of residuals, e.g. rates depending on all variables. Called sequentially before CalculateResidualsBlock, if several blocks are set.
+	 *	\param _dTime Current value of the independent variable
+	 *	\param _pVars Current value of the dependent variable vector, y(t)
+	 *	\param _pDerivs Current value of y'(t)
+	 *	\param _pUserData Pointer to user's data*/
+	virtual void PrepareResiduals(double _dTime, double* _pVars, double* _pDerivs, void* _pUserData);
+	/** Calculate residuals of one block. Called in parallel for all blocks, if several blocks are set.
+	 *	Each block must write only its own residuals and must not modify data shared with other blocks.
+	 *	\param _dTime Current value of the independent variable
+	 *	\param _pVars Current value of the dependent variable vector, y(t)
+	 *	\param _pDerivs Current value of y'(t)
+	 *	\param _pRes Output residual vector F(t, y, y')
+	 *	\param _iBlock Index of the block
+	 *	\param _pUserData Pointer to user's data*/
+	virtual void CalculateResidualsBlock(double _dTime, double* _pVars, double* _pDerivs, double* _pRes, size_t _iBlock, void* _pUserData);
 	/** Handle results.
 	 *	\param _dTime Current value of the independent variable
 	 *	\param _pVars Current value of the dependent variable vector, y(t)
 	 *	\param _pDerivs Current value of y'(t)
 	 *	\param _pUserData Pointer to user's data*/
 	virtual void ResultsHandler( double _dTime, double* _pVars, double* _pDerivs, void* _pUserData );
+	/** Calculate root functions, whose zero crossings define events. Called if root functions are set with SetRootsNumber.
+	 *	\param _dTime Current value of the independent variable
+	 *	\param _pVars Current value of the dependent variable vector, y(t)
+	 *	\param _pDerivs Current value of y'(t)
+	 *	\param _pRoots Output values of root functions g(t, y, y')
+	 *	\param _pUserData Pointer to user's data*/
+	virtual void CalculateRoots(double _dTime, double* _pVars, double* _pDerivs, double* _pRoots, void* _pUserData);
+	/** Handle event at the located root. Called after results at the time point of the event are handled.
+	 *	Variables and derivatives may be changed here to describe the state after the event, e.g. switched flows.
+	 *	\param _dTime Time point of the event
+	 *	\param _pVars Value of the dependent variable vector at the event, y(t); may be changed
+	 *	\param _pDerivs Value of y'(t) at the event; may be changed
+	 *	\param _pRootsFound For each root function: 0 if it has no root, 1 if it crosses zero increasing, -1 if it crosses zero decreasing
+	 *	\param _pUserData Pointer to user's data
+	 *	\retval true Variables were changed and the solver must be reinitialized from them
+	 *	\retval false Integration continues without reinitialization*/
+	virtual bool EventHandler(double _dTime, double* _pVars, double* _pDerivs, const int* _pRootsFound, void* _pUserData);
+	/** Calculate the Jacobian J = dF/dy + _dAlpha * dF/dy'. Called if enabled with SetUseAnalyticalJacobian.
+	 *	The matrix is set to zero before the call, so only non-zero entries must be set.
+	 *	\param _dTime Current value of the independent variable
+	 *	\param _pVars Current value of the dependent variable vector, y(t)
+	 *	\param _pDerivs Current value of y'(t)
+	 *	\param _dAlpha Scalar in the system Jacobian, proportional to the inverse of the step size
+	 *	\param _jacobian Output Jacobian matrix
+	 *	\param _pUserData Pointer to user's data*/
+	virtual void CalculateJacobian(double _dTime, double* _pVars, double* _pDerivs, double _dAlpha, CJacobianMatrix& _jacobian, void* _pUserData);
+	/** Calculate the product of the Jacobian J = dF/dy + _dAlpha * dF/dy' with a vector. Called if enabled with SetUseAnalyticalJacobianTimesVector.
+	 *	\param _dTime Current value of the independent variable
+	 *	\param _pVars Current value of the dependent variable vector, y(t)
+	 *	\param _pDerivs Current value of y'(t)
+	 *	\param _dAlpha Scalar in the system Jacobian, proportional to the inverse of the step size
+	 *	\param _pVector Vector to multiply with, v
+	 *	\param _pResult Output product J*v
+	 *	\param _pUserData Pointer to user's data*/
+	virtual void CalculateJacobianTimesVector(double _dTime, double* _pVars, double* _pDerivs, double _dAlpha, double* _pVector, double* _pResult, void* _pUserData);
 
 	// ========== Functions for calling from solver
 
-	/** Calculate residuals. Calls CalculateResiduals.*/
+	/** Calculate residuals. Calls CalculateResiduals or, if several blocks are set, PrepareResiduals and CalculateResidualsBlock.*/
 	bool GetResiduals( double _dTime, double* _pVars, double* _pDerivs, double* _pRes );
 	/** Handle results. Calls ResultsHandler.*/
 	void HandleResults( double _dTime, double* _pVars, double* _pDerivs );
+	/** Calculate root functions. Calls CalculateRoots.*/
+	void GetRoots(double _dTime, double* _pVars, double* _pDerivs, double* _pRoots);
+	/** Handle event. Calls EventHandler.*/
+	bool HandleEvent(double _dTime, double* _pVars, double* _pDerivs, const int* _pRootsFound);
+	/** Calculate Jacobian. Calls CalculateJacobian.*/
+	void GetJacobian(double _dTime, double* _pVars, double* _pDerivs, double _dAlpha, CJacobianMatrix& _jacobian);
+	/** Calculate Jacobian-vector product. Calls CalculateJacobianTimesVector.*/
+	void GetJacobianTimesVector(double _dTime, double* _pVars, double* _pDerivs, double _dAlpha, double* _pVector, double* _pResult);
 };
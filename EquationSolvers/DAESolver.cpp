@@ -1,10 +1,21 @@
 /* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
 
 #include "DAESolver.h"
+#include "SUNJacobianMatrix.h"
+#include "ThreadedNVector.h"
 #include <ida/ida.h>
 #include <ida/ida_direct_impl.h>
 #include <sunmatrix/sunmatrix_dense.h>
 #include <sunlinsol/sunlinsol_dense.h>
+#include <sunmatrix/sunmatrix_band.h>
+#include <sunlinsol/sunlinsol_band.h>
+#include <sunlinsol/sunlinsol_spgmr.h>
+#include <ida/ida_spils.h>
+#include <ida/ida_bbdpre.h>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <sstream>
 #include <cstring>
 
 #ifdef _MSC_VER
@@ -15,19 +26,33 @@
 #endif
 
 CDAESolver::CDAESolver():
-	m_dMaxStep(0),
-	m_pIDAmem(nullptr),
 	m_pModel(nullptr),
-	m_dLastTime(0),
+	m_pIDAmem(nullptr),
 	m_vectorVars(nullptr),
 	m_vectorDers(nullptr),
 	m_vectorATols(nullptr),
 	m_vectorId(nullptr),
+	m_vectorOutVars(nullptr),
+	m_vectorOutDers(nullptr),
+	m_matrix(nullptr),
+	m_linearSolver(nullptr),
+	m_storeMatrix(nullptr),
+	m_storeLinearSolver(nullptr),
+	m_bPatternDetected(false),
+	m_nPatternFailures(0),
+	m_bCalcICPending(false),
+	m_dLastTime(0),
+	m_dMaxStep(0),
+	m_sErrorDescription(""),
 	m_pStoreIDAmem(nullptr),
 	m_StoreVectorVars(nullptr),
 	m_StoreVectorDers(nullptr),
-	m_sErrorDescription(""),
-	m_nMaxIter(500)
+	m_bStoreCalcICPending(false),
+	m_bStateChanged(true),
+	m_nMaxIter(500),
+	m_method(EDAEIntegrationMethod::BDF),
+	m_dOutputInterval(0),
+	m_dOutputTolerance(0)
 {
 }
 
@@ -46,12 +71,26 @@ size_t CDAESolver::GetSolverMaxIter()
 	return m_nMaxIter;
 }
 
+void CDAESolver::SetIntegrationMethod(EDAEIntegrationMethod _method)
+{
+	m_method = _method;
+}
+
+EDAEIntegrationMethod CDAESolver::GetIntegrationMethod() const
+{
+	return m_method;
+}
+
 bool CDAESolver::SetModel( CDAEModel* _pModel )
 {
 	ClearMemory();
 
 	m_pModel = _pModel;
 
+	// explicit methods do not need IDA
+	if( m_method != EDAEIntegrationMethod::BDF )
+		return m_RKSolver.SetModel( _pModel, m_method == EDAEIntegrationMethod::IMEX );
+
 	// Create IDA memory
 	m_pIDAmem = IDACreate();
 	if( m_pIDAmem == NULL )
@@ -67,13 +106,16 @@ bool CDAESolver::SetModel( CDAEModel* _pModel )
 
 	const sunindextype nVarsCnt = static_cast<sunindextype>(_pModel->GetVariablesNumber());
 
-	// Allocate N-vectors
-	m_vectorVars  = N_VNew_Serial(nVarsCnt);
-	m_vectorDers  = N_VNew_Serial(nVarsCnt);
-	m_vectorATols = N_VNew_Serial(nVarsCnt);
-	m_vectorId    = N_VNew_Serial(nVarsCnt);
+	// Allocate N-vectors; vector operations of IDA are run in parallel for block-parallel models, since IDA clones its internal vectors from them
+	const auto NewVector = _pModel->GetResidualBlocksNumber() > 1 ? &ThreadedNVector::New : &N_VNew_Serial;
+	m_vectorVars  = NewVector(nVarsCnt);
+	m_vectorDers  = NewVector(nVarsCnt);
+	m_vectorATols = NewVector(nVarsCnt);
+	m_vectorId    = NewVector(nVarsCnt);
+	m_vectorOutVars = N_VNew_Serial(nVarsCnt);
+	m_vectorOutDers = N_VNew_Serial(nVarsCnt);
 
-	if (!m_vectorVars || !m_vectorDers || !m_vectorATols || !m_vectorId)
+	if (!m_vectorVars || !m_vectorDers || !m_vectorATols || !m_vectorId || !m_vectorOutVars || !m_vectorOutDers)
 	{
 		ErrorHandler( -1, "IDA", "N_VNew_Serial", "Cannot allocate memory for solver.", &m_sErrorDescription );
 		return false;
@@ -116,26 +158,31 @@ bool CDAESolver::SetModel( CDAEModel* _pModel )
 	if( IDAInit( m_pIDAmem, &CDAESolver::ResidualFunction, ZERO, m_vectorVars, m_vectorDers ) != IDA_SUCCESS )
 		return false;
 
-	// Set model as user data
-	if( IDASetUserData( m_pIDAmem, _pModel ) != IDA_SUCCESS )
+	// Set solver as user data
+	if( IDASetUserData( m_pIDAmem, this ) != IDA_SUCCESS )
 		return false;
 
 	// Set tolerances
 	if( IDASVtolerances( m_pIDAmem, _pModel->GetRTol(), m_vectorATols ) != IDA_SUCCESS )
 		return false;
 
+	// Set root functions to locate events
+	if( _pModel->GetRootsNumber() != 0 )
+	{
+		if( IDARootInit( m_pIDAmem, static_cast<int>(_pModel->GetRootsNumber()), &CDAESolver::RootFunction ) != IDA_SUCCESS )
+			return false;
+		m_vRootsFound.resize(_pModel->GetRootsNumber());
+	}
+
+	// Prepare colored finite-difference Jacobian before creating matrices, since the detected pattern defines bandwidths
+	if (_pModel->GetUseColoredJacobian() && !_pModel->GetUseAnalyticalJacobian() && _pModel->GetJacobianType() != EJacobianType::SPARSE)
+		if (!InitColoredJacobian())
+			return false;
+
 	// Set linear solver
-	SUNMatrix A;
-	SUNLinearSolver LS;
-	/* Create dense SUNMatrix for use in linear solves */
-	A = SUNDenseMatrix(nVarsCnt, nVarsCnt);
-	/* Create dense SUNMatrix for use in linear solves */
-	LS = SUNDenseLinearSolver(m_vectorVars, A);
-	/* Attach the matrix and linear solver */
-	if (IDADlsSetLinearSolver(m_pIDAmem, LS, A) != IDADLS_SUCCESS)
+	if (!SetupLinearSolver(m_pIDAmem, m_vectorVars, m_matrix, m_linearSolver))
 		return false;
 
-
 	if( !InitStoringMemory() )
 		return false;
 
@@ -146,6 +193,12 @@ bool CDAESolver::SetModel( CDAEModel* _pModel )
 
 bool CDAESolver::Calculate( realtype _dStartTime, realtype _dEndTime )
 {
+	if( m_method != EDAEIntegrationMethod::BDF )
+		return m_RKSolver.Calculate( _dStartTime, _dEndTime );
+
+	m_bStateChanged = true;
+	UpdateStatistics();
+
 	if( _dStartTime == _dEndTime )
 	{
 		ErrorHandler( -1, "CDAESolver", "Calculate", "Start and end time are equal. Cannot perform calculations for dynamic unit.", &m_sErrorDescription );
@@ -161,10 +214,14 @@ bool CDAESolver::Calculate( realtype _dStartTime, realtype _dEndTime )
 		vConsistDers = N_VNew_Serial( static_cast<sunindextype>(m_pModel->GetVariablesNumber()) );
 		if( IDAGetConsistentIC( m_pIDAmem, vConsistVars, vConsistDers ) != IDA_SUCCESS )
 			return false;
-		m_pModel->HandleResults( 0, NV_DATA_S( vConsistVars ), NV_DATA_S( vConsistDers ) );
+		OutputResults( 0, vConsistVars, vConsistDers );
 		N_VDestroy_Serial( vConsistVars );
 		N_VDestroy_Serial( vConsistDers );
 	}
+	else if( m_bCalcICPending && !CalculateConsistentValues( _dEndTime ) )
+		return false;
+	else
+		m_vLastOutput.assign(NV_DATA_S(m_vectorVars), NV_DATA_S(m_vectorVars) + NV_LENGTH_S(m_vectorVars));
 
 	realtype dStep = (_dEndTime - _dStartTime) / 2.0;
 	if((m_dMaxStep != 0) && (dStep > m_dMaxStep))
@@ -175,21 +232,58 @@ bool CDAESolver::Calculate( realtype _dStartTime, realtype _dEndTime )
 	if( IDASetStopTime( m_pIDAmem, RCONST(_dEndTime) ) != IDA_SUCCESS )
 		return false;
 
+	const bool bDecimate = m_dOutputInterval > 0 || m_dOutputTolerance > 0;
+	// first output time point on the grid of output interval after the start time
+	realtype dNextOutput = m_dOutputInterval > 0 ? (std::floor(_dStartTime / m_dOutputInterval) + 1) * m_dOutputInterval : _dEndTime;
+	realtype dLastOutput = _dStartTime;
+
 	int bRes;
 	do
 	{
 		bRes = IDASolve( m_pIDAmem, _dEndTime, &m_dLastTime, m_vectorVars, m_vectorDers, IDA_ONE_STEP );
 		if( bRes < 0 )
 			return false;
-		m_pModel->HandleResults( m_dLastTime, NV_DATA_S( m_vectorVars ), NV_DATA_S( m_vectorDers ) );
+		if( !bDecimate )
+		{
+			m_pModel->HandleResults( m_dLastTime, NV_DATA_S( m_vectorVars ), NV_DATA_S( m_vectorDers ) );
+			if( bRes == IDA_ROOT_RETURN && !ProcessEvent( _dEndTime ) )
+				return false;
+			continue;
+		}
+		// output requested time points passed by this step, interpolating with IDA dense output
+		while( dNextOutput < m_dLastTime && dNextOutput < _dEndTime )
+		{
+			if( IDAGetDky( m_pIDAmem, dNextOutput, 0, m_vectorOutVars ) != IDA_SUCCESS || IDAGetDky( m_pIDAmem, dNextOutput, 1, m_vectorOutDers ) != IDA_SUCCESS )
+				return false;
+			OutputResults( dNextOutput, m_vectorOutVars, m_vectorOutDers );
+			dLastOutput = dNextOutput;
+			dNextOutput += m_dOutputInterval;
+		}
+		// output the step itself if it is a requested time point, the end of the interval, an event, or the solution has changed significantly
+		if( m_dLastTime == dNextOutput || bRes == IDA_TSTOP_RETURN || bRes == IDA_ROOT_RETURN || ( m_dOutputTolerance > 0 && IsOutputChanged() ) )
+		{
+			if( m_dLastTime != dLastOutput )
+				OutputResults( m_dLastTime, m_vectorVars, m_vectorDers );
+			dLastOutput = m_dLastTime;
+			if( m_dLastTime == dNextOutput )
+				dNextOutput += m_dOutputInterval;
+		}
+		if( bRes == IDA_ROOT_RETURN && !ProcessEvent( _dEndTime ) )
+			return false;
 	}
-	while( bRes != IDA_TSTOP_RETURN );
+	while( bRes != IDA_TSTOP_RETURN && m_dLastTime < _dEndTime );
 
 	return true;
 }
 
 bool CDAESolver::Calculate( realtype _dTime )
 {
+	if( m_method != EDAEIntegrationMethod::BDF )
+		return m_RKSolver.Calculate( _dTime );
+
+	m_bStateChanged = true;
+	UpdateStatistics();
+
 	if( _dTime == 0 )
 	{
 		if( IDACalcIC( m_pIDAmem, IDA_YA_YDP_INIT, 0.001 ) != IDA_SUCCESS )
@@ -200,6 +294,8 @@ bool CDAESolver::Calculate( realtype _dTime )
 	{
 		if( IDASetStopTime( m_pIDAmem, RCONST(_dTime) ) != IDA_SUCCESS )
 			return false;
+		if( m_bCalcICPending && !CalculateConsistentValues( _dTime ) )
+			return false;
 
 		int bRes;
 		do
@@ -207,8 +303,10 @@ bool CDAESolver::Calculate( realtype _dTime )
 			bRes = IDASolve( m_pIDAmem, _dTime, &m_dLastTime, m_vectorVars, m_vectorDers, IDA_ONE_STEP );
 			if( bRes < 0 )
 				return false;
+			if( bRes == IDA_ROOT_RETURN && !ProcessEvent( _dTime ) )
+				return false;
 		}
-		while( bRes != IDA_TSTOP_RETURN );
+		while( bRes != IDA_TSTOP_RETURN && m_dLastTime < _dTime );
 		m_pModel->HandleResults( m_dLastTime, NV_DATA_S( m_vectorVars ), NV_DATA_S( m_vectorDers ) );
 	}
 
@@ -217,42 +315,468 @@ bool CDAESolver::Calculate( realtype _dTime )
 
 void CDAESolver::SaveState()
 {
+	if( m_method != EDAEIntegrationMethod::BDF )
+	{
+		m_RKSolver.SaveState();
+		return;
+	}
+	// the stored state is still equal to the current one
+	if( !m_bStateChanged ) return;
 	CopyIDAmem( m_pStoreIDAmem, m_pIDAmem );
 	CopyNVector( m_StoreVectorVars, m_vectorVars );
 	CopyNVector( m_StoreVectorDers, m_vectorDers );
+	m_bStoreCalcICPending = m_bCalcICPending;
+	m_bStateChanged = false;
 }
 
 void CDAESolver::LoadState()
 {
+	if( m_method != EDAEIntegrationMethod::BDF )
+	{
+		m_RKSolver.LoadState();
+		return;
+	}
+	// nothing has been calculated since the last saving or loading
+	if( !m_bStateChanged ) return;
+	// count work done before restoring of counters
+	UpdateStatistics();
 	CopyIDAmem( m_pIDAmem, m_pStoreIDAmem );
 	CopyNVector( m_vectorVars, m_StoreVectorVars );
 	CopyNVector( m_vectorDers, m_StoreVectorDers );
+	m_bCalcICPending = m_bStoreCalcICPending;
+	m_statisticsIDA = ReadStatistics();
+	m_bStateChanged = false;
+}
+
+SSolverStatistics CDAESolver::GetStatistics()
+{
+	if( m_method != EDAEIntegrationMethod::BDF )
+		return m_RKSolver.GetStatistics();
+	UpdateStatistics();
+	return m_statistics;
+}
+
+SSolverStatistics CDAESolver::ReadStatistics() const
+{
+	SSolverStatistics stat;
+	if( !m_pIDAmem ) return stat;
+	long nResiduals = 0, nJacobians = 0;
+	IDAGetNumSteps( m_pIDAmem, &stat.nSteps );
+	IDAGetNumResEvals( m_pIDAmem, &nResiduals );
+	IDAGetNumLinSolvSetups( m_pIDAmem, &stat.nLinearSetups );
+	IDAGetNumNonlinSolvIters( m_pIDAmem, &stat.nNonlinearIterations );
+	IDAGetNumNonlinSolvConvFails( m_pIDAmem, &stat.nNonlinearFailures );
+	IDAGetNumErrTestFails( m_pIDAmem, &stat.nErrorTestFailures );
+	if( m_pModel->GetJacobianType() == EJacobianType::SPARSE )
+	{
+		IDASpilsGetNumResEvals( m_pIDAmem, &stat.nResiduals );
+		IDASpilsGetNumPrecEvals( m_pIDAmem, &nJacobians );
+		IDASpilsGetNumLinIters( m_pIDAmem, &stat.nLinearIterations );
+	}
+	else
+	{
+		IDADlsGetNumResEvals( m_pIDAmem, &stat.nResiduals );
+		IDADlsGetNumJacEvals( m_pIDAmem, &nJacobians );
+	}
+	stat.nResiduals += nResiduals;
+	stat.nJacobians = nJacobians;
+	return stat;
+}
+
+void CDAESolver::UpdateStatistics()
+{
+	// counters of IDA are read anew after each reinitialization and loading of IDA memory, so they only grow in between
+	const SSolverStatistics cur = ReadStatistics();
+	m_statistics += cur - m_statisticsIDA;
+	m_statisticsIDA = cur;
 }
 
 std::string CDAESolver::GetError()
 {
+	if (m_method != EDAEIntegrationMethod::BDF)
+		return m_RKSolver.GetError();
+	if (!m_sJacobianCheckDescription.empty())
+		return m_sErrorDescription + " " + m_sJacobianCheckDescription;
 	return m_sErrorDescription;
 }
 
+std::string CDAESolver::GetWarning() const
+{
+	return m_sWarningDescription;
+}
+
+void CDAESolver::ClearWarning()
+{
+	m_sWarningDescription.clear();
+}
+
+void CDAESolver::SetOutputInterval(double _dInterval)
+{
+	m_dOutputInterval = _dInterval > 0 ? _dInterval : 0;
+	m_RKSolver.SetOutputInterval(m_dOutputInterval);
+}
+
+double CDAESolver::GetOutputInterval() const
+{
+	return m_dOutputInterval;
+}
+
+void CDAESolver::SetOutputTolerance(double _dTolerance)
+{
+	m_dOutputTolerance = _dTolerance > 0 ? _dTolerance : 0;
+	m_RKSolver.SetOutputTolerance(m_dOutputTolerance);
+}
+
+double CDAESolver::GetOutputTolerance() const
+{
+	return m_dOutputTolerance;
+}
+
+bool CDAESolver::ProcessEvent(realtype _dEndTime)
+{
+	if( IDAGetRootInfo( m_pIDAmem, m_vRootsFound.data() ) != IDA_SUCCESS )
+		return false;
+	if( !m_pModel->HandleEvent( m_dLastTime, NV_DATA_S( m_vectorVars ), NV_DATA_S( m_vectorDers ), m_vRootsFound.data() ) )
+		return true;
+
+	// restart integration from the state after the event instead of stepping over the discontinuity
+	UpdateStatistics();
+	if( IDAReInit( m_pIDAmem, m_dLastTime, m_vectorVars, m_vectorDers ) != IDA_SUCCESS )
+		return false;
+	// reinitialization resets counters of IDA, but not the ones of the linear solver, so the counters after it are the offsets for further updates
+	m_statisticsIDA = ReadStatistics();
+	// the event may break consistency of variables and derivatives; at the end of the interval it is restored on the next call
+	m_bCalcICPending = true;
+	if( m_dLastTime < _dEndTime )
+		return CalculateConsistentValues( _dEndTime );
+	return true;
+}
+
+bool CDAESolver::CalculateConsistentValues(realtype _dEndTime)
+{
+	m_bCalcICPending = false;
+	if( IDACalcIC( m_pIDAmem, IDA_YA_YDP_INIT, _dEndTime ) != IDA_SUCCESS )
+		return false;
+	if( IDAGetConsistentIC( m_pIDAmem, m_vectorVars, m_vectorDers ) != IDA_SUCCESS )
+		return false;
+	OutputResults( m_dLastTime, m_vectorVars, m_vectorDers );
+	return true;
+}
+
+void CDAESolver::OutputResults(realtype _dTime, N_Vector _vars, N_Vector _ders)
+{
+	m_pModel->HandleResults(_dTime, NV_DATA_S(_vars), NV_DATA_S(_ders));
+	m_vLastOutput.assign(NV_DATA_S(_vars), NV_DATA_S(_vars) + NV_LENGTH_S(_vars));
+}
+
+bool CDAESolver::IsOutputChanged() const
+{
+	const realtype* pVars = NV_DATA_S(m_vectorVars);
+	const realtype* pATols = NV_DATA_S(m_vectorATols);
+	for (size_t i = 0; i < m_vLastOutput.size(); ++i)
+		if (std::abs(pVars[i] - m_vLastOutput[i]) > m_dOutputTolerance * std::abs(m_vLastOutput[i]) + pATols[i])
+			return true;
+	return false;
+}
+
 bool CDAESolver::SetMaxStep( double _dStep )
 {
 	m_dMaxStep = _dStep;
+	m_RKSolver.SetMaxStep( m_dMaxStep );
+	if( m_method != EDAEIntegrationMethod::BDF )
+		return true;
 	if( IDASetMaxStep( m_pIDAmem, RCONST( m_dMaxStep ) ) != IDA_SUCCESS )
 		return false;
 	return true;
 }
 
-int CDAESolver::ResidualFunction( realtype _dTime, N_Vector _value, N_Vector _deriv, N_Vector _res, void *_pModel )
+int CDAESolver::ResidualFunction( realtype _dTime, N_Vector _value, N_Vector _deriv, N_Vector _res, void *_pSolver )
 {
 	realtype *pValue = NV_DATA_S( _value );
 	realtype *pDeriv = NV_DATA_S( _deriv );
 	realtype *pResult = NV_DATA_S( _res );
 
-	bool bRes = (static_cast<CDAEModel*>(_pModel))->GetResiduals( _dTime, pValue, pDeriv, pResult );
+	bool bRes = static_cast<CDAESolver*>(_pSolver)->m_pModel->GetResiduals( _dTime, pValue, pDeriv, pResult );
 
 	return bRes ? 0 : -1;
 }
 
+int CDAESolver::LocalResidualFunction(sunindextype /*_nLocal*/, realtype _dTime, N_Vector _value, N_Vector _deriv, N_Vector _res, void *_pSolver)
+{
+	return ResidualFunction(_dTime, _value, _deriv, _res, _pSolver);
+}
+
+int CDAESolver::RootFunction(realtype _dTime, N_Vector _value, N_Vector _deriv, realtype* _pRoots, void *_pSolver)
+{
+	static_cast<CDAESolver*>(_pSolver)->m_pModel->GetRoots(_dTime, NV_DATA_S(_value), NV_DATA_S(_deriv), _pRoots);
+	return 0;
+}
+
+int CDAESolver::JacobianFunction(realtype _dTime, realtype _dAlpha, N_Vector _value, N_Vector _deriv, N_Vector _res, SUNMatrix _jacobian, void *_pSolver, N_Vector _tmp1, N_Vector _tmp2, N_Vector _tmp3)
+{
+	auto* pSolver = static_cast<CDAESolver*>(_pSolver);
+	SUNMatZero(_jacobian);
+	CSUNJacobianMatrix jacobian(_jacobian);
+	pSolver->m_pModel->GetJacobian(_dTime, NV_DATA_S(_value), NV_DATA_S(_deriv), _dAlpha, jacobian);
+	if (pSolver->m_pModel->GetCheckJacobian() && !pSolver->CheckJacobian(_dTime, _dAlpha, _value, _deriv, _res, _jacobian, _tmp1, _tmp2, _tmp3))
+		return -1;
+	return 0;
+}
+
+int CDAESolver::JacobianTimesVectorFunction(realtype _dTime, N_Vector _value, N_Vector _deriv, N_Vector _res, N_Vector _vector, N_Vector _result, realtype _dAlpha, void *_pSolver, N_Vector _tmp1, N_Vector _tmp2)
+{
+	auto* pSolver = static_cast<CDAESolver*>(_pSolver);
+	pSolver->m_pModel->GetJacobianTimesVector(_dTime, NV_DATA_S(_value), NV_DATA_S(_deriv), _dAlpha, NV_DATA_S(_vector), NV_DATA_S(_result));
+	if (pSolver->m_pModel->GetCheckJacobian() && !pSolver->CheckJacobianTimesVector(_dTime, _dAlpha, _value, _deriv, _res, _vector, _result, _tmp1, _tmp2))
+		return -1;
+	return 0;
+}
+
+int CDAESolver::ColoredJacobianFunction(realtype _dTime, realtype _dAlpha, N_Vector _value, N_Vector _deriv, N_Vector _res, SUNMatrix _jacobian, void *_pSolver, N_Vector _tmp1, N_Vector _tmp2, N_Vector _tmp3)
+{
+	auto* pSolver = static_cast<CDAESolver*>(_pSolver);
+	const CJacobianPattern& pattern = pSolver->m_pModel->GetJacobianPattern();
+	const realtype dRTol = pSolver->m_pModel->GetRTol();
+	const realtype* pATol = NV_DATA_S(pSolver->m_vectorATols);
+	const realtype* pValue = NV_DATA_S(_value);
+	const realtype* pDeriv = NV_DATA_S(_deriv);
+	const realtype* pRes = NV_DATA_S(_res);
+	realtype* pPertValue = NV_DATA_S(_tmp1);
+	realtype* pPertDeriv = NV_DATA_S(_tmp2);
+	realtype* pPertRes = NV_DATA_S(_tmp3);
+	std::vector<realtype>& vInc = pSolver->m_vIncrements;
+	realtype dStep = 0;
+	IDAGetCurrentStep(pSolver->m_pIDAmem, &dStep);
+
+	// repeated convergence failures may be caused by dependencies, which have not been revealed at the initial point
+	if (pSolver->m_bPatternDetected)
+	{
+		pSolver->UpdateStatistics();
+		if (pSolver->m_statistics.nNonlinearFailures - pSolver->m_nPatternFailures >= m_cnMaxPatternFailures)
+			pSolver->ExtendJacobianPattern(_dTime, pValue, pDeriv);
+	}
+
+	pSolver->CopyNVector(_tmp1, _value);
+	pSolver->CopyNVector(_tmp2, _deriv);
+	SUNMatZero(_jacobian);
+	CSUNJacobianMatrix jacobian(_jacobian);
+	for (const auto& color : pSolver->m_vColors)
+	{
+		// perturb all variables of the color, increments are chosen as in the difference quotient of IDA
+		for (const size_t j : color)
+		{
+			realtype dInc = std::max(std::sqrt(DBL_EPSILON) * std::max(std::abs(pValue[j]), std::abs(dStep * pDeriv[j])), dRTol * std::abs(pValue[j]) + pATol[j]);
+			if (dStep * pDeriv[j] < 0)
+				dInc = -dInc;
+			dInc = (pValue[j] + dInc) - pValue[j];
+			vInc[j] = dInc;
+			pPertValue[j] += dInc;
+			pPertDeriv[j] += _dAlpha * dInc;
+		}
+		// residuals calculated here are not counted by IDA
+		pSolver->m_statistics.nResiduals++;
+		if (!pSolver->m_pModel->GetResiduals(_dTime, pPertValue, pPertDeriv, pPertRes))
+			return 1;
+		// columns of one color have no common rows, so each changed residual belongs to a single column
+		for (const size_t j : color)
+		{
+			for (const size_t i : pattern.GetColumn(j))
+				jacobian.SetEntry(i, j, (pPertRes[i] - pRes[i]) / vInc[j]);
+			pPertValue[j] = pValue[j];
+			pPertDeriv[j] = pDeriv[j];
+		}
+	}
+	return 0;
+}
+
+bool CDAESolver::InitColoredJacobian()
+{
+	const size_t nVarsCnt = m_pModel->GetVariablesNumber();
+	const CJacobianPattern& pattern = m_pModel->GetJacobianPattern();
+	m_bPatternDetected = pattern.GetSize() != nVarsCnt || pattern.IsEmpty();
+	if (m_bPatternDetected)
+	{
+		CJacobianPattern detected(nVarsCnt);
+		if (!DetectJacobianPattern(0, NV_DATA_S(m_vectorVars), NV_DATA_S(m_vectorDers), detected))
+		{
+			ErrorHandler(-1, "CDAESolver", "InitColoredJacobian", "Cannot calculate residuals at the initial point.", &m_sErrorDescription);
+			return false;
+		}
+		m_pModel->SetJacobianPattern(detected);
+	}
+
+	m_vColors = m_pModel->GetJacobianPattern().ColorColumns();
+	m_vIncrements.resize(nVarsCnt);
+	m_nPatternFailures = m_statistics.nNonlinearFailures;
+	return true;
+}
+
+bool CDAESolver::DetectJacobianPattern(realtype _dTime, const realtype* _pVars, const realtype* _pDers, CJacobianPattern& _pattern)
+{
+	const size_t nVarsCnt = m_pModel->GetVariablesNumber();
+	std::vector<realtype> vVars(_pVars, _pVars + nVarsCnt);
+	std::vector<realtype> vDers(_pDers, _pDers + nVarsCnt);
+	std::vector<realtype> vRes0(nVarsCnt), vRes(nVarsCnt);
+	m_statistics.nResiduals++;
+	if (!m_pModel->GetResiduals(_dTime, vVars.data(), vDers.data(), vRes0.data()))
+		return false;
+	for (size_t j = 0; j < nVarsCnt; ++j)
+	{
+		for (auto* pVec : { &vVars, &vDers })
+			for (const double dRelInc : JACOBIAN_PROBE_INCREMENTS)
+			{
+				const realtype dOld = (*pVec)[j];
+				(*pVec)[j] += std::max(std::abs(dOld), RCONST(1.0)) * dRelInc;
+				m_statistics.nResiduals++;
+				const bool bSuccess = m_pModel->GetResiduals(_dTime, vVars.data(), vDers.data(), vRes.data());
+				(*pVec)[j] = dOld;
+				// a perturbation may leave the domain of the model, then it reveals nothing
+				if (bSuccess)
+					_pattern.AddChangedEntries(j, vRes0, vRes);
+			}
+		// diagonal is always kept to get a non-singular iteration matrix
+		_pattern.AddEntry(j, j);
+	}
+	return true;
+}
+
+void CDAESolver::ExtendJacobianPattern(realtype _dTime, const realtype* _pVars, const realtype* _pDers)
+{
+	m_nPatternFailures = m_statistics.nNonlinearFailures;
+	CJacobianPattern pattern = m_pModel->GetJacobianPattern();
+	const size_t nOldEntries = pattern.GetEntriesNumber();
+	if (!DetectJacobianPattern(_dTime, _pVars, _pDers, pattern) || pattern.GetEntriesNumber() == nOldEntries) return;
+	m_pModel->SetJacobianPattern(pattern);
+	m_vColors = pattern.ColorColumns();
+	const std::string sWarning = "Repeated convergence failures at t = " + std::to_string(_dTime) + ": sparsity pattern of the colored Jacobian has been extended by " + std::to_string(pattern.GetEntriesNumber() - nOldEntries) + " entries.";
+	m_sWarningDescription += (m_sWarningDescription.empty() ? "" : "\n") + sWarning;
+}
+
+bool CDAESolver::CheckJacobian(realtype _dTime, realtype _dAlpha, N_Vector _value, N_Vector _deriv, N_Vector _res, SUNMatrix _jacobian, N_Vector _tmp1, N_Vector _tmp2, N_Vector _tmp3)
+{
+	const CSUNJacobianMatrix jacobian(_jacobian);
+	const size_t nVarsCnt = m_pModel->GetVariablesNumber();
+	const double dTol = m_pModel->GetCheckJacobianTolerance();
+	realtype* pValue = NV_DATA_S(_value);
+	realtype* pDeriv = NV_DATA_S(_deriv);
+	realtype* pRes = NV_DATA_S(_res);
+	realtype* pPertRes = NV_DATA_S(_tmp3);
+	CopyNVector(_tmp1, _value);
+	CopyNVector(_tmp2, _deriv);
+	for (size_t j = 0; j < nVarsCnt; ++j)
+	{
+		// perturb variable and its derivative consistently with J = dF/dy + c_j * dF/dy'
+		const realtype dInc = std::sqrt(DBL_EPSILON) * std::max(std::abs(pValue[j]), RCONST(1.0));
+		NV_DATA_S(_tmp1)[j] = pValue[j] + dInc;
+		NV_DATA_S(_tmp2)[j] = pDeriv[j] + _dAlpha * dInc;
+		if (!m_pModel->GetResiduals(_dTime, NV_DATA_S(_tmp1), NV_DATA_S(_tmp2), pPertRes))
+			return false;
+		NV_DATA_S(_tmp1)[j] = pValue[j];
+		NV_DATA_S(_tmp2)[j] = pDeriv[j];
+		for (size_t i = 0; i < nVarsCnt; ++i)
+		{
+			if (!jacobian.IsStored(i, j)) continue;
+			const double dNumeric = (pPertRes[i] - pRes[i]) / dInc;
+			const double dAnalytic = jacobian.GetEntry(i, j);
+			if (std::abs(dAnalytic - dNumeric) > dTol * std::max({ std::abs(dAnalytic), std::abs(dNumeric), 1.0 }))
+			{
+				std::ostringstream os;
+				os << "Analytical Jacobian differs from finite differences in entry (" << i << ", " << j << ") at time " << _dTime << ": analytical " << dAnalytic << ", numerical " << dNumeric << ".";
+				m_sJacobianCheckDescription = os.str();
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool CDAESolver::CheckJacobianTimesVector(realtype _dTime, realtype _dAlpha, N_Vector _value, N_Vector _deriv, N_Vector _res, N_Vector _vector, N_Vector _result, N_Vector _tmp1, N_Vector _tmp2)
+{
+	const size_t nVarsCnt = m_pModel->GetVariablesNumber();
+	const double dTol = m_pModel->GetCheckJacobianTolerance();
+	const realtype dNormV = N_VMaxNorm(_vector);
+	if (dNormV == 0) return true;
+	// directional difference F(y + s*v, y' + c_j*s*v) - F(y, y')
+	const realtype dInc = std::sqrt(DBL_EPSILON) * std::max(N_VMaxNorm(_value), RCONST(1.0)) / dNormV;
+	N_VLinearSum(1.0, _value, dInc, _vector, _tmp1);
+	N_VLinearSum(1.0, _deriv, _dAlpha * dInc, _vector, _tmp2);
+	std::vector<realtype> vPertRes(nVarsCnt);
+	if (!m_pModel->GetResiduals(_dTime, NV_DATA_S(_tmp1), NV_DATA_S(_tmp2), vPertRes.data()))
+		return false;
+	for (size_t i = 0; i < nVarsCnt; ++i)
+	{
+		const double dNumeric = (vPertRes[i] - NV_DATA_S(_res)[i]) / dInc;
+		const double dAnalytic = NV_DATA_S(_result)[i];
+		if (std::abs(dAnalytic - dNumeric) > dTol * std::max({ std::abs(dAnalytic), std::abs(dNumeric), 1.0 }))
+		{
+			std::ostringstream os;
+			os << "Analytical Jacobian-vector product differs from finite differences in entry " << i << " at time " << _dTime << ": analytical " << dAnalytic << ", numerical " << dNumeric << ".";
+			m_sJacobianCheckDescription = os.str();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool CDAESolver::SetupLinearSolver(void* _pIDAmem, N_Vector _vector, SUNMatrix& _matrix, SUNLinearSolver& _solver)
+{
+	const sunindextype nVarsCnt = static_cast<sunindextype>(m_pModel->GetVariablesNumber());
+	const sunindextype nUpper = static_cast<sunindextype>(m_pModel->GetUpperBandwidth());
+	const sunindextype nLower = static_cast<sunindextype>(m_pModel->GetLowerBandwidth());
+
+	switch (m_pModel->GetJacobianType())
+	{
+	case EJacobianType::DENSE:
+		_matrix = SUNDenseMatrix(nVarsCnt, nVarsCnt);
+		_solver = SUNDenseLinearSolver(_vector, _matrix);
+		break;
+	case EJacobianType::BANDED:
+		// additional upper diagonals are needed to store LU factors
+		_matrix = SUNBandMatrix(nVarsCnt, nUpper, nLower, std::min<sunindextype>(nVarsCnt - 1, nUpper + nLower));
+		_solver = SUNBandLinearSolver(_vector, _matrix);
+		break;
+	case EJacobianType::SPARSE:
+		_matrix = nullptr;
+		_solver = SUNSPGMR(_vector, PREC_LEFT, 0);
+		break;
+	}
+
+	if (!_solver || (!_matrix && m_pModel->GetJacobianType() != EJacobianType::SPARSE))
+	{
+		ErrorHandler(-1, "IDA", "SetupLinearSolver", "Cannot allocate memory for linear solver.", &m_sErrorDescription);
+		return false;
+	}
+
+	if (m_pModel->GetJacobianType() == EJacobianType::SPARSE)
+	{
+		// matrix-free Krylov solver preconditioned with a banded approximation of the Jacobian
+		if (IDASpilsSetLinearSolver(_pIDAmem, _solver) != IDASPILS_SUCCESS)
+			return false;
+		if (IDABBDPrecInit(_pIDAmem, nVarsCnt, nUpper, nLower, nUpper, nLower, ZERO, &CDAESolver::LocalResidualFunction, nullptr) != IDASPILS_SUCCESS)
+			return false;
+		if (m_pModel->GetUseAnalyticalJacobianTimesVector())
+			if (IDASpilsSetJacTimes(_pIDAmem, nullptr, &CDAESolver::JacobianTimesVectorFunction) != IDASPILS_SUCCESS)
+				return false;
+	}
+	else
+	{
+		if (IDADlsSetLinearSolver(_pIDAmem, _solver, _matrix) != IDADLS_SUCCESS)
+			return false;
+		if (m_pModel->GetUseAnalyticalJacobian())
+		{
+			if (IDADlsSetJacFn(_pIDAmem, &CDAESolver::JacobianFunction) != IDADLS_SUCCESS)
+				return false;
+		}
+		else if (!m_vColors.empty())
+		{
+			if (IDADlsSetJacFn(_pIDAmem, &CDAESolver::ColoredJacobianFunction) != IDADLS_SUCCESS)
+				return false;
+		}
+	}
+
+	return true;
+}
+
 bool CDAESolver::InitStoringMemory()
 {
 	// Allocate IDA memory for storing
@@ -281,15 +805,13 @@ bool CDAESolver::InitStoringMemory()
 	if (IDAInit(m_pStoreIDAmem, &CDAESolver::ResidualFunction, ZERO, m_StoreVectorVars, m_StoreVectorDers) != IDA_SUCCESS)
 		return false;
 
-	// Set linear solver
-	SUNMatrix A;
-	SUNLinearSolver LS;
-	/* Create dense SUNMatrix for use in linear solves */
-	A = SUNDenseMatrix(nVarsCnt, nVarsCnt);
-	/* Create dense SUNMatrix for use in linear solves */
-	LS = SUNDenseLinearSolver(m_vectorVars, A);
-	/* Attach the matrix and linear solver */
-	if (IDADlsSetLinearSolver(m_pStoreIDAmem, LS, A) != IDADLS_SUCCESS)
+	// Allocate memory for rootfinding data
+	if (m_pModel->GetRootsNumber() != 0)
+		if (IDARootInit(m_pStoreIDAmem, static_cast<int>(m_pModel->GetRootsNumber()), &CDAESolver::RootFunction) != IDA_SUCCESS)
+			return false;
+
+	// Set linear solver of the same type as in the main IDA memory
+	if (!SetupLinearSolver(m_pStoreIDAmem, m_StoreVectorVars, m_storeMatrix, m_storeLinearSolver))
 		return false;
 
 	IDAMem originMem = static_cast<IDAMemRec*>( m_pIDAmem );
@@ -310,6 +832,14 @@ bool CDAESolver::InitStoringMemory()
 void CDAESolver::ClearMemory()
 {
 	m_sErrorDescription.clear();
+	m_sJacobianCheckDescription.clear();
+	m_vColors.clear();
+	m_vIncrements.clear();
+	m_vRootsFound.clear();
+	m_bCalcICPending = false;
+	m_bStateChanged = true;
+	m_statistics = SSolverStatistics{};
+	m_statisticsIDA = SSolverStatistics{};
 
 	// free vectors
 	if (m_vectorVars)		{ N_VDestroy_Serial(m_vectorVars);		m_vectorVars = nullptr; }
@@ -318,8 +848,12 @@ void CDAESolver::ClearMemory()
 	if (m_StoreVectorDers)	{ N_VDestroy_Serial(m_StoreVectorDers);	m_StoreVectorDers = nullptr; }
 	if (m_vectorATols)		{ N_VDestroy_Serial(m_vectorATols);		m_vectorATols = nullptr; }
 	if (m_vectorId)			{ N_VDestroy_Serial(m_vectorId);		m_vectorId = nullptr; }
+	if (m_vectorOutVars)	{ N_VDestroy_Serial(m_vectorOutVars);	m_vectorOutVars = nullptr; }
+	if (m_vectorOutDers)	{ N_VDestroy_Serial(m_vectorOutDers);	m_vectorOutDers = nullptr; }
 	// free IDA memory
 	if (m_pIDAmem)			{ IDAFree(&m_pIDAmem);					m_pIDAmem = nullptr; }
+	if (m_linearSolver)		{ SUNLinSolFree(m_linearSolver);		m_linearSolver = nullptr; }
+	if (m_matrix)			{ SUNMatDestroy(m_matrix);				m_matrix = nullptr; }
 	// free store IDA memory
 	if (m_pStoreIDAmem)
 	{
@@ -331,6 +865,8 @@ void CDAESolver::ClearMemory()
 		if (storeMem->ida_mm)		{ N_VDestroy_Serial(storeMem->ida_mm);		storeMem->ida_mm = nullptr; }
 		IDAFree(&m_pStoreIDAmem);	m_pStoreIDAmem = nullptr;
 	}
+	if (m_storeLinearSolver)	{ SUNLinSolFree(m_storeLinearSolver);	m_storeLinearSolver = nullptr; }
+	if (m_storeMatrix)			{ SUNMatDestroy(m_storeMatrix);			m_storeMatrix = nullptr; }
 }
 
 void CDAESolver::CopyNVector( N_Vector _dst, N_Vector _src )
@@ -347,8 +883,10 @@ void CDAESolver::CopyIDAmem( void* _pDst, void* _pSrc )
 	IDAMem src = static_cast<IDAMemRec*>( _pSrc );
 	IDAMem dst = static_cast<IDAMemRec*>( _pDst );
 
-	// Divided differences array and associated minor arrays
-	for(size_t i=0; i<MXORDP1; ++i )
+	// Divided differences array and associated minor arrays.
+	// Only phi[0..kused+1] are read by IDA on the next step (phi[kk+1] if the order is being raised), the rest is overwritten before use.
+	const size_t nPhi = std::min<size_t>( MXORDP1, static_cast<size_t>( std::max( src->ida_kk, src->ida_kused ) ) + 2 );
+	for(size_t i=0; i<nPhi; ++i )
 		std::memcpy( NV_DATA_S( dst->ida_phi[i] ), NV_DATA_S( src->ida_phi[i] ), sizeof(realtype)*NV_LENGTH_S( src->ida_phi[i] ) );
 	std::memcpy( dst->ida_psi, src->ida_psi, sizeof(realtype)*MXORDP1 );
 	std::memcpy( dst->ida_alpha, src->ida_alpha, sizeof(realtype)*MXORDP1 );
@@ -414,8 +952,22 @@ void CDAESolver::CopyIDAmem( void* _pDst, void* _pSrc )
 	dst->ida_trout = src->ida_trout;
 	dst->ida_toutc = src->ida_toutc;
 	dst->ida_taskc = src->ida_taskc;
+	if (src->ida_nrtfn > 0 && src->ida_glo != NULL && dst->ida_glo != NULL)
+	{
+		dst->ida_tlo = src->ida_tlo;
+		dst->ida_thi = src->ida_thi;
+		dst->ida_irfnd = src->ida_irfnd;
+		dst->ida_nge = src->ida_nge;
+		std::memcpy(dst->ida_glo, src->ida_glo, sizeof(realtype)*src->ida_nrtfn);
+		std::memcpy(dst->ida_ghi, src->ida_ghi, sizeof(realtype)*src->ida_nrtfn);
+		std::memcpy(dst->ida_grout, src->ida_grout, sizeof(realtype)*src->ida_nrtfn);
+		std::memcpy(dst->ida_iroots, src->ida_iroots, sizeof(int)*src->ida_nrtfn);
+		std::memcpy(dst->ida_gactive, src->ida_gactive, sizeof(booleantype)*src->ida_nrtfn);
+	}
 
-	/// Linear Solver specific memory
+	/// Linear Solver specific memory, only for direct linear solvers
+	if (m_pModel->GetJacobianType() == EJacobianType::SPARSE)
+		return;
 	((IDADlsMemRec*)dst->ida_lmem)->nje = ((IDADlsMemRec*)src->ida_lmem)->nje;
 	((IDADlsMemRec*)dst->ida_lmem)->nreDQ = ((IDADlsMemRec*)src->ida_lmem)->nreDQ;
 
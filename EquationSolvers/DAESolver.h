@@ -3,11 +3,24 @@
 #pragma once
 
 #include "DAEModel.h"
+#include "RKSolver.h"
+#include "SolverStatistics.h"
 #include <string>
+#include <vector>
 #include <nvector/nvector_serial.h>
+#include <sundials/sundials_matrix.h>
+#include <sundials/sundials_linearsolver.h>
 
 #define ZERO RCONST(0.0)
 
+/** Integration method of CDAESolver.*/
+enum class EDAEIntegrationMethod : unsigned
+{
+	BDF         = 0,	///< Variable-order BDF method with Newton iterations from IDA. Suitable for stiff systems.
+	EXPLICIT_RK = 1,	///< Explicit adaptive Runge-Kutta method without Jacobians. Suitable for non-stiff systems of ODEs.
+	IMEX        = 2		///< Explicit Runge-Kutta method for differential variables with implicit solution of algebraic equations. Suitable for non-stiff DAE systems.
+};
+
 /** Solver of differential algebraic equations. Uses IDA solver from SUNDIALS package*/
 class CDAESolver
 {
@@ -19,19 +32,50 @@ private:
 	N_Vector m_vectorDers;		///< Vector of derivatives
 	N_Vector m_vectorATols;		///< Vector of absolute tolerances
 	N_Vector m_vectorId;		///< Vector of states (algebraic/differential)
+	N_Vector m_vectorOutVars;	///< Vector of variables interpolated to output time points
+	N_Vector m_vectorOutDers;	///< Vector of derivatives interpolated to output time points
+
+	SUNMatrix m_matrix;						///< Jacobian matrix, nullptr for matrix-free linear solver
+	SUNLinearSolver m_linearSolver;			///< Linear solver
+	SUNMatrix m_storeMatrix;				///< Jacobian matrix of IDA memory for storing
+	SUNLinearSolver m_storeLinearSolver;	///< Linear solver of IDA memory for storing
+
+	std::vector<std::vector<size_t>> m_vColors;	///< Groups of variables perturbed together to calculate colored finite-difference Jacobian
+	std::vector<realtype> m_vIncrements;		///< Increments of variables used in colored finite-difference Jacobian
+	bool m_bPatternDetected;					///< Whether the sparsity pattern for colored finite-difference Jacobian has been detected by the solver rather than set in the model
+	long m_nPatternFailures;					///< Number of Newton convergence failures at the last detection of the sparsity pattern
+	static constexpr long m_cnMaxPatternFailures = 10;	///< Number of Newton convergence failures, after which the detected sparsity pattern is extended at the current point
+
+	std::vector<int> m_vRootsFound;	///< Information about root functions, which have found a root at the last event
+	bool m_bCalcICPending;			///< Whether consistent initial values must be calculated before the next step, since the model was reinitialized by an event at the end of the interval
 
 	realtype m_dLastTime;		///< Last calculated time
 	realtype m_dMaxStep;		// Maximum iteration time step.
 
-	std::string m_sErrorDescription;	///< Text description of the last occurred error
+	std::string m_sErrorDescription;			///< Text description of the last occurred error
+	std::string m_sJacobianCheckDescription;	///< Text description of the last failed comparison of analytical and finite-difference Jacobians
+	std::string m_sWarningDescription;			///< Text description of warnings since the last call of ClearWarning
 
 	// Variables for storing
 	void *m_pStoreIDAmem;		///< Memory for storing of IDA memory
 	N_Vector m_StoreVectorVars;	///< Memory for storing of vector of variables
 	N_Vector m_StoreVectorDers;	///< Memory for storing of vector of derivatives
+	bool m_bStoreCalcICPending;	///< Memory for storing of the flag of pending calculation of consistent initial values
+	bool m_bStateChanged;		///< Whether the solver has calculated anything since its state was last saved or loaded
+
+	// Statistics
+	SSolverStatistics m_statistics;		///< Statistics accumulated since the model was set
+	SSolverStatistics m_statisticsIDA;	///< Counters of IDA at the last update of statistics
 
 	// Solver settings
 	size_t m_nMaxIter;		///< Integer with maximum number of solver iterations
+	EDAEIntegrationMethod m_method;	///< Integration method
+	CRKSolver m_RKSolver;			///< Solver used instead of IDA for explicit integration methods
+
+	// Output settings
+	realtype m_dOutputInterval;			///< Interval between output time points; 0 to output each internal step
+	realtype m_dOutputTolerance;		///< Relative change of variables since the last output to output an internal step; 0 to disable
+	std::vector<realtype> m_vLastOutput;	///< Values of variables at the last output time point
 
 public:
 	/**	Basic constructor.*/
@@ -39,6 +83,12 @@ public:
 	/**	Basic destructor.*/
 	~CDAESolver();
 
+	/** Sets integration method. Must be called before SetModel.
+	 *	Explicit methods need no Jacobian and are faster for non-stiff systems, but require residuals of differential variables to be linear in their own derivatives.*/
+	void SetIntegrationMethod(EDAEIntegrationMethod _method);
+	/** Returns integration method.*/
+	EDAEIntegrationMethod GetIntegrationMethod() const;
+
 	/** Set model to a solver.
 	*	\param _pModel Pointer to a model
 	*	\retval true No errors occurred*/
@@ -61,19 +111,136 @@ public:
 
 	/** Return error description.*/
 	std::string GetError();
+	/** Return description of warnings, which occurred since the last call of ClearWarning. Empty if there were no warnings.*/
+	std::string GetWarning() const;
+	/** Remove all warnings.*/
+	void ClearWarning();
 
 	/** Sets maximum time step for solver.*/
 	bool SetMaxStep(double _dStep);
 
+	/** Sets interval between output time points. If set, results are passed to the model only at multiples of the interval and at the end of each
+	 *	calculated time interval, interpolating the solution with IDA dense output instead of reporting each internal step.
+	 *	\param _dInterval Output interval; 0 to output each internal step (default)*/
+	void SetOutputInterval(double _dInterval);
+	/** Returns interval between output time points.*/
+	double GetOutputInterval() const;
+	/** Sets relative tolerance of changes of variables to output an internal step. If set, an internal step is additionally passed to the model
+	 *	if any variable has changed since the last output by more than _dTolerance * |y| + absolute tolerance of the variable.
+	 *	\param _dTolerance Relative tolerance; 0 to disable (default)*/
+	void SetOutputTolerance(double _dTolerance);
+	/** Returns relative tolerance of changes of variables to output an internal step.*/
+	double GetOutputTolerance() const;
+
+	/** Returns statistics of the solver accumulated over all calculations since the model was set, including calculations discarded by LoadState.*/
+	SSolverStatistics GetStatistics();
+
 private:
 	/** Calculate residuals. Function computes residual for given values of the independent variable, state vector, and derivative.
 	*	\param _dTime Current value of the independent variable
 	*	\param _value Current value of the dependent variable vector, y(t)
 	*	\param _deriv Current value of y'(t)
 	*	\param _res Output residual vector F(t, y, y')
-	*	\param _pModel Pointer to a DAE model
+	*	\param _pSolver Pointer to the solver
 	*	\return Error code*/
-	static int ResidualFunction(realtype _dTime, N_Vector _value, N_Vector _deriv, N_Vector _res, void *_pModel);
+	static int ResidualFunction(realtype _dTime, N_Vector _value, N_Vector _deriv, N_Vector _res, void *_pSolver);
+	/** Calculate residuals for the band-block-diagonal preconditioner. Calls ResidualFunction.
+	*	\param _nLocal Number of variables
+	*	\param _dTime Current value of the independent variable
+	*	\param _value Current value of the dependent variable vector, y(t)
+	*	\param _deriv Current value of y'(t)
+	*	\param _res Output residual vector F(t, y, y')
+	*	\param _pSolver Pointer to the solver
+	*	\return Error code*/
+	static int LocalResidualFunction(sunindextype _nLocal, realtype _dTime, N_Vector _value, N_Vector _deriv, N_Vector _res, void *_pSolver);
+	/** Calculate Jacobian J = dF/dy + c_j * dF/dy' with the analytical Jacobian of the model.
+	*	\param _dTime Current value of the independent variable
+	*	\param _dAlpha Scalar c_j in the system Jacobian
+	*	\param _value Current value of the dependent variable vector, y(t)
+	*	\param _deriv Current value of y'(t)
+	*	\param _res Current residual vector F(t, y, y')
+	*	\param _jacobian Output Jacobian matrix
+	*	\param _pSolver Pointer to the solver
+	*	\param _tmp1 Temporary vector
+	*	\param _tmp2 Temporary vector
+	*	\param _tmp3 Temporary vector
+	*	\return Error code*/
+	static int JacobianFunction(realtype _dTime, realtype _dAlpha, N_Vector _value, N_Vector _deriv, N_Vector _res, SUNMatrix _jacobian, void *_pSolver, N_Vector _tmp1, N_Vector _tmp2, N_Vector _tmp3);
+	/** Calculate product of the Jacobian J = dF/dy + c_j * dF/dy' with a vector with the analytical function of the model.
+	*	\param _dTime Current value of the independent variable
+	*	\param _value Current value of the dependent variable vector, y(t)
+	*	\param _deriv Current value of y'(t)
+	*	\param _res Current residual vector F(t, y, y')
+	*	\param _vector Vector to multiply with, v
+	*	\param _result Output product J*v
+	*	\param _dAlpha Scalar c_j in the system Jacobian
+	*	\param _pSolver Pointer to the solver
+	*	\param _tmp1 Temporary vector
+	*	\param _tmp2 Temporary vector
+	*	\return Error code*/
+	static int JacobianTimesVectorFunction(realtype _dTime, N_Vector _value, N_Vector _deriv, N_Vector _res, N_Vector _vector, N_Vector _result, realtype _dAlpha, void *_pSolver, N_Vector _tmp1, N_Vector _tmp2);
+
+	/** Calculate Jacobian J = dF/dy + c_j * dF/dy' with finite differences, perturbing all variables of one color at once.
+	*	Parameters are the same as in JacobianFunction.
+	*	\return Error code*/
+	static int ColoredJacobianFunction(realtype _dTime, realtype _dAlpha, N_Vector _value, N_Vector _deriv, N_Vector _res, SUNMatrix _jacobian, void *_pSolver, N_Vector _tmp1, N_Vector _tmp2, N_Vector _tmp3);
+
+	/** Calculate root functions of the model.
+	*	\param _dTime Current value of the independent variable
+	*	\param _value Current value of the dependent variable vector, y(t)
+	*	\param _deriv Current value of y'(t)
+	*	\param _pRoots Output values of root functions
+	*	\param _pSolver Pointer to the solver
+	*	\return Error code*/
+	static int RootFunction(realtype _dTime, N_Vector _value, N_Vector _deriv, realtype* _pRoots, void *_pSolver);
+
+	/** Pass the located event to the model and reinitialize the solver if the model has changed its state.
+	*	\param _dEndTime End of the current time interval
+	*	\retval true No errors occurred*/
+	bool ProcessEvent(realtype _dEndTime);
+	/** Calculate consistent initial values after reinitialization of the solver.
+	*	\param _dEndTime End of the current time interval
+	*	\retval true No errors occurred*/
+	bool CalculateConsistentValues(realtype _dEndTime);
+
+	/** Prepare colored finite-difference Jacobian: detect sparsity pattern of the model if it is not set and group its columns into colors.
+	*	\retval true No errors occurred*/
+	bool InitColoredJacobian();
+	/** Add structurally non-zero entries of the Jacobian to the pattern, perturbing each variable and its derivative with several increments around the given point.
+	*	\param _dTime Current value of the independent variable
+	*	\param _pVars Current values of variables
+	*	\param _pDers Current values of derivatives
+	*	\param _pattern Pattern to add entries to
+	*	\retval true No errors occurred*/
+	bool DetectJacobianPattern(realtype _dTime, const realtype* _pVars, const realtype* _pDers, CJacobianPattern& _pattern);
+	/** Extend the detected sparsity pattern at the given point and group its columns into colors anew, since the Newton iteration fails repeatedly with the current one.
+	*	Parameters are the same as in DetectJacobianPattern.*/
+	void ExtendJacobianPattern(realtype _dTime, const realtype* _pVars, const realtype* _pDers);
+
+	/** Compare the analytical Jacobian with finite differences. Sets error description if they differ.
+	*	\retval true Jacobians coincide within the tolerance*/
+	bool CheckJacobian(realtype _dTime, realtype _dAlpha, N_Vector _value, N_Vector _deriv, N_Vector _res, SUNMatrix _jacobian, N_Vector _tmp1, N_Vector _tmp2, N_Vector _tmp3);
+	/** Compare the analytical Jacobian-vector product with finite differences. Sets error description if they differ.
+	*	\retval true Products coincide within the tolerance*/
+	bool CheckJacobianTimesVector(realtype _dTime, realtype _dAlpha, N_Vector _value, N_Vector _deriv, N_Vector _res, N_Vector _vector, N_Vector _result, N_Vector _tmp1, N_Vector _tmp2);
+
+	/** Create Jacobian matrix and linear solver according to the Jacobian type of the model and attach them to IDA memory.
+	*	\param _pIDAmem IDA memory
+	*	\param _vector Template vector
+	*	\param _matrix Output created matrix, nullptr for matrix-free linear solver
+	*	\param _solver Output created linear solver
+	*	\retval true No errors occurred*/
+	bool SetupLinearSolver(void* _pIDAmem, N_Vector _vector, SUNMatrix& _matrix, SUNLinearSolver& _solver);
+
+	/** Pass results at a time point to the model and remember them as the last output.*/
+	void OutputResults(realtype _dTime, N_Vector _vars, N_Vector _ders);
+	/** Check whether variables have changed since the last output by more than the output tolerance.*/
+	bool IsOutputChanged() const;
+
+	/** Read current values of IDA counters.*/
+	SSolverStatistics ReadStatistics() const;
+	/** Add changes of IDA counters since the last update to statistics.*/
+	void UpdateStatistics();
 
 	/** Initialize memory for storing.*/
 	bool InitStoringMemory();
@@ -0,0 +1,121 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#include "JacobianPattern.h"
+#include <algorithm>
+#include <cmath>
+
+CJacobianPattern::CJacobianPattern(size_t _nSize /*= 0*/)
+{
+	Resize(_nSize);
+}
+
+void CJacobianPattern::Resize(size_t _nSize)
+{
+	m_nSize = _nSize;
+	m_vColumns.assign(_nSize, std::vector<size_t>{});
+}
+
+void CJacobianPattern::Clear()
+{
+	for (auto& column : m_vColumns)
+		column.clear();
+}
+
+size_t CJacobianPattern::GetSize() const
+{
+	return m_nSize;
+}
+
+bool CJacobianPattern::IsEmpty() const
+{
+	for (const auto& column : m_vColumns)
+		if (!column.empty())
+			return false;
+	return true;
+}
+
+size_t CJacobianPattern::GetEntriesNumber() const
+{
+	size_t res = 0;
+	for (const auto& column : m_vColumns)
+		res += column.size();
+	return res;
+}
+
+void CJacobianPattern::AddEntry(size_t _iRow, size_t _iCol)
+{
+	if (_iRow >= m_nSize || _iCol >= m_nSize) return;
+	auto& column = m_vColumns[_iCol];
+	const auto it = std::lower_bound(column.begin(), column.end(), _iRow);
+	if (it == column.end() || *it != _iRow)
+		column.insert(it, _iRow);
+}
+
+void CJacobianPattern::AddChangedEntries(size_t _iCol, const std::vector<double>& _vReference, const std::vector<double>& _vPerturbed)
+{
+	for (size_t i = 0; i < _vReference.size() && i < _vPerturbed.size(); ++i)
+		// a function, which is not a number at both points, does not reveal anything
+		if (_vPerturbed[i] != _vReference[i] && !(std::isnan(_vPerturbed[i]) && std::isnan(_vReference[i])))
+			AddEntry(i, _iCol);
+}
+
+bool CJacobianPattern::HasEntry(size_t _iRow, size_t _iCol) const
+{
+	if (_iRow >= m_nSize || _iCol >= m_nSize) return false;
+	return std::binary_search(m_vColumns[_iCol].begin(), m_vColumns[_iCol].end(), _iRow);
+}
+
+const std::vector<size_t>& CJacobianPattern::GetColumn(size_t _iCol) const
+{
+	static const std::vector<size_t> empty;
+	if (_iCol >= m_nSize) return empty;
+	return m_vColumns[_iCol];
+}
+
+size_t CJacobianPattern::GetUpperBandwidth() const
+{
+	size_t res = 0;
+	for (size_t iCol = 0; iCol < m_nSize; ++iCol)
+		if (!m_vColumns[iCol].empty() && m_vColumns[iCol].front() < iCol)
+			res = std::max(res, iCol - m_vColumns[iCol].front());
+	return res;
+}
+
+size_t CJacobianPattern::GetLowerBandwidth() const
+{
+	size_t res = 0;
+	for (size_t iCol = 0; iCol < m_nSize; ++iCol)
+		if (!m_vColumns[iCol].empty() && m_vColumns[iCol].back() > iCol)
+			res = std::max(res, m_vColumns[iCol].back() - iCol);
+	return res;
+}
+
+std::vector<std::vector<size_t>> CJacobianPattern::ColorColumns() const
+{
+	// columns with non-zero entries in each row
+	std::vector<std::vector<size_t>> rows(m_nSize);
+	for (size_t iCol = 0; iCol < m_nSize; ++iCol)
+		for (const size_t iRow : m_vColumns[iCol])
+			rows[iRow].push_back(iCol);
+
+	// greedy coloring: each column gets the smallest color not used by columns sharing a row with it
+	const size_t NO_COLOR = static_cast<size_t>(-1);
+	std::vector<size_t> colors(m_nSize, NO_COLOR);
+	std::vector<size_t> forbidden(m_nSize, NO_COLOR);	// column, for which the color is forbidden the last time
+	std::vector<std::vector<size_t>> res;
+	for (size_t iCol = 0; iCol < m_nSize; ++iCol)
+	{
+		for (const size_t iRow : m_vColumns[iCol])
+			for (const size_t iNeighbor : rows[iRow])
+				if (colors[iNeighbor] != NO_COLOR)
+					forbidden[colors[iNeighbor]] = iCol;
+		size_t iColor = 0;
+		while (forbidden[iColor] == iCol)
+			++iColor;
+		colors[iCol] = iColor;
+		if (iColor == res.size())
+			res.emplace_back();
+		res[iColor].push_back(iCol);
+	}
+	return res;
+}
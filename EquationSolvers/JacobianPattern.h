@@ -0,0 +1,82 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/** Type of the Jacobian matrix and of the linear solver used with it.*/
+enum class EJacobianType : unsigned
+{
+	DENSE  = 0,	///< Dense matrix and direct dense linear solver.
+	BANDED = 1,	///< Banded matrix and direct banded linear solver. Bandwidths are set in the model or derived from its sparsity pattern.
+	SPARSE = 2	///< Matrix-free Krylov linear solver (SPGMR) with a banded preconditioner. Bandwidths of the preconditioner are set in the model or derived from its sparsity pattern.
+};
+
+/** Relative increments of variables used to detect the sparsity pattern by perturbation. Increments of different sizes and signs
+ *	reveal also dependencies that a single increment misses, e.g. near extrema or in piecewise defined functions.*/
+constexpr double JACOBIAN_PROBE_INCREMENTS[] = { 1e-3, -1e-2, 1e-1 };
+
+/** Sparsity pattern of a square Jacobian matrix: positions of structurally non-zero entries.*/
+class CJacobianPattern
+{
+	size_t m_nSize;									///< Number of rows and columns.
+	std::vector<std::vector<size_t>> m_vColumns;	///< Sorted indices of rows with non-zero entries for each column.
+
+public:
+	/**	Basic constructor.
+	 *	\param _nSize Number of rows and columns*/
+	CJacobianPattern(size_t _nSize = 0);
+
+	/** Sets the number of rows and columns and removes all entries.*/
+	void Resize(size_t _nSize);
+	/** Removes all entries.*/
+	void Clear();
+
+	/** Returns number of rows and columns.*/
+	size_t GetSize() const;
+	/** Returns true if no entries are defined.*/
+	bool IsEmpty() const;
+	/** Returns number of defined entries.*/
+	size_t GetEntriesNumber() const;
+
+	/** Marks the entry as structurally non-zero.
+	 *	\param _iRow Index of the row, i.e. of the equation
+	 *	\param _iCol Index of the column, i.e. of the variable*/
+	void AddEntry(size_t _iRow, size_t _iCol);
+	/** Marks entries of the column as structurally non-zero in all rows, where functions of the perturbed variables differ from the reference ones.
+	 *	\param _iCol Index of the perturbed variable
+	 *	\param _vReference Functions at the reference point
+	 *	\param _vPerturbed Functions after perturbation of the variable*/
+	void AddChangedEntries(size_t _iCol, const std::vector<double>& _vReference, const std::vector<double>& _vPerturbed);
+	/** Returns true if the entry is structurally non-zero.*/
+	bool HasEntry(size_t _iRow, size_t _iCol) const;
+	/** Returns sorted indices of rows with non-zero entries in the column.*/
+	const std::vector<size_t>& GetColumn(size_t _iCol) const;
+
+	/** Returns the upper bandwidth: the largest distance of a non-zero entry above the main diagonal.*/
+	size_t GetUpperBandwidth() const;
+	/** Returns the lower bandwidth: the largest distance of a non-zero entry below the main diagonal.*/
+	size_t GetLowerBandwidth() const;
+
+	/** Groups columns into colors, so that no two columns of the same color have non-zero entries in the same row.
+	 *	Such columns can be perturbed simultaneously to calculate a finite-difference Jacobian.
+	 *	\return Indices of columns for each color*/
+	std::vector<std::vector<size_t>> ColorColumns() const;
+};
+
+/** Interface to fill a Jacobian matrix independently of its storage format. Row index is the index of the equation, column index is the index of the variable.*/
+class CJacobianMatrix
+{
+public:
+	virtual ~CJacobianMatrix() = default;
+
+	/** Returns number of rows and columns.*/
+	virtual size_t GetSize() const = 0;
+	/** Returns true if the entry is stored in the matrix. Entries outside the band of banded matrices are not stored.*/
+	virtual bool IsStored(size_t _iRow, size_t _iCol) const = 0;
+	/** Returns value of the entry or zero if it is not stored.*/
+	virtual double GetEntry(size_t _iRow, size_t _iCol) const = 0;
+	/** Sets value of the entry. Entries that are not stored are ignored.*/
+	virtual void SetEntry(size_t _iRow, size_t _iCol, double _dValue) = 0;
+};
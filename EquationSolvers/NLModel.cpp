@@ -2,10 +2,16 @@
 
 #include "NLModel.h"
 #include <cfloat>
+#include <algorithm>
 
 CNLModel::CNLModel()
 {
 	m_pUserData = nullptr;
+	m_jacobianType = EJacobianType::DENSE;
+	m_nUpperBandwidth = 0;
+	m_nLowerBandwidth = 0;
+	m_bBandwidthSet = false;
+	m_bColoredJacobian = false;
 }
 
 CNLModel::~CNLModel()
@@ -16,6 +22,12 @@ void CNLModel::Clear()
 {
 	m_vVariables.clear();
 	m_pUserData = NULL;
+	m_jacobianType = EJacobianType::DENSE;
+	m_nUpperBandwidth = 0;
+	m_nLowerBandwidth = 0;
+	m_bBandwidthSet = false;
+	m_bColoredJacobian = false;
+	m_jacobianPattern.Resize(0);
 }
 
 size_t CNLModel::AddNLVariable(double _dVariableInit, double _dConstraint /*= 0.0 */, double _dUScale /*= 1.0 */, double _dFScale /*= 1.0 */)
@@ -62,6 +74,59 @@ void CNLModel::ClearVariables()
 	m_vVariables.clear();
 }
 
+void CNLModel::SetJacobianType(EJacobianType _type)
+{
+	m_jacobianType = _type;
+}
+
+EJacobianType CNLModel::GetJacobianType() const
+{
+	return m_jacobianType;
+}
+
+void CNLModel::SetJacobianBandwidth(size_t _nUpper, size_t _nLower)
+{
+	m_nUpperBandwidth = _nUpper;
+	m_nLowerBandwidth = _nLower;
+	m_bBandwidthSet = true;
+}
+
+size_t CNLModel::GetUpperBandwidth() const
+{
+	if (m_vVariables.empty()) return 0;
+	if (m_bBandwidthSet) return std::min(m_nUpperBandwidth, m_vVariables.size() - 1);
+	if (m_jacobianPattern.GetSize() == m_vVariables.size() && !m_jacobianPattern.IsEmpty()) return m_jacobianPattern.GetUpperBandwidth();
+	return m_vVariables.size() - 1;
+}
+
+size_t CNLModel::GetLowerBandwidth() const
+{
+	if (m_vVariables.empty()) return 0;
+	if (m_bBandwidthSet) return std::min(m_nLowerBandwidth, m_vVariables.size() - 1);
+	if (m_jacobianPattern.GetSize() == m_vVariables.size() && !m_jacobianPattern.IsEmpty()) return m_jacobianPattern.GetLowerBandwidth();
+	return m_vVariables.size() - 1;
+}
+
+void CNLModel::SetJacobianPattern(const CJacobianPattern& _pattern)
+{
+	m_jacobianPattern = _pattern;
+}
+
+const CJacobianPattern& CNLModel::GetJacobianPattern() const
+{
+	return m_jacobianPattern;
+}
+
+void CNLModel::SetUseColoredJacobian(bool _bEnable)
+{
+	m_bColoredJacobian = _bEnable;
+}
+
+bool CNLModel::GetUseColoredJacobian() const
+{
+	return m_bColoredJacobian;
+}
+
 void CNLModel::SetUserData( void* _pUserData )
 {
 	m_pUserData = _pUserData;
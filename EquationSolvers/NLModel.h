@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "JacobianPattern.h"
 #include <vector>
 
 #define DEFAULT_ATOL 1.0e-6
@@ -35,6 +36,12 @@ class CNLModel
 
 	std::vector<SNLVariable> m_vVariables;	///< Vector of state variables
 	void *m_pUserData;						///< Pointer to a user data
+	EJacobianType m_jacobianType;			///< Type of the Jacobian matrix and of the linear solver
+	size_t m_nUpperBandwidth;				///< Upper bandwidth of the Jacobian, set explicitly
+	size_t m_nLowerBandwidth;				///< Lower bandwidth of the Jacobian, set explicitly
+	bool m_bBandwidthSet;					///< Whether bandwidths were set explicitly
+	CJacobianPattern m_jacobianPattern;		///< Sparsity pattern of the Jacobian
+	bool m_bColoredJacobian;				///< Whether colored finite differences are used to calculate the Jacobian
 
 public:
 	/**	Basic constructor.*/
@@ -71,6 +78,34 @@ public:
 	/** Remove all variables*/
 	void ClearVariables();
 
+	// ========== Functions to work with Jacobian structure
+
+	/**	Set type of the Jacobian matrix and of the linear solver used to solve the system.
+	 *	Picard strategy requires direct linear solver, i.e. dense or banded Jacobian.
+	 *	\param _type Type of the Jacobian*/
+	void SetJacobianType(EJacobianType _type);
+	/**	Get type of the Jacobian matrix.*/
+	EJacobianType GetJacobianType() const;
+	/**	Set bandwidths of the Jacobian. Used for banded Jacobians and as bandwidths of the preconditioner for sparse ones.
+	 *	\param _nUpper Upper bandwidth
+	 *	\param _nLower Lower bandwidth*/
+	void SetJacobianBandwidth(size_t _nUpper, size_t _nLower);
+	/**	Get upper bandwidth of the Jacobian. Returns the explicitly set value, otherwise the value derived from the sparsity pattern, otherwise full bandwidth.*/
+	size_t GetUpperBandwidth() const;
+	/**	Get lower bandwidth of the Jacobian. Returns the explicitly set value, otherwise the value derived from the sparsity pattern, otherwise full bandwidth.*/
+	size_t GetLowerBandwidth() const;
+	/**	Set sparsity pattern of the Jacobian: entry (i, j) is non-zero if function i depends on variable j.
+	 *	\param _pattern Sparsity pattern*/
+	void SetJacobianPattern(const CJacobianPattern& _pattern);
+	/**	Get sparsity pattern of the Jacobian.*/
+	const CJacobianPattern& GetJacobianPattern() const;
+	/**	Calculate finite-difference Jacobian for dense and banded Jacobian types by perturbing groups of structurally independent variables at once.
+	 *	If no sparsity pattern is set, it is detected when the model is set to the solver by perturbing each variable at the initial point.
+	 *	\param _bEnable Enable colored finite differences*/
+	void SetUseColoredJacobian(bool _bEnable);
+	/**	Whether colored finite differences are used to calculate the Jacobian.*/
+	bool GetUseColoredJacobian() const;
+
 	/**	Set pointer to user data. This pointer will be returned with functions \a CalculateResiduals and \a ResultsHandler.
 	 *	\param _pUserData Pointer to user data*/
 	void SetUserData(void* _pUserData);
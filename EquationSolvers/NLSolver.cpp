@@ -1,10 +1,19 @@
 /* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
 
 #include "NLSolver.h"
+#include "SUNJacobianMatrix.h"
 #include <kinsol/kinsol.h>
 #include <kinsol/kinsol_direct_impl.h>
 #include <sunmatrix/sunmatrix_dense.h>
 #include <sunlinsol/sunlinsol_dense.h>
+#include <sunmatrix/sunmatrix_band.h>
+#include <sunlinsol/sunlinsol_band.h>
+#include <sunlinsol/sunlinsol_spgmr.h>
+#include <kinsol/kinsol_spils.h>
+#include <kinsol/kinsol_bbdpre.h>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
 #include <cstring>
 
 #ifdef _MSC_VER
@@ -20,9 +29,15 @@ CNLSolver::CNLSolver():
 	m_vectorVars(nullptr),
 	m_vectorUScales(nullptr),
 	m_vectorFScales(nullptr),
+	m_matrix(nullptr),
+	m_linearSolver(nullptr),
+	m_bPatternDetected(false),
+	m_nPatternFailures(0),
 	m_sErrorDescription(""),
 	m_StoreVectorVars(nullptr),
-	m_nMaxIter(200)
+	m_nMaxIter(200),
+	m_bWarmStart(false),
+	m_bExtrapolate(false)
 {
 }
 
@@ -41,6 +56,22 @@ size_t CNLSolver::GetSolverMaxIter()
 	return m_nMaxIter;
 }
 
+void CNLSolver::SetWarmStart(bool _bWarmStart, bool _bExtrapolate)
+{
+	m_bWarmStart = _bWarmStart;
+	m_bExtrapolate = _bExtrapolate;
+}
+
+bool CNLSolver::GetWarmStart() const
+{
+	return m_bWarmStart;
+}
+
+bool CNLSolver::GetExtrapolation() const
+{
+	return m_bExtrapolate;
+}
+
 unsigned CNLSolver::GetSolverIter()
 {
 	long int nIter = 0;
@@ -116,19 +147,18 @@ bool CNLSolver::SetModel( CNLModel* _pModel , unsigned _nMAA)
 	if (KINInit(m_pKINmem, &CNLSolver::ResidualFunction, m_vectorVars) != KIN_SUCCESS)
 		return false;
 
-	// Set model as user data
-	if( KINSetUserData( m_pKINmem, m_pModel) != KIN_SUCCESS)
-		return false;
-
-	/* Create dense SUNMatrix for use in linear solves */
-	SUNMatrix A = SUNDenseMatrix(nVarsCnt, nVarsCnt);
-	/* Create dense SUNMatrix for use in linear solves */
-	SUNLinearSolver LS = SUNDenseLinearSolver(m_vectorVars, A);
-	/* Attach the matrix and linear solver */
-	if (KINDlsSetLinearSolver(m_pKINmem, LS, A) != KINDLS_SUCCESS)
+	// Set solver as user data
+	if( KINSetUserData( m_pKINmem, this) != KIN_SUCCESS)
 		return false;
 
+	// Prepare colored finite-difference Jacobian before creating matrices, since the detected pattern defines bandwidths
+	if (m_pModel->GetUseColoredJacobian() && m_pModel->GetJacobianType() != EJacobianType::SPARSE)
+		if (!InitColoredJacobian())
+			return false;
 
+	// Set linear solver
+	if (!SetupLinearSolver())
+		return false;
 
 	SaveState();
 
@@ -144,25 +174,118 @@ bool CNLSolver::Calculate(realtype _dTime, unsigned _nModel)
 	*	KIN_PICARD: Picard iteration with Anderson Acceleration (uses linear solver) */
 	if (_nModel > 3)
 		_nModel = KIN_FP;
-	const int ret = KINSol(m_pKINmem, m_vectorVars, _nModel, m_vectorUScales, m_vectorFScales);
 
+	if (m_bWarmStart)
+	{
+		SetInitialGuess(_dTime);
+		// reuse the Jacobian of the previous time point, KINSOL updates it itself if convergence degrades
+		KINSetNoInitSetup(m_pKINmem, m_vHistory.empty() ? SUNFALSE : SUNTRUE);
+	}
+
+	const int ret = KINSol(m_pKINmem, m_vectorVars, _nModel, m_vectorUScales, m_vectorFScales);
+	UpdateStatistics(ret >= 0);
 
 	if (ret == KIN_SUCCESS || ret == KIN_INITIAL_GUESS_OK || ret ==  KIN_STEP_LT_STPTOL)
 		m_pModel->HandleResults(_dTime, NV_DATA_S(m_vectorVars));
 	else
+	{
+		// do not start the next time point from the failed iterate
+		if (m_bWarmStart && !m_vHistory.empty())
+			std::copy(m_vHistory.back().vars.begin(), m_vHistory.back().vars.end(), NV_DATA_S(m_vectorVars));
 		return false;
+	}
+
+	if (m_bWarmStart)
+		AddToHistory(_dTime);
 
 	return true;
 }
 
+void CNLSolver::SetInitialGuess(realtype _dTime)
+{
+	if (m_vHistory.empty()) return;
+
+	const SSolution& last = m_vHistory.back();
+	std::copy(last.vars.begin(), last.vars.end(), NV_DATA_S(m_vectorVars));
+	if (!m_bExtrapolate || m_vHistory.size() < 2) return;
+
+	const SSolution& prev = m_vHistory.front();
+	if (last.time <= prev.time || _dTime <= last.time) return;
+
+	// linear extrapolation from two previous time points
+	const realtype factor = (_dTime - last.time) / (last.time - prev.time);
+	std::vector<realtype> vGuess(last.vars.size());
+	for (size_t i = 0; i < vGuess.size(); ++i)
+		vGuess[i] = last.vars[i] + (last.vars[i] - prev.vars[i]) * factor;
+	// KINSOL rejects initial guesses violating constraints, so keep the last solution in this case
+	if (CheckConstraints(vGuess.data()))
+		std::copy(vGuess.begin(), vGuess.end(), NV_DATA_S(m_vectorVars));
+}
+
+void CNLSolver::AddToHistory(realtype _dTime)
+{
+	// repeated calculation of the same time point replaces its solution
+	if (!m_vHistory.empty() && m_vHistory.back().time >= _dTime)
+		m_vHistory.pop_back();
+	if (m_vHistory.size() == 2)
+		m_vHistory.erase(m_vHistory.begin());
+	m_vHistory.push_back({ _dTime, std::vector<realtype>(NV_DATA_S(m_vectorVars), NV_DATA_S(m_vectorVars) + NV_LENGTH_S(m_vectorVars)) });
+}
+
+bool CNLSolver::CheckConstraints(const realtype* _pVars) const
+{
+	for (size_t i = 0; i < m_pModel->GetVariablesNumber(); ++i)
+	{
+		const double dConstr = m_pModel->GetConstraintValue(i);
+		if (dConstr ==  1 && _pVars[i] <  0) return false;
+		if (dConstr ==  2 && _pVars[i] <= 0) return false;
+		if (dConstr == -1 && _pVars[i] >  0) return false;
+		if (dConstr == -2 && _pVars[i] >= 0) return false;
+	}
+	return true;
+}
+
+void CNLSolver::UpdateStatistics(bool _bSuccess)
+{
+	// counters of KINSOL are reset on each call of KINSol
+	long nResiduals = 0, nIterations = 0, nJacobians = 0, nLinResiduals = 0, nLinIterations = 0;
+	KINGetNumFuncEvals(m_pKINmem, &nResiduals);
+	KINGetNumNonlinSolvIters(m_pKINmem, &nIterations);
+	if (m_pModel->GetJacobianType() == EJacobianType::SPARSE)
+	{
+		KINSpilsGetNumFuncEvals(m_pKINmem, &nLinResiduals);
+		KINSpilsGetNumPrecEvals(m_pKINmem, &nJacobians);
+		KINSpilsGetNumLinIters(m_pKINmem, &nLinIterations);
+	}
+	else
+	{
+		KINDlsGetNumFuncEvals(m_pKINmem, &nLinResiduals);
+		KINDlsGetNumJacEvals(m_pKINmem, &nJacobians);
+	}
+	m_statistics.nSteps++;
+	m_statistics.nResiduals += nResiduals + nLinResiduals;
+	m_statistics.nJacobians += nJacobians;
+	m_statistics.nNonlinearIterations += nIterations;
+	m_statistics.nLinearIterations += nLinIterations;
+	if (!_bSuccess)
+		m_statistics.nNonlinearFailures++;
+}
+
+SSolverStatistics CNLSolver::GetStatistics() const
+{
+	return m_statistics;
+}
+
 void CNLSolver::SaveState()
 {
 	CopyNVector(m_StoreVectorVars, m_vectorVars);
+	m_vStoreHistory = m_vHistory;
 }
 
 void CNLSolver::LoadState()
 {
 	CopyNVector(m_vectorVars, m_StoreVectorVars);
+	m_vHistory = m_vStoreHistory;
 }
 
 std::string CNLSolver::GetError() const
@@ -170,26 +293,199 @@ std::string CNLSolver::GetError() const
 	return m_sErrorDescription;
 }
 
-int CNLSolver::ResidualFunction(N_Vector _value, N_Vector _func, void *_pModel)
+std::string CNLSolver::GetWarning() const
+{
+	return m_sWarningDescription;
+}
+
+void CNLSolver::ClearWarning()
+{
+	m_sWarningDescription.clear();
+}
+
+int CNLSolver::ResidualFunction(N_Vector _value, N_Vector _func, void *_pSolver)
 {
 	realtype *pValue = NV_DATA_S( _value );
 	realtype *pFunc = NV_DATA_S(_func);
 
-	const bool bRes = static_cast<CNLModel*>(_pModel)->GetFunctions(pValue, pFunc);
+	const bool bRes = static_cast<CNLSolver*>(_pSolver)->m_pModel->GetFunctions(pValue, pFunc);
 
 	return bRes ? 0 : -1;
 }
 
+int CNLSolver::LocalResidualFunction(sunindextype /*_nLocal*/, N_Vector _value, N_Vector _func, void *_pSolver)
+{
+	return ResidualFunction(_value, _func, _pSolver);
+}
+
+int CNLSolver::ColoredJacobianFunction(N_Vector _value, N_Vector _func, SUNMatrix _jacobian, void *_pSolver, N_Vector _tmp1, N_Vector _tmp2)
+{
+	auto* pSolver = static_cast<CNLSolver*>(_pSolver);
+	const CJacobianPattern& pattern = pSolver->m_pModel->GetJacobianPattern();
+	const realtype* pValue = NV_DATA_S(_value);
+	const realtype* pFunc = NV_DATA_S(_func);
+	const realtype* pUScale = NV_DATA_S(pSolver->m_vectorUScales);
+	realtype* pPertValue = NV_DATA_S(_tmp1);
+	realtype* pPertFunc = NV_DATA_S(_tmp2);
+	std::vector<realtype>& vInc = pSolver->m_vIncrements;
+
+	// repeated failures may be caused by dependencies, which have not been revealed at the initial point
+	if (pSolver->m_bPatternDetected && pSolver->m_statistics.nNonlinearFailures - pSolver->m_nPatternFailures >= m_cnMaxPatternFailures)
+		pSolver->ExtendJacobianPattern(pValue);
+
+	pSolver->CopyNVector(_tmp1, _value);
+	SUNMatZero(_jacobian);
+	CSUNJacobianMatrix jacobian(_jacobian);
+	for (const auto& color : pSolver->m_vColors)
+	{
+		// perturb all variables of the color, increments are chosen as in the difference quotient of KINSOL
+		for (const size_t j : color)
+		{
+			realtype dInc = std::sqrt(DBL_EPSILON) * std::max(std::abs(pValue[j]), RCONST(1.0) / pUScale[j]);
+			if (pValue[j] < 0)
+				dInc = -dInc;
+			vInc[j] = dInc;
+			pPertValue[j] += dInc;
+		}
+		// functions calculated here are not counted by KINSOL
+		pSolver->m_statistics.nResiduals++;
+		if (!pSolver->m_pModel->GetFunctions(pPertValue, pPertFunc))
+			return 1;
+		// columns of one color have no common rows, so each changed function belongs to a single column
+		for (const size_t j : color)
+		{
+			for (const size_t i : pattern.GetColumn(j))
+				jacobian.SetEntry(i, j, (pPertFunc[i] - pFunc[i]) / vInc[j]);
+			pPertValue[j] = pValue[j];
+		}
+	}
+	return 0;
+}
+
+bool CNLSolver::InitColoredJacobian()
+{
+	const size_t nVarsCnt = m_pModel->GetVariablesNumber();
+	const CJacobianPattern& pattern = m_pModel->GetJacobianPattern();
+	m_bPatternDetected = pattern.GetSize() != nVarsCnt || pattern.IsEmpty();
+	if (m_bPatternDetected)
+	{
+		CJacobianPattern detected(nVarsCnt);
+		if (!DetectJacobianPattern(NV_DATA_S(m_vectorVars), detected))
+		{
+			ErrorHandler(-1, "CNLSolver", "InitColoredJacobian", "Cannot calculate functions at the initial point.", &m_sErrorDescription);
+			return false;
+		}
+		m_pModel->SetJacobianPattern(detected);
+	}
+
+	m_vColors = m_pModel->GetJacobianPattern().ColorColumns();
+	m_vIncrements.resize(nVarsCnt);
+	m_nPatternFailures = m_statistics.nNonlinearFailures;
+	return true;
+}
+
+bool CNLSolver::DetectJacobianPattern(const realtype* _pVars, CJacobianPattern& _pattern)
+{
+	const size_t nVarsCnt = m_pModel->GetVariablesNumber();
+	std::vector<realtype> vVars(_pVars, _pVars + nVarsCnt);
+	std::vector<realtype> vFunc0(nVarsCnt), vFunc(nVarsCnt);
+	m_statistics.nResiduals++;
+	if (!m_pModel->GetFunctions(vVars.data(), vFunc0.data()))
+		return false;
+	for (size_t j = 0; j < nVarsCnt; ++j)
+	{
+		for (const double dRelInc : JACOBIAN_PROBE_INCREMENTS)
+		{
+			const realtype dOld = vVars[j];
+			vVars[j] += std::max(std::abs(dOld), RCONST(1.0)) * dRelInc;
+			m_statistics.nResiduals++;
+			const bool bSuccess = m_pModel->GetFunctions(vVars.data(), vFunc.data());
+			vVars[j] = dOld;
+			// a perturbation may leave the domain of the model, then it reveals nothing
+			if (bSuccess)
+				_pattern.AddChangedEntries(j, vFunc0, vFunc);
+		}
+		// diagonal is always kept to get a non-singular Jacobian
+		_pattern.AddEntry(j, j);
+	}
+	return true;
+}
+
+void CNLSolver::ExtendJacobianPattern(const realtype* _pVars)
+{
+	m_nPatternFailures = m_statistics.nNonlinearFailures;
+	CJacobianPattern pattern = m_pModel->GetJacobianPattern();
+	const size_t nOldEntries = pattern.GetEntriesNumber();
+	if (!DetectJacobianPattern(_pVars, pattern) || pattern.GetEntriesNumber() == nOldEntries) return;
+	m_pModel->SetJacobianPattern(pattern);
+	m_vColors = pattern.ColorColumns();
+	const std::string sWarning = "Repeated failures to solve the system: sparsity pattern of the colored Jacobian has been extended by " + std::to_string(pattern.GetEntriesNumber() - nOldEntries) + " entries.";
+	m_sWarningDescription += (m_sWarningDescription.empty() ? "" : "\n") + sWarning;
+}
+
+bool CNLSolver::SetupLinearSolver()
+{
+	const sunindextype nVarsCnt = static_cast<sunindextype>(m_pModel->GetVariablesNumber());
+	const sunindextype nUpper = static_cast<sunindextype>(m_pModel->GetUpperBandwidth());
+	const sunindextype nLower = static_cast<sunindextype>(m_pModel->GetLowerBandwidth());
+
+	switch (m_pModel->GetJacobianType())
+	{
+	case EJacobianType::DENSE:
+		m_matrix = SUNDenseMatrix(nVarsCnt, nVarsCnt);
+		m_linearSolver = SUNDenseLinearSolver(m_vectorVars, m_matrix);
+		break;
+	case EJacobianType::BANDED:
+		// additional upper diagonals are needed to store LU factors
+		m_matrix = SUNBandMatrix(nVarsCnt, nUpper, nLower, std::min<sunindextype>(nVarsCnt - 1, nUpper + nLower));
+		m_linearSolver = SUNBandLinearSolver(m_vectorVars, m_matrix);
+		break;
+	case EJacobianType::SPARSE:
+		m_matrix = nullptr;
+		m_linearSolver = SUNSPGMR(m_vectorVars, PREC_RIGHT, 0);
+		break;
+	}
+
+	if (!m_linearSolver || (!m_matrix && m_pModel->GetJacobianType() != EJacobianType::SPARSE))
+	{
+		ErrorHandler(-1, "KIN", "SetupLinearSolver", "Cannot allocate memory for linear solver.", &m_sErrorDescription);
+		return false;
+	}
+
+	if (m_pModel->GetJacobianType() == EJacobianType::SPARSE)
+	{
+		// matrix-free Krylov solver preconditioned with a banded approximation of the Jacobian
+		if (KINSpilsSetLinearSolver(m_pKINmem, m_linearSolver) != KINSPILS_SUCCESS)
+			return false;
+		if (KINBBDPrecInit(m_pKINmem, nVarsCnt, nUpper, nLower, nUpper, nLower, ZERO, &CNLSolver::LocalResidualFunction, nullptr) != KINSPILS_SUCCESS)
+			return false;
+	}
+	else
+	{
+		if (KINDlsSetLinearSolver(m_pKINmem, m_linearSolver, m_matrix) != KINDLS_SUCCESS)
+			return false;
+		if (!m_vColors.empty())
+			if (KINDlsSetJacFn(m_pKINmem, &CNLSolver::ColoredJacobianFunction) != KINDLS_SUCCESS)
+				return false;
+	}
+
+	return true;
+}
+
 void CNLSolver::ClearMemory()
 {
 	m_sErrorDescription.clear();
-	// free memory associates with the KINDls system solver interface.
-	KINMem originMem = static_cast<KINMemRec*>(m_pKINmem);
-	if (originMem)
-		SUNLinSolFree(((KINDlsMemRec*)originMem->kin_lmem)->LS);
+	m_vColors.clear();
+	m_vIncrements.clear();
+	m_vHistory.clear();
+	m_vStoreHistory.clear();
+	m_statistics = SSolverStatistics{};
 
 	// free KIN memory
 	if (m_pKINmem)			{ KINFree(&m_pKINmem);					m_pKINmem = nullptr; }
+	// free linear solver and matrix
+	if (m_linearSolver)		{ SUNLinSolFree(m_linearSolver);		m_linearSolver = nullptr; }
+	if (m_matrix)			{ SUNMatDestroy(m_matrix);				m_matrix = nullptr; }
 
 	// free vectors
 	if (m_vectorVars) { N_VDestroy_Serial(m_vectorVars);		m_vectorVars = nullptr; }
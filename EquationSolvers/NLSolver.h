@@ -3,9 +3,13 @@
 #pragma once
 
 #include "NLModel.h"
+#include "SolverStatistics.h"
 #include <kinsol/kinsol.h>
 #include <string>
+#include <vector>
 #include <nvector/nvector_serial.h>
+#include <sundials/sundials_matrix.h>
+#include <sundials/sundials_linearsolver.h>
 
 #define ZERO RCONST(0.0)
 
@@ -20,14 +24,37 @@ private:
 	N_Vector m_vectorUScales;			///< Vector of uscales
 	N_Vector m_vectorFScales;			///< Vector of fscales
 
+	SUNMatrix m_matrix;					///< Jacobian matrix, nullptr for matrix-free linear solver
+	SUNLinearSolver m_linearSolver;		///< Linear solver
+
+	std::vector<std::vector<size_t>> m_vColors;	///< Groups of variables perturbed together to calculate colored finite-difference Jacobian
+	std::vector<realtype> m_vIncrements;		///< Increments of variables used in colored finite-difference Jacobian
+	bool m_bPatternDetected;					///< Whether the sparsity pattern for colored finite-difference Jacobian has been detected by the solver rather than set in the model
+	long m_nPatternFailures;					///< Number of failed solutions at the last detection of the sparsity pattern
+	static constexpr long m_cnMaxPatternFailures = 3;	///< Number of failed solutions, after which the detected sparsity pattern is extended at the current point
+
 	std::string m_sErrorDescription;	///< Text description of the last occurred error
+	std::string m_sWarningDescription;	///< Text description of warnings since the last call of ClearWarning
+
+	/** Converged solution at some time point.*/
+	struct SSolution
+	{
+		realtype time;					///< Time point
+		std::vector<realtype> vars;		///< Values of variables
+	};
+	std::vector<SSolution> m_vHistory;	///< Solutions at the last two time points, used for warm start
 
 	// Variables for storing
 	N_Vector m_StoreVectorVars;			///< Memory for storing of vector of variables
+	std::vector<SSolution> m_vStoreHistory;	///< Memory for storing of solutions at the last time points
 
 
 	// Solver settings
 	size_t m_nMaxIter;		///< Integer with maximum number of solver iterations
+	bool m_bWarmStart;		///< Whether to start from the solution of the previous time point and to reuse its Jacobian
+	bool m_bExtrapolate;	///< Whether to extrapolate the initial guess linearly from two previous time points during warm start
+
+	SSolverStatistics m_statistics;	///< Statistics accumulated since the model was set
 
 public:
 	/**	Basic constructor.*/
@@ -52,14 +79,65 @@ public:
 
 	/** Return error description.*/
 	std::string GetError() const;
+	/** Return description of warnings, which occurred since the last call of ClearWarning. Empty if there were no warnings.*/
+	std::string GetWarning() const;
+	/** Remove all warnings.*/
+	void ClearWarning();
 
 private:
 	/** Calculate residuals. Function computes residual for given values of the independent variable and the function value.
 	 *	\param _value Current value of the dependent variable vector, y
 	 *	\param _func  Current function value of value, f(y)
-	 *	\param _pModel Pointer to a DAE model
+	 *	\param _pSolver Pointer to the solver
+	 *	\return Error code*/
+	static int ResidualFunction(N_Vector _value, N_Vector _func, void *_pSolver);
+	/** Calculate residuals for the band-block-diagonal preconditioner. Calls ResidualFunction.
+	 *	\param _nLocal Number of variables
+	 *	\param _value Current value of the dependent variable vector, y
+	 *	\param _func  Current function value of value, f(y)
+	 *	\param _pSolver Pointer to the solver
 	 *	\return Error code*/
-	static int ResidualFunction(N_Vector _value, N_Vector _func, void *_pModel);
+	static int LocalResidualFunction(sunindextype _nLocal, N_Vector _value, N_Vector _func, void *_pSolver);
+	/** Calculate Jacobian with finite differences, perturbing all variables of one color at once.
+	 *	\param _value Current value of the dependent variable vector, y
+	 *	\param _func Current function value of value, f(y)
+	 *	\param _jacobian Output Jacobian matrix
+	 *	\param _pSolver Pointer to the solver
+	 *	\param _tmp1 Temporary vector
+	 *	\param _tmp2 Temporary vector
+	 *	\return Error code*/
+	static int ColoredJacobianFunction(N_Vector _value, N_Vector _func, SUNMatrix _jacobian, void *_pSolver, N_Vector _tmp1, N_Vector _tmp2);
+
+	/** Prepare colored finite-difference Jacobian: detect sparsity pattern of the model if it is not set and group its columns into colors.
+	 *	\retval true No errors occurred*/
+	bool InitColoredJacobian();
+	/** Add structurally non-zero entries of the Jacobian to the pattern, perturbing each variable with several increments around the given point.
+	 *	\param _pVars Current values of variables
+	 *	\param _pattern Pattern to add entries to
+	 *	\retval true No errors occurred*/
+	bool DetectJacobianPattern(const realtype* _pVars, CJacobianPattern& _pattern);
+	/** Extend the detected sparsity pattern at the given point and group its columns into colors anew, since the solution fails repeatedly with the current one.
+	 *	\param _pVars Current values of variables*/
+	void ExtendJacobianPattern(const realtype* _pVars);
+
+	/** Create Jacobian matrix and linear solver according to the Jacobian type of the model and attach them to KIN memory.
+	 *	\retval true No errors occurred*/
+	bool SetupLinearSolver();
+
+	/** Set initial guess for the given time point from the solutions at previous time points.
+	 *	\param _dTime Time point*/
+	void SetInitialGuess(realtype _dTime);
+	/** Add converged solution to the history of solutions.
+	 *	\param _dTime Time point*/
+	void AddToHistory(realtype _dTime);
+	/** Check whether all values satisfy constraints of the model.
+	 *	\param _pVars Values of variables
+	 *	\retval true All constraints are satisfied*/
+	bool CheckConstraints(const realtype* _pVars) const;
+
+	/** Add counters of KINSOL from the last solution to statistics.
+	 *	\param _bSuccess Whether the system has been solved*/
+	void UpdateStatistics(bool _bSuccess);
 
 	/** Clear all allocated memory.*/
 	void ClearMemory();
@@ -86,4 +164,16 @@ public:
 	void SetSolverMaxIter(size_t _nMaxIter);
 	/** Returns the number of iterations to solve the system*/
 	unsigned GetSolverIter();
+	/** Returns statistics of the solver accumulated over all solved systems since the model was set*/
+	SSolverStatistics GetStatistics() const;
+
+	/** Sets warm start (default: false). If enabled, each time point starts from the converged solution of the previous time point
+	 *	and reuses the last factorized Jacobian, which is recalculated by the solver only when convergence degrades.
+	 *	\param _bWarmStart Enable warm start
+	 *	\param _bExtrapolate Extrapolate the initial guess linearly from two previous time points*/
+	void SetWarmStart(bool _bWarmStart, bool _bExtrapolate = false);
+	/** Returns whether warm start is enabled*/
+	bool GetWarmStart() const;
+	/** Returns whether the initial guess is extrapolated during warm start*/
+	bool GetExtrapolation() const;
 };
@@ -0,0 +1,652 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#include "RKSolver.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <sstream>
+
+namespace
+{
+	// Butcher tableau of the Dormand-Prince 5(4) method; the last row of A contains weights of the 5th order solution, so the last stage is the derivative at the end of the step
+	const double RK_C[7] = { 0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0 };
+	const double RK_A[7][6] = {
+		{ 0.0 },
+		{ 1.0 / 5.0 },
+		{ 3.0 / 40.0, 9.0 / 40.0 },
+		{ 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0 },
+		{ 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0 },
+		{ 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0 },
+		{ 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0 } };
+	// differences between weights of the 5th and the 4th order solutions
+	const double RK_E[7] = { 71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0, -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0 };
+
+	const double SAFETY_FACTOR = 0.9;		// safety factor of step size selection
+	const double MIN_STEP_FACTOR = 0.2;		// minimum factor of step size change after a rejected step
+	const double MAX_STEP_FACTOR = 5.0;		// maximum factor of step size change after an accepted step
+	const double FAIL_STEP_FACTOR = 0.25;	// factor of step size change if derivatives cannot be calculated
+	const size_t MAX_NEWTON_ITERATIONS = 5;	// maximum number of Newton iterations for algebraic variables with one Jacobian
+	const double NEWTON_TOLERANCE = 0.1;	// fraction of tolerances of algebraic variables to stop Newton iterations
+	const double LINEARITY_TOLERANCE = 1e-6;// relative tolerance of the check of residuals for linearity in derivatives
+
+	std::string ErrorText(const std::string& _sFunction, const std::string& _sMessage)
+	{
+		return "[CRKSolver ERROR] in " + _sFunction + ": " + _sMessage;
+	}
+
+	// LU factorization with partial pivoting of a dense row-major matrix
+	bool FactorizeLU(std::vector<double>& _vMatrix, std::vector<size_t>& _vPivots, size_t _n)
+	{
+		for (size_t k = 0; k < _n; ++k)
+		{
+			size_t p = k;
+			for (size_t i = k + 1; i < _n; ++i)
+				if (std::abs(_vMatrix[i * _n + k]) > std::abs(_vMatrix[p * _n + k]))
+					p = i;
+			_vPivots[k] = p;
+			if (_vMatrix[p * _n + k] == 0.0)
+				return false;
+			if (p != k)
+				for (size_t j = 0; j < _n; ++j)
+					std::swap(_vMatrix[k * _n + j], _vMatrix[p * _n + j]);
+			for (size_t i = k + 1; i < _n; ++i)
+			{
+				const double dFactor = _vMatrix[i * _n + k] /= _vMatrix[k * _n + k];
+				for (size_t j = k + 1; j < _n; ++j)
+					_vMatrix[i * _n + j] -= dFactor * _vMatrix[k * _n + j];
+			}
+		}
+		return true;
+	}
+
+	// solution of a linear system with LU factors; the right-hand side is replaced with the solution
+	void SolveLU(const std::vector<double>& _vMatrix, const std::vector<size_t>& _vPivots, size_t _n, std::vector<double>& _vRHS)
+	{
+		for (size_t k = 0; k < _n; ++k)
+		{
+			std::swap(_vRHS[k], _vRHS[_vPivots[k]]);
+			for (size_t i = k + 1; i < _n; ++i)
+				_vRHS[i] -= _vMatrix[i * _n + k] * _vRHS[k];
+		}
+		for (size_t k = _n; k-- > 0;)
+		{
+			for (size_t j = k + 1; j < _n; ++j)
+				_vRHS[k] -= _vMatrix[k * _n + j] * _vRHS[j];
+			_vRHS[k] /= _vMatrix[k * _n + k];
+		}
+	}
+
+	// whether a root function has crossed zero; functions, which are exactly zero at the start, are not checked, as in IDA
+	bool IsCrossed(double _dLeft, double _dRight)
+	{
+		return _dLeft != 0.0 && (_dRight == 0.0 || (_dLeft < 0.0) != (_dRight < 0.0));
+	}
+}
+
+CRKSolver::CRKSolver() :
+	m_pModel(nullptr),
+	m_dRTol(0),
+	m_bInitialized(false),
+	m_dTime(0),
+	m_dStep(0),
+	m_bAlgJacobianValid(false),
+	m_bStoreInitialized(false),
+	m_dStoreTime(0),
+	m_dStoreStep(0),
+	m_dMaxStep(0),
+	m_dOutputInterval(0),
+	m_dOutputTolerance(0)
+{
+}
+
+bool CRKSolver::SetModel(CDAEModel* _pModel, bool _bImplicitAlgebraic)
+{
+	m_pModel = _pModel;
+	m_sErrorDescription.clear();
+	m_statistics = SSolverStatistics{};
+	const size_t nVars = m_pModel->GetVariablesNumber();
+
+	m_vDifferential.clear();
+	m_vAlgebraic.clear();
+	for (size_t i = 0; i < nVars; ++i)
+		(m_pModel->GetVarType(i) != 0 ? m_vDifferential : m_vAlgebraic).push_back(i);
+	if (!m_vAlgebraic.empty() && !_bImplicitAlgebraic)
+	{
+		m_sErrorDescription = ErrorText("SetModel", "The model contains algebraic variables. Use IMEX integration method to calculate them.");
+		return false;
+	}
+
+	m_dRTol = m_pModel->GetRTol();
+	m_vATols.resize(nVars);
+	m_vVars.resize(nVars);
+	m_vDers.resize(nVars);
+	for (size_t i = 0; i < nVars; ++i)
+	{
+		m_vATols[i] = m_pModel->GetATol(i);
+		m_vVars[i] = m_pModel->GetVarInitValue(i);
+		m_vDers[i] = m_pModel->GetDerInitValue(i);
+	}
+	for (auto& stage : m_vStages)
+		stage.assign(nVars, 0.0);
+	m_vNewVars.assign(nVars, 0.0);
+	m_vOutVars.assign(nVars, 0.0);
+	m_vOutDers.assign(nVars, 0.0);
+	m_vRes.assign(nVars, 0.0);
+	m_vZeros.assign(nVars, 0.0);
+	m_vOnes.assign(nVars, 1.0);
+	m_vResOnes.assign(nVars, 0.0);
+	m_vAlgJacobian.assign(m_vAlgebraic.size() * m_vAlgebraic.size(), 0.0);
+	m_vAlgPivots.assign(m_vAlgebraic.size(), 0);
+	m_bAlgJacobianValid = false;
+	m_vRoots.assign(m_pModel->GetRootsNumber(), 0.0);
+	m_vNewRoots.assign(m_pModel->GetRootsNumber(), 0.0);
+	m_vRootsFound.assign(m_pModel->GetRootsNumber(), 0);
+
+	// derivatives are obtained from residuals as F(t, y, y') = c(t, y) * y' + F(t, y, 0), so check with two different derivatives that
+	// residuals of differential variables depend only and linearly on their own derivatives, and residuals of algebraic ones do not depend on them.
+	// The coefficients themselves are recalculated together with derivatives, since they may depend on the state
+	std::vector<double> vRes0(nVars), vRes1(nVars), vRes2(nVars), vDers1(nVars, 1.0), vDers2(nVars);
+	for (size_t i = 0; i < nVars; ++i)
+		vDers2[i] = static_cast<double>(i + 2);
+	std::vector<double> vVars = m_vVars;
+	m_statistics.nResiduals += 3;
+	if (!m_pModel->GetResiduals(0, vVars.data(), m_vZeros.data(), vRes0.data()) || !m_pModel->GetResiduals(0, vVars.data(), vDers1.data(), vRes1.data()) || !m_pModel->GetResiduals(0, vVars.data(), vDers2.data(), vRes2.data()))
+	{
+		m_sErrorDescription = ErrorText("SetModel", "Cannot calculate residuals at the initial point.");
+		return false;
+	}
+	m_vDerCoeffs.assign(m_vDifferential.size(), 0.0);
+	for (size_t k = 0; k < m_vDifferential.size(); ++k)
+	{
+		const size_t i = m_vDifferential[k];
+		const double dCoeff1 = vRes1[i] - vRes0[i];
+		const double dCoeff2 = (vRes2[i] - vRes0[i]) / vDers2[i];
+		const double dScale = std::abs(dCoeff1) + std::abs(vRes0[i]);
+		if (!std::isfinite(dCoeff1) || std::abs(dCoeff1) <= LINEARITY_TOLERANCE * dScale || std::abs(dCoeff2 - dCoeff1) > LINEARITY_TOLERANCE * dScale)
+		{
+			std::ostringstream os;
+			os << "Residual of differential variable " << i << " is not linear in its own derivative. Use BDF integration method for this model.";
+			m_sErrorDescription = ErrorText("SetModel", os.str());
+			return false;
+		}
+	}
+	for (size_t i : m_vAlgebraic)
+	{
+		const double dScale = std::max(1.0, std::abs(vRes0[i]));
+		if (std::abs(vRes1[i] - vRes0[i]) > LINEARITY_TOLERANCE * dScale || std::abs(vRes2[i] - vRes0[i]) > LINEARITY_TOLERANCE * dScale)
+		{
+			std::ostringstream os;
+			os << "Residual of algebraic variable " << i << " depends on derivatives. Use BDF integration method for this model.";
+			m_sErrorDescription = ErrorText("SetModel", os.str());
+			return false;
+		}
+	}
+
+	m_dTime = 0;
+	m_dStep = 0;
+	m_bInitialized = false;
+	SaveState();
+
+	return true;
+}
+
+bool CRKSolver::Calculate(double _dStartTime, double _dEndTime)
+{
+	if (_dStartTime == _dEndTime)
+	{
+		m_sErrorDescription = ErrorText("Calculate", "Start and end time are equal. Cannot perform calculations for dynamic unit.");
+		return false;
+	}
+
+	if ((_dStartTime == 0 || !m_bInitialized) && !InitializeSolution())
+		return false;
+	if (_dStartTime == 0)
+		OutputResults(m_dTime, m_vVars, m_vDers);
+	else
+		m_vLastOutput = m_vVars;
+
+	double dMaxStep = (_dEndTime - _dStartTime) / 2.0;
+	if (m_dMaxStep != 0 && dMaxStep > m_dMaxStep)
+		dMaxStep = m_dMaxStep;
+
+	return Integrate(_dEndTime, dMaxStep, true);
+}
+
+bool CRKSolver::Calculate(double _dTime)
+{
+	if ((_dTime == 0 || !m_bInitialized) && !InitializeSolution())
+		return false;
+	if (_dTime != 0 && !Integrate(_dTime, m_dMaxStep != 0 ? m_dMaxStep : DBL_MAX, false))
+		return false;
+	m_pModel->HandleResults(m_dTime, m_vVars.data(), m_vDers.data());
+	return true;
+}
+
+void CRKSolver::SaveState()
+{
+	m_bStoreInitialized = m_bInitialized;
+	m_dStoreTime = m_dTime;
+	m_dStoreStep = m_dStep;
+	m_vStoreVars = m_vVars;
+	m_vStoreDers = m_vDers;
+	m_vStoreRoots = m_vRoots;
+}
+
+void CRKSolver::LoadState()
+{
+	m_bInitialized = m_bStoreInitialized;
+	m_dTime = m_dStoreTime;
+	m_dStep = m_dStoreStep;
+	m_vVars = m_vStoreVars;
+	m_vDers = m_vStoreDers;
+	m_vRoots = m_vStoreRoots;
+}
+
+std::string CRKSolver::GetError() const
+{
+	return m_sErrorDescription;
+}
+
+SSolverStatistics CRKSolver::GetStatistics() const
+{
+	return m_statistics;
+}
+
+void CRKSolver::SetMaxStep(double _dStep)
+{
+	m_dMaxStep = _dStep;
+}
+
+void CRKSolver::SetOutputInterval(double _dInterval)
+{
+	m_dOutputInterval = _dInterval;
+}
+
+void CRKSolver::SetOutputTolerance(double _dTolerance)
+{
+	m_dOutputTolerance = _dTolerance;
+}
+
+bool CRKSolver::Integrate(double _dEndTime, double _dMaxStep, bool _bOutput)
+{
+	const bool bDecimate = _bOutput && (m_dOutputInterval > 0 || m_dOutputTolerance > 0);
+	// first output time point on the grid of output interval after the current time
+	double dNextOutput = m_dOutputInterval > 0 ? (std::floor(m_dTime / m_dOutputInterval) + 1) * m_dOutputInterval : _dEndTime;
+	double dLastOutput = m_dTime;
+
+	// initial step from the ratio of scales of variables and their derivatives
+	if (m_dStep == 0)
+	{
+		const double dNormVars = WeightedNorm(m_vVars, m_vVars, m_vVars);
+		const double dNormDers = WeightedNorm(m_vDers, m_vVars, m_vVars);
+		m_dStep = dNormVars < 1e-5 || dNormDers < 1e-5 ? 1e-6 : 0.01 * dNormVars / dNormDers;
+	}
+
+	while (m_dTime < _dEndTime)
+	{
+		double dStep = std::min(m_dStep, _dMaxStep);
+		// do not leave a tiny remainder till the end of the interval
+		const bool bLast = m_dTime + 1.01 * dStep >= _dEndTime;
+		if (bLast)
+			dStep = _dEndTime - m_dTime;
+		const double dNewTime = bLast ? _dEndTime : m_dTime + dStep;
+		if (dNewTime <= m_dTime)
+		{
+			std::ostringstream os;
+			os << "Step size became too small at t = " << m_dTime << ".";
+			m_sErrorDescription = ErrorText("Integrate", os.str());
+			return false;
+		}
+
+		double dError;
+		if (!Step(dStep, dError))
+		{
+			// derivatives cannot be calculated at some stage, retry with a smaller step
+			m_dStep = dStep * FAIL_STEP_FACTOR;
+			continue;
+		}
+		if (!std::isfinite(dError) || dError > 1.0)
+		{
+			m_statistics.nErrorTestFailures++;
+			m_dStep = dStep * (std::isfinite(dError) ? std::max(MIN_STEP_FACTOR, SAFETY_FACTOR * std::pow(dError, -0.2)) : MIN_STEP_FACTOR);
+			continue;
+		}
+		m_statistics.nSteps++;
+		m_dStep = dStep * (dError == 0 ? MAX_STEP_FACTOR : std::min(MAX_STEP_FACTOR, SAFETY_FACTOR * std::pow(dError, -0.2)));
+
+		double dTheta = 1.0;
+		const bool bEvent = !m_vRoots.empty() && FindEvent(dStep, dTheta);
+		const double dStepEnd = dTheta == 1.0 ? dNewTime : m_dTime + dTheta * dStep;
+
+		// output requested time points passed by this step, interpolating inside the step
+		if (bDecimate)
+			while (dNextOutput < dStepEnd && dNextOutput < _dEndTime)
+			{
+				Interpolate(dStep, (dNextOutput - m_dTime) / dStep);
+				OutputResults(dNextOutput, m_vOutVars, m_vOutDers);
+				dLastOutput = dNextOutput;
+				dNextOutput += m_dOutputInterval;
+			}
+
+		if (dTheta < 1.0)
+		{
+			// stop at the event and restore consistency of the interpolated state
+			Interpolate(dStep, dTheta);
+			std::swap(m_vVars, m_vOutVars);
+			m_dTime = dStepEnd;
+			if (!CalculateDerivatives(m_dTime, m_vVars, m_vDers))
+			{
+				std::ostringstream os;
+				os << "Cannot calculate derivatives at the event at t = " << m_dTime << ".";
+				m_sErrorDescription = ErrorText("Integrate", os.str());
+				return false;
+			}
+		}
+		else
+		{
+			std::swap(m_vVars, m_vNewVars);
+			std::swap(m_vDers, m_vStages[STAGES - 1]);
+			m_dTime = dNewTime;
+		}
+		std::swap(m_vRoots, m_vNewRoots);
+
+		if (!bDecimate)
+		{
+			if (_bOutput)
+				OutputResults(m_dTime, m_vVars, m_vDers);
+		}
+		// output the step itself if it is a requested time point, the end of the interval, an event, or the solution has changed significantly
+		else if (m_dTime == dNextOutput || m_dTime >= _dEndTime || bEvent || (m_dOutputTolerance > 0 && IsOutputChanged()))
+		{
+			if (m_dTime != dLastOutput)
+				OutputResults(m_dTime, m_vVars, m_vDers);
+			dLastOutput = m_dTime;
+			if (m_dTime == dNextOutput)
+				dNextOutput += m_dOutputInterval;
+		}
+
+		if (bEvent && !ProcessEvent(_bOutput))
+			return false;
+	}
+
+	return true;
+}
+
+bool CRKSolver::Step(double _dStep, double& _dError)
+{
+	m_vStages[0] = m_vDers;
+	for (size_t s = 1; s < STAGES; ++s)
+	{
+		// variables of the last stage are the solution at the end of the step
+		std::vector<double>& vStageVars = s == STAGES - 1 ? m_vNewVars : m_vOutVars;
+		vStageVars = m_vVars;
+		for (size_t i : m_vDifferential)
+		{
+			double dSum = 0;
+			for (size_t j = 0; j < s; ++j)
+				dSum += RK_A[s][j] * m_vStages[j][i];
+			vStageVars[i] += _dStep * dSum;
+		}
+		if (!CalculateDerivatives(m_dTime + RK_C[s] * _dStep, vStageVars, m_vStages[s]))
+			return false;
+	}
+
+	// local error as the difference between solutions of the 5th and the 4th order
+	for (size_t i : m_vDifferential)
+	{
+		double dSum = 0;
+		for (size_t j = 0; j < STAGES; ++j)
+			dSum += RK_E[j] * m_vStages[j][i];
+		m_vOutDers[i] = _dStep * dSum;
+	}
+	_dError = WeightedNorm(m_vOutDers, m_vVars, m_vNewVars);
+	return true;
+}
+
+bool CRKSolver::InitializeSolution()
+{
+	if (!CalculateDerivatives(m_dTime, m_vVars, m_vDers))
+	{
+		std::ostringstream os;
+		os << "Cannot calculate consistent initial values at t = " << m_dTime << ".";
+		m_sErrorDescription = ErrorText("InitializeSolution", os.str());
+		return false;
+	}
+	if (!m_vRoots.empty())
+		m_pModel->GetRoots(m_dTime, m_vVars.data(), m_vDers.data(), m_vRoots.data());
+	m_bInitialized = true;
+	return true;
+}
+
+bool CRKSolver::CalculateDerivatives(double _dTime, std::vector<double>& _vVars, std::vector<double>& _vDers)
+{
+	if (!m_vAlgebraic.empty() && !SolveAlgebraic(_dTime, _vVars))
+		return false;
+	if (!CalculateResiduals(_dTime, _vVars) || !CalculateDerCoeffs(_dTime, _vVars))
+		return false;
+	for (size_t k = 0; k < m_vDifferential.size(); ++k)
+		_vDers[m_vDifferential[k]] = -m_vRes[m_vDifferential[k]] / m_vDerCoeffs[k];
+	for (size_t i : m_vAlgebraic)
+		_vDers[i] = 0;
+	return true;
+}
+
+bool CRKSolver::SolveAlgebraic(double _dTime, std::vector<double>& _vVars)
+{
+	const size_t nAlg = m_vAlgebraic.size();
+	// the Jacobian is reused between stages and steps while Newton iterations converge with it
+	bool bFresh = false;
+	if (!m_bAlgJacobianValid)
+	{
+		if (!CalculateAlgebraicJacobian(_dTime, _vVars))
+			return false;
+		bFresh = true;
+	}
+
+	std::vector<double> vInit(nAlg), vDelta(nAlg);
+	for (size_t k = 0; k < nAlg; ++k)
+		vInit[k] = _vVars[m_vAlgebraic[k]];
+
+	while (true)
+	{
+		for (size_t iIter = 0; iIter < MAX_NEWTON_ITERATIONS; ++iIter)
+		{
+			if (!CalculateResiduals(_dTime, _vVars))
+				break;
+			m_statistics.nNonlinearIterations++;
+			for (size_t k = 0; k < nAlg; ++k)
+				vDelta[k] = -m_vRes[m_vAlgebraic[k]];
+			SolveLU(m_vAlgJacobian, m_vAlgPivots, nAlg, vDelta);
+			double dNorm = 0;
+			for (size_t k = 0; k < nAlg; ++k)
+			{
+				const size_t i = m_vAlgebraic[k];
+				_vVars[i] += vDelta[k];
+				dNorm = std::max(dNorm, std::abs(vDelta[k]) / (m_vATols[i] + m_dRTol * std::abs(_vVars[i])));
+			}
+			if (!std::isfinite(dNorm))
+				break;
+			if (dNorm <= NEWTON_TOLERANCE)
+				return true;
+		}
+		m_statistics.nNonlinearFailures++;
+
+		// restart from the initial guess with an updated Jacobian, unless it has just been calculated
+		for (size_t k = 0; k < nAlg; ++k)
+			_vVars[m_vAlgebraic[k]] = vInit[k];
+		if (bFresh || !CalculateAlgebraicJacobian(_dTime, _vVars))
+			return false;
+		bFresh = true;
+	}
+}
+
+bool CRKSolver::CalculateAlgebraicJacobian(double _dTime, std::vector<double>& _vVars)
+{
+	m_bAlgJacobianValid = false;
+	const size_t nAlg = m_vAlgebraic.size();
+	if (!CalculateResiduals(_dTime, _vVars))
+		return false;
+	std::vector<double> vRes0(nAlg);
+	for (size_t k = 0; k < nAlg; ++k)
+		vRes0[k] = m_vRes[m_vAlgebraic[k]];
+
+	for (size_t c = 0; c < nAlg; ++c)
+	{
+		const size_t j = m_vAlgebraic[c];
+		const double dValue = _vVars[j];
+		double dIncrement = std::sqrt(DBL_EPSILON) * std::max(std::abs(dValue), m_vATols[j]);
+		if (dIncrement == 0)
+			dIncrement = std::sqrt(DBL_EPSILON);
+		_vVars[j] = dValue + dIncrement;
+		dIncrement = _vVars[j] - dValue;
+		const bool bSuccess = CalculateResiduals(_dTime, _vVars);
+		_vVars[j] = dValue;
+		if (!bSuccess)
+			return false;
+		for (size_t r = 0; r < nAlg; ++r)
+			m_vAlgJacobian[r * nAlg + c] = (m_vRes[m_vAlgebraic[r]] - vRes0[r]) / dIncrement;
+	}
+	m_statistics.nJacobians++;
+
+	m_bAlgJacobianValid = FactorizeLU(m_vAlgJacobian, m_vAlgPivots, nAlg);
+	if (m_bAlgJacobianValid)
+		m_statistics.nLinearSetups++;
+	return m_bAlgJacobianValid;
+}
+
+bool CRKSolver::CalculateResiduals(double _dTime, std::vector<double>& _vVars)
+{
+	m_statistics.nResiduals++;
+	if (!m_pModel->GetResiduals(_dTime, _vVars.data(), m_vZeros.data(), m_vRes.data()))
+		return false;
+	return std::all_of(m_vRes.begin(), m_vRes.end(), [](double _dValue) { return std::isfinite(_dValue); });
+}
+
+bool CRKSolver::CalculateDerCoeffs(double _dTime, std::vector<double>& _vVars)
+{
+	if (m_vDifferential.empty())
+		return true;
+	m_statistics.nResiduals++;
+	if (!m_pModel->GetResiduals(_dTime, _vVars.data(), m_vOnes.data(), m_vResOnes.data()))
+		return false;
+	for (size_t k = 0; k < m_vDifferential.size(); ++k)
+	{
+		const size_t i = m_vDifferential[k];
+		m_vDerCoeffs[k] = m_vResOnes[i] - m_vRes[i];
+		if (!std::isfinite(m_vDerCoeffs[k]) || std::abs(m_vDerCoeffs[k]) <= LINEARITY_TOLERANCE * (std::abs(m_vResOnes[i]) + std::abs(m_vRes[i])))
+			return false;
+	}
+	return true;
+}
+
+void CRKSolver::Interpolate(double _dStep, double _dTheta)
+{
+	// cubic Hermite basis functions and their derivatives
+	const double dTheta2 = _dTheta * _dTheta;
+	const double dTheta3 = dTheta2 * _dTheta;
+	const double h00 = 2 * dTheta3 - 3 * dTheta2 + 1;
+	const double h10 = dTheta3 - 2 * dTheta2 + _dTheta;
+	const double h01 = -2 * dTheta3 + 3 * dTheta2;
+	const double h11 = dTheta3 - dTheta2;
+	const double d00 = 6 * dTheta2 - 6 * _dTheta;
+	const double d10 = 3 * dTheta2 - 4 * _dTheta + 1;
+	const double d11 = 3 * dTheta2 - 2 * _dTheta;
+	const std::vector<double>& vNewDers = m_vStages[STAGES - 1];
+	for (size_t i : m_vDifferential)
+	{
+		m_vOutVars[i] = h00 * m_vVars[i] + h10 * _dStep * m_vDers[i] + h01 * m_vNewVars[i] + h11 * _dStep * vNewDers[i];
+		m_vOutDers[i] = d00 * (m_vVars[i] - m_vNewVars[i]) / _dStep + d10 * m_vDers[i] + d11 * vNewDers[i];
+	}
+	for (size_t i : m_vAlgebraic)
+	{
+		m_vOutVars[i] = m_vVars[i] + _dTheta * (m_vNewVars[i] - m_vVars[i]);
+		m_vOutDers[i] = 0;
+	}
+}
+
+bool CRKSolver::FindEvent(double _dStep, double& _dTheta)
+{
+	const size_t nRoots = m_vRoots.size();
+	m_pModel->GetRoots(m_dTime + _dStep, m_vNewVars.data(), m_vStages[STAGES - 1].data(), m_vNewRoots.data());
+	bool bFound = false;
+	for (size_t i = 0; i < nRoots && !bFound; ++i)
+		bFound = IsCrossed(m_vRoots[i], m_vNewRoots[i]);
+	if (!bFound)
+		return false;
+
+	// bisection on the interpolated solution until the bracket reaches the time resolution
+	std::vector<double> vLeft = m_vRoots, vMiddle(nRoots);
+	double dLeft = 0, dRight = 1;
+	const double dTolerance = 100 * DBL_EPSILON * (std::abs(m_dTime) + std::abs(_dStep)) / _dStep;
+	while (dRight - dLeft > dTolerance)
+	{
+		const double dMiddle = 0.5 * (dLeft + dRight);
+		Interpolate(_dStep, dMiddle);
+		m_pModel->GetRoots(m_dTime + dMiddle * _dStep, m_vOutVars.data(), m_vOutDers.data(), vMiddle.data());
+		bool bLeftHalf = false;
+		for (size_t i = 0; i < nRoots && !bLeftHalf; ++i)
+			bLeftHalf = IsCrossed(vLeft[i], vMiddle[i]);
+		if (bLeftHalf)
+		{
+			dRight = dMiddle;
+			std::swap(m_vNewRoots, vMiddle);
+		}
+		else
+		{
+			dLeft = dMiddle;
+			std::swap(vLeft, vMiddle);
+		}
+	}
+
+	// the event is reported at the right end of the bracket, where root functions have already changed their signs
+	for (size_t i = 0; i < nRoots; ++i)
+		m_vRootsFound[i] = IsCrossed(vLeft[i], m_vNewRoots[i]) ? (m_vNewRoots[i] > vLeft[i] ? 1 : -1) : 0;
+	_dTheta = dRight;
+	return true;
+}
+
+bool CRKSolver::ProcessEvent(bool _bOutput)
+{
+	if (!m_pModel->HandleEvent(m_dTime, m_vVars.data(), m_vDers.data(), m_vRootsFound.data()))
+		return true;
+
+	// the model has changed its state: restore consistency of derivatives and algebraic variables and continue from it
+	if (!CalculateDerivatives(m_dTime, m_vVars, m_vDers))
+	{
+		std::ostringstream os;
+		os << "Cannot calculate consistent values after the event at t = " << m_dTime << ".";
+		m_sErrorDescription = ErrorText("ProcessEvent", os.str());
+		return false;
+	}
+	m_pModel->GetRoots(m_dTime, m_vVars.data(), m_vDers.data(), m_vRoots.data());
+	if (_bOutput)
+		OutputResults(m_dTime, m_vVars, m_vDers);
+	return true;
+}
+
+double CRKSolver::WeightedNorm(const std::vector<double>& _vVector, const std::vector<double>& _vVars1, const std::vector<double>& _vVars2) const
+{
+	if (m_vDifferential.empty())
+		return 0;
+	double dSum = 0;
+	for (size_t i : m_vDifferential)
+	{
+		const double dValue = _vVector[i] / (m_vATols[i] + m_dRTol * std::max(std::abs(_vVars1[i]), std::abs(_vVars2[i])));
+		dSum += dValue * dValue;
+	}
+	return std::sqrt(dSum / static_cast<double>(m_vDifferential.size()));
+}
+
+void CRKSolver::OutputResults(double _dTime, std::vector<double>& _vVars, std::vector<double>& _vDers)
+{
+	m_pModel->HandleResults(_dTime, _vVars.data(), _vDers.data());
+	m_vLastOutput = _vVars;
+}
+
+bool CRKSolver::IsOutputChanged() const
+{
+	for (size_t i = 0; i < m_vLastOutput.size(); ++i)
+		if (std::abs(m_vVars[i] - m_vLastOutput[i]) > m_dOutputTolerance * std::abs(m_vLastOutput[i]) + m_vATols[i])
+			return true;
+	return false;
+}
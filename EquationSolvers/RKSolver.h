@@ -0,0 +1,159 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#pragma once
+
+#include "DAEModel.h"
+#include "SolverStatistics.h"
+#include <array>
+#include <string>
+#include <vector>
+
+/** Explicit adaptive Runge-Kutta solver of DAE models for non-stiff systems. Uses the Dormand-Prince 5(4) method with step size control and needs no Jacobian of the model.
+ *	Derivatives are obtained from residuals, so the residual of each differential variable must be linear in its own derivative, as in F = c(t, y) * y' - f(t, y).
+ *	Linearity is checked when the model is set; the coefficient c(t, y) may depend on time and state and is evaluated anew at each calculation of derivatives.
+ *	In IMEX mode algebraic variables are additionally calculated at each stage by Newton iterations on the algebraic equations only.*/
+class CRKSolver
+{
+	static const size_t STAGES = 7;	///< Number of stages of the method
+
+	CDAEModel* m_pModel;					///< Pointer to a DAE model
+	std::vector<size_t> m_vDifferential;	///< Indices of differential variables
+	std::vector<size_t> m_vAlgebraic;		///< Indices of algebraic variables
+	std::vector<double> m_vDerCoeffs;		///< Coefficients of derivatives in residuals of differential variables at the last calculated point
+	std::vector<double> m_vATols;			///< Absolute tolerances of variables
+	double m_dRTol;							///< Relative tolerance
+
+	bool m_bInitialized;					///< Whether derivatives and algebraic variables are consistent with the current state
+	double m_dTime;							///< Current time
+	double m_dStep;							///< Proposed size of the next step; 0 if it is not estimated yet
+	std::vector<double> m_vVars;			///< Current values of variables
+	std::vector<double> m_vDers;			///< Current values of derivatives
+	std::array<std::vector<double>, STAGES> m_vStages;	///< Derivatives at all stages of the current step; the last one is the derivative at the end of the step
+	std::vector<double> m_vNewVars;			///< Values of variables at the end of the current step
+	std::vector<double> m_vOutVars;			///< Values of variables interpolated to output time points
+	std::vector<double> m_vOutDers;			///< Values of derivatives interpolated to output time points
+	std::vector<double> m_vRes;				///< Residuals
+	std::vector<double> m_vZeros;			///< Zero derivatives used to calculate residuals
+	std::vector<double> m_vOnes;			///< Unit derivatives used to calculate coefficients of derivatives
+	std::vector<double> m_vResOnes;			///< Residuals at unit derivatives
+
+	std::vector<double> m_vAlgJacobian;		///< LU factors of the Jacobian of algebraic equations with respect to algebraic variables
+	std::vector<size_t> m_vAlgPivots;		///< Pivots of LU factorization of the Jacobian of algebraic equations
+	bool m_bAlgJacobianValid;				///< Whether LU factors of the Jacobian of algebraic equations are available
+
+	std::vector<double> m_vRoots;			///< Values of root functions at the current time
+	std::vector<double> m_vNewRoots;		///< Values of root functions at the end of the current step
+	std::vector<int> m_vRootsFound;			///< Information about root functions, which have found a root at the last event
+
+	// Variables for storing
+	bool m_bStoreInitialized;				///< Memory for storing of the initialization flag
+	double m_dStoreTime;					///< Memory for storing of the current time
+	double m_dStoreStep;					///< Memory for storing of the proposed step size
+	std::vector<double> m_vStoreVars;		///< Memory for storing of variables
+	std::vector<double> m_vStoreDers;		///< Memory for storing of derivatives
+	std::vector<double> m_vStoreRoots;		///< Memory for storing of values of root functions
+
+	// Solver settings
+	double m_dMaxStep;						///< Maximum step size; 0 for unlimited
+	double m_dOutputInterval;				///< Interval between output time points; 0 to output each step
+	double m_dOutputTolerance;				///< Relative change of variables since the last output to output a step; 0 to disable
+	std::vector<double> m_vLastOutput;		///< Values of variables at the last output time point
+
+	SSolverStatistics m_statistics;			///< Statistics accumulated since the model was set
+	std::string m_sErrorDescription;		///< Text description of the last occurred error
+
+public:
+	/**	Basic constructor.*/
+	CRKSolver();
+
+	/** Set model to a solver.
+	 *	\param _pModel Pointer to a model
+	 *	\param _bImplicitAlgebraic Whether algebraic variables are allowed and calculated implicitly (IMEX mode)
+	 *	\retval true No errors occurred*/
+	bool SetModel(CDAEModel* _pModel, bool _bImplicitAlgebraic);
+
+	/** Solve problem on a given time interval.
+	 *	\param _dStartTime Start of the time interval
+	 *	\param _dEndTime End of the time interval
+	 *	\retval true No errors occurred*/
+	bool Calculate(double _dStartTime, double _dEndTime);
+	/** Solve problem on a given time point.
+	 *	\param _dTime Time point
+	 *	\retval true No errors occurred*/
+	bool Calculate(double _dTime);
+
+	/** Save current state of solver.*/
+	void SaveState();
+	/** Load current state of solver.*/
+	void LoadState();
+
+	/** Return error description.*/
+	std::string GetError() const;
+	/** Returns statistics of the solver accumulated over all calculations since the model was set.*/
+	SSolverStatistics GetStatistics() const;
+
+	/** Sets maximum step size; 0 for unlimited.*/
+	void SetMaxStep(double _dStep);
+	/** Sets interval between output time points; 0 to output each step.*/
+	void SetOutputInterval(double _dInterval);
+	/** Sets relative tolerance of changes of variables to output a step; 0 to disable.*/
+	void SetOutputTolerance(double _dTolerance);
+
+private:
+	/** Integrate from the current time to the given one.
+	 *	\param _dEndTime End of the time interval
+	 *	\param _dMaxStep Maximum step size
+	 *	\param _bOutput Whether to pass intermediate results to the model
+	 *	\retval true No errors occurred*/
+	bool Integrate(double _dEndTime, double _dMaxStep, bool _bOutput);
+	/** Make one step of the method from the current state. Results are put into m_vNewVars and into the last stage.
+	 *	\param _dStep Step size
+	 *	\param _dError Output weighted norm of the local error estimate
+	 *	\retval true Derivatives could be calculated at all stages*/
+	bool Step(double _dStep, double& _dError);
+
+	/** Calculate consistent derivatives and algebraic variables for the current state and values of root functions.
+	 *	\retval true No errors occurred*/
+	bool InitializeSolution();
+	/** Calculate derivatives of differential variables. In IMEX mode algebraic variables are calculated first.
+	 *	\param _dTime Time point
+	 *	\param _vVars Values of variables; algebraic ones are updated
+	 *	\param _vDers Output values of derivatives
+	 *	\retval true No errors occurred*/
+	bool CalculateDerivatives(double _dTime, std::vector<double>& _vVars, std::vector<double>& _vDers);
+	/** Solve algebraic equations for algebraic variables with the modified Newton method.
+	 *	\param _dTime Time point
+	 *	\param _vVars Values of variables; algebraic ones are updated
+	 *	\retval true Newton iterations have converged*/
+	bool SolveAlgebraic(double _dTime, std::vector<double>& _vVars);
+	/** Calculate and factorize the Jacobian of algebraic equations with finite differences.
+	 *	\retval true The Jacobian is not singular*/
+	bool CalculateAlgebraicJacobian(double _dTime, std::vector<double>& _vVars);
+	/** Calculate residuals with zero derivatives into m_vRes.
+	 *	\retval true Residuals are finite*/
+	bool CalculateResiduals(double _dTime, std::vector<double>& _vVars);
+	/** Calculate coefficients of derivatives in residuals of differential variables into m_vDerCoeffs as F(t, y, 1) - F(t, y, 0). m_vRes must contain F(t, y, 0).
+	 *	\retval true All coefficients are finite and not zero*/
+	bool CalculateDerCoeffs(double _dTime, std::vector<double>& _vVars);
+
+	/** Interpolate the solution inside the current step with cubic Hermite polynomials into m_vOutVars and m_vOutDers.
+	 *	\param _dStep Size of the current step
+	 *	\param _dTheta Relative position inside the step, [0, 1]*/
+	void Interpolate(double _dStep, double _dTheta);
+	/** Locate the first zero crossing of root functions inside the current step.
+	 *	\param _dStep Size of the current step
+	 *	\param _dTheta Output relative position of the event inside the step, slightly after the crossing
+	 *	\retval true An event has been found*/
+	bool FindEvent(double _dStep, double& _dTheta);
+	/** Pass the located event to the model and restore consistency if the model has changed its state.
+	 *	\param _bOutput Whether to pass the state after the event to the model
+	 *	\retval true No errors occurred*/
+	bool ProcessEvent(bool _bOutput);
+
+	/** Weighted root-mean-square norm of a vector over differential variables. Weights are built from tolerances and the larger of two values of each variable.*/
+	double WeightedNorm(const std::vector<double>& _vVector, const std::vector<double>& _vVars1, const std::vector<double>& _vVars2) const;
+	/** Pass results at a time point to the model and remember them as the last output.*/
+	void OutputResults(double _dTime, std::vector<double>& _vVars, std::vector<double>& _vDers);
+	/** Check whether variables have changed since the last output by more than the output tolerance.*/
+	bool IsOutputChanged() const;
+};
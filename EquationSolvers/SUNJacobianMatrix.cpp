@@ -0,0 +1,42 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#include "SUNJacobianMatrix.h"
+#include <sunmatrix/sunmatrix_dense.h>
+#include <sunmatrix/sunmatrix_band.h>
+
+CSUNJacobianMatrix::CSUNJacobianMatrix(SUNMatrix _matrix) :
+	m_matrix{ _matrix },
+	m_bBanded{ SUNMatGetID(_matrix) == SUNMATRIX_BAND }
+{
+}
+
+size_t CSUNJacobianMatrix::GetSize() const
+{
+	return static_cast<size_t>(m_bBanded ? SM_COLUMNS_B(m_matrix) : SM_COLUMNS_D(m_matrix));
+}
+
+bool CSUNJacobianMatrix::IsStored(size_t _iRow, size_t _iCol) const
+{
+	if (_iRow >= GetSize() || _iCol >= GetSize()) return false;
+	if (!m_bBanded) return true;
+	return _iRow + SM_UBAND_B(m_matrix) >= _iCol && _iRow <= _iCol + SM_LBAND_B(m_matrix);
+}
+
+double CSUNJacobianMatrix::GetEntry(size_t _iRow, size_t _iCol) const
+{
+	if (!IsStored(_iRow, _iCol)) return 0.0;
+	const sunindextype i = static_cast<sunindextype>(_iRow);
+	const sunindextype j = static_cast<sunindextype>(_iCol);
+	return m_bBanded ? SM_ELEMENT_B(m_matrix, i, j) : SM_ELEMENT_D(m_matrix, i, j);
+}
+
+void CSUNJacobianMatrix::SetEntry(size_t _iRow, size_t _iCol, double _dValue)
+{
+	if (!IsStored(_iRow, _iCol)) return;
+	const sunindextype i = static_cast<sunindextype>(_iRow);
+	const sunindextype j = static_cast<sunindextype>(_iCol);
+	if (m_bBanded)
+		SM_ELEMENT_B(m_matrix, i, j) = _dValue;
+	else
+		SM_ELEMENT_D(m_matrix, i, j) = _dValue;
+}
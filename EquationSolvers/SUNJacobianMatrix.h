@@ -0,0 +1,23 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#pragma once
+
+#include "JacobianPattern.h"
+#include <sundials/sundials_matrix.h>
+
+/** Jacobian matrix stored in a dense or banded SUNDIALS matrix.*/
+class CSUNJacobianMatrix : public CJacobianMatrix
+{
+	SUNMatrix m_matrix;	///< Wrapped matrix
+	bool m_bBanded;		///< Whether the matrix is banded
+
+public:
+	/**	Basic constructor.
+	 *	\param _matrix Dense or banded matrix to wrap*/
+	CSUNJacobianMatrix(SUNMatrix _matrix);
+
+	size_t GetSize() const override;
+	bool IsStored(size_t _iRow, size_t _iCol) const override;
+	double GetEntry(size_t _iRow, size_t _iCol) const override;
+	void SetEntry(size_t _iRow, size_t _iCol, double _dValue) override;
+};
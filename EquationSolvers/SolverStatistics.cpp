@@ -0,0 +1,53 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#include "SolverStatistics.h"
+
+SSolverStatistics& SSolverStatistics::operator+=(const SSolverStatistics& _other)
+{
+	nSteps               += _other.nSteps;
+	nResiduals           += _other.nResiduals;
+	nJacobians           += _other.nJacobians;
+	nLinearSetups        += _other.nLinearSetups;
+	nNonlinearIterations += _other.nNonlinearIterations;
+	nNonlinearFailures   += _other.nNonlinearFailures;
+	nLinearIterations    += _other.nLinearIterations;
+	nErrorTestFailures   += _other.nErrorTestFailures;
+	return *this;
+}
+
+SSolverStatistics SSolverStatistics::operator+(const SSolverStatistics& _other) const
+{
+	SSolverStatistics res = *this;
+	return res += _other;
+}
+
+SSolverStatistics SSolverStatistics::operator-(const SSolverStatistics& _other) const
+{
+	SSolverStatistics res;
+	res.nSteps               = nSteps               - _other.nSteps;
+	res.nResiduals           = nResiduals           - _other.nResiduals;
+	res.nJacobians           = nJacobians           - _other.nJacobians;
+	res.nLinearSetups        = nLinearSetups        - _other.nLinearSetups;
+	res.nNonlinearIterations = nNonlinearIterations - _other.nNonlinearIterations;
+	res.nNonlinearFailures   = nNonlinearFailures   - _other.nNonlinearFailures;
+	res.nLinearIterations    = nLinearIterations    - _other.nLinearIterations;
+	res.nErrorTestFailures   = nErrorTestFailures   - _other.nErrorTestFailures;
+	return res;
+}
+
+bool SSolverStatistics::IsEmpty() const
+{
+	return nSteps == 0 && nResiduals == 0 && nJacobians == 0 && nLinearSetups == 0 && nNonlinearIterations == 0 && nNonlinearFailures == 0 && nLinearIterations == 0 && nErrorTestFailures == 0;
+}
+
+std::string SSolverStatistics::ToString() const
+{
+	return "steps: " + std::to_string(nSteps) +
+		", residuals: " + std::to_string(nResiduals) +
+		", Jacobians: " + std::to_string(nJacobians) +
+		", linear setups: " + std::to_string(nLinearSetups) +
+		", Newton iterations: " + std::to_string(nNonlinearIterations) +
+		", Newton failures: " + std::to_string(nNonlinearFailures) +
+		", linear iterations: " + std::to_string(nLinearIterations) +
+		", error test failures: " + std::to_string(nErrorTestFailures);
+}
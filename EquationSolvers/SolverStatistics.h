@@ -0,0 +1,27 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#pragma once
+
+#include <string>
+
+/** Work counters of an equation solver, accumulated over all calculations since the model was set.*/
+struct SSolverStatistics
+{
+	long nSteps{ 0 };					///< Number of internal time steps of DAE solvers or number of solved systems of NL solvers.
+	long nResiduals{ 0 };				///< Number of evaluations of residuals or functions, including those for finite-difference Jacobians and for detection of sparsity patterns.
+	long nJacobians{ 0 };				///< Number of evaluations of the Jacobian or of its preconditioner.
+	long nLinearSetups{ 0 };			///< Number of setups of the linear solver.
+	long nNonlinearIterations{ 0 };		///< Number of Newton iterations.
+	long nNonlinearFailures{ 0 };		///< Number of Newton convergence failures of DAE solvers or number of failed systems of NL solvers.
+	long nLinearIterations{ 0 };		///< Number of iterations of the iterative linear solver.
+	long nErrorTestFailures{ 0 };		///< Number of local error test failures of DAE solvers.
+
+	SSolverStatistics& operator+=(const SSolverStatistics& _other);
+	SSolverStatistics operator+(const SSolverStatistics& _other) const;
+	SSolverStatistics operator-(const SSolverStatistics& _other) const;
+
+	/** Whether no work has been done.*/
+	bool IsEmpty() const;
+	/** Text description of all counters.*/
+	std::string ToString() const;
+};
@@ -0,0 +1,270 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#include "ThreadedNVector.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+	/** Number of chunks, into which the range of length _length is split for parallel processing.*/
+	size_t ChunksNumber(sunindextype _length)
+	{
+		return _length < ThreadedNVector::MIN_PARALLEL_LENGTH ? 1 : std::max<size_t>(getThreadPool().GetThreadsNumber(), 1);
+	}
+
+	/** Splits the range [0, _length) into _nChunks chunks and calls _fun(iChunk, begin, end) for each of them in parallel. A single chunk is processed directly in the calling thread.*/
+	template<typename F>
+	void ForChunks(sunindextype _length, size_t _nChunks, const F& _fun)
+	{
+		if (_nChunks == 1)
+		{
+			if (_length > 0)
+				_fun(0, 0, _length);
+			return;
+		}
+		const sunindextype nChunkSize = (_length + static_cast<sunindextype>(_nChunks) - 1) / static_cast<sunindextype>(_nChunks);
+		ParallelFor(_nChunks, [&](size_t i)
+		{
+			const sunindextype begin = static_cast<sunindextype>(i) * nChunkSize;
+			const sunindextype end = std::min(begin + nChunkSize, _length);
+			if (begin < end)
+				_fun(i, begin, end);
+		});
+	}
+
+	/** Splits the range [0, _length) into chunks and calls _fun(iChunk, begin, end) for each of them in parallel. Short ranges are processed directly in the calling thread.*/
+	template<typename F>
+	void ForChunks(sunindextype _length, const F& _fun)
+	{
+		ForChunks(_length, ChunksNumber(_length), _fun);
+	}
+
+	/** Calculates partial results for each chunk with _fun(begin, end) and combines them with _reduce. Short ranges are reduced directly in the calling thread.*/
+	template<typename F, typename R>
+	realtype Reduce(sunindextype _length, realtype _init, const F& _fun, const R& _reduce)
+	{
+		const size_t nChunks = ChunksNumber(_length);
+		if (nChunks == 1)
+			return _reduce(_init, _fun(0, _length));
+		std::vector<realtype> vPartial(nChunks, _init);
+		ForChunks(_length, nChunks, [&](size_t _iChunk, sunindextype _begin, sunindextype _end)
+		{
+			vPartial[_iChunk] = _fun(_begin, _end);
+		});
+		realtype res = _init;
+		for (const realtype v : vPartial)
+			res = _reduce(res, v);
+		return res;
+	}
+
+	realtype SumOf(realtype _a, realtype _b) { return _a + _b; }
+	realtype MaxOf(realtype _a, realtype _b) { return std::max(_a, _b); }
+	realtype MinOf(realtype _a, realtype _b) { return std::min(_a, _b); }
+
+	void LinearSum(realtype _a, N_Vector _x, realtype _b, N_Vector _y, N_Vector _z)
+	{
+		realtype *x = NV_DATA_S(_x), *y = NV_DATA_S(_y), *z = NV_DATA_S(_z);
+		ForChunks(NV_LENGTH_S(_x), [&](size_t, sunindextype _begin, sunindextype _end)
+		{
+			for (sunindextype i = _begin; i < _end; ++i)
+				z[i] = _a * x[i] + _b * y[i];
+		});
+	}
+
+	void Const(realtype _c, N_Vector _z)
+	{
+		realtype *z = NV_DATA_S(_z);
+		ForChunks(NV_LENGTH_S(_z), [&](size_t, sunindextype _begin, sunindextype _end)
+		{
+			std::fill(z + _begin, z + _end, _c);
+		});
+	}
+
+	void Prod(N_Vector _x, N_Vector _y, N_Vector _z)
+	{
+		realtype *x = NV_DATA_S(_x), *y = NV_DATA_S(_y), *z = NV_DATA_S(_z);
+		ForChunks(NV_LENGTH_S(_x), [&](size_t, sunindextype _begin, sunindextype _end)
+		{
+			for (sunindextype i = _begin; i < _end; ++i)
+				z[i] = x[i] * y[i];
+		});
+	}
+
+	void Div(N_Vector _x, N_Vector _y, N_Vector _z)
+	{
+		realtype *x = NV_DATA_S(_x), *y = NV_DATA_S(_y), *z = NV_DATA_S(_z);
+		ForChunks(NV_LENGTH_S(_x), [&](size_t, sunindextype _begin, sunindextype _end)
+		{
+			for (sunindextype i = _begin; i < _end; ++i)
+				z[i] = x[i] / y[i];
+		});
+	}
+
+	void Scale(realtype _c, N_Vector _x, N_Vector _z)
+	{
+		realtype *x = NV_DATA_S(_x), *z = NV_DATA_S(_z);
+		ForChunks(NV_LENGTH_S(_x), [&](size_t, sunindextype _begin, sunindextype _end)
+		{
+			for (sunindextype i = _begin; i < _end; ++i)
+				z[i] = _c * x[i];
+		});
+	}
+
+	void Abs(N_Vector _x, N_Vector _z)
+	{
+		realtype *x = NV_DATA_S(_x), *z = NV_DATA_S(_z);
+		ForChunks(NV_LENGTH_S(_x), [&](size_t, sunindextype _begin, sunindextype _end)
+		{
+			for (sunindextype i = _begin; i < _end; ++i)
+				z[i] = std::abs(x[i]);
+		});
+	}
+
+	void Inv(N_Vector _x, N_Vector _z)
+	{
+		realtype *x = NV_DATA_S(_x), *z = NV_DATA_S(_z);
+		ForChunks(NV_LENGTH_S(_x), [&](size_t, sunindextype _begin, sunindextype _end)
+		{
+			for (sunindextype i = _begin; i < _end; ++i)
+				z[i] = 1. / x[i];
+		});
+	}
+
+	void AddConst(N_Vector _x, realtype _b, N_Vector _z)
+	{
+		realtype *x = NV_DATA_S(_x), *z = NV_DATA_S(_z);
+		ForChunks(NV_LENGTH_S(_x), [&](size_t, sunindextype _begin, sunindextype _end)
+		{
+			for (sunindextype i = _begin; i < _end; ++i)
+				z[i] = x[i] + _b;
+		});
+	}
+
+	void Compare(realtype _c, N_Vector _x, N_Vector _z)
+	{
+		realtype *x = NV_DATA_S(_x), *z = NV_DATA_S(_z);
+		ForChunks(NV_LENGTH_S(_x), [&](size_t, sunindextype _begin, sunindextype _end)
+		{
+			for (sunindextype i = _begin; i < _end; ++i)
+				z[i] = std::abs(x[i]) >= _c ? 1. : 0.;
+		});
+	}
+
+	realtype DotProd(N_Vector _x, N_Vector _y)
+	{
+		realtype *x = NV_DATA_S(_x), *y = NV_DATA_S(_y);
+		return Reduce(NV_LENGTH_S(_x), 0., [&](sunindextype _begin, sunindextype _end)
+		{
+			realtype sum = 0.;
+			for (sunindextype i = _begin; i < _end; ++i)
+				sum += x[i] * y[i];
+			return sum;
+		}, SumOf);
+	}
+
+	realtype MaxNorm(N_Vector _x)
+	{
+		realtype *x = NV_DATA_S(_x);
+		return Reduce(NV_LENGTH_S(_x), 0., [&](sunindextype _begin, sunindextype _end)
+		{
+			realtype max = 0.;
+			for (sunindextype i = _begin; i < _end; ++i)
+				max = std::max(max, std::abs(x[i]));
+			return max;
+		}, MaxOf);
+	}
+
+	realtype WrmsNorm(N_Vector _x, N_Vector _w)
+	{
+		realtype *x = NV_DATA_S(_x), *w = NV_DATA_S(_w);
+		const sunindextype length = NV_LENGTH_S(_x);
+		const realtype sum = Reduce(length, 0., [&](sunindextype _begin, sunindextype _end)
+		{
+			realtype sum = 0.;
+			for (sunindextype i = _begin; i < _end; ++i)
+				sum += x[i] * w[i] * x[i] * w[i];
+			return sum;
+		}, SumOf);
+		return std::sqrt(sum / length);
+	}
+
+	realtype WrmsNormMask(N_Vector _x, N_Vector _w, N_Vector _id)
+	{
+		realtype *x = NV_DATA_S(_x), *w = NV_DATA_S(_w), *id = NV_DATA_S(_id);
+		const sunindextype length = NV_LENGTH_S(_x);
+		const realtype sum = Reduce(length, 0., [&](sunindextype _begin, sunindextype _end)
+		{
+			realtype sum = 0.;
+			for (sunindextype i = _begin; i < _end; ++i)
+				if (id[i] > 0.)
+					sum += x[i] * w[i] * x[i] * w[i];
+			return sum;
+		}, SumOf);
+		return std::sqrt(sum / length);
+	}
+
+	realtype Min(N_Vector _x)
+	{
+		realtype *x = NV_DATA_S(_x);
+		return Reduce(NV_LENGTH_S(_x), std::numeric_limits<realtype>::max(), [&](sunindextype _begin, sunindextype _end)
+		{
+			realtype min = std::numeric_limits<realtype>::max();
+			for (sunindextype i = _begin; i < _end; ++i)
+				min = std::min(min, x[i]);
+			return min;
+		}, MinOf);
+	}
+
+	realtype WL2Norm(N_Vector _x, N_Vector _w)
+	{
+		realtype *x = NV_DATA_S(_x), *w = NV_DATA_S(_w);
+		const realtype sum = Reduce(NV_LENGTH_S(_x), 0., [&](sunindextype _begin, sunindextype _end)
+		{
+			realtype sum = 0.;
+			for (sunindextype i = _begin; i < _end; ++i)
+				sum += x[i] * w[i] * x[i] * w[i];
+			return sum;
+		}, SumOf);
+		return std::sqrt(sum);
+	}
+
+	realtype L1Norm(N_Vector _x)
+	{
+		realtype *x = NV_DATA_S(_x);
+		return Reduce(NV_LENGTH_S(_x), 0., [&](sunindextype _begin, sunindextype _end)
+		{
+			realtype sum = 0.;
+			for (sunindextype i = _begin; i < _end; ++i)
+				sum += std::abs(x[i]);
+			return sum;
+		}, SumOf);
+	}
+}
+
+N_Vector ThreadedNVector::New(sunindextype _length)
+{
+	N_Vector v = N_VNew_Serial(_length);
+	if (!v) return nullptr;
+
+	N_Vector_Ops ops = v->ops;
+	ops->nvlinearsum    = LinearSum;
+	ops->nvconst        = Const;
+	ops->nvprod         = Prod;
+	ops->nvdiv          = Div;
+	ops->nvscale        = Scale;
+	ops->nvabs          = Abs;
+	ops->nvinv          = Inv;
+	ops->nvaddconst     = AddConst;
+	ops->nvcompare      = Compare;
+	ops->nvdotprod      = DotProd;
+	ops->nvmaxnorm      = MaxNorm;
+	ops->nvwrmsnorm     = WrmsNorm;
+	ops->nvwrmsnormmask = WrmsNormMask;
+	ops->nvmin          = Min;
+	ops->nvwl2norm      = WL2Norm;
+	ops->nvl1norm       = L1Norm;
+	return v;
+}
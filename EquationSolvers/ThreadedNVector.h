@@ -0,0 +1,19 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#pragma once
+
+#include <nvector/nvector_serial.h>
+
+/** Serial SUNDIALS vector, whose element-wise operations and reductions are executed in parallel on the thread pool.
+ *	The data layout and the vector ID are the same as for the serial vector, so all NV_*_S macros and N_V*_Serial functions can be used.
+ *	Clones of the vector inherit the parallel operations.*/
+namespace ThreadedNVector
+{
+	/** Minimum length of the vector, starting from which operations are executed in parallel.*/
+	constexpr sunindextype MIN_PARALLEL_LENGTH = 4096;
+
+	/**	Create new vector.
+	 *	\param _length Length of the vector
+	 *	\retval Created vector or nullptr if memory cannot be allocated*/
+	N_Vector New(sunindextype _length);
+}
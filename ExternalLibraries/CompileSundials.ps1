@@ -86,10 +86,6 @@ $REM_LIB_LIST = @(
 	"sundials_sunmatrixsparse"
 )
 $REM_INCLUDE_LIST = @(
-	"ida\ida_bbdpre",
-	"ida\ida_spils",
-	"kinsol\kinsol_bbdpre",
-	"kinsol\kinsol_spils",
 	"sundials\sundials_band",
 	"sundials\sundials_fconfig",
 	"sundials\sundials_fnvector",
@@ -101,13 +97,10 @@ $REM_INCLUDE_LIST = @(
 	"sundials\sundials_spgmr",
 	"sundials\sundials_sptfqmr",
 	"sundials\sundials_version",
-	"sunlinsol\sunlinsol_band",
 	"sunlinsol\sunlinsol_pcg",
 	"sunlinsol\sunlinsol_spbcgs",
 	"sunlinsol\sunlinsol_spfgmr",
-	"sunlinsol\sunlinsol_spgmr",
 	"sunlinsol\sunlinsol_sptfqmr",
-	"sunmatrix\sunmatrix_band",
 	"sunmatrix\sunmatrix_sparse"
 )
 
@@ -0,0 +1,71 @@
+/*
+ * -----------------------------------------------------------------
+ * Programmer(s): Daniel R. Reynolds @ SMU
+ *                Radu Serban @ LLNL
+ * -----------------------------------------------------------------
+ * LLNS/SMU Copyright Start
+ * Copyright (c) 2017, Southern Methodist University and 
+ * Lawrence Livermore National Security
+ *
+ * This work was performed under the auspices of the U.S. Department 
+ * of Energy by Southern Methodist University and Lawrence Livermore 
+ * National Laboratory under Contract DE-AC52-07NA27344.
+ * Produced at Southern Methodist University and the Lawrence 
+ * Livermore National Laboratory.
+ *
+ * All rights reserved.
+ * For details, see the LICENSE file.
+ * LLNS/SMU Copyright End
+ * -----------------------------------------------------------------
+ * This is the header file for the IDABBDPRE module, for a
+ * band-block-diagonal preconditioner, i.e. a block-diagonal
+ * matrix with banded blocks, for use with IDA and an IDASPILS
+ * linear solver.
+ * -----------------------------------------------------------------
+ */
+
+#ifndef _IDABBDPRE_H
+#define _IDABBDPRE_H
+
+#include <sundials/sundials_nvector.h>
+
+#ifdef __cplusplus  /* wrapper to enable C++ usage */
+extern "C" {
+#endif
+
+/* User-supplied function types */
+
+typedef int (*IDABBDLocalFn)(sunindextype Nlocal, realtype tt,
+                             N_Vector yy, N_Vector yp, N_Vector gval,
+                             void *user_data);
+
+typedef int (*IDABBDCommFn)(sunindextype Nlocal, realtype tt,
+                            N_Vector yy, N_Vector yp,
+                            void *user_data);
+
+/* Exported Functions */
+
+SUNDIALS_EXPORT int IDABBDPrecInit(void *ida_mem, sunindextype Nlocal,
+                                   sunindextype mudq, sunindextype mldq, 
+                                   sunindextype mukeep, sunindextype mlkeep, 
+                                   realtype dq_rel_yy, 
+                                   IDABBDLocalFn Gres, IDABBDCommFn Gcomm);
+
+SUNDIALS_EXPORT int IDABBDPrecReInit(void *ida_mem,
+                                     sunindextype mudq, sunindextype mldq, 
+                                     realtype dq_rel_yy);
+
+/* Optional output functions */
+
+SUNDIALS_EXPORT int IDABBDPrecGetWorkSpace(void *ida_mem,
+                                           long int *lenrwBBDP,
+                                           long int *leniwBBDP);
+
+SUNDIALS_EXPORT int IDABBDPrecGetNumGfnEvals(void *ida_mem,
+                                             long int *ngevalsBBDP);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * -----------------------------------------------------------------
+ * Programmer(s): Daniel R. Reynolds @ SMU
+ *                Radu Serban @ LLNL
+ * -----------------------------------------------------------------
+ * LLNS/SMU Copyright Start
+ * Copyright (c) 2017, Southern Methodist University and 
+ * Lawrence Livermore National Security
+ *
+ * This work was performed under the auspices of the U.S. Department 
+ * of Energy by Southern Methodist University and Lawrence Livermore 
+ * National Laboratory under Contract DE-AC52-07NA27344.
+ * Produced at Southern Methodist University and the Lawrence 
+ * Livermore National Laboratory.
+ *
+ * All rights reserved.
+ * For details, see the LICENSE file.
+ * LLNS/SMU Copyright End
+ * -----------------------------------------------------------------
+ * Common header file for the scaled, preconditioned iterative
+ * linear solver interface in IDA.
+ * -----------------------------------------------------------------
+ */
+
+#ifndef _IDASPILS_H
+#define _IDASPILS_H
+
+#include <sundials/sundials_iterative.h>
+#include <sundials/sundials_linearsolver.h>
+#include <sundials/sundials_nvector.h>
+
+#ifdef __cplusplus  /* wrapper to enable C++ usage */
+extern "C" {
+#endif
+
+/*=================================================================
+   IDASPILS Constants
+  =================================================================*/
+
+#define IDASPILS_SUCCESS     0
+#define IDASPILS_MEM_NULL   -1
+#define IDASPILS_LMEM_NULL  -2
+#define IDASPILS_ILL_INPUT  -3
+#define IDASPILS_MEM_FAIL   -4
+#define IDASPILS_PMEM_NULL  -5
+#define IDASPILS_SUNLS_FAIL -6
+
+/*=================================================================
+   IDASPILS user-supplied function prototypes
+  =================================================================*/
+
+typedef int (*IDASpilsPrecSetupFn)(realtype tt, N_Vector yy,
+                                   N_Vector yp, N_Vector rr,
+                                   realtype c_j, void *user_data);
+
+typedef int (*IDASpilsPrecSolveFn)(realtype tt, N_Vector yy,
+                                   N_Vector yp, N_Vector rr,
+                                   N_Vector rvec, N_Vector zvec,
+                                   realtype c_j, realtype delta,
+                                   void *user_data);
+
+typedef int (*IDASpilsJacTimesSetupFn)(realtype tt, N_Vector yy,
+                                       N_Vector yp, N_Vector rr,
+                                       realtype c_j, void *user_data);
+
+typedef int (*IDASpilsJacTimesVecFn)(realtype tt, N_Vector yy, 
+                                     N_Vector yp, N_Vector rr,
+                                     N_Vector v, N_Vector Jv, 
+                                     realtype c_j, void *user_data, 
+                                     N_Vector tmp1, N_Vector tmp2);
+
+/*=================================================================
+   IDASPILS Exported functions
+  =================================================================*/
+
+SUNDIALS_EXPORT int IDASpilsSetLinearSolver(void *ida_mem, 
+                                            SUNLinearSolver LS);
+
+SUNDIALS_EXPORT int IDASpilsSetPreconditioner(void *ida_mem,
+                                              IDASpilsPrecSetupFn pset, 
+                                              IDASpilsPrecSolveFn psolve);
+SUNDIALS_EXPORT int IDASpilsSetJacTimes(void *ida_mem,
+                                        IDASpilsJacTimesSetupFn jtsetup,
+                                        IDASpilsJacTimesVecFn jtimes);
+SUNDIALS_EXPORT int IDASpilsSetEpsLin(void *ida_mem, realtype eplifac);
+SUNDIALS_EXPORT int IDASpilsSetIncrementFactor(void *ida_mem,
+                                               realtype dqincfac);
+
+SUNDIALS_EXPORT int IDASpilsGetWorkSpace(void *ida_mem, long int *lenrwLS,
+                                         long int *leniwLS);
+SUNDIALS_EXPORT int IDASpilsGetNumPrecEvals(void *ida_mem, long int *npevals);
+SUNDIALS_EXPORT int IDASpilsGetNumPrecSolves(void *ida_mem, long int *npsolves);
+SUNDIALS_EXPORT int IDASpilsGetNumLinIters(void *ida_mem, long int *nliters);
+SUNDIALS_EXPORT int IDASpilsGetNumConvFails(void *ida_mem, long int *nlcfails);
+SUNDIALS_EXPORT int IDASpilsGetNumJTSetupEvals(void *ida_mem,
+                                               long int *njtsetups);
+SUNDIALS_EXPORT int IDASpilsGetNumJtimesEvals(void *ida_mem, long int *njvevals);
+SUNDIALS_EXPORT int IDASpilsGetNumResEvals(void *ida_mem, long int *nrevalsLS); 
+SUNDIALS_EXPORT int IDASpilsGetLastFlag(void *ida_mem, long int *flag);
+SUNDIALS_EXPORT char *IDASpilsGetReturnFlagName(long int flag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * -----------------------------------------------------------------
+ * Programmer(s): Daniel R. Reynolds @ SMU
+ *                Radu Serban @ LLNL
+ * -----------------------------------------------------------------
+ * LLNS/SMU Copyright Start
+ * Copyright (c) 2017, Southern Methodist University and 
+ * Lawrence Livermore National Security
+ *
+ * This work was performed under the auspices of the U.S. Department 
+ * of Energy by Southern Methodist University and Lawrence Livermore 
+ * National Laboratory under Contract DE-AC52-07NA27344.
+ * Produced at Southern Methodist University and the Lawrence 
+ * Livermore National Laboratory.
+ *
+ * All rights reserved.
+ * For details, see the LICENSE file.
+ * LLNS/SMU Copyright End
+ * -----------------------------------------------------------------
+ * This is the header file for the KINBBDPRE module, for a
+ * band-block-diagonal preconditioner, i.e. a block-diagonal
+ * matrix with banded blocks, for use with KINSOL and a KINSPILS
+ * linear solver.
+ * -----------------------------------------------------------------
+ */
+
+#ifndef _KINBBDPRE_H
+#define _KINBBDPRE_H
+
+#include <sundials/sundials_nvector.h>
+
+#ifdef __cplusplus  /* wrapper to enable C++ usage */
+extern "C" {
+#endif
+
+/* User-supplied function types */
+
+typedef int (*KINBBDCommFn)(sunindextype Nlocal, N_Vector u,
+                            void *user_data);
+
+typedef int (*KINBBDLocalFn)(sunindextype Nlocal, N_Vector uu,
+                             N_Vector gval, void *user_data);
+
+/* Exported Functions */
+
+SUNDIALS_EXPORT int KINBBDPrecInit(void *kinmem, sunindextype Nlocal, 
+                                   sunindextype mudq, sunindextype mldq,
+                                   sunindextype mukeep, sunindextype mlkeep,
+                                   realtype dq_rel_uu, 
+                                   KINBBDLocalFn gloc, KINBBDCommFn gcomm);
+
+/* Optional output functions */
+
+SUNDIALS_EXPORT int KINBBDPrecGetWorkSpace(void *kinmem,
+                                           long int *lenrwBBDP,
+                                           long int *leniwBBDP);
+
+SUNDIALS_EXPORT int KINBBDPrecGetNumGfnEvals(void *kinmem,
+                                             long int *ngevalsBBDP);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
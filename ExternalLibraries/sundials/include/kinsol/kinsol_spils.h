@@ -0,0 +1,92 @@
+/*
+ * -----------------------------------------------------------------
+ * Programmer(s): Daniel R. Reynolds @ SMU
+ *                Radu Serban @ LLNL
+ * -----------------------------------------------------------------
+ * LLNS/SMU Copyright Start
+ * Copyright (c) 2017, Southern Methodist University and 
+ * Lawrence Livermore National Security
+ *
+ * This work was performed under the auspices of the U.S. Department 
+ * of Energy by Southern Methodist University and Lawrence Livermore 
+ * National Laboratory under Contract DE-AC52-07NA27344.
+ * Produced at Southern Methodist University and the Lawrence 
+ * Livermore National Laboratory.
+ *
+ * All rights reserved.
+ * For details, see the LICENSE file.
+ * LLNS/SMU Copyright End
+ * -----------------------------------------------------------------
+ * Common header file for the scaled, preconditioned iterative
+ * linear solver interface in KINSOL.
+ * -----------------------------------------------------------------
+ */
+
+#ifndef _KINSPILS_H
+#define _KINSPILS_H
+
+#include <sundials/sundials_iterative.h>
+#include <sundials/sundials_linearsolver.h>
+#include <sundials/sundials_nvector.h>
+
+#ifdef __cplusplus  /* wrapper to enable C++ usage */
+extern "C" {
+#endif
+
+/*==================================================================
+  KINSPILS Constants
+  ==================================================================*/
+
+#define KINSPILS_SUCCESS     0
+#define KINSPILS_MEM_NULL   -1
+#define KINSPILS_LMEM_NULL  -2
+#define KINSPILS_ILL_INPUT  -3
+#define KINSPILS_MEM_FAIL   -4
+#define KINSPILS_PMEM_NULL  -5
+#define KINSPILS_SUNLS_FAIL -6
+
+/*==================================================================
+  KINSPILS user-supplied function prototypes
+  ==================================================================*/
+
+typedef int (*KINSpilsPrecSetupFn)(N_Vector uu, N_Vector uscale,
+                                   N_Vector fval, N_Vector fscale,
+                                   void *user_data);
+
+typedef int (*KINSpilsPrecSolveFn)(N_Vector uu, N_Vector uscale, 
+                                   N_Vector fval, N_Vector fscale, 
+                                   N_Vector vv, void *user_data);
+
+typedef int (*KINSpilsJacTimesVecFn)(N_Vector v, N_Vector Jv,
+                                     N_Vector uu, booleantype *new_uu, 
+                                     void *J_data);
+
+/*==================================================================
+  KINSPILS Exported functions
+  ==================================================================*/
+
+SUNDIALS_EXPORT int KINSpilsSetLinearSolver(void *kinmem,
+                                            SUNLinearSolver LS);
+
+SUNDIALS_EXPORT int KINSpilsSetPreconditioner(void *kinmem,
+                                              KINSpilsPrecSetupFn psetup,
+                                              KINSpilsPrecSolveFn psolve);
+SUNDIALS_EXPORT int KINSpilsSetJacTimesVecFn(void *kinmem,
+                                             KINSpilsJacTimesVecFn jtv);
+
+SUNDIALS_EXPORT int KINSpilsGetWorkSpace(void *kinmem, long int *lenrwLS,
+                                         long int *leniwLS);
+SUNDIALS_EXPORT int KINSpilsGetNumPrecEvals(void *kinmem, long int *npevals);
+SUNDIALS_EXPORT int KINSpilsGetNumPrecSolves(void *kinmem, long int *npsolves);
+SUNDIALS_EXPORT int KINSpilsGetNumLinIters(void *kinmem, long int *nliters);
+SUNDIALS_EXPORT int KINSpilsGetNumConvFails(void *kinmem, long int *nlcfails);
+SUNDIALS_EXPORT int KINSpilsGetNumJtimesEvals(void *kinmem, long int *njvevals);
+SUNDIALS_EXPORT int KINSpilsGetNumFuncEvals(void *kinmem, long int *nfevals);
+SUNDIALS_EXPORT int KINSpilsGetLastFlag(void *kinmem, long int *flag);
+SUNDIALS_EXPORT char *KINSpilsGetReturnFlagName(long int flag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
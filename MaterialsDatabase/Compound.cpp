@@ -154,3 +154,10 @@ double CCompound::GetTPPropertyValue(ECompoundTPProperties _nType, double _dT, d
 		return prop->GetValue(_dT, _dP);
 	return 0;
 }
+
+std::vector<double> CCompound::GetTPPropertyValues(ECompoundTPProperties _nType, const std::vector<double>& _vT, const std::vector<double>& _vP) const
+{
+	if (const CTPDProperty *prop = GetTPProperty(_nType))
+		return prop->GetValues(_vT, _vP);
+	return std::vector<double>(_vT.size(), 0);
+}
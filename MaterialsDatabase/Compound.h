@@ -78,4 +78,6 @@ public:
 	double GetConstPropertyValue(ECompoundConstProperties _nType) const;
 	// Returns value of a temperature/pressure-dependent property by specified temperature [K] and pressure [Pa]. Returns 0 if such property doesn't exist.
 	double GetTPPropertyValue(ECompoundTPProperties _nType, double _dT, double _dP) const;
+	// Returns values of a temperature/pressure-dependent property for each pair of specified T and P. Returns zeros if such property doesn't exist.
+	std::vector<double> GetTPPropertyValues(ECompoundTPProperties _nType, const std::vector<double>& _vT, const std::vector<double>& _vP) const;
 };
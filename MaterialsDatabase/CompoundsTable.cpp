@@ -0,0 +1,187 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#include "CompoundsTable.h"
+
+void CCompoundsTable::Update(const CMaterialsDatabase* _pMaterialsDB, const std::vector<std::string>& _vKeys)
+{
+	Clear();
+	m_pMaterialsDB = _pMaterialsDB;
+	m_vKeys = _vKeys;
+	if (!m_pMaterialsDB) return;
+
+	m_nVersion = m_pMaterialsDB->GetVersion();
+	const size_t n = m_vKeys.size();
+	m_vCompounds.resize(n, nullptr);
+	m_vConstProperties.resize(n, std::vector<const CConstProperty*>(m_cnPropertiesRange, nullptr));
+	m_vTPProperties.resize(n, std::vector<const CTPDProperty*>(m_cnPropertiesRange, nullptr));
+	m_vTPKernelsIndices.resize(n * m_cnPropertiesRange, -1);
+	m_vInteractions.resize(n * n, nullptr);
+	for (size_t i = 0; i < n; ++i)
+	{
+		m_vCompounds[i] = m_pMaterialsDB->GetCompound(m_vKeys[i]);
+		if (!m_vCompounds[i]) continue;
+		for (const auto& prop : m_vCompounds[i]->GetConstProperties())
+			if (prop.GetType() >= CONST_PROP_NO_PROERTY && prop.GetType() < CONST_PROP_NO_PROERTY + m_cnPropertiesRange)
+				m_vConstProperties[i][prop.GetType() - CONST_PROP_NO_PROERTY] = &prop;
+		for (const auto& prop : m_vCompounds[i]->GetTPProperties())
+			if (prop.GetType() >= TP_PROP_NO_PROERTY && prop.GetType() < TP_PROP_NO_PROERTY + m_cnPropertiesRange)
+			{
+				m_vTPProperties[i][prop.GetType() - TP_PROP_NO_PROERTY] = &prop;
+				CPropertyKernel kernel;
+				if (!kernel.Build(prop)) continue;
+				m_vTPKernelsIndices[i * m_cnPropertiesRange + prop.GetType() - TP_PROP_NO_PROERTY] = m_vTPKernels.size();
+				m_vTPKernels.push_back(std::move(kernel));
+			}
+	}
+
+	// resolve interactions in one pass over the database, the first defined interaction for each pair is used, as in the database itself
+	for (size_t k = 0; k < m_pMaterialsDB->InteractionsNumber(); ++k)
+	{
+		const CInteraction* pInteraction = m_pMaterialsDB->GetInteraction(k);
+		const size_t i1 = GetIndex(pInteraction->GetKey1());
+		const size_t i2 = GetIndex(pInteraction->GetKey2());
+		if (i1 == static_cast<size_t>(-1) || i2 == static_cast<size_t>(-1)) continue;
+		if (!m_vInteractions[i1 * n + i2]) m_vInteractions[i1 * n + i2] = pInteraction;
+		if (!m_vInteractions[i2 * n + i1]) m_vInteractions[i2 * n + i1] = pInteraction;
+	}
+
+	// build dense table of interaction properties, only for properties that are currently defined in the database
+	m_vInteractionSlots.resize(m_cnPropertiesRange, -1);
+	for (const auto& descr : m_pMaterialsDB->ActiveInterProperties())
+		if (descr.first >= INT_PROP_NO_PROERTY && descr.first < INT_PROP_NO_PROERTY + m_cnPropertiesRange)
+			m_vInteractionSlots[descr.first - INT_PROP_NO_PROERTY] = m_nInteractionSlots++;
+	m_vInteractionProperties.resize(n * n * m_nInteractionSlots, nullptr);
+	for (size_t k = 0; k < n * n; ++k)
+		if (m_vInteractions[k])
+			for (const auto& prop : m_vInteractions[k]->GetProperties())
+				if (prop.GetType() >= INT_PROP_NO_PROERTY && prop.GetType() < INT_PROP_NO_PROERTY + m_cnPropertiesRange && m_vInteractionSlots[prop.GetType() - INT_PROP_NO_PROERTY] != static_cast<size_t>(-1))
+					m_vInteractionProperties[k * m_nInteractionSlots + m_vInteractionSlots[prop.GetType() - INT_PROP_NO_PROERTY]] = &prop;
+}
+
+void CCompoundsTable::Clear()
+{
+	m_pMaterialsDB = nullptr;
+	m_nVersion = 0;
+	m_vKeys.clear();
+	m_vCompounds.clear();
+	m_vConstProperties.clear();
+	m_vTPProperties.clear();
+	m_vTPKernelsIndices.clear();
+	m_vTPKernels.clear();
+	m_vInteractions.clear();
+	m_nInteractionSlots = 0;
+	m_vInteractionSlots.clear();
+	m_vInteractionProperties.clear();
+}
+
+bool CCompoundsTable::IsValid() const
+{
+	return m_pMaterialsDB && m_pMaterialsDB->GetVersion() == m_nVersion;
+}
+
+size_t CCompoundsTable::Size() const
+{
+	return m_vKeys.size();
+}
+
+size_t CCompoundsTable::GetIndex(const std::string& _sCompoundKey) const
+{
+	for (size_t i = 0; i < m_vKeys.size(); ++i)
+		if (m_vKeys[i] == _sCompoundKey)
+			return i;
+	return -1; // will be implicitly converted to size_t::max
+}
+
+const CCompound* CCompoundsTable::GetCompound(size_t _iCompound) const
+{
+	if (_iCompound >= m_vKeys.size()) return nullptr;
+	if (!IsValid()) return m_pMaterialsDB ? m_pMaterialsDB->GetCompound(m_vKeys[_iCompound]) : nullptr;
+	return m_vCompounds[_iCompound];
+}
+
+const CConstProperty* CCompoundsTable::GetConstProperty(size_t _iCompound, ECompoundConstProperties _nProperty) const
+{
+	if (_iCompound >= m_vKeys.size() || _nProperty < CONST_PROP_NO_PROERTY || _nProperty >= CONST_PROP_NO_PROERTY + m_cnPropertiesRange) return nullptr;
+	if (!IsValid())
+	{
+		const CCompound* pCompound = GetCompound(_iCompound);
+		return pCompound ? pCompound->GetConstProperty(_nProperty) : nullptr;
+	}
+	return m_vConstProperties[_iCompound][_nProperty - CONST_PROP_NO_PROERTY];
+}
+
+const CTPDProperty* CCompoundsTable::GetTPProperty(size_t _iCompound, ECompoundTPProperties _nProperty) const
+{
+	if (_iCompound >= m_vKeys.size() || _nProperty < TP_PROP_NO_PROERTY || _nProperty >= TP_PROP_NO_PROERTY + m_cnPropertiesRange) return nullptr;
+	if (!IsValid())
+	{
+		const CCompound* pCompound = GetCompound(_iCompound);
+		return pCompound ? pCompound->GetTPProperty(_nProperty) : nullptr;
+	}
+	return m_vTPProperties[_iCompound][_nProperty - TP_PROP_NO_PROERTY];
+}
+
+const CInteraction* CCompoundsTable::GetInteraction(size_t _iCompound1, size_t _iCompound2) const
+{
+	if (_iCompound1 >= m_vKeys.size() || _iCompound2 >= m_vKeys.size()) return nullptr;
+	if (!IsValid()) return m_pMaterialsDB ? m_pMaterialsDB->GetInteraction(m_vKeys[_iCompound1], m_vKeys[_iCompound2]) : nullptr;
+	return m_vInteractions[_iCompound1 * m_vKeys.size() + _iCompound2];
+}
+
+const CTPDProperty* CCompoundsTable::GetInteractionProperty(size_t _iCompound1, size_t _iCompound2, EInteractionProperties _nProperty) const
+{
+	if (_iCompound1 >= m_vKeys.size() || _iCompound2 >= m_vKeys.size() || _nProperty < INT_PROP_NO_PROERTY || _nProperty >= INT_PROP_NO_PROERTY + m_cnPropertiesRange) return nullptr;
+	if (!IsValid())
+	{
+		const CInteraction* pInteraction = GetInteraction(_iCompound1, _iCompound2);
+		return pInteraction ? pInteraction->GetProperty(_nProperty) : nullptr;
+	}
+	const size_t slot = m_vInteractionSlots[_nProperty - INT_PROP_NO_PROERTY];
+	if (slot == static_cast<size_t>(-1)) return nullptr;
+	return m_vInteractionProperties[(_iCompound1 * m_vKeys.size() + _iCompound2) * m_nInteractionSlots + slot];
+}
+
+double CCompoundsTable::GetConstPropertyValue(size_t _iCompound, ECompoundConstProperties _nProperty) const
+{
+	if (const CConstProperty* prop = GetConstProperty(_iCompound, _nProperty))
+		return prop->GetValue();
+	return 0;
+}
+
+double CCompoundsTable::GetTPPropertyValue(size_t _iCompound, ECompoundTPProperties _nProperty, double _dT, double _dP) const
+{
+	if (_iCompound < m_vKeys.size() && _nProperty >= TP_PROP_NO_PROERTY && _nProperty < TP_PROP_NO_PROERTY + m_cnPropertiesRange && IsValid())
+	{
+		const size_t iKernel = m_vTPKernelsIndices[_iCompound * m_cnPropertiesRange + _nProperty - TP_PROP_NO_PROERTY];
+		if (iKernel != static_cast<size_t>(-1) && m_vTPKernels[iKernel].IsActual())
+			return m_vTPKernels[iKernel].GetValue(_dT, _dP);
+	}
+	if (const CTPDProperty* prop = GetTPProperty(_iCompound, _nProperty))
+		return prop->GetValue(_dT, _dP);
+	return 0;
+}
+
+std::vector<double> CCompoundsTable::GetTPPropertyValues(size_t _iCompound, ECompoundTPProperties _nProperty, const std::vector<double>& _vT, const std::vector<double>& _vP) const
+{
+	if (_vT.size() == _vP.size() && _iCompound < m_vKeys.size() && _nProperty >= TP_PROP_NO_PROERTY && _nProperty < TP_PROP_NO_PROERTY + m_cnPropertiesRange && IsValid())
+	{
+		const size_t iKernel = m_vTPKernelsIndices[_iCompound * m_cnPropertiesRange + _nProperty - TP_PROP_NO_PROERTY];
+		if (iKernel != static_cast<size_t>(-1) && m_vTPKernels[iKernel].IsActual())
+		{
+			std::vector<double> vRes(_vT.size());
+			for (size_t i = 0; i < _vT.size(); ++i)
+				vRes[i] = m_vTPKernels[iKernel].GetValue(_vT[i], _vP[i]);
+			return vRes;
+		}
+	}
+	if (const CTPDProperty* prop = GetTPProperty(_iCompound, _nProperty))
+		return prop->GetValues(_vT, _vP);
+	return std::vector<double>(_vT.size(), 0);
+}
+
+double CCompoundsTable::GetInteractionPropertyValue(size_t _iCompound1, size_t _iCompound2, EInteractionProperties _nProperty, double _dT, double _dP) const
+{
+	if (const CTPDProperty* prop = GetInteractionProperty(_iCompound1, _iCompound2, _nProperty))
+		return prop->GetValue(_dT, _dP);
+	return 0;
+}
@@ -0,0 +1,64 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#pragma once
+
+#include "MaterialsDatabase.h"
+#include "PropertyKernel.h"
+
+// Resolved access to properties of a fixed list of compounds from the materials database.
+// Compounds are addressed by their indices in the list. Pointers to compounds, their properties and interactions are looked up once in Update(),
+// so that property values are then obtained without searching by string keys. If the structure of the database changes afterwards,
+// values are obtained from the database by keys until the next Update(). TP-dependent properties described by a single analytical correlation
+// are additionally specialized into compact evaluators, which reflect the parameters of correlations at the moment of Update().
+class CCompoundsTable
+{
+	static const unsigned m_cnPropertiesRange = 100;	// Range of keys of each type of properties: [100;200) for const, [200;300) for TP-dependent, [300;400) for interaction properties.
+
+	const CMaterialsDatabase* m_pMaterialsDB{ nullptr };	// Pointer to the database of materials.
+	size_t m_nVersion{ 0 };									// Version of the database, for which pointers have been resolved.
+	std::vector<std::string> m_vKeys;						// Keys of compounds.
+	std::vector<const CCompound*> m_vCompounds;				// Pointers to compounds for each key.
+	std::vector<std::vector<const CConstProperty*>> m_vConstProperties;	// Pointers to const properties of each compound, indexed by property keys relative to CONST_PROP_NO_PROERTY.
+	std::vector<std::vector<const CTPDProperty*>> m_vTPProperties;		// Pointers to TP-dependent properties of each compound, indexed by property keys relative to TP_PROP_NO_PROERTY.
+	std::vector<size_t> m_vTPKernelsIndices;							// Indices of specialized evaluators in m_vTPKernels for TP-dependent properties, stored as [iCompound * range + key - TP_PROP_NO_PROERTY]; -1 if not specialized.
+	std::vector<CPropertyKernel> m_vTPKernels;							// Specialized evaluators of TP-dependent properties. Outdated ones are bypassed until the next Update().
+	std::vector<const CInteraction*> m_vInteractions;		// Pointers to interactions between each pair of compounds, stored as [i * n + j].
+	size_t m_nInteractionSlots{ 0 };						// Number of interaction properties stored for each pair of compounds.
+	std::vector<size_t> m_vInteractionSlots;				// Position of each interaction property in a row of m_vInteractionProperties, indexed by property keys relative to INT_PROP_NO_PROERTY; -1 if not defined.
+	std::vector<const CTPDProperty*> m_vInteractionProperties;	// Dense table of pointers to interaction properties, stored as [(i * n + j) * slots + slot].
+
+public:
+	// Resolves pointers to compounds with the given keys and to their properties in the database.
+	void Update(const CMaterialsDatabase* _pMaterialsDB, const std::vector<std::string>& _vKeys);
+	// Removes all resolved pointers.
+	void Clear();
+
+	// Returns true if pointers are resolved for the current structure of the database.
+	bool IsValid() const;
+
+	// Returns number of compounds.
+	size_t Size() const;
+	// Returns index of a compound with the specified key. Returns -1 if such compound has not been defined.
+	size_t GetIndex(const std::string& _sCompoundKey) const;
+
+	// Returns const pointer to a compound with the specified index. Returns nullptr if such compound has not been defined.
+	const CCompound* GetCompound(size_t _iCompound) const;
+	// Returns const pointer to a specified const property of a compound with the specified index. Returns nullptr if such property doesn't exist.
+	const CConstProperty* GetConstProperty(size_t _iCompound, ECompoundConstProperties _nProperty) const;
+	// Returns const pointer to a specified temperature/pressure-dependent property of a compound with the specified index. Returns nullptr if such property doesn't exist.
+	const CTPDProperty* GetTPProperty(size_t _iCompound, ECompoundTPProperties _nProperty) const;
+	// Returns const pointer to an interaction between compounds with specified indices. Returns nullptr if such interaction has not been defined.
+	const CInteraction* GetInteraction(size_t _iCompound1, size_t _iCompound2) const;
+
+	// Returns const pointer to a specified interaction property between compounds with specified indices. Returns nullptr if such property doesn't exist.
+	const CTPDProperty* GetInteractionProperty(size_t _iCompound1, size_t _iCompound2, EInteractionProperties _nProperty) const;
+
+	// Returns value of a constant property for a compound with the specified index. Returns 0 if such property doesn't exist.
+	double GetConstPropertyValue(size_t _iCompound, ECompoundConstProperties _nProperty) const;
+	// Returns value of a temperature/pressure-dependent property by specified temperature [K] and pressure [Pa] for a compound with the specified index. Returns 0 if such property doesn't exist.
+	double GetTPPropertyValue(size_t _iCompound, ECompoundTPProperties _nProperty, double _dT, double _dP) const;
+	// Returns values of a temperature/pressure-dependent property for each pair of specified temperatures [K] and pressures [Pa] for a compound with the specified index. Returns zeros if such property doesn't exist.
+	std::vector<double> GetTPPropertyValues(size_t _iCompound, ECompoundTPProperties _nProperty, const std::vector<double>& _vT, const std::vector<double>& _vP) const;
+	// Returns value of an interaction property by specified temperature [K] and pressure [Pa] between compounds with specified indices. Returns 0 if such property doesn't exist.
+	double GetInteractionPropertyValue(size_t _iCompound1, size_t _iCompound2, EInteractionProperties _nProperty, double _dT, double _dP) const;
+};
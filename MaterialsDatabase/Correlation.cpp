@@ -5,6 +5,9 @@
 #include "DyssolStringConstants.h"
 #include <sstream>
 #include <cmath>
+#include <algorithm>
+
+std::atomic<size_t> CCorrelation::m_revisionsCounter{ 0 };
 
 CCorrelation::CCorrelation()
 {
@@ -25,6 +28,7 @@ bool CCorrelation::SetTInterval(const SInterval& _TInterval)
 {
 	if (_TInterval.min < 0 || _TInterval.max < 0) return false;
 	m_TInterval = _TInterval;
+	UpdateRevision();
 	return true;
 }
 
@@ -37,6 +41,7 @@ bool CCorrelation::SetPInterval(const SInterval& _PInterval)
 {
 	if (_PInterval.min < 0 || _PInterval.max < 0) return false;
 	m_PInterval = _PInterval;
+	UpdateRevision();
 	return true;
 }
 
@@ -57,6 +62,7 @@ void CCorrelation::SetType(ECorrelationTypes _nType)
 
 	// prepare the parameters list
 	m_vParameters.resize(MDBDescriptors::correlations[m_nType].parametersNumber, 1.0);
+	UpdateRevision();
 }
 
 std::vector<double> CCorrelation::GetParameters() const
@@ -96,45 +102,80 @@ bool CCorrelation::SetParameters(const std::vector<double>& _vParams)
 		m_vParameters = _vParams;
 	}
 
+	UpdateRevision();
 	return true;
 }
 
+size_t CCorrelation::GetRevision() const
+{
+	return m_nRevision;
+}
+
 double CCorrelation::GetValue(double _dT, double _dP) const
 {
 	if (!IsTInInterval(_dT)) _dT = _dT < m_TInterval.min ? m_TInterval.min : m_TInterval.max;
 	if (!IsPInInterval(_dP)) _dP = _dP < m_PInterval.min ? m_PInterval.min : m_PInterval.max;
 
+	const double* p = m_vParameters.data();
 	switch (m_nType)
 	{
-	case ECorrelationTypes::LIST_OF_T_VALUES:
-		return m_valuesList.GetValue(_dT);
-	case ECorrelationTypes::LIST_OF_P_VALUES:
-		return m_valuesList.GetValue(_dP);
-	case ECorrelationTypes::CONSTANT:
-		return m_vParameters[0];
-	case ECorrelationTypes::LINEAR:
-		return _dT*m_vParameters[0] + _dP*m_vParameters[1] + m_vParameters[2];
-	case ECorrelationTypes::EXPONENT_1:
-		if (m_vParameters[6] * _dT + m_vParameters[7] != 0)
-			return m_vParameters[0] * std::pow(m_vParameters[1], m_vParameters[2] + m_vParameters[3] * _dT + (m_vParameters[4] * _dT + m_vParameters[5]) / (m_vParameters[6] * _dT + m_vParameters[7])) + m_vParameters[8];
-	case ECorrelationTypes::POW_1:
-		return m_vParameters[0] * std::pow(_dT, m_vParameters[1]);
-	case ECorrelationTypes::POLYNOMIAL_1:
-		return m_vParameters[0] + m_vParameters[1] * _dT + m_vParameters[2] * std::pow(_dT, 2) + m_vParameters[3] * std::pow(_dT, 3) + m_vParameters[4] * std::pow(_dT, 4) + m_vParameters[5] * std::pow(_dT, 5) + m_vParameters[6] * std::pow(_dT, 6) + m_vParameters[7] * std::pow(_dT, 7);
-	case ECorrelationTypes::POLYNOMIAL_CP:
-		if(_dT != 0)
-			return m_vParameters[0] + m_vParameters[1] * _dT + m_vParameters[2] * std::pow(_dT, 2.) + m_vParameters[3] * std::pow(_dT, 3.) + m_vParameters[4] / std::pow(_dT, 2.);
-	case ECorrelationTypes::POLYNOMIAL_H:
-		if (_dT != 0)
-			return m_vParameters[0] * _dT + m_vParameters[1] * std::pow(_dT, 2.) / 2. + m_vParameters[2] * std::pow(_dT, 3.) / 3. + m_vParameters[3] * std::pow(_dT, 4.) / 4. - m_vParameters[4] / _dT + m_vParameters[5] - m_vParameters[6];
-	case ECorrelationTypes::POLYNOMIAL_S:
-		if (_dT != 0)
-			return m_vParameters[0] * std::log(_dT) + m_vParameters[1] * _dT + m_vParameters[2] * std::pow(_dT, 2.) / 2. + m_vParameters[3] * std::pow(_dT, 3.) / 3. - m_vParameters[4] / (2 * std::pow(_dT, 2.)) + m_vParameters[5];
+	case ECorrelationTypes::LIST_OF_T_VALUES:	return m_valuesList.GetValue(_dT);
+	case ECorrelationTypes::LIST_OF_P_VALUES:	return m_valuesList.GetValue(_dP);
+	case ECorrelationTypes::CONSTANT:		return Evaluate<ECorrelationTypes::CONSTANT>(p, _dT, _dP);
+	case ECorrelationTypes::LINEAR:			return Evaluate<ECorrelationTypes::LINEAR>(p, _dT, _dP);
+	case ECorrelationTypes::EXPONENT_1:		return Evaluate<ECorrelationTypes::EXPONENT_1>(p, _dT, _dP);
+	case ECorrelationTypes::POW_1:			return Evaluate<ECorrelationTypes::POW_1>(p, _dT, _dP);
+	case ECorrelationTypes::POLYNOMIAL_1:	return Evaluate<ECorrelationTypes::POLYNOMIAL_1>(p, _dT, _dP);
+	case ECorrelationTypes::POLYNOMIAL_CP:	return Evaluate<ECorrelationTypes::POLYNOMIAL_CP>(p, _dT, _dP);
+	case ECorrelationTypes::POLYNOMIAL_H:	return Evaluate<ECorrelationTypes::POLYNOMIAL_H>(p, _dT, _dP);
+	case ECorrelationTypes::POLYNOMIAL_S:	return Evaluate<ECorrelationTypes::POLYNOMIAL_S>(p, _dT, _dP);
 	}
 
 	return 0;
 }
 
+template<ECorrelationTypes TYPE>
+void CCorrelation::EvaluateAll(const double* _p, const std::vector<double>& _vT, const std::vector<double>& _vP, std::vector<double>& _vRes)
+{
+	for (size_t i = 0; i < _vRes.size(); ++i)
+		_vRes[i] = Evaluate<TYPE>(_p, _vT[i], _vP[i]);
+}
+
+std::vector<double> CCorrelation::GetValues(const std::vector<double>& _vT, const std::vector<double>& _vP) const
+{
+	if (_vT.size() != _vP.size()) return {};
+	const size_t n = _vT.size();
+
+	// bring T and P to the defined intervals, as in GetValue()
+	std::vector<double> vT(n), vP(n);
+	const double Tmin = m_TInterval.min, Tmax = m_TInterval.max;
+	const double Pmin = m_PInterval.min, Pmax = m_PInterval.max;
+	for (size_t i = 0; i < n; ++i)
+	{
+		vT[i] = _vT[i] >= Tmin && _vT[i] <= Tmax ? _vT[i] : _vT[i] < Tmin ? Tmin : Tmax;
+		vP[i] = _vP[i] >= Pmin && _vP[i] <= Pmax ? _vP[i] : _vP[i] < Pmin ? Pmin : Pmax;
+	}
+
+	// the type is resolved once, each case is a plain loop over all points with the formula of this type
+	std::vector<double> vRes(n, 0);
+	const double* p = m_vParameters.data();
+	switch (m_nType)
+	{
+	case ECorrelationTypes::LIST_OF_T_VALUES:	return m_valuesList.GetValues(vT);
+	case ECorrelationTypes::LIST_OF_P_VALUES:	return m_valuesList.GetValues(vP);
+	case ECorrelationTypes::CONSTANT:		EvaluateAll<ECorrelationTypes::CONSTANT>(p, vT, vP, vRes);		break;
+	case ECorrelationTypes::LINEAR:			EvaluateAll<ECorrelationTypes::LINEAR>(p, vT, vP, vRes);		break;
+	case ECorrelationTypes::EXPONENT_1:		EvaluateAll<ECorrelationTypes::EXPONENT_1>(p, vT, vP, vRes);	break;
+	case ECorrelationTypes::POW_1:			EvaluateAll<ECorrelationTypes::POW_1>(p, vT, vP, vRes);			break;
+	case ECorrelationTypes::POLYNOMIAL_1:	EvaluateAll<ECorrelationTypes::POLYNOMIAL_1>(p, vT, vP, vRes);	break;
+	case ECorrelationTypes::POLYNOMIAL_CP:	EvaluateAll<ECorrelationTypes::POLYNOMIAL_CP>(p, vT, vP, vRes);	break;
+	case ECorrelationTypes::POLYNOMIAL_H:	EvaluateAll<ECorrelationTypes::POLYNOMIAL_H>(p, vT, vP, vRes);	break;
+	case ECorrelationTypes::POLYNOMIAL_S:	EvaluateAll<ECorrelationTypes::POLYNOMIAL_S>(p, vT, vP, vRes);	break;
+	}
+
+	return vRes;
+}
+
 bool CCorrelation::IsTInInterval(double _dT) const
 {
 	return _dT >= m_TInterval.min && _dT <= m_TInterval.max;
@@ -196,6 +237,7 @@ void CCorrelation::Initialize(ECorrelationTypes _nType, const std::vector<double
 		m_valuesList.clear();
 		m_TInterval = { MDBDescriptors::TEMP_MIN , MDBDescriptors::TEMP_MIN };
 		m_PInterval = { MDBDescriptors::PRES_MIN , MDBDescriptors::PRES_MAX };
+		UpdateRevision();
 	}
 }
 
@@ -204,3 +246,8 @@ bool CCorrelation::TrySetCorrelation(ECorrelationTypes _nType, const std::vector
 	SetType(_nType); // set type
 	return SetTInterval(_TInterval) && SetPInterval(_PInterval) && SetParameters(_vParams); // try to set other parameters
 }
+
+void CCorrelation::UpdateRevision()
+{
+	m_nRevision = ++m_revisionsCounter;
+}
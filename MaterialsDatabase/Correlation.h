@@ -5,6 +5,8 @@
 #include "Descriptable.h"
 #include "DyssolTypes.h"
 #include "DefinesMDB.h"
+#include <atomic>
+#include <cmath>
 
 // Correlation between the value of the property and the temperature(T)/pressure(P) in a certain T/P-interval. Is used to describe TP-dependent parameters of pure compounds
 class CCorrelation : public CDescriptable
@@ -14,6 +16,9 @@ class CCorrelation : public CDescriptable
 	SInterval m_PInterval{};			// Left and right boundaries of pressure interval in [Pa], for which this correlation is defined.
 	std::vector<double> m_vParameters;	// Correlation parameters for all types except LIST_OF_T_VALUES and LIST_OF_P_VALUES.
 	CDependentValues m_valuesList;		// List of pairs [parameter:value] in the case of LIST_OF_T_VALUES and LIST_OF_P_VALUES.
+	size_t m_nRevision{ 0 };			// Revision of this correlation, changes with each modification.
+
+	static std::atomic<size_t> m_revisionsCounter;	// Global counter of modifications of all correlations.
 
 public:
 	CCorrelation();
@@ -38,9 +43,14 @@ public:
 	// Sets vector of correlation parameters. In the case of LIST_OF_T_VALUES and LIST_OF_P_VALUES, it must be a list of pairs [parameter:value].
 	bool SetParameters(const std::vector<double>& _vParams);
 
+	// Returns revision of the correlation. It is unique among all correlations and changes with each modification of this correlation.
+	size_t GetRevision() const;
+
 	// Returns value of the correlation at the specified Temperature and Pressure. For the LIST_OF_T_VALUES and LIST_OF_P_VALUES returns a linearly interpolated value.
 	// If the specified T or P are out of defined intervals, returns value at the nearest boundary.
 	double GetValue(double _dT, double _dP) const;
+	// Returns values of the correlation at each pair of specified Temperatures and Pressures, evaluated in one pass. Both vectors must have the same length, otherwise returns an empty vector.
+	std::vector<double> GetValues(const std::vector<double>& _vT, const std::vector<double>& _vP) const;
 
 	// Returns true if T lays within the defined interval for this correlation.
 	bool IsTInInterval(double _dT) const;
@@ -57,9 +67,43 @@ public:
 	// Comparison.
 	bool operator==(const CCorrelation& _c) const;
 
+	// Evaluates the analytical correlation of type TYPE with parameters _p at the Temperature and Pressure, which are already brought to the intervals of the correlation.
+	// The only definition of the formulas, used by all functions that evaluate correlations. Returns 0 for LIST_OF_T_VALUES and LIST_OF_P_VALUES.
+	template<ECorrelationTypes TYPE>
+	static double Evaluate(const double* _p, double _dT, double _dP)
+	{
+		if constexpr (TYPE == ECorrelationTypes::CONSTANT)
+			return _p[0];
+		else if constexpr (TYPE == ECorrelationTypes::LINEAR)
+			return _dT*_p[0] + _dP*_p[1] + _p[2];
+		else if constexpr (TYPE == ECorrelationTypes::EXPONENT_1)
+		{
+			if (_p[6] * _dT + _p[7] != 0)
+				return _p[0] * std::pow(_p[1], _p[2] + _p[3] * _dT + (_p[4] * _dT + _p[5]) / (_p[6] * _dT + _p[7])) + _p[8];
+			return Evaluate<ECorrelationTypes::POW_1>(_p, _dT, _dP);
+		}
+		else if constexpr (TYPE == ECorrelationTypes::POW_1)
+			return _p[0] * std::pow(_dT, _p[1]);
+		else if constexpr (TYPE == ECorrelationTypes::POLYNOMIAL_1)
+			return _p[0] + _p[1] * _dT + _p[2] * std::pow(_dT, 2) + _p[3] * std::pow(_dT, 3) + _p[4] * std::pow(_dT, 4) + _p[5] * std::pow(_dT, 5) + _p[6] * std::pow(_dT, 6) + _p[7] * std::pow(_dT, 7);
+		else if constexpr (TYPE == ECorrelationTypes::POLYNOMIAL_CP)
+			return _dT != 0 ? _p[0] + _p[1] * _dT + _p[2] * std::pow(_dT, 2.) + _p[3] * std::pow(_dT, 3.) + _p[4] / std::pow(_dT, 2.) : 0;
+		else if constexpr (TYPE == ECorrelationTypes::POLYNOMIAL_H)
+			return _dT != 0 ? _p[0] * _dT + _p[1] * std::pow(_dT, 2.) / 2. + _p[2] * std::pow(_dT, 3.) / 3. + _p[3] * std::pow(_dT, 4.) / 4. - _p[4] / _dT + _p[5] - _p[6] : 0;
+		else if constexpr (TYPE == ECorrelationTypes::POLYNOMIAL_S)
+			return _dT != 0 ? _p[0] * std::log(_dT) + _p[1] * _dT + _p[2] * std::pow(_dT, 2.) / 2. + _p[3] * std::pow(_dT, 3.) / 3. - _p[4] / (2 * std::pow(_dT, 2.)) + _p[5] : 0;
+		else
+			return 0;
+	}
+
 private:
 	// Initializes Correlation with specified parameters. If some error occurs during initialization, sets default parameters.
 	void Initialize(ECorrelationTypes _nType, const std::vector<double>& _vParams, const SInterval& _TInterval, const SInterval& _PInterval);
 	// Set new correlation with parameters. It some error occurs, returns false and leaves the Correlation in inconsistent state.
 	bool TrySetCorrelation(ECorrelationTypes _nType, const std::vector<double>& _vParams, const SInterval& _TInterval, const SInterval& _PInterval);
+	// Sets a new unique revision of the correlation. Must be called by all functions that modify it.
+	void UpdateRevision();
+	// Evaluates the analytical correlation of type TYPE with parameters _p at each pair of Temperatures and Pressures, writing results to _vRes of the same length.
+	template<ECorrelationTypes TYPE>
+	static void EvaluateAll(const double* _p, const std::vector<double>& _vT, const std::vector<double>& _vP, std::vector<double>& _vRes);
 };
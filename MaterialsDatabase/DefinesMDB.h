@@ -13,8 +13,11 @@ namespace MDBDescriptors
 {
 	const std::string SIGNATURE_STRING = "DyssolMaterialsDatabase";
 	const unsigned VERSION = 3;
+	const std::string BINARY_SIGNATURE_STRING = "DyssolMaterialsDatabaseBinary";
+	const unsigned BINARY_VERSION = 1;
 
 	const std::wstring DEFAULT_MDB_FILE_NAME = L"Materials.dmdb";
+	const std::wstring BINARY_MDB_FILE_EXTENSION = L"dmdbc";
 
 	const double TEMP_MIN = 10;
 	const double TEMP_MAX = 10000;
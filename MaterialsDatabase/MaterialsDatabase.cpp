@@ -4,13 +4,18 @@
 #include "StringFunctions.h"
 #include "DyssolUtilities.h"
 #include "DyssolStringConstants.h"
+#include "MemoryMappedFile.h"
 #include <fstream>
 #include <sstream>
+#include <cstring>
 
 using namespace StringFunctions;
 
+std::atomic<size_t> CMaterialsDatabase::m_versionsCounter{ 0 };
+
 CMaterialsDatabase::CMaterialsDatabase()
 {
+	UpdateVersion();
 	m_sFileName = MDBDescriptors::DEFAULT_MDB_FILE_NAME;
 
 	activeConstProperties = MDBDescriptors::defaultConstProperties;
@@ -69,6 +74,7 @@ void CMaterialsDatabase::AddProperty(const MDBDescriptors::SPropertyDescriptor&
 	}
 
 	// add to compounds and interactions
+	UpdateVersion();
 	switch (_descriptor.type)
 	{
 	case MDBDescriptors::EPropertyType::CONSTANT:
@@ -88,6 +94,7 @@ void CMaterialsDatabase::AddProperty(const MDBDescriptors::SPropertyDescriptor&
 
 void CMaterialsDatabase::RemoveProperty(const MDBDescriptors::EPropertyType& _type, unsigned _key)
 {
+	UpdateVersion();
 	switch (_type)
 	{
 	case MDBDescriptors::EPropertyType::CONSTANT:
@@ -119,6 +126,16 @@ bool CMaterialsDatabase::IsPropertyDefined(unsigned _key) const
 	return false;
 }
 
+size_t CMaterialsDatabase::GetVersion() const
+{
+	return m_nVersion;
+}
+
+void CMaterialsDatabase::UpdateVersion()
+{
+	m_nVersion = ++m_versionsCounter;
+}
+
 std::wstring CMaterialsDatabase::GetFileName() const
 {
 	return m_sFileName;
@@ -129,6 +146,7 @@ void CMaterialsDatabase::CreateNewDatabase()
 	m_sFileName.clear();
 	m_vCompounds.clear();
 	m_vInteractions.clear();
+	UpdateVersion();
 
 	activeConstProperties = MDBDescriptors::defaultConstProperties;
 	activeTPDepProperties = MDBDescriptors::defaultTPDProperties;
@@ -269,6 +287,9 @@ bool CMaterialsDatabase::LoadFromFile(const std::wstring& _fileName /*= ""*/)
 	CreateNewDatabase();
 	const std::wstring fileName = _fileName.empty() ? MDBDescriptors::DEFAULT_MDB_FILE_NAME : _fileName;
 
+	if (IsBinaryFile(fileName))
+		return LoadFromBinaryFile(fileName);
+
 	std::ifstream inFile(UnicodePath(fileName));
 	if (inFile.fail()) return false;
 
@@ -561,6 +582,302 @@ bool CMaterialsDatabase::LoadFromFileV3(std::ifstream& _file)
 	return true;
 }
 
+bool CMaterialsDatabase::SaveToBinaryFile(const std::wstring& _fileName) const
+{
+	std::string payload;
+	// Appends a trivially copyable value to the payload.
+	const auto Write = [&](auto _value)
+	{
+		payload.append(reinterpret_cast<const char*>(&_value), sizeof(_value));
+	};
+	// Appends a string prefixed with its length.
+	const auto WriteString = [&](const std::string& _s)
+	{
+		Write(static_cast<uint32_t>(_s.size()));
+		payload.append(_s);
+	};
+	// Appends a vector of doubles prefixed with its length.
+	const auto WriteVector = [&](const std::vector<double>& _v)
+	{
+		Write(static_cast<uint32_t>(_v.size()));
+		for (double v : _v)
+			Write(v);
+	};
+	// Appends a TP-dependent property with all its correlations.
+	const auto WriteTPDProperty = [&](const CTPDProperty& _prop)
+	{
+		Write(static_cast<uint32_t>(_prop.GetType()));
+		WriteString(_prop.GetDescription());
+		Write(static_cast<uint32_t>(_prop.CorrelationsNumber()));
+		for (size_t i = 0; i < _prop.CorrelationsNumber(); ++i)
+		{
+			const CCorrelation& corr = *_prop.GetCorrelation(i);
+			Write(static_cast<uint32_t>(E2I(corr.GetType())));
+			Write(corr.GetTInterval().min);
+			Write(corr.GetTInterval().max);
+			Write(corr.GetPInterval().min);
+			Write(corr.GetPInterval().max);
+			WriteVector(corr.GetParameters());
+			WriteString(corr.GetDescription());
+		}
+	};
+	// Appends descriptors of all user-defined properties of one type.
+	const auto WriteDescriptors = [&](const auto& _active, const auto& _default, const auto& _writeValue)
+	{
+		uint32_t count = 0;
+		for (const auto& p : _active)
+			if (!MapContainsKey(_default, p.first))
+				++count;
+		Write(count);
+		for (const auto& p : _active)
+			if (!MapContainsKey(_default, p.first))
+			{
+				Write(static_cast<uint32_t>(p.first));
+				WriteString(p.second.name);
+				WriteString(WString2String(p.second.units));
+				WriteString(p.second.description);
+				_writeValue(p.second);
+			}
+	};
+	const auto WriteTPDDefault = [&](const MDBDescriptors::SCompoundTPDPropertyDescriptor& _descr)
+	{
+		Write(static_cast<uint32_t>(E2I(_descr.defuaultType)));
+		WriteVector(_descr.defaultParameters);
+	};
+
+	// user-defined properties
+	WriteDescriptors(activeConstProperties, MDBDescriptors::defaultConstProperties, [&](const MDBDescriptors::SCompoundConstPropertyDescriptor& _descr) { Write(_descr.defaultValue); });
+	WriteDescriptors(activeTPDepProperties, MDBDescriptors::defaultTPDProperties, WriteTPDDefault);
+	WriteDescriptors(activeInterProperties, MDBDescriptors::defaultInteractionProperties, WriteTPDDefault);
+
+	// compounds
+	Write(static_cast<uint32_t>(m_vCompounds.size()));
+	for (const auto& compound : m_vCompounds)
+	{
+		WriteString(compound.GetKey());
+		WriteString(compound.GetName());
+		WriteString(compound.GetDescription());
+		Write(static_cast<uint32_t>(compound.GetConstProperties().size()));
+		for (const auto& prop : compound.GetConstProperties())
+		{
+			Write(static_cast<uint32_t>(prop.GetType()));
+			Write(prop.GetValue());
+			WriteString(prop.GetDescription());
+		}
+		Write(static_cast<uint32_t>(compound.GetTPProperties().size()));
+		for (const auto& prop : compound.GetTPProperties())
+			WriteTPDProperty(prop);
+	}
+
+	// interactions, only those that differ from the defaults, as in the text format
+	std::vector<const CInteraction*> interactions;
+	for (const auto& interaction : m_vInteractions)
+		for (const auto& prop : interaction.GetProperties())
+			if (!prop.IsDefaultValue() || !prop.GetDescription().empty())
+			{
+				interactions.push_back(&interaction);
+				break;
+			}
+	Write(static_cast<uint32_t>(interactions.size()));
+	for (const auto* interaction : interactions)
+	{
+		WriteString(interaction->GetKey1());
+		WriteString(interaction->GetKey2());
+		Write(static_cast<uint32_t>(interaction->PropertiesNumber()));
+		for (const auto& prop : interaction->GetProperties())
+			WriteTPDProperty(prop);
+	}
+
+	std::ofstream outFile(UnicodePath(_fileName), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (outFile.fail()) return false;
+
+	// header: signature, version, size of payload and its checksum
+	const uint32_t version = MDBDescriptors::BINARY_VERSION;
+	const uint64_t size = payload.size();
+	const uint64_t checksum = Checksum(payload.data(), payload.size());
+	outFile.write(MDBDescriptors::BINARY_SIGNATURE_STRING.data(), MDBDescriptors::BINARY_SIGNATURE_STRING.size());
+	outFile.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	outFile.write(reinterpret_cast<const char*>(&size), sizeof(size));
+	outFile.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+	outFile.write(payload.data(), payload.size());
+	return outFile.good();
+}
+
+bool CMaterialsDatabase::LoadFromBinaryFile(const std::wstring& _fileName)
+{
+	CreateNewDatabase();
+
+	CMemoryMappedFile file;
+	if (!file.Open(UnicodePath(_fileName))) return false;
+
+	const char* pos = file.Data();
+	const char* end = file.Data() + file.Size();
+	bool ok = true;
+	// Reads a trivially copyable value and advances the cursor. Sets the error flag if the data is exhausted.
+	const auto Read = [&](auto& _value)
+	{
+		if (static_cast<size_t>(end - pos) < sizeof(_value))
+		{
+			ok = false;
+			_value = {};
+			return;
+		}
+		std::memcpy(&_value, pos, sizeof(_value));
+		pos += sizeof(_value);
+	};
+	const auto ReadUInt = [&]()
+	{
+		uint32_t value;
+		Read(value);
+		return value;
+	};
+	const auto ReadDouble = [&]()
+	{
+		double value;
+		Read(value);
+		return value;
+	};
+	const auto ReadString = [&]()
+	{
+		const uint32_t length = ReadUInt();
+		if (static_cast<size_t>(end - pos) < length)
+		{
+			ok = false;
+			return std::string{};
+		}
+		std::string res(pos, length);
+		pos += length;
+		return res;
+	};
+	const auto ReadVector = [&]()
+	{
+		const uint32_t length = ReadUInt();
+		if (static_cast<size_t>(end - pos) / sizeof(double) < length)
+		{
+			ok = false;
+			return std::vector<double>{};
+		}
+		std::vector<double> res(length);
+		std::memcpy(res.data(), pos, length * sizeof(double));
+		pos += length * sizeof(double);
+		return res;
+	};
+	// Reads a TP-dependent property with all its correlations and applies it to the property returned by the getter.
+	const auto ReadTPDProperty = [&](const auto& _getProperty)
+	{
+		CTPDProperty* prop = _getProperty(ReadUInt());
+		const std::string description = ReadString();
+		if (prop)
+		{
+			prop->RemoveAllCorrelations();
+			prop->SetDescription(description);
+		}
+		const uint32_t number = ReadUInt();
+		for (uint32_t i = 0; i < number && ok; ++i)
+		{
+			const auto type = static_cast<ECorrelationTypes>(ReadUInt());
+			const SInterval T{ ReadDouble(), ReadDouble() };
+			const SInterval P{ ReadDouble(), ReadDouble() };
+			const std::vector<double> params = ReadVector();
+			const std::string corrDescription = ReadString();
+			if (!prop || !ok) continue;
+			CCorrelation correlation{ type, params, T, P };
+			correlation.SetDescription(corrDescription);
+			prop->AddCorrelation(correlation);
+		}
+	};
+	// Reads descriptors of user-defined properties of one type into the active descriptors.
+	const auto ReadDescriptors = [&](auto& _active, const auto& _readValue)
+	{
+		using key_type = typename std::remove_reference_t<decltype(_active)>::key_type;
+		const uint32_t number = ReadUInt();
+		for (uint32_t i = 0; i < number && ok; ++i)
+		{
+			auto& descr = _active[static_cast<key_type>(ReadUInt())];
+			descr.name = ReadString();
+			descr.units = String2WString(ReadString());
+			descr.description = ReadString();
+			_readValue(descr);
+		}
+	};
+	const auto ReadTPDDefault = [&](MDBDescriptors::SCompoundTPDPropertyDescriptor& _descr)
+	{
+		_descr.defuaultType = static_cast<ECorrelationTypes>(ReadUInt());
+		_descr.defaultParameters = ReadVector();
+	};
+
+	// check header and integrity of the data
+	if (file.Size() < MDBDescriptors::BINARY_SIGNATURE_STRING.size() || std::string(pos, MDBDescriptors::BINARY_SIGNATURE_STRING.size()) != MDBDescriptors::BINARY_SIGNATURE_STRING) return false;
+	pos += MDBDescriptors::BINARY_SIGNATURE_STRING.size();
+	const uint32_t version = ReadUInt();
+	uint64_t size, checksum;
+	Read(size);
+	Read(checksum);
+	if (!ok || version != MDBDescriptors::BINARY_VERSION || static_cast<uint64_t>(end - pos) != size || Checksum(pos, static_cast<size_t>(size)) != checksum) return false;
+
+	// user-defined properties
+	ReadDescriptors(activeConstProperties, [&](MDBDescriptors::SCompoundConstPropertyDescriptor& _descr) { _descr.defaultValue = ReadDouble(); });
+	ReadDescriptors(activeTPDepProperties, ReadTPDDefault);
+	ReadDescriptors(activeInterProperties, ReadTPDDefault);
+
+	// compounds
+	const uint32_t compoundsNumber = ReadUInt();
+	for (uint32_t iCompound = 0; iCompound < compoundsNumber && ok; ++iCompound)
+	{
+		CCompound* compound = AddCompound(ReadString());
+		compound->SetName(ReadString());
+		compound->SetDescription(ReadString());
+		const uint32_t constNumber = ReadUInt();
+		for (uint32_t i = 0; i < constNumber && ok; ++i)
+		{
+			CConstProperty* prop = compound->GetConstProperty(static_cast<ECompoundConstProperties>(ReadUInt()));
+			const double value = ReadDouble();
+			const std::string description = ReadString();
+			if (!prop) continue;
+			prop->SetValue(value);
+			prop->SetDescription(description);
+		}
+		const uint32_t tpdNumber = ReadUInt();
+		for (uint32_t i = 0; i < tpdNumber && ok; ++i)
+			ReadTPDProperty([&](unsigned _key) { return compound->GetTPProperty(static_cast<ECompoundTPProperties>(_key)); });
+	}
+
+	// interactions
+	const uint32_t interactionsNumber = ReadUInt();
+	for (uint32_t iInteraction = 0; iInteraction < interactionsNumber && ok; ++iInteraction)
+	{
+		const std::string key1 = ReadString();
+		const std::string key2 = ReadString();
+		CInteraction* interaction = AddInteraction(key1, key2);
+		const uint32_t propsNumber = ReadUInt();
+		for (uint32_t i = 0; i < propsNumber && ok; ++i)
+			ReadTPDProperty([&](unsigned _key) { return interaction->GetProperty(static_cast<EInteractionProperties>(_key)); });
+	}
+
+	if (!ok || pos != end)
+	{
+		CreateNewDatabase();
+		return false;
+	}
+	m_sFileName = _fileName;
+	return true;
+}
+
+bool CMaterialsDatabase::ConvertToBinaryFile(const std::wstring& _srcFileName, const std::wstring& _dstFileName)
+{
+	CMaterialsDatabase database;
+	return database.LoadFromFile(_srcFileName) && database.SaveToBinaryFile(_dstFileName);
+}
+
+bool CMaterialsDatabase::IsBinaryFile(const std::wstring& _fileName)
+{
+	std::ifstream inFile(UnicodePath(_fileName), std::ios::in | std::ios::binary);
+	if (inFile.fail()) return false;
+	std::string signature(MDBDescriptors::BINARY_SIGNATURE_STRING.size(), '\0');
+	inFile.read(&signature[0], signature.size());
+	return inFile.good() && signature == MDBDescriptors::BINARY_SIGNATURE_STRING;
+}
+
 size_t CMaterialsDatabase::CompoundsNumber() const
 {
 	return m_vCompounds.size();
@@ -577,6 +894,7 @@ CCompound* CMaterialsDatabase::AddCompound(const CCompound& _compound)
 	const std::string sKey = GenerateUniqueString(_compound.GetKey(), GetCompoundsKeys());
 	// add new compound
 	m_vCompounds.emplace_back(_compound);
+	UpdateVersion();
 	// set key
 	m_vCompounds.back().SetKey(sKey);
 	// add corresponding interactions
@@ -590,6 +908,7 @@ void CMaterialsDatabase::RemoveCompound(size_t _iCompound)
 	if (_iCompound >= m_vCompounds.size()) return;
 	ConformInteractionsRemove(m_vCompounds[_iCompound].GetKey());
 	m_vCompounds.erase(m_vCompounds.begin() + _iCompound);
+	UpdateVersion();
 }
 
 void CMaterialsDatabase::RemoveCompound(const std::string& _sCompoundUniqueKey)
@@ -600,7 +919,10 @@ void CMaterialsDatabase::RemoveCompound(const std::string& _sCompoundUniqueKey)
 void CMaterialsDatabase::ShiftCompoundUp(size_t _iCompound)
 {
 	if (_iCompound < m_vCompounds.size() && _iCompound != 0)
+	{
 		std::iter_swap(m_vCompounds.begin() + _iCompound, m_vCompounds.begin() + _iCompound - 1);
+		UpdateVersion();
+	}
 }
 
 void CMaterialsDatabase::ShiftCompoundUp(const std::string& _sCompoundUniqueKey)
@@ -611,7 +933,10 @@ void CMaterialsDatabase::ShiftCompoundUp(const std::string& _sCompoundUniqueKey)
 void CMaterialsDatabase::ShiftCompoundDown(size_t _iCompound)
 {
 	if ((_iCompound < m_vCompounds.size()) && (_iCompound != (m_vCompounds.size() - 1)))
+	{
 		std::iter_swap(m_vCompounds.begin() + _iCompound, m_vCompounds.begin() + _iCompound + 1);
+		UpdateVersion();
+	}
 }
 
 void CMaterialsDatabase::ShiftCompoundDown(const std::string& _sCompoundUniqueKey)
@@ -679,6 +1004,13 @@ double CMaterialsDatabase::GetTPPropertyValue(const std::string& _sCompoundUniqu
 	return 0;
 }
 
+std::vector<double> CMaterialsDatabase::GetTPPropertyValues(const std::string& _sCompoundUniqueKey, ECompoundTPProperties _nTPPropType, const std::vector<double>& _vT, const std::vector<double>& _vP) const
+{
+	if (const CCompound *comp = GetCompound(_sCompoundUniqueKey))
+		return comp->GetTPPropertyValues(_nTPPropType, _vT, _vP);
+	return std::vector<double>(_vT.size(), 0);
+}
+
 double CMaterialsDatabase::GetInteractionPropertyValue(const std::string& _sCompoundUniqueKey1, const std::string& _sCompoundUniqueKey2, EInteractionProperties _nInterPropType, double _dT, double _dP) const
 {
 	if (const CInteraction* inter = GetInteraction(_sCompoundUniqueKey1, _sCompoundUniqueKey2))
@@ -762,6 +1094,7 @@ CInteraction* CMaterialsDatabase::AddInteraction(const std::string& _sCompoundKe
 
 	// create new interaction
 	m_vInteractions.emplace_back(activeInterProperties, _sCompoundKey1, _sCompoundKey2);
+	UpdateVersion();
 	return &m_vInteractions.back();
 }
 
@@ -773,7 +1106,10 @@ void CMaterialsDatabase::RemoveInteraction(const std::string& _sCompoundKey1, co
 void CMaterialsDatabase::RemoveInteraction(size_t _iInteraction)
 {
 	if (_iInteraction < m_vInteractions.size())
+	{
 		m_vInteractions.erase(m_vInteractions.begin() + _iInteraction);
+		UpdateVersion();
+	}
 }
 
 void CMaterialsDatabase::ConformInteractionsAdd(const std::string& _sCompoundKey)
@@ -798,3 +1134,14 @@ std::string CMaterialsDatabase::Comment(const std::string& _s)
 {
 	return " \t" + StrConst::COMMENT_SYMBOL + " " + _s;
 }
+
+uint64_t CMaterialsDatabase::Checksum(const char* _data, size_t _size)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < _size; ++i)
+	{
+		hash ^= static_cast<unsigned char>(_data[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
@@ -4,6 +4,7 @@
 
 #include "Compound.h"
 #include "Interaction.h"
+#include <atomic>
 
 // Description of parameters of all compounds.
 class CMaterialsDatabase
@@ -47,6 +48,9 @@ class CMaterialsDatabase
 	std::vector<CCompound> m_vCompounds;				// List of defined compounds.
 	std::vector<CInteraction> m_vInteractions;	// List of defined interactions between each pair of defined compounds.
 
+	static std::atomic<size_t> m_versionsCounter;	// Global counter of structural changes in all databases.
+	size_t m_nVersion;								// Number of the last structural change of this database.
+
 public:
 	CMaterialsDatabase();
 
@@ -68,6 +72,10 @@ public:
 	// Determines, whether a property with the specified key is present in materials database.
 	bool IsPropertyDefined(unsigned _key) const;
 
+	// Returns the version of the database structure. It changes each time when compounds, properties or interactions are added, removed or moved, and thus pointers to them may become invalid.
+	// Versions are drawn from a global counter and never repeat. A copy takes over the version of its source, so assigning another database also changes it.
+	size_t GetVersion() const;
+
 	//////////////////////////////////////////////////////////////////////////
 	/// Functions to work with file
 
@@ -79,8 +87,16 @@ public:
 
 	// Saves database to a text file with specified name. If the name is not specified, data will be written to the default file. Returns true on success.
 	bool SaveToFile(const std::wstring& _fileName = L"");
-	// Loads database from a text file with specified name. If the name is not specified, data will be loaded from the default file. Returns true on success.
+	// Loads database from a text or a binary file with specified name. The format is detected automatically. If the name is not specified, data will be loaded from the default file. Returns true on success.
 	bool LoadFromFile(const std::wstring& _fileName = L"");
+	// Saves database to a compact binary file with specified name. The name of the current database file is not changed. Returns true on success.
+	bool SaveToBinaryFile(const std::wstring& _fileName) const;
+	// Loads database from a binary file with specified name by mapping it into memory. Fails if the file is damaged. Returns true on success.
+	bool LoadFromBinaryFile(const std::wstring& _fileName);
+	// Converts a database file of any supported format into the binary format. Returns true on success.
+	static bool ConvertToBinaryFile(const std::wstring& _srcFileName, const std::wstring& _dstFileName);
+	// Returns true if the specified file contains a database in the binary format.
+	static bool IsBinaryFile(const std::wstring& _fileName);
 	// Loads database from the file. Loads file with old syntax for versions before v0.7. Returns true on success.
 	bool LoadFromFileV0(std::ifstream& _file);
 	// Loads database from the file. Loads file with old syntax for versions before v0.9.1. Returns true on success.
@@ -136,6 +152,8 @@ public:
 	double GetConstPropertyValue(const std::string& _sCompoundUniqueKey, ECompoundConstProperties _nConstPropType) const;
 	// Returns value of a temperature/pressure-dependent property by specified temperature [K] and pressure [Pa] for specified compound. Returns 0 if such property doesn't exist.
 	double GetTPPropertyValue(const std::string& _sCompoundUniqueKey, ECompoundTPProperties _nTPPropType, double _dT, double _dP) const;
+	// Returns values of a temperature/pressure-dependent property for each pair of specified temperatures [K] and pressures [Pa] for specified compound. Returns zeros if such property or compound don't exist.
+	std::vector<double> GetTPPropertyValues(const std::string& _sCompoundUniqueKey, ECompoundTPProperties _nTPPropType, const std::vector<double>& _vT, const std::vector<double>& _vP) const;
 	// Returns value of an interaction property by specified temperature [K] and pressure [Pa] between specified compounds. Returns 0 if such property doesn't exist.
 	double GetInteractionPropertyValue(const std::string& _sCompoundUniqueKey1, const std::string& _sCompoundUniqueKey2, EInteractionProperties _nInterPropType, double _dT, double _dP) const;
 
@@ -171,6 +189,9 @@ public:
 
 
 private:
+	// Sets new unique version of the database structure. Must be called after each change, which can invalidate pointers to compounds, properties or interactions.
+	void UpdateVersion();
+
 	//////////////////////////////////////////////////////////////////////////
 	/// Functions to work with compounds
 
@@ -196,5 +217,11 @@ private:
 
 	// Returns a string formatted as a comment.
 	static std::string Comment(const std::string& _s);
+
+	//////////////////////////////////////////////////////////////////////////
+	/// Auxiliary function to work with binary files
+
+	// Calculates a 64-bit FNV-1a checksum of the data.
+	static uint64_t Checksum(const char* _data, size_t _size);
 };
 
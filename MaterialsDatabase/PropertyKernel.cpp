@@ -0,0 +1,85 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#include "PropertyKernel.h"
+
+template<>
+double CPropertyKernel::Evaluate<ECorrelationTypes::LIST_OF_T_VALUES>(const CPropertyKernel& _kernel, double _dT, double /*_dP*/)
+{
+	return CDependentValues::Interpolate(_kernel.m_listParams, _kernel.m_listValues, _dT);
+}
+
+template<>
+double CPropertyKernel::Evaluate<ECorrelationTypes::LIST_OF_P_VALUES>(const CPropertyKernel& _kernel, double /*_dT*/, double _dP)
+{
+	return CDependentValues::Interpolate(_kernel.m_listParams, _kernel.m_listValues, _dP);
+}
+
+template<ECorrelationTypes TYPE>
+double CPropertyKernel::Evaluate(const CPropertyKernel& _kernel, double _dT, double _dP)
+{
+	return CCorrelation::Evaluate<TYPE>(_kernel.m_params.data(), _dT, _dP);
+}
+
+bool CPropertyKernel::Build(const CTPDProperty& _property)
+{
+	Clear();
+
+	// with a single correlation, CTPDProperty::GetValue() always evaluates it, whatever T and P are
+	if (_property.CorrelationsNumber() != 1) return false;
+	const CCorrelation& correlation = *_property.GetCorrelation(0);
+
+	kernel_t kernel;
+	switch (correlation.GetType())
+	{
+	case ECorrelationTypes::LIST_OF_T_VALUES:	kernel = &Evaluate<ECorrelationTypes::LIST_OF_T_VALUES>;	break;
+	case ECorrelationTypes::LIST_OF_P_VALUES:	kernel = &Evaluate<ECorrelationTypes::LIST_OF_P_VALUES>;	break;
+	case ECorrelationTypes::CONSTANT:		kernel = &Evaluate<ECorrelationTypes::CONSTANT>;		break;
+	case ECorrelationTypes::LINEAR:			kernel = &Evaluate<ECorrelationTypes::LINEAR>;			break;
+	case ECorrelationTypes::EXPONENT_1:		kernel = &Evaluate<ECorrelationTypes::EXPONENT_1>;		break;
+	case ECorrelationTypes::POW_1:			kernel = &Evaluate<ECorrelationTypes::POW_1>;			break;
+	case ECorrelationTypes::POLYNOMIAL_1:	kernel = &Evaluate<ECorrelationTypes::POLYNOMIAL_1>;	break;
+	case ECorrelationTypes::POLYNOMIAL_CP:	kernel = &Evaluate<ECorrelationTypes::POLYNOMIAL_CP>;	break;
+	case ECorrelationTypes::POLYNOMIAL_H:	kernel = &Evaluate<ECorrelationTypes::POLYNOMIAL_H>;	break;
+	case ECorrelationTypes::POLYNOMIAL_S:	kernel = &Evaluate<ECorrelationTypes::POLYNOMIAL_S>;	break;
+	default: return false;
+	}
+
+	const std::vector<double> params = correlation.GetParameters();
+	if (correlation.GetType() == ECorrelationTypes::LIST_OF_T_VALUES || correlation.GetType() == ECorrelationTypes::LIST_OF_P_VALUES)
+	{
+		// parameters are sorted pairs [parameter:value]
+		for (size_t i = 0; i + 1 < params.size(); i += 2)
+		{
+			m_listParams.push_back(params[i]);
+			m_listValues.push_back(params[i + 1]);
+		}
+	}
+	else
+	{
+		if (params.size() < MDBDescriptors::correlations[correlation.GetType()].parametersNumber || params.size() > m_cnMaxParameters) return false;
+		std::copy(params.begin(), params.end(), m_params.begin());
+	}
+
+	m_pKernel = kernel;
+	m_TInterval = correlation.GetTInterval();
+	m_PInterval = correlation.GetPInterval();
+	m_pProperty = &_property;
+	m_pCorrelation = &correlation;
+	m_nPropertyRevision = _property.GetRevision();
+	m_nCorrelationRevision = correlation.GetRevision();
+	return true;
+}
+
+void CPropertyKernel::Clear()
+{
+	m_pKernel = nullptr;
+	m_params.fill(0);
+	m_listParams.clear();
+	m_listValues.clear();
+	m_TInterval = {};
+	m_PInterval = {};
+	m_pProperty = nullptr;
+	m_pCorrelation = nullptr;
+	m_nPropertyRevision = 0;
+	m_nCorrelationRevision = 0;
+}
@@ -0,0 +1,55 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#pragma once
+
+#include "TPDProperty.h"
+#include "DependentValues.h"
+#include <array>
+
+// Compact evaluator of a temperature/pressure-dependent property, specialized for the type of its correlation.
+// Can be built for properties defined by a single correlation, which is the case for most compounds. The evaluator keeps a copy of the correlation's
+// parameters and boundaries and calls a function generated for this correlation type, so no search of correlations and no type switch is needed.
+// The evaluator remembers revisions of the property and its correlation at Build(). If any of them is modified afterwards, the evaluator becomes outdated
+// and must not be used until the next Build(), see IsActual().
+class CPropertyKernel
+{
+	static const size_t m_cnMaxParameters = 9;	// Maximum number of parameters among all analytical correlations.
+
+	using kernel_t = double(*)(const CPropertyKernel& _kernel, double _dT, double _dP);
+
+	kernel_t m_pKernel{ nullptr };						// Function to evaluate the correlation of a specific type.
+	std::array<double, m_cnMaxParameters> m_params{};	// Parameters of the analytical correlation.
+	std::vector<double> m_listParams;					// Sorted params of the list of values for LIST_OF_T_VALUES and LIST_OF_P_VALUES.
+	std::vector<double> m_listValues;					// Values of the list of values for LIST_OF_T_VALUES and LIST_OF_P_VALUES.
+	SInterval m_TInterval{};							// Temperature interval of the correlation.
+	SInterval m_PInterval{};							// Pressure interval of the correlation.
+	const CTPDProperty* m_pProperty{ nullptr };			// Property, for which the evaluator has been built.
+	const CCorrelation* m_pCorrelation{ nullptr };		// Correlation of the property, for which the evaluator has been built.
+	size_t m_nPropertyRevision{ 0 };					// Revision of the property at the moment of building.
+	size_t m_nCorrelationRevision{ 0 };					// Revision of the correlation at the moment of building.
+
+public:
+	// Builds the evaluator for the property. Returns false if the property can not be specialized.
+	bool Build(const CTPDProperty& _property);
+	// Removes the evaluator.
+	void Clear();
+
+	// Returns true if the evaluator has been built.
+	bool IsValid() const { return m_pKernel != nullptr; }
+	// Returns true if neither the property nor its correlation have been modified since Build(). Must be called only if IsValid() and the property still exists.
+	// The property is checked first, so the correlation is not accessed if it might have been removed.
+	bool IsActual() const { return m_pProperty->GetRevision() == m_nPropertyRevision && m_pCorrelation->GetRevision() == m_nCorrelationRevision; }
+
+	// Returns value of the property at the specified temperature [K] and pressure [Pa]. The same as CTPDProperty::GetValue(). Must be called only if IsValid() and IsActual().
+	double GetValue(double _dT, double _dP) const
+	{
+		if (!(_dT >= m_TInterval.min && _dT <= m_TInterval.max)) _dT = _dT < m_TInterval.min ? m_TInterval.min : m_TInterval.max;
+		if (!(_dP >= m_PInterval.min && _dP <= m_PInterval.max)) _dP = _dP < m_PInterval.min ? m_PInterval.min : m_PInterval.max;
+		return m_pKernel(*this, _dT, _dP);
+	}
+
+private:
+	// Evaluates the correlation of the specified type, using CCorrelation::Evaluate() for analytical correlations.
+	template<ECorrelationTypes TYPE>
+	static double Evaluate(const CPropertyKernel& _kernel, double _dT, double _dP);
+};
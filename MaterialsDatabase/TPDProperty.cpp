@@ -3,12 +3,16 @@
 #include "TPDProperty.h"
 #include <algorithm>
 #include <cmath>
+#include <functional>
+
+std::atomic<size_t> CTPDProperty::m_revisionsCounter{ 0 };
 
 CTPDProperty::CTPDProperty(unsigned _nProperty, const std::string& _sName, const std::wstring& _sUnits, const CCorrelation& _defaultValue)
 	: CBaseProperty(_nProperty, _sName, _sUnits),
 	m_defaultValue{ _defaultValue },
 	m_vCorrelations{ _defaultValue }
 {
+	UpdateRevision();
 }
 
 double CTPDProperty::GetValue(double _dT, double _dP) const
@@ -30,6 +34,44 @@ double CTPDProperty::GetValue(double _dT, double _dP) const
 	//		return m_vCorrelations[i].GetValue(_dT, _dP);
 
 	// find the nearest correlation, taking only T into account
+	return m_vCorrelations[GetNearestCorrelation(_dT)].GetValue(_dT, _dP);
+}
+
+std::vector<double> CTPDProperty::GetValues(const std::vector<double>& _vT, const std::vector<double>& _vP) const
+{
+	if (_vT.size() != _vP.size()) return {};
+	if (m_vCorrelations.empty()) return std::vector<double>(_vT.size(), 0);
+
+	const std::vector<size_t> vIndices = GetCorrelationsIndices(_vT, _vP);
+
+	// all points are covered by the same correlation
+	if (std::adjacent_find(vIndices.begin(), vIndices.end(), std::not_equal_to<>()) == vIndices.end())
+		return m_vCorrelations[vIndices.empty() ? 0 : vIndices.front()].GetValues(_vT, _vP);
+
+	// gather points of each correlation, evaluate them at once and scatter back
+	std::vector<double> vRes(_vT.size());
+	std::vector<double> vT, vP;
+	for (size_t iCorr = 0; iCorr < m_vCorrelations.size(); ++iCorr)
+	{
+		vT.clear();
+		vP.clear();
+		for (size_t i = 0; i < vIndices.size(); ++i)
+			if (vIndices[i] == iCorr)
+			{
+				vT.push_back(_vT[i]);
+				vP.push_back(_vP[i]);
+			}
+		if (vT.empty()) continue;
+		const std::vector<double> vValues = m_vCorrelations[iCorr].GetValues(vT, vP);
+		for (size_t i = 0, j = 0; i < vIndices.size(); ++i)
+			if (vIndices[i] == iCorr)
+				vRes[i] = vValues[j++];
+	}
+	return vRes;
+}
+
+size_t CTPDProperty::GetNearestCorrelation(double _dT) const
+{
 	double deltaTMin = MDBDescriptors::TEMP_MAX;
 	size_t iNearest = 0;
 	for (size_t i = 0; i < m_vCorrelations.size(); ++i)
@@ -48,7 +90,84 @@ double CTPDProperty::GetValue(double _dT, double _dP) const
 			iNearest = i;
 		}
 	}
-	return m_vCorrelations[iNearest].GetValue(_dT, _dP);
+	return iNearest;
+}
+
+std::vector<size_t> CTPDProperty::GetCorrelationsIndices(const std::vector<double>& _vT, const std::vector<double>& _vP) const
+{
+	const std::shared_ptr<const STIntervalsIndex> pIndex = GetTIntervalsIndex();
+	const std::vector<double>& vBounds = pIndex->vBounds;
+	const std::vector<std::vector<size_t>>& vCells = pIndex->vCells;
+
+	std::vector<size_t> vRes(_vT.size());
+	for (size_t i = 0; i < _vT.size(); ++i)
+	{
+		const size_t k = std::upper_bound(vBounds.begin(), vBounds.end(), _vT[i]) - vBounds.begin();
+		const std::vector<size_t>& vCandidates = vCells[k > 0 && vBounds[k - 1] == _vT[i] ? 2 * k - 1 : 2 * k];
+		if (vCandidates.empty())
+		{
+			vRes[i] = GetNearestCorrelation(_vT[i]);
+			continue;
+		}
+		// the first correlation with T and P within, otherwise the first one with T within
+		vRes[i] = vCandidates.front();
+		for (size_t iCorr : vCandidates)
+			if (m_vCorrelations[iCorr].IsPInInterval(_vP[i]))
+			{
+				vRes[i] = iCorr;
+				break;
+			}
+	}
+	return vRes;
+}
+
+std::shared_ptr<const CTPDProperty::STIntervalsIndex> CTPDProperty::GetTIntervalsIndex() const
+{
+	// the index is never modified after building, so it can be used by several threads, while another one replaces it
+	std::shared_ptr<const STIntervalsIndex> pIndex = std::atomic_load(&m_pTIndex);
+	const auto IsActual = [&]
+	{
+		if (pIndex->nRevision != m_nRevision || pIndex->vCorrelationsRevisions.size() != m_vCorrelations.size()) return false;
+		for (size_t i = 0; i < m_vCorrelations.size(); ++i)
+			if (pIndex->vCorrelationsRevisions[i] != m_vCorrelations[i].GetRevision())
+				return false;
+		return true;
+	};
+	if (pIndex && IsActual())
+		return pIndex;
+
+	auto pNewIndex = std::make_shared<STIntervalsIndex>();
+	pNewIndex->nRevision = m_nRevision;
+	for (const auto& corr : m_vCorrelations)
+		pNewIndex->vCorrelationsRevisions.push_back(corr.GetRevision());
+
+	// boundaries of all T-intervals split T-axis into cells: the boundaries themselves and open intervals between them
+	std::vector<double>& vBounds = pNewIndex->vBounds;
+	for (const auto& corr : m_vCorrelations)
+	{
+		vBounds.push_back(corr.GetTInterval().min);
+		vBounds.push_back(corr.GetTInterval().max);
+	}
+	std::sort(vBounds.begin(), vBounds.end());
+	vBounds.erase(std::unique(vBounds.begin(), vBounds.end()), vBounds.end());
+
+	// each cell is either fully covered by the T-interval of a correlation or not at all, so check one point of the cell.
+	// cells are numbered as: 2*k+1 - k-th boundary, 2*k+2 - interval after it, 0 and the last one - unbounded intervals, not covered by any correlation.
+	const size_t nBounds = vBounds.size();
+	std::vector<std::vector<size_t>>& vCells = pNewIndex->vCells;
+	vCells.resize(2 * nBounds + 1);
+	for (size_t k = 0; k < nBounds; ++k)
+		for (size_t iCorr = 0; iCorr < m_vCorrelations.size(); ++iCorr)
+		{
+			if (m_vCorrelations[iCorr].IsTInInterval(vBounds[k]))
+				vCells[2 * k + 1].push_back(iCorr);
+			if (k + 1 < nBounds && m_vCorrelations[iCorr].IsTInInterval(vBounds[k] + (vBounds[k + 1] - vBounds[k]) / 2))
+				vCells[2 * k + 2].push_back(iCorr);
+		}
+
+	pIndex = std::move(pNewIndex);
+	std::atomic_store(&m_pTIndex, pIndex);
+	return pIndex;
 }
 
 SInterval CTPDProperty::GetTInterval() const
@@ -81,6 +200,11 @@ SInterval CTPDProperty::GetPInterval() const
 	return overall;
 }
 
+size_t CTPDProperty::GetRevision() const
+{
+	return m_nRevision;
+}
+
 size_t CTPDProperty::CorrelationsNumber() const
 {
 	return m_vCorrelations.size();
@@ -106,24 +230,28 @@ void CTPDProperty::AddCorrelation(ECorrelationTypes _nType, const std::vector<do
 void CTPDProperty::AddCorrelation(const CCorrelation& _correlation)
 {
 	m_vCorrelations.push_back(_correlation);
+	UpdateRevision();
 }
 
 void CTPDProperty::SetCorrelation(size_t _index, ECorrelationTypes _nType, const std::vector<double>& _vParams, const SInterval& _TInterval /*= { TEMP_MIN , TEMP_MAX }*/, const SInterval& _PInterval /*= { PRES_MIN , PRES_MAX }*/)
 {
 	if (_index >= m_vCorrelations.size()) return;
 	m_vCorrelations[_index] = { _nType, _vParams, _TInterval, _PInterval };
+	UpdateRevision();
 }
 
 void CTPDProperty::RemoveCorrelation(size_t _index)
 {
 	if (_index >= m_vCorrelations.size()) return;
 	m_vCorrelations.erase(m_vCorrelations.begin() + _index);
+	UpdateRevision();
 }
 
 bool CTPDProperty::ShiftCorrelationUp(size_t _index)
 {
 	if (_index == 0 || _index >= m_vCorrelations.size()) return false;
 	std::iter_swap(m_vCorrelations.begin() + _index, m_vCorrelations.begin() + _index - 1);
+	UpdateRevision();
 	return true;
 
 }
@@ -132,15 +260,22 @@ bool CTPDProperty::ShiftCorrelationDown(size_t _index)
 {
 	if (_index == m_vCorrelations.size() - 1 || _index >= m_vCorrelations.size()) return false;
 	std::iter_swap(m_vCorrelations.begin() + _index, m_vCorrelations.begin() + _index + 1);
+	UpdateRevision();
 	return true;
 }
 
 void CTPDProperty::RemoveAllCorrelations()
 {
 	m_vCorrelations.clear();
+	UpdateRevision();
 }
 
 bool CTPDProperty::IsDefaultValue() const
 {
 	return m_vCorrelations.size() == 1 && m_vCorrelations.front() == m_defaultValue;
 }
+
+void CTPDProperty::UpdateRevision()
+{
+	m_nRevision = ++m_revisionsCounter;
+}
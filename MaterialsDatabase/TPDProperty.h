@@ -4,24 +4,45 @@
 
 #include "BaseProperty.h"
 #include "Correlation.h"
+#include <atomic>
+#include <memory>
 
 // Description of a temperature/pressure-dependent property of a pure compound.
 class CTPDProperty : public CBaseProperty
 {
 	CCorrelation m_defaultValue;				// Default value.
 	std::vector<CCorrelation> m_vCorrelations;	// List of correlations for different combinations of T and P.
+	size_t m_nRevision{ 0 };					// Revision of the list of correlations, changes with each addition, removal, replacement or reordering of correlations.
+
+	// Boundaries of T-intervals of all correlations, splitting T-axis into cells, and correlations covering each cell.
+	struct STIntervalsIndex
+	{
+		size_t nRevision{ 0 };						// Revision of the list of correlations, for which the index is built.
+		std::vector<size_t> vCorrelationsRevisions;	// Revisions of all correlations, for which the index is built.
+		std::vector<double> vBounds;				// Sorted unique boundaries of T-intervals.
+		std::vector<std::vector<size_t>> vCells;	// Indices of correlations covering each cell: 2*k+1 - k-th boundary, 2*k+2 - interval after it, 0 and the last one - unbounded intervals.
+	};
+	mutable std::shared_ptr<const STIntervalsIndex> m_pTIndex;	// Index of T-intervals, built on demand and replaced after the correlations are modified.
+
+	static std::atomic<size_t> m_revisionsCounter;	// Global counter of modifications of lists of correlations in all properties.
 
 public:
 	CTPDProperty(unsigned _nProperty, const std::string& _sName, const std::wstring& _sUnits, const CCorrelation& _defaultValue);
 
 	// Returns property value for specified T and P. If no correlation defined for specified T and P, a nearest-neighbor extrapolation from some correlation will be done.
 	double GetValue(double _dT, double _dP) const;
+	// Returns property values for each pair of specified T and P, choosing correlations as in GetValue(). Both vectors must have the same length, otherwise returns an empty vector.
+	std::vector<double> GetValues(const std::vector<double>& _vT, const std::vector<double>& _vP) const;
 
 	// Returns boundaries of the temperature interval, on which this property is defined. If no correlations defined, returns interval (-1;-1).
 	SInterval GetTInterval() const;
 	// Returns boundaries of the pressure interval, on which this property is defined. If no correlations defined, returns interval (-1;-1).
 	SInterval GetPInterval() const;
 
+	// Returns revision of the list of correlations. It is unique among all properties and changes with each addition, removal, replacement or reordering of correlations.
+	// Modifications of the correlations themselves are reflected by their own revisions.
+	size_t GetRevision() const;
+
 	// Returns number of defined correlations.
 	size_t CorrelationsNumber() const;
 
@@ -52,5 +73,15 @@ public:
 
 	// Checks if the default value is set.
 	bool IsDefaultValue() const override;
+
+private:
+	// Returns index of the correlation with the T-interval boundary nearest to the specified T.
+	size_t GetNearestCorrelation(double _dT) const;
+	// Returns indices of correlations, which GetValue() would use for each pair of specified T and P.
+	std::vector<size_t> GetCorrelationsIndices(const std::vector<double>& _vT, const std::vector<double>& _vP) const;
+	// Returns the index of T-intervals of the current correlations, building a new one if the list of correlations or any correlation has been modified. Can be called concurrently.
+	std::shared_ptr<const STIntervalsIndex> GetTIntervalsIndex() const;
+	// Sets a new unique revision of the list of correlations. Must be called by all functions that modify the list.
+	void UpdateRevision();
 };
 
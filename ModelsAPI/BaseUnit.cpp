@@ -4,37 +4,41 @@
 #include "MaterialStream.h"
 #include "DyssolUtilities.h"
 #include "DyssolStringConstants.h"
+#include "DAESolver.h"
+#include "NLSolver.h"
+#include <tuple>
 
 const unsigned CBaseUnit::m_cnSaveVersion	= 2;
 
 CBaseUnit::CBaseUnit(void):
-	m_nCompilerVer(COMPILER_VERSION),
-	m_sUnitName(StrConst::BUnit_UnspecValue),
-	m_sUniqueID(""),
-	m_sAuthorName(StrConst::BUnit_UnspecValue),
-	m_dUnitVersion(1),
+	m_nPermanentHoldups(-1),
+	m_nPermanentStreams(-1),
 	m_bIsDynamic(true),
+	m_dStoreT1(0),
+	m_dStoreT2(0),
+	m_bStateChanged(true),
 	m_bError(false),
 	m_bWarning(false),
 	m_bInfo(false),
 	m_sErrorDescription(StrConst::BUnit_NoErrors),
 	m_sWarningDescription(StrConst::BUnit_NoWarnings),
 	m_sInfoDescription(StrConst::BUnit_NoInfos),
+	m_sCachePath(L""),
+	m_bCacheEnabled(DEFAULT_CACHE_FLAG_HOLDUPS),
+	m_nCacheWindow(DEFAULT_CACHE_WINDOW),
+	m_dMinFraction(DEFAULT_MIN_FRACTION),
+	m_sUnitName(StrConst::BUnit_UnspecValue),
+	m_sUniqueID(""),
+	m_sAuthorName(StrConst::BUnit_UnspecValue),
+	m_dUnitVersion(1),
 	m_pvCompoundsKeys(NULL),
-	m_pvPhasesSOA(NULL),
 	m_pvPhasesNames(NULL),
+	m_pvPhasesSOA(NULL),
 	m_pDistributionsGrid(NULL),
 	m_pMaterialsDB(NULL),
-	m_dRTol(DEFAULT_R_TOL),
 	m_dATol(DEFAULT_A_TOL),
-	m_sCachePath(L""),
-	m_bCacheEnabled(DEFAULT_CACHE_FLAG_HOLDUPS),
-	m_nCacheWindow(DEFAULT_CACHE_WINDOW),
-	m_dMinFraction(DEFAULT_MIN_FRACTION),
-	m_dStoreT1(0),
-	m_dStoreT2(0),
-	m_nPermanentHoldups(-1),
-	m_nPermanentStreams(-1)
+	m_dRTol(DEFAULT_R_TOL),
+	m_nCompilerVer(COMPILER_VERSION)
 {}
 
 CBaseUnit::~CBaseUnit(void)
@@ -187,6 +191,7 @@ CHoldup* CBaseUnit::AddHoldup(const std::string& _sHoldupName, const std::string
 	pStoreHoldup->SetStreamName(_sHoldupName + StrConst::BUnit_StoreStreamSuffix);
 	SetupStream(pStoreHoldup);
 	m_vStoreHoldupsWork.push_back(pStoreHoldup);
+	m_vStoreHoldupsVersions.emplace_back();
 
 	return pWorkHoldup;
 }
@@ -222,6 +227,7 @@ CMaterialStream* CBaseUnit::AddFeed(const std::string& _sFeedName, const std::st
 	pStoreFeed->SetStreamName(_sFeedName + StrConst::BUnit_StoreStreamSuffix);
 	SetupStream(pStoreFeed);
 	m_vStoreHoldupsWork.push_back(reinterpret_cast<CHoldup*>(pStoreFeed));
+	m_vStoreHoldupsVersions.emplace_back();
 
 	return pWorkFeed;
 }
@@ -252,6 +258,7 @@ void CBaseUnit::RemoveHoldup(const std::string &_sName)
 			m_vHoldupsInit.erase( m_vHoldupsInit.begin() + i );
 			m_vHoldupsWork.erase( m_vHoldupsWork.begin() + i );
 			m_vStoreHoldupsWork.erase( m_vStoreHoldupsWork.begin() + i );
+			m_vStoreHoldupsVersions.erase( m_vStoreHoldupsVersions.begin() + i );
 		}
 	}
 }
@@ -295,6 +302,7 @@ CMaterialStream* CBaseUnit::AddMaterialStream(const std::string& _sStreamName, c
 	pStoreStream->SetStreamName(_sStreamName + StrConst::BUnit_StoreStreamSuffix);
 	SetupStream(pStoreStream);
 	m_vStoreStreams.push_back(pStoreStream);
+	m_vStoreStreamsVersions.emplace_back();
 
 	return pStream;
 }
@@ -323,6 +331,7 @@ void CBaseUnit::RemoveMaterialStream(const std::string &_sStreamName)
 			delete m_vStoreStreams[i];
 			m_vStreams.erase( m_vStreams.begin() + i );
 			m_vStoreStreams.erase( m_vStoreStreams.begin() + i );
+			m_vStoreStreamsVersions.erase( m_vStoreStreamsVersions.begin() + i );
 		}
 	}
 }
@@ -354,6 +363,7 @@ void CBaseUnit::ClearHoldups()
 	m_vHoldupsInit.clear();
 	m_vHoldupsWork.clear();
 	m_vStoreHoldupsWork.clear();
+	m_vStoreHoldupsVersions.clear();
 }
 
 void CBaseUnit::ClearMaterialStreams()
@@ -365,6 +375,7 @@ void CBaseUnit::ClearMaterialStreams()
 	}
 	m_vStreams.clear();
 	m_vStoreStreams.clear();
+	m_vStoreStreamsVersions.clear();
 }
 
 void CBaseUnit::SetupStream( CStream* _pStream )
@@ -589,6 +600,14 @@ void CBaseUnit::ReduceTimePoints(double _dStart, double _dEnd, double _dStep)
 	for (auto& s : m_vStoreStreams)		s->ReduceTimePoints(_dStart, _dEnd, _dStep);
 }
 
+void CBaseUnit::CompressTimePoints(double _dStart, double _dEnd, double _dATol, double _dRTol)
+{
+	for (auto& s : m_vHoldupsWork)		s->CompressTimePoints(_dStart, _dEnd, _dATol, _dRTol);
+	for (auto& s : m_vStoreHoldupsWork)	s->CompressTimePoints(_dStart, _dEnd, _dATol, _dRTol);
+	for (auto& s : m_vStreams)			s->CompressTimePoints(_dStart, _dEnd, _dATol, _dRTol);
+	for (auto& s : m_vStoreStreams)		s->CompressTimePoints(_dStart, _dEnd, _dATol, _dRTol);
+}
+
 const CUnitParametersManager& CBaseUnit::GetUnitParametersManager() const
 {
 	return m_unitParameters;
@@ -952,6 +971,7 @@ void CBaseUnit::SetMaterialsDatabase(const CMaterialsDatabase* _pDatabase)
 		m_vStreams[i]->SetMaterialsDatabase( m_pMaterialsDB );
 		m_vStoreStreams[i]->SetMaterialsDatabase( m_pMaterialsDB );
 	}
+	m_compoundsTable.Update(m_pMaterialsDB, GetCompoundsList());
 }
 
 void CBaseUnit::SetCompounds(const std::vector<std::string>* _pvCompoundsKeys)
@@ -968,11 +988,13 @@ void CBaseUnit::SetCompounds(const std::vector<std::string>* _pvCompoundsKeys)
 		m_vStreams[i]->SetCompounds( *m_pvCompoundsKeys );
 		m_vStoreStreams[i]->SetCompounds( *m_pvCompoundsKeys );
 	}
+	m_compoundsTable.Update(m_pMaterialsDB, GetCompoundsList());
 }
 
 void CBaseUnit::SetCompoundsPtr( const std::vector<std::string>* _pvCompoundsKeys )
 {
 	m_pvCompoundsKeys = _pvCompoundsKeys;
+	m_compoundsTable.Update(m_pMaterialsDB, GetCompoundsList());
 }
 
 void CBaseUnit::AddCompound( std::string _sCompoundKey )
@@ -988,6 +1010,7 @@ void CBaseUnit::AddCompound( std::string _sCompoundKey )
 		m_vStreams[i]->AddCompound( _sCompoundKey );
 		m_vStoreStreams[i]->AddCompound( _sCompoundKey );
 	}
+	m_compoundsTable.Update(m_pMaterialsDB, GetCompoundsList());
 }
 
 void CBaseUnit::RemoveCompound( std::string _sCompoundKey )
@@ -1003,6 +1026,23 @@ void CBaseUnit::RemoveCompound( std::string _sCompoundKey )
 		m_vStreams[i]->RemoveCompound( _sCompoundKey );
 		m_vStoreStreams[i]->RemoveCompound( _sCompoundKey );
 	}
+	m_compoundsTable.Update(m_pMaterialsDB, GetCompoundsList());
+}
+
+void CBaseUnit::UpdateCompoundsTable()
+{
+	m_compoundsTable.Update(m_pMaterialsDB, GetCompoundsList());
+	for (size_t i = 0; i < m_vHoldupsInit.size(); ++i)
+	{
+		m_vHoldupsInit[i]->UpdateCompoundsTable();
+		m_vHoldupsWork[i]->UpdateCompoundsTable();
+		m_vStoreHoldupsWork[i]->UpdateCompoundsTable();
+	}
+	for (size_t i = 0; i < m_vStreams.size(); ++i)
+	{
+		m_vStreams[i]->UpdateCompoundsTable();
+		m_vStoreStreams[i]->UpdateCompoundsTable();
+	}
 }
 
 std::vector<std::string> CBaseUnit::GetCompoundsList() const
@@ -1146,12 +1186,44 @@ double CBaseUnit::GetCompoundsInteractionProp(const std::string& _sCompoundKey1,
 	case INT_PROP_USER_DEFINED_18:
 	case INT_PROP_USER_DEFINED_19:
 	case INT_PROP_USER_DEFINED_20:
-		dVal = m_pMaterialsDB->GetInteractionPropertyValue(_sCompoundKey1, _sCompoundKey2, static_cast<EInteractionProperties>(_nProperty), _dTemperature, _dPressure);
+	{
+		const size_t iCompound1 = m_compoundsTable.GetIndex(_sCompoundKey1);
+		const size_t iCompound2 = m_compoundsTable.GetIndex(_sCompoundKey2);
+		if (iCompound1 != static_cast<size_t>(-1) && iCompound2 != static_cast<size_t>(-1))
+			dVal = m_compoundsTable.GetInteractionPropertyValue(iCompound1, iCompound2, static_cast<EInteractionProperties>(_nProperty), _dTemperature, _dPressure);
+		else
+			dVal = m_pMaterialsDB->GetInteractionPropertyValue(_sCompoundKey1, _sCompoundKey2, static_cast<EInteractionProperties>(_nProperty), _dTemperature, _dPressure);
+		break;
+	}
 	case INT_PROP_NO_PROERTY: break;
 	}
 	return dVal;
 }
 
+double CBaseUnit::GetCompoundConstant(size_t _nCompoundIndex, unsigned _nConstant) const
+{
+	return m_compoundsTable.GetConstPropertyValue(_nCompoundIndex, static_cast<ECompoundConstProperties>(_nConstant));
+}
+
+double CBaseUnit::GetCompoundTPDProp(size_t _nCompoundIndex, unsigned _nProperty, double _dTemperature, double _dPressure) const
+{
+	return m_compoundsTable.GetTPPropertyValue(_nCompoundIndex, static_cast<ECompoundTPProperties>(_nProperty), _dTemperature, _dPressure);
+}
+
+double CBaseUnit::GetCompoundsInteractionProp(size_t _nCompoundIndex1, size_t _nCompoundIndex2, unsigned _nProperty, double _dTemperature, double _dPressure) const
+{
+	return m_compoundsTable.GetInteractionPropertyValue(_nCompoundIndex1, _nCompoundIndex2, static_cast<EInteractionProperties>(_nProperty), _dTemperature, _dPressure);
+}
+
+size_t CBaseUnit::GetCompoundIndex(const std::string& _sCompoundKey) const
+{
+	if (!m_pvCompoundsKeys) return -1;
+	for (size_t i = 0; i < m_pvCompoundsKeys->size(); ++i)
+		if ((*m_pvCompoundsKeys)[i] == _sCompoundKey)
+			return i;
+	return -1;
+}
+
 bool CBaseUnit::IsCompoundNameDefined(const std::string& _sCompoundName) const
 {
 	const std::vector<std::string> vCompNames = GetCompoundsNames();
@@ -1841,7 +1913,7 @@ bool CBaseUnit::CheckError() const
 
 bool CBaseUnit::CheckWarning() const
 {
-	return m_bWarning;
+	return m_bWarning || !GetSolversWarnings().empty();
 }
 
 bool CBaseUnit::CheckInfo() const
@@ -1856,7 +1928,10 @@ std::string CBaseUnit::GetErrorDescription() const
 
 std::string CBaseUnit::GetWarningDescription() const
 {
-	return m_sWarningDescription;
+	const std::string sSolvers = GetSolversWarnings();
+	if (sSolvers.empty()) return m_sWarningDescription;
+	if (m_sWarningDescription.empty()) return sSolvers;
+	return m_sWarningDescription + "\n" + sSolvers;
 }
 
 std::string CBaseUnit::GetInfoDescription() const
@@ -1912,6 +1987,10 @@ void CBaseUnit::ClearWarning()
 {
 	m_bWarning = false;
 	m_sWarningDescription.clear();
+	for (auto& s : m_vDAESolvers)
+		s->ClearWarning();
+	for (auto& s : m_vNLSolvers)
+		s->ClearWarning();
 }
 
 void CBaseUnit::ClearInfo()
@@ -1933,6 +2012,8 @@ void CBaseUnit::InitializeUnit(double _dTime)
 	ClearPlots();
 	m_nPermanentHoldups = (int)m_vHoldupsInit.size();
 	m_nPermanentStreams = (int)m_vStreams.size();
+	m_mTMCache.clear();
+	UpdateCompoundsTable();
 	InitializeHoldups();
 	InitializeMaterialStreams();
 	InitializeExternalSolvers();
@@ -1946,6 +2027,19 @@ void CBaseUnit::FinalizeUnit()
 	FinalizeExternalSolvers();
 	RemoveTempHoldups();
 	RemoveTempMaterialStreams();
+	m_mTMCache.clear();
+}
+
+void CBaseUnit::SimulateUnit(double _dStartTime, double _dEndTime)
+{
+	m_bStateChanged = true;
+	Simulate(_dStartTime, _dEndTime);
+}
+
+void CBaseUnit::SimulateUnit(double _dTime)
+{
+	m_bStateChanged = true;
+	Simulate(_dTime);
 }
 
 void CBaseUnit::SaveStateUnit(double _dT1, double _dT2 /*= -1*/)
@@ -1958,30 +2052,36 @@ void CBaseUnit::SaveStateUnit(double _dT1, double _dT2 /*= -1*/)
 	// save state variables
 	for (auto& v : m_vStateVariables)
 		v->dSavedValue = v->dValue;
-	// save material streams and holdups
-	if(_dT2 != -1)
+	// save material streams and holdups, skipping those, which are unchanged since they were saved or loaded for the same time window;
+	// streams with data after the time window would lose it on loading, so they are never considered unchanged
+	const bool bSameWindow = _dT1 == m_dStoreT1 && _dT2 == m_dStoreT2;
+	for (size_t i = 0; i < m_vStreams.size(); ++i)
 	{
-		for (size_t i = 0; i < m_vStreams.size(); ++i)
-			m_vStoreStreams[i]->CopyFromStream(m_vStreams[i], _dT1, _dT2);
-		for (size_t i = 0; i < m_vStoreHoldupsWork.size(); ++i)
-			m_vStoreHoldupsWork[i]->CopyFromHoldup(m_vHoldupsWork[i], _dT1, _dT2);
+		if (bSameWindow && IsStoredStateActual(*m_vStreams[i], *m_vStoreStreams[i], m_vStoreStreamsVersions[i])) continue;
+		const double dT2 = _dT2 != -1 ? _dT2 : m_vStreams[i]->GetLastTimePoint();
+		m_vStoreStreams[i]->CopyFromStream(m_vStreams[i], _dT1, dT2);
+		m_vStoreStreamsVersions[i] = m_vStreams[i]->GetLastTimePoint() <= dT2 ? GetStoredVersions(*m_vStreams[i], *m_vStoreStreams[i]) : SStoredVersions{};
 	}
-	else
+	for (size_t i = 0; i < m_vStoreHoldupsWork.size(); ++i)
 	{
-		for (size_t i = 0; i < m_vStreams.size(); ++i)
-			m_vStoreStreams[i]->CopyFromStream(m_vStreams[i], _dT1, m_vStreams[i]->GetLastTimePoint());
-		for (size_t i = 0; i < m_vStoreHoldupsWork.size(); ++i)
-			m_vStoreHoldupsWork[i]->CopyFromHoldup(m_vHoldupsWork[i], _dT1, m_vHoldupsWork[i]->GetLastTimePoint());
+		if (bSameWindow && IsStoredStateActual(*m_vHoldupsWork[i], *m_vStoreHoldupsWork[i], m_vStoreHoldupsVersions[i])) continue;
+		const double dT2 = _dT2 != -1 ? _dT2 : m_vHoldupsWork[i]->GetLastTimePoint();
+		m_vStoreHoldupsWork[i]->CopyFromHoldup(m_vHoldupsWork[i], _dT1, dT2);
+		m_vStoreHoldupsVersions[i] = m_vHoldupsWork[i]->GetLastTimePoint() <= dT2 ? GetStoredVersions(*m_vHoldupsWork[i], *m_vStoreHoldupsWork[i]) : SStoredVersions{};
 	}
 	// save time points
 	m_dStoreT1 = _dT1;
 	m_dStoreT2 = _dT2;
 	// save state of plots
 	SavePlots();
+	m_bStateChanged = false;
 }
 
 void CBaseUnit::LoadStateUnit()
 {
+	// nothing has been calculated since the last saving or loading, so the current state equals the stored one
+	if (!m_bStateChanged)
+		return;
 	// call internal loading procedure of unit
 	LoadState();
 	// call loading procedures for solvers
@@ -1990,23 +2090,32 @@ void CBaseUnit::LoadStateUnit()
 	// load state variables
 	for(auto& v : m_vStateVariables)
 		v->dValue = v->dSavedValue;
-	// load material streams and holdups
-	if (m_dStoreT2 != -1)
+	// load material streams and holdups, skipping those, which are unchanged since they were saved or loaded
+	for (size_t i = 0; i < m_vStreams.size(); ++i)
 	{
-		for (size_t i = 0; i < m_vStreams.size(); ++i)
-			m_vStreams[i]->CopyFromStream(m_vStoreStreams[i], m_dStoreT1, m_dStoreT2);
-		for (size_t i = 0; i < m_vHoldupsWork.size(); ++i)
-			m_vHoldupsWork[i]->CopyFromHoldup(m_vStoreHoldupsWork[i], m_dStoreT1, m_dStoreT2);
+		if (IsStoredStateActual(*m_vStreams[i], *m_vStoreStreams[i], m_vStoreStreamsVersions[i])) continue;
+		m_vStreams[i]->CopyFromStream(m_vStoreStreams[i], m_dStoreT1, m_dStoreT2 != -1 ? m_dStoreT2 : m_vStoreStreams[i]->GetLastTimePoint());
+		m_vStoreStreamsVersions[i] = GetStoredVersions(*m_vStreams[i], *m_vStoreStreams[i]);
 	}
-	else
+	for (size_t i = 0; i < m_vHoldupsWork.size(); ++i)
 	{
-		for (size_t i = 0; i < m_vStreams.size(); ++i)
-			m_vStreams[i]->CopyFromStream(m_vStoreStreams[i], m_dStoreT1, m_vStoreStreams[i]->GetLastTimePoint());
-		for (size_t i = 0; i < m_vHoldupsWork.size(); ++i)
-			m_vHoldupsWork[i]->CopyFromHoldup(m_vStoreHoldupsWork[i], m_dStoreT1, m_vStoreHoldupsWork[i]->GetLastTimePoint());
+		if (IsStoredStateActual(*m_vHoldupsWork[i], *m_vStoreHoldupsWork[i], m_vStoreHoldupsVersions[i])) continue;
+		m_vHoldupsWork[i]->CopyFromHoldup(m_vStoreHoldupsWork[i], m_dStoreT1, m_dStoreT2 != -1 ? m_dStoreT2 : m_vStoreHoldupsWork[i]->GetLastTimePoint());
+		m_vStoreHoldupsVersions[i] = GetStoredVersions(*m_vHoldupsWork[i], *m_vStoreHoldupsWork[i]);
 	}
 	// load state of plots
 	LoadPlots();
+	m_bStateChanged = false;
+}
+
+bool CBaseUnit::IsStoredStateActual(const CStream& _work, const CStream& _store, const SStoredVersions& _versions)
+{
+	return !_versions.vWork.empty() && _work.GetDataVersions() == _versions.vWork && _store.GetDataVersions() == _versions.vStore;
+}
+
+CBaseUnit::SStoredVersions CBaseUnit::GetStoredVersions(const CStream& _work, const CStream& _store)
+{
+	return SStoredVersions{ _work.GetDataVersions(), _store.GetDataVersions() };
 }
 
 bool CBaseUnit::IsDynamicUnit() const
@@ -2089,6 +2198,27 @@ void CBaseUnit::CalculateTM( EDistrTypes _nDistrType, std::vector<double> _vInDi
 	}
 }
 
+bool CBaseUnit::STMCacheKey::operator<(const STMCacheKey& _other) const
+{
+	return std::tie(sName, sCompound, nIndex) < std::tie(_other.sName, _other.sCompound, _other.nIndex);
+}
+
+const CTransformMatrix* CBaseUnit::GetCachedTM(const std::string& _sName, const std::vector<double>& _vParams, const std::string& _sCompound /*= ""*/, size_t _nIndex /*= 0*/) const
+{
+	const auto it = m_mTMCache.find(STMCacheKey{ _sName, _sCompound, _nIndex });
+	if (it == m_mTMCache.end() || it->second.first != _vParams)
+		return nullptr;
+	return &it->second.second;
+}
+
+const CTransformMatrix& CBaseUnit::SetCachedTM(const std::string& _sName, const std::vector<double>& _vParams, const CTransformMatrix& _TM, const std::string& _sCompound /*= ""*/, size_t _nIndex /*= 0*/)
+{
+	auto& entry = m_mTMCache[STMCacheKey{ _sName, _sCompound, _nIndex }];
+	entry.first = _vParams;
+	entry.second = _TM;
+	return entry.second;
+}
+
 void CBaseUnit::SetCachePath(const std::wstring& _sPath)
 {
 	m_sCachePath = _sPath;
@@ -2399,6 +2529,43 @@ void CBaseUnit::SetSolversPointers(const std::vector<CExternalSolver*>& _vPointe
 	m_vExternalSolvers = _vPointers;
 }
 
+void CBaseUnit::RegisterSolver(CDAESolver* _pSolver)
+{
+	if (_pSolver && std::find(m_vDAESolvers.begin(), m_vDAESolvers.end(), _pSolver) == m_vDAESolvers.end())
+		m_vDAESolvers.push_back(_pSolver);
+}
+
+void CBaseUnit::RegisterSolver(CNLSolver* _pSolver)
+{
+	if (_pSolver && std::find(m_vNLSolvers.begin(), m_vNLSolvers.end(), _pSolver) == m_vNLSolvers.end())
+		m_vNLSolvers.push_back(_pSolver);
+}
+
+SSolverStatistics CBaseUnit::GetSolverStatistics() const
+{
+	SSolverStatistics res;
+	for (auto& s : m_vDAESolvers)
+		res += s->GetStatistics();
+	for (auto& s : m_vNLSolvers)
+		res += s->GetStatistics();
+	return res;
+}
+
+std::string CBaseUnit::GetSolversWarnings() const
+{
+	std::string res;
+	const auto Append = [&](const std::string& _sWarning)
+	{
+		if (_sWarning.empty()) return;
+		res += (res.empty() ? "" : "\n") + _sWarning;
+	};
+	for (auto& s : m_vDAESolvers)
+		Append(s->GetWarning());
+	for (auto& s : m_vNLSolvers)
+		Append(s->GetWarning());
+	return res;
+}
+
 void CBaseUnit::HeatExchange(CMaterialStream* _pStream1, CMaterialStream* _pStream2, double _dTime, double _dEfficiency)
 {
 	// No heat transfer if _dEfficiency bigger 1 or smaller/equal 0
@@ -2415,13 +2582,12 @@ void CBaseUnit::HeatExchange(CMaterialStream* _pStream1, CMaterialStream* _pStre
 	double dTemperatureSrc1 = _pStream1->GetTemperature(_dTime);
 	double dTemperatureSrc2 = _pStream2->GetTemperature(_dTime);
 
-	// Calculate enthalpy lookup tables for both streams
-	CLookupTable lookupSrc1(m_pMaterialsDB, GetCompoundsList(), ENTHALPY, EDependencyTypes::DEPENDENCE_TEMP);
-	std::vector<double> vCompoundFractionsSrc1 = _pStream1->GetCompoundsFractions(_dTime);
-	lookupSrc1.SetCompoundFractions(vCompoundFractionsSrc1);
-	CLookupTable lookupSrc2(m_pMaterialsDB, GetCompoundsList(), ENTHALPY, EDependencyTypes::DEPENDENCE_TEMP);
-	std::vector<double> vCompoundFractionsSrc2 = _pStream2->GetCompoundsFractions(_dTime);
-	lookupSrc2.SetCompoundFractions(vCompoundFractionsSrc2);
+	// Calculate enthalpy lookup tables for both streams (compound and mixture tables are taken from the shared cache if available)
+	const std::vector<std::string> vCompounds = GetCompoundsList();
+	CLookupTable lookupSrc1(m_pMaterialsDB, vCompounds, ENTHALPY, EDependencyTypes::DEPENDENCE_TEMP);
+	lookupSrc1.SetCompoundFractions(_pStream1->GetCompoundsFractions(_dTime));
+	CLookupTable lookupSrc2(m_pMaterialsDB, vCompounds, ENTHALPY, EDependencyTypes::DEPENDENCE_TEMP);
+	lookupSrc2.SetCompoundFractions(_pStream2->GetCompoundsFractions(_dTime));
 
 
 	// Specific enthalpy of both streams and combination
@@ -2430,7 +2596,7 @@ void CBaseUnit::HeatExchange(CMaterialStream* _pStream1, CMaterialStream* _pStre
 	double dEnthalpySrcTot = (dMassSrc1 * dEnthalpySrc1 + dMassSrc2 * dEnthalpySrc2) / dMassSrcTot;
 
 	// Add up both enthalpy tables weighted with their respective mass fraction of total mass flow
-	CLookupTable lookupMix(m_pMaterialsDB, GetCompoundsList(), ENTHALPY, EDependencyTypes::DEPENDENCE_TEMP);
+	CLookupTable lookupMix(m_pMaterialsDB, vCompounds, ENTHALPY, EDependencyTypes::DEPENDENCE_TEMP);
 	lookupMix.Add(lookupSrc1, dMassSrc1 / dMassSrcTot);
 	lookupMix.Add(lookupSrc2, dMassSrc2 / dMassSrcTot);
 
@@ -2490,9 +2656,10 @@ double CBaseUnit::GetParamFromLookup(ECompoundTPProperties _nProperty, EDependen
 	if (!IsDefined(_nProperty, _nDependenceType))
 		AddPropertyTable(_nProperty, _nDependenceType);
 
-	m_vLookupTables.find(_nProperty)->second.SetCompoundFractions(_vCompoundFractions);
-
-	return m_vLookupTables.find(_nProperty)->second.GetParam(_dValue);
+	// the table is recalculated only if fractions have changed since the last call
+	CLookupTable& table = m_vLookupTables.find(_nProperty)->second;
+	table.SetCompoundFractions(_vCompoundFractions);
+	return table.GetParam(_dValue);
 }
 
 double CBaseUnit::CalcTemperatureFromProperty(ECompoundTPProperties _nProperty, const std::vector<double>& _vCompoundFractions, double _dValue)
@@ -5,6 +5,10 @@
 #include "UnitParameters.h"
 #include "AgglomerationSolver.h"
 #include "PBMSolver.h"
+#include "SolverStatistics.h"
+
+class CDAESolver;
+class CNLSolver;
 
 #ifdef _DEBUG
 #define DYSSOL_CREATE_MODEL_FUN CreateDYSSOLUnitV1_DEBUG
@@ -57,9 +61,18 @@ private:
 	int m_nPermanentStreams;								///< Is used to distinguish between material streams which have been added in constructor (permanent) and elsewhere (temp)
 	std::vector<sStateVariable*> m_vStateVariables;			///< State variables of the unit
 	bool m_bIsDynamic;										///< Contains true - if this unit is defined as dynamic, false - as steady-state
+	/** Versions of data of a working stream or holdup and of its stored copy, at which both contain the same data in the stored time window.*/
+	struct SStoredVersions
+	{
+		std::vector<size_t> vWork;	///< Versions of the working stream or holdup
+		std::vector<size_t> vStore;	///< Versions of the stored copy
+	};
 	std::vector<CHoldup*> m_vStoreHoldupsWork;				///< Used to store data from m_vHoldupsWork for cyclic calculations
 	std::vector<CMaterialStream*> m_vStoreStreams;			///< Used to store data from m_vStreams for cyclic calculations
+	std::vector<SStoredVersions> m_vStoreHoldupsVersions;	///< Versions of m_vHoldupsWork and m_vStoreHoldupsWork, at which they were last synchronized
+	std::vector<SStoredVersions> m_vStoreStreamsVersions;	///< Versions of m_vStreams and m_vStoreStreams, at which they were last synchronized
 	double m_dStoreT1, m_dStoreT2;							///< Stored time window in m_vStoreHoldupsWork and m_vStoreStreams
+	bool m_bStateChanged;									///< Contains true if the unit has been simulated since its state was last saved or loaded
 
 	// ========== Variables to work with errors and warnings
 	bool m_bError;						///< Contains true if an error was detected
@@ -76,6 +89,17 @@ private:
 
 	double m_dMinFraction;
 
+	// ========== Cached transformation matrices
+	/** Key of a cached transformation matrix.*/
+	struct STMCacheKey
+	{
+		std::string sName;		///< Name of the matrix within the unit
+		std::string sCompound;	///< Key of the compound, for which the matrix is calculated, or empty if it is applied to all compounds
+		size_t nIndex;			///< Index of the matrix in a sequence of matrices with the same name and compound
+		bool operator<(const STMCacheKey& _other) const;
+	};
+	std::map<STMCacheKey, std::pair<std::vector<double>, CTransformMatrix>> m_mTMCache;	///< Transformation matrices together with parameters they were calculated for
+
 protected:
 	// ========== Basic info of the unit
 	std::string m_sUnitName;	///< Name of the unit
@@ -89,6 +113,7 @@ protected:
 	const std::vector<unsigned>* m_pvPhasesSOA;			///< Aggregation states of phases
 	const CDistributionsGrid* m_pDistributionsGrid;		///< Pointer to a grid with size classes of MD parameters
 	const CMaterialsDatabase* m_pMaterialsDB;			///< Pointer to a database of materials
+	CCompoundsTable m_compoundsTable;					///< Compounds of the unit resolved in the database of materials, to access their properties by indices
 	double m_dATol;										///< Value of an absolute tolerance
 	double m_dRTol;										///< Value of a relative tolerance
 
@@ -286,6 +311,8 @@ public:		std::vector<double> GetAllStreamsTimePoints( const std::vector<CMateria
 
 			// Removes time points, which are closer as _dStep, from internal holdups and streams within the specified interval [_dStart; _dEnd).
 public:		void ReduceTimePoints(double _dStart, double _dEnd, double _dStep);
+			// Removes time points, which can be linearly interpolated with the given tolerances, from internal holdups and streams within the specified interval (_dStart; _dEnd).
+public:		void CompressTimePoints(double _dStart, double _dEnd, double _dATol, double _dRTol);
 
 //////////////////////////////////////////////////////////////////////////
 /// Functions to work with UNIT PARAMETERS
@@ -469,6 +496,8 @@ public:		void SetCompounds( const std::vector<std::string>* _pvCompoundsKeys );
 public:		void SetCompoundsPtr( const std::vector<std::string>* _pvCompoundsKeys );
 public:		void AddCompound( std::string _sCompoundKey );
 public:		void RemoveCompound( std::string _sCompoundKey );
+	/** Resolves compounds and their properties in the database of materials anew for the unit and all its holdups and streams.*/
+public:		void UpdateCompoundsTable();
 	/** Returns unique keys of all using compounds.*/
 public:		std::vector<std::string> GetCompoundsList() const;
 	/** Returns names of all using compounds.*/
@@ -482,6 +511,14 @@ public:		double GetCompoundConstant( const std::string &_sCompoundKey, unsigned
 public:		double GetCompoundTPDProp( const std::string &_sCompoundKey, unsigned _nProperty, double _dTemperature, double _dPressure ) const;
 			/** Returns the value of the interaction property (INTERFACE_TENSION, INT_PROP_USER_DEFINED_01, INT_PROP_USER_DEFINED_02, etc) between specified compounds	under specified temperature [K] and pressure [Pa].*/
 public:		double GetCompoundsInteractionProp(const std::string &_sCompoundKey1, const std::string &_sCompoundKey2, unsigned _nProperty, double _dTemperature = STANDARD_CONDITION_T, double _dPressure = STANDARD_CONDITION_P) const;
+	/** Get the value of constant physical property for the compound with the specified index.*/
+public:		double GetCompoundConstant( size_t _nCompoundIndex, unsigned _nConstant ) const;
+	/** Returns the value of temperature/pressure-dependent physical property for the compound with the specified index with specified temperature [K] and pressure [Pa].*/
+public:		double GetCompoundTPDProp( size_t _nCompoundIndex, unsigned _nProperty, double _dTemperature, double _dPressure ) const;
+			/** Returns the value of the interaction property between compounds with specified indices under specified temperature [K] and pressure [Pa].*/
+public:		double GetCompoundsInteractionProp(size_t _nCompoundIndex1, size_t _nCompoundIndex2, unsigned _nProperty, double _dTemperature = STANDARD_CONDITION_T, double _dPressure = STANDARD_CONDITION_P) const;
+			// Returns index of a compound with the specified unique key. Returns -1 if such compound has not been defined.
+public:		size_t GetCompoundIndex(const std::string& _sCompoundKey) const;
 			// Returns true if compound with specified name has been defined, otherwise returns false.
 public:		bool IsCompoundNameDefined(const std::string& _sCompoundName) const;
 			// Returns true if compound with specified unique key has been defined, otherwise returns false.
@@ -561,6 +598,15 @@ public:		void SetDistributionsGrid( const CDistributionsGrid* _pGrid );
 
 public:		static void CalculateTM( EDistrTypes _nDistrType, std::vector<double> _vInDistr, std::vector<double> _vOutDistr, CTransformMatrix &_outTM );
 
+	/** Returns transformation matrix stored under the name _sName for compound _sCompound with index _nIndex, if it was calculated for the same parameters _vParams, otherwise returns nullptr.
+	 *	_vParams must contain all values the matrix depends on: unit parameters, input distributions, etc. The cache is cleared at each initialization
+	 *	of the unit, so cached matrices always correspond to the current distributions grid. _sCompound is empty for matrices applied to all compounds,
+	 *	_nIndex distinguishes several matrices applied one after another.*/
+protected:	const CTransformMatrix* GetCachedTM( const std::string& _sName, const std::vector<double>& _vParams, const std::string& _sCompound = "", size_t _nIndex = 0 ) const;
+	/** Stores transformation matrix _TM calculated for parameters _vParams under the name _sName for compound _sCompound with index _nIndex, replacing the previous one.
+	 *	Returns reference to the cached matrix.*/
+protected:	const CTransformMatrix& SetCachedTM( const std::string& _sName, const std::vector<double>& _vParams, const CTransformMatrix& _TM, const std::string& _sCompound = "", size_t _nIndex = 0 );
+
 	/** Returns list of defined dimensions of solid distribution.*/
 public:		std::vector<EDistrTypes> GetDistributionsTypes() const;
 	/** Returns list of classes numbers for defined dimensions of solid distribution.*/
@@ -629,7 +675,7 @@ private:	void LoadFromFileOldVer( CH5Handler& _h5Loader, const std::string& _sPa
 	/**	Checks unit's error.
 	 *	\retval true An error has occurred*/
 public:		bool CheckError() const;
-	/**	Checks unit's warning.
+	/**	Checks unit's warning, including warnings of registered solvers.
 	 *	\retval true A warning has occurred*/
 public:		bool CheckWarning() const;
 	/**	Checks unit's info.
@@ -637,7 +683,7 @@ public:		bool CheckWarning() const;
 public:		bool CheckInfo() const;
 	/**	Get text description of the last error.*/
 public:		std::string GetErrorDescription() const;
-	/**	Get text description of the last warning.*/
+	/**	Get text description of the last warning, followed by warnings of registered solvers.*/
 public:		std::string GetWarningDescription() const;
 	/**	Get text description of the last info.*/
 public:		std::string GetInfoDescription() const;
@@ -668,10 +714,20 @@ protected:	void SetDynamicUnit( bool _bIsDynamic );
 public:		void InitializeUnit( double _dTime );
 			/// Finalize unit after each simulation. Makes internal finalization and calls Finalize()*/
 public:		void FinalizeUnit();
-	/** Save current state of the unit on specified time interval. If T2 == -1, time window is [T1; LastTimePoint]. Performs internal saving procedure and calls SaveState()*/
+	/** Calculate unit on specified time interval. Performs internal bookkeeping and calls Simulate()*/
+public:		void SimulateUnit(double _dStartTime, double _dEndTime);
+	/** Calculate unit on a time point. Performs internal bookkeeping and calls Simulate()*/
+public:		void SimulateUnit(double _dTime);
+	/** Save current state of the unit on specified time interval. If T2 == -1, time window is [T1; LastTimePoint]. Performs internal saving procedure and calls SaveState().
+	 *	Holdups and material streams, which have not been modified since they were last saved or loaded for the same time window, are not copied.*/
 public:		void SaveStateUnit(double _dT1, double _dT2 = -1);
-	/** Load previously saved state of the unit. Performs internal loading procedure and calls LoadState()*/
+	/** Load previously saved state of the unit. Performs internal loading procedure and calls LoadState(). Does nothing if the unit has not been simulated since the last saving or loading.
+	 *	Holdups and material streams, which have not been modified since they were last saved or loaded, are not copied.*/
 public:		void LoadStateUnit();
+	/** Checks whether the working stream and its stored copy have not been modified since the given versions were obtained, so they still contain the same data in the stored time window.*/
+private:	static bool IsStoredStateActual(const CStream& _work, const CStream& _store, const SStoredVersions& _versions);
+	/** Returns current versions of the working stream and its stored copy.*/
+private:	static SStoredVersions GetStoredVersions(const CStream& _work, const CStream& _store);
 	/** Get unit type.
 	 *	\retval true Dynamic unit
 	 *	\retval false Steady state unit*/
@@ -779,6 +835,30 @@ public:
 	void InitializeExternalSolvers() const;
 	void FinalizeExternalSolvers() const;
 	void SetSolversPointers(const std::vector<CExternalSolver*>& _pvPointers);
+
+
+	//////////////////////////////////////////////////////////////////////////
+	/// Functions to work with statistics of equation solvers
+	//////////////////////////////////////////////////////////////////////////
+
+private:
+	std::vector<CDAESolver*> m_vDAESolvers;		///< DAE solvers of the unit, whose statistics and warnings are collected
+	std::vector<CNLSolver*> m_vNLSolvers;		///< NL solvers of the unit, whose statistics and warnings are collected
+
+	/** Returns warnings of all registered solvers, each on a separate line.*/
+	std::string GetSolversWarnings() const;
+
+protected:
+	/** Registers DAE solver of the unit to collect its statistics and warnings. Should be called in the constructor of the unit.
+	 *	\param _pSolver Pointer to the solver*/
+	void RegisterSolver(CDAESolver* _pSolver);
+	/** Registers NL solver of the unit to collect its statistics and warnings. Should be called in the constructor of the unit.
+	 *	\param _pSolver Pointer to the solver*/
+	void RegisterSolver(CNLSolver* _pSolver);
+
+public:
+	/** Returns statistics of all registered solvers, accumulated since their models were set.*/
+	SSolverStatistics GetSolverStatistics() const;
 };
 
 typedef DECLDIR CBaseUnit* (*CreateUnit)();
@@ -4,6 +4,7 @@
 #include "DyssolDefines.h"
 #include "DyssolUtilities.h"
 #include "DyssolStringConstants.h"
+#include <algorithm>
 
 const unsigned CDenseDistr2D::m_cnSaveVersion	= 2;
 
@@ -31,17 +32,16 @@ CDenseDistr2D::~CDenseDistr2D()
 
 void CDenseDistr2D::Clear()
 {
-	//for (unsigned i=0; i<m_Data.size(); i++ )
-	//	delete m_Data[ i ];
+	++m_nVersion;
 	m_Data.clear();
 	m_vTimePoints.clear();
 	m_nDimensions = 0;
-	//m_vLabels.clear();
 	ClearCache();
 }
 
 void CDenseDistr2D::AddTimePoint( double _dTimePoint, double _dSourceTimePoint )
 {
+	++m_nVersion;
 	//TODO: set time point to zero if it must be set at the first place
 	if( _dTimePoint < 0 )
 		return;
@@ -52,7 +52,7 @@ void CDenseDistr2D::AddTimePoint( double _dTimePoint, double _dSourceTimePoint )
 	{
 		UnCacheData( _dTimePoint );
 		m_vTimePoints.push_back( _dTimePoint );
-		m_Data.push_back( vNewVector );
+		InsertRow( 0, vNewVector );
 	}
 	else
 	{
@@ -66,12 +66,12 @@ void CDenseDistr2D::AddTimePoint( double _dTimePoint, double _dSourceTimePoint )
 				if( nIndex > 0 )
 				{
 					UnCacheData( m_vTimePoints[nIndex-1] );
-					vNewVector = m_Data[ nIndex-1-m_nCurrOffset ];
+					vNewVector = GetRow( nIndex-1-m_nCurrOffset );
 				}
 				else
 				{
 					UnCacheData( m_vTimePoints[nIndex] );
-					vNewVector = m_Data[ nIndex-m_nCurrOffset ];
+					vNewVector = GetRow( nIndex-m_nCurrOffset );
 				}
 			}
 			else // copy data from _dSourceTimePoint
@@ -80,22 +80,22 @@ void CDenseDistr2D::AddTimePoint( double _dTimePoint, double _dSourceTimePoint )
 			}
 			UnCacheData( _dTimePoint );
 			m_vTimePoints.insert( m_vTimePoints.begin() + nIndex, _dTimePoint );
-			m_Data.insert( m_Data.begin() + (nIndex - m_nCurrOffset), vNewVector );
+			InsertRow( nIndex - m_nCurrOffset, vNewVector );
 		}
 		else
 		{
 			if( _dSourceTimePoint == -1 ) // copy previous data into the new time point
 			{
 				UnCacheData( m_vTimePoints[m_vTimePoints.size()-1] );
-				vNewVector = m_Data.back();
+				vNewVector = GetRow( GetStoredNumber()-1 );
 			}
 			else // copy data from _dSourceTimePoint
 			{
 				vNewVector = GetValue( _dSourceTimePoint );
 			}
 			UnCacheData( _dTimePoint );
+			InsertRow( GetStoredNumber(), vNewVector );
 			m_vTimePoints.push_back( _dTimePoint );
-			m_Data.push_back( vNewVector );
 		}
 	}
 
@@ -106,6 +106,7 @@ void CDenseDistr2D::AddTimePoint( double _dTimePoint, double _dSourceTimePoint )
 
 void CDenseDistr2D::RemoveTimePoint( double _dTimePoint )
 {
+	++m_nVersion;
 	if( m_vTimePoints.empty() ) return;
 	size_t nIndex = GetIndexByTime( _dTimePoint );
 	if( nIndex < m_vTimePoints.size() )
@@ -113,8 +114,9 @@ void CDenseDistr2D::RemoveTimePoint( double _dTimePoint )
 		if( m_vTimePoints[ nIndex ] == _dTimePoint )
 		{
 			UnCacheData( _dTimePoint );
+			for( auto& column : m_Data )
+				column.erase( column.begin() + (nIndex - m_nCurrOffset) );
 			m_vTimePoints.erase( m_vTimePoints.begin() + nIndex );
-			m_Data.erase( m_Data.begin() + (nIndex - m_nCurrOffset) );
 		}
 	}
 	m_bCacheCoherent = false;
@@ -123,6 +125,7 @@ void CDenseDistr2D::RemoveTimePoint( double _dTimePoint )
 
 void CDenseDistr2D::RemoveTimePoints( double _dStart, double _dEnd )
 {
+	++m_nVersion;
 	if( ( !m_vTimePoints.empty() ) && ( m_vTimePoints.front() == _dStart ) && ( m_vTimePoints.back() == _dEnd ) ) // remove all time points
 	{
 		RemoveAllTimePoints();
@@ -134,29 +137,57 @@ void CDenseDistr2D::RemoveTimePoints( double _dStart, double _dEnd )
 
 void CDenseDistr2D::RemoveTimePoints(const std::vector<unsigned>& _vIndexes)
 {
-	if( ( !_vIndexes.empty() ) && ( !m_vTimePoints.empty() ) && ( m_vTimePoints.front() == m_vTimePoints[_vIndexes.front()] )
-		&& ( m_vTimePoints.back() == m_vTimePoints[_vIndexes.back()] ) ) // remove all time points
+	++m_nVersion;
+	if( _vIndexes.empty() || m_vTimePoints.empty() || _vIndexes.back() >= m_vTimePoints.size() ) return;
+
+	if( _vIndexes.size() == m_vTimePoints.size() ) // remove all time points
 	{
 		RemoveAllTimePoints();
 		return;
 	}
 
-	for ( unsigned i=0; i<_vIndexes.size(); i++ )
+	UnCacheData( m_vTimePoints[_vIndexes.front()], m_vTimePoints[_vIndexes.back()] );
+
+	// compact all arrays in one pass
+	std::vector<bool> vRemove( m_vTimePoints.size(), false );
+	for( unsigned index : _vIndexes )
+		vRemove[index] = true;
+	for( auto& column : m_Data )
 	{
-		unsigned nIndex = _vIndexes[ _vIndexes.size() - i - 1 ];
-		if ( nIndex < m_vTimePoints.size() )
-		{
-			UnCacheData( m_vTimePoints[nIndex] );
-			m_Data.erase( m_Data.begin() + (nIndex - m_nCurrOffset) );
-			m_vTimePoints.erase( m_vTimePoints.begin() + nIndex );
-		}
+		size_t iDst = 0;
+		for( size_t iSrc = 0; iSrc < column.size(); ++iSrc )
+			if( !vRemove[iSrc + m_nCurrOffset] )
+				column[iDst++] = column[iSrc];
+		column.resize( iDst );
 	}
+	size_t iDst = 0;
+	for( size_t iSrc = 0; iSrc < m_vTimePoints.size(); ++iSrc )
+		if( !vRemove[iSrc] )
+			m_vTimePoints[iDst++] = m_vTimePoints[iSrc];
+	m_vTimePoints.resize( iDst );
+
 	m_bCacheCoherent = false;
 	CorrectWinBoundary();
 }
 
+void CDenseDistr2D::RemoveTimePoints(const std::vector<double>& _vTimes)
+{
+	++m_nVersion;
+	std::vector<unsigned> vIndexes;
+	size_t iTime = 0;
+	for( size_t i = 0; i < m_vTimePoints.size() && iTime < _vTimes.size(); ++i )
+	{
+		while( ( iTime < _vTimes.size() ) && ( _vTimes[iTime] < m_vTimePoints[i] ) )
+			iTime++;
+		if( ( iTime < _vTimes.size() ) && ( _vTimes[iTime] == m_vTimePoints[i] ) )
+			vIndexes.push_back( static_cast<unsigned>( i ) );
+	}
+	RemoveTimePoints( vIndexes );
+}
+
 void CDenseDistr2D::RemoveAllDataAfter(double _dStartTime, bool _bIncludeStartTime)
 {
+	++m_nVersion;
 	if (m_vTimePoints.empty()) return;
 
 	size_t iStart = GetIndexByTime(_dStartTime);
@@ -174,7 +205,8 @@ void CDenseDistr2D::RemoveAllDataAfter(double _dStartTime, bool _bIncludeStartTi
 	{
 		UnCacheData(m_vTimePoints[iStart], m_vTimePoints.back());
 
-		m_Data.erase(m_Data.begin() + (iStart - m_nCurrOffset), m_Data.end());
+		for (auto& column : m_Data)
+			column.erase(column.begin() + (iStart - m_nCurrOffset), column.end());
 		m_vTimePoints.erase(m_vTimePoints.begin() + iStart, m_vTimePoints.end());
 
 		m_bCacheCoherent = false;
@@ -184,6 +216,7 @@ void CDenseDistr2D::RemoveAllDataAfter(double _dStartTime, bool _bIncludeStartTi
 
 void CDenseDistr2D::ChangeTimePoint( unsigned _nTimePointIndex, double _dNewValue )
 {
+	++m_nVersion;
 	if ( _nTimePointIndex >= m_vTimePoints.size() ) return;
 	if( _dNewValue < m_dCurrWinStart )
 		UnCacheData( _dNewValue, m_dCurrWinStart );
@@ -200,10 +233,12 @@ void CDenseDistr2D::ChangeTimePoint( unsigned _nTimePointIndex, double _dNewValu
 
 void CDenseDistr2D::RemoveAllTimePoints()
 {
+	++m_nVersion;
 	if( m_vTimePoints.empty() ) return;
 
 	m_vTimePoints.clear();
-	m_Data.clear();
+	for( auto& column : m_Data )
+		column.clear();
 	ClearCache();
 }
 
@@ -212,6 +247,11 @@ size_t CDenseDistr2D::GetTimePointsNumber() const
 	return m_vTimePoints.size();
 }
 
+size_t CDenseDistr2D::GetVersion() const
+{
+	return m_nVersion;
+}
+
 std::vector<double> CDenseDistr2D::GetAllTimePoints() const
 {
 	return m_vTimePoints;
@@ -219,6 +259,7 @@ std::vector<double> CDenseDistr2D::GetAllTimePoints() const
 
 bool CDenseDistr2D::CopyFrom( CDenseDistr2D* _pSource, double _dStartTime, double _dEndTime )
 {
+	++m_nVersion;
 	if ( m_nDimensions != _pSource->GetDimensionsNumber() ) // the number of dimensions does not corresponds to each other
 		return false;
 
@@ -231,6 +272,7 @@ bool CDenseDistr2D::CopyFrom( CDenseDistr2D* _pSource, double _dStartTime, doubl
 
 bool CDenseDistr2D::CopyFrom( CDenseDistr2D* _pSource, double _dTime )
 {
+	++m_nVersion;
 	if ( m_nDimensions != _pSource->GetDimensionsNumber() ) // the number of dimensions does not corresponds to each other
 		return false;
 
@@ -242,6 +284,7 @@ bool CDenseDistr2D::CopyFrom( CDenseDistr2D* _pSource, double _dTime )
 
 bool CDenseDistr2D::CopyFromTimePoint( CDenseDistr2D* _pSource, double _dTimeSrc, double _dTimeDest )
 {
+	++m_nVersion;
 	if ( m_nDimensions != _pSource->GetDimensionsNumber() ) // the number of dimensions does not corresponds to each other
 		return false;
 
@@ -253,41 +296,31 @@ bool CDenseDistr2D::CopyFromTimePoint( CDenseDistr2D* _pSource, double _dTimeSrc
 
 void CDenseDistr2D::SetValue( unsigned _nTimeIndex, unsigned _nPropIndex, double _dNewValue )
 {
+	++m_nVersion;
 	if ( m_vTimePoints.size() <= _nTimeIndex ) return;
 	if ( m_nDimensions <= _nPropIndex ) return;
 	UnCacheData( m_vTimePoints[_nTimeIndex] );
-	m_Data[ _nTimeIndex - m_nCurrOffset ][ _nPropIndex ] = _dNewValue;
+	m_Data[ _nPropIndex ][ _nTimeIndex - m_nCurrOffset ] = _dNewValue;
 	m_bCacheCoherent = false;
-	//m_nLastTimePos = _nTimeIndex;
 }
 
 void CDenseDistr2D::SetValue( double _dTime, unsigned _nPropIndex, double _dNewValue )
 {
+	++m_nVersion;
 	if ( m_nDimensions <= _nPropIndex ) return;
 
 	size_t index = GetIndexByTime( _dTime );
 	UnCacheData( _dTime );
-	if( index < m_vTimePoints.size() )
-	{
-		if( m_vTimePoints[index] == _dTime ) // overwrite existing element
-			m_Data[ index - m_nCurrOffset ][ _nPropIndex ] = _dNewValue;
-		else								// insert new element
-		{
-			m_Data.insert( m_Data.begin() + (index - m_nCurrOffset), std::vector<double>( m_nDimensions ) );
-			if( ( index - m_nCurrOffset < m_Data.size() ) && ( index > 0 ) )
-				m_Data[index - m_nCurrOffset] = m_Data[index-1 - m_nCurrOffset];
-			m_Data[ index - m_nCurrOffset ][ _nPropIndex ] = _dNewValue;
-			m_vTimePoints.insert( m_vTimePoints.begin() + index, _dTime );
-		}
-	}
-	else // just add to the end of the vector
+	if( ( index < m_vTimePoints.size() ) && ( m_vTimePoints[index] == _dTime ) ) // overwrite existing element
+		m_Data[ _nPropIndex ][ index - m_nCurrOffset ] = _dNewValue;
+	else // insert new element with values of the previous one
 	{
 		std::vector<double> vTemp( m_nDimensions );
-		if( m_Data.size() != 0 )
-			vTemp = m_Data.back();
+		if( index > m_nCurrOffset )
+			vTemp = GetRow( index - 1 - m_nCurrOffset );
 		vTemp[_nPropIndex] = _dNewValue;
-		m_Data.push_back( vTemp );
-		m_vTimePoints.push_back( _dTime );
+		InsertRow( index - m_nCurrOffset, vTemp );
+		m_vTimePoints.insert( m_vTimePoints.begin() + index, _dTime );
 	}
 	m_bCacheCoherent = false;
 	CorrectWinBoundary();
@@ -296,215 +329,60 @@ void CDenseDistr2D::SetValue( double _dTime, unsigned _nPropIndex, double _dNewV
 
 void CDenseDistr2D::SetValue(double _dTime, const std::vector<double>& _newValue)
 {
+	++m_nVersion;
 	if( _newValue.size() != m_nDimensions ) // if dimensions number is not corresponded
 		return;
 
 	size_t index = GetIndexByTime( _dTime );
 	UnCacheData( _dTime );
-	if( index < m_vTimePoints.size() )
-	{
-		if( m_vTimePoints[index] == _dTime ) // overwrite existing element
-			m_Data[index - m_nCurrOffset] = _newValue;
-		else								// insert new element
-		{
-			m_Data.insert( m_Data.begin() + (index - m_nCurrOffset), std::vector<double>( m_nDimensions ) );
-			m_Data[index - m_nCurrOffset] = _newValue;
-			m_vTimePoints.insert( m_vTimePoints.begin() + index, _dTime );
-		}
-	}
-	else // just add to the end of the vector
+	if( ( index < m_vTimePoints.size() ) && ( m_vTimePoints[index] == _dTime ) ) // overwrite existing element
+		for( size_t i = 0; i < m_nDimensions; ++i )
+			m_Data[i][index - m_nCurrOffset] = _newValue[i];
+	else // insert new element
 	{
-		m_Data.push_back( _newValue );
-		m_vTimePoints.push_back( _dTime );
+		InsertRow( index - m_nCurrOffset, _newValue );
+		m_vTimePoints.insert( m_vTimePoints.begin() + index, _dTime );
 	}
 	m_bCacheCoherent = false;
 	CorrectWinBoundary();
 	CheckCacheNeed();
 }
 
-//double CDenseDistr2D::GetValue( double _dTime, unsigned _nDimension ) const
-//{
-//	if (( _nDimension > m_nDimensions ) || m_vTimePoints.empty() )
-//		return 0;
-//
-//	UnCacheData( _dTime );
-//
-//	if ( m_vTimePoints.size() == 1 ) // just one element - no interpolation will be done
-//		//if( m_vTimePoints.front() == _dTime )
-//		return m_Data[0][_nDimension];
-//	//else
-//	//return 0;
-//
-//
-//	// find indexes where interpolation should be done
-//	int nLeft = (int)m_vTimePoints.size()-1;
-//	int nRight = 0;;
-//	while ( nRight < (int)m_vTimePoints.size() )
-//		if ( m_vTimePoints[ nRight ] >= _dTime )
-//		{
-//			nLeft = nRight - 1;
-//			break;
-//		}
-//		else
-//			nRight++;
-//	if(( nLeft >= 0 ) && ( m_vTimePoints[nLeft] == _dTime ))
-//		return m_Data[nLeft-m_nCurrOffset][_nDimension];
-//	else if(( nRight < (int)m_vTimePoints.size() ) && ( m_vTimePoints[nRight] == _dTime ))
-//		return m_Data[nRight-m_nCurrOffset][_nDimension];
-//	else if( nRight == m_vTimePoints.size() ) // point is after the last - extrapolation
-//	{
-//		nRight--;
-//		nLeft--;
-//		return ( m_Data[nRight-m_nCurrOffset][_nDimension] - m_Data[nLeft-m_nCurrOffset][_nDimension] ) /
-//			( m_vTimePoints[nRight] - m_vTimePoints[nLeft] ) *
-//			( _dTime - m_vTimePoints[nLeft] ) + m_Data[nLeft-m_nCurrOffset][_nDimension];
-//	}
-//	else if( nLeft == -1 ) // point at the beginning - extrapolation
-//	{
-//		nRight++;
-//		nLeft++;
-//		double timePart = (m_vTimePoints[nRight] - _dTime) / (m_vTimePoints[nLeft] - _dTime);
-//		return (timePart * m_Data[nLeft-m_nCurrOffset][_nDimension] - m_Data[nRight-m_nCurrOffset][_nDimension]) / (timePart - 1);
-//	}
-//	else // point inside - interpolation
-//	{
-//		return( m_Data[nRight-m_nCurrOffset][_nDimension] - m_Data[nLeft-m_nCurrOffset][_nDimension] ) /
-//			( m_vTimePoints[nRight] - m_vTimePoints[nLeft] ) *
-//			( _dTime - m_vTimePoints[nLeft] ) + m_Data[nLeft-m_nCurrOffset][_nDimension];
-//	}
-//}
-//
-//std::vector<double> CDenseDistr2D::GetValue( double _dTime ) const
-//{
-//	std::vector<double> vRes;
-//
-//	if ( m_vTimePoints.empty() )
-//		return vRes;
-//
-//	UnCacheData( _dTime );
-//
-//	if ( m_vTimePoints.size() == 1 ) // just one element - no interpolation will be done
-//		return m_Data[0];
-//
-//	// find indexes where interpolation should be done
-//	int nLeft = (int)m_vTimePoints.size()-1;
-//	int nRight = 0;;
-//	while ( nRight < (int)m_vTimePoints.size() )
-//		if ( m_vTimePoints[ nRight ] >= _dTime )
-//		{
-//			nLeft = nRight - 1;
-//			break;
-//		}
-//		else
-//			nRight++;
-//	if(( nLeft >= 0 ) && ( m_vTimePoints[nLeft] == _dTime ))
-//		return m_Data[nLeft-m_nCurrOffset];
-//	else if(( nRight < (int)m_vTimePoints.size() ) && ( m_vTimePoints[nRight] == _dTime ))
-//		return m_Data[nRight-m_nCurrOffset];
-//	else if( nRight == m_vTimePoints.size() ) // point is after the last - extrapolation
-//	{
-//		nRight--;
-//		nLeft--;
-//		for( unsigned i=0; i<m_nDimensions; ++i )
-//			vRes.push_back( ( m_Data[nRight-m_nCurrOffset][i] - m_Data[nLeft-m_nCurrOffset][i] ) /
-//			( m_vTimePoints[nRight] - m_vTimePoints[nLeft] ) *
-//			( _dTime - m_vTimePoints[nLeft] ) + m_Data[nLeft-m_nCurrOffset][i] );
-//	}
-//	else if( nLeft == -1 ) // point at the beginning - extrapolation
-//	{
-//		nRight++;
-//		nLeft++;
-//		double timePart = (m_vTimePoints[nRight] - _dTime) / (m_vTimePoints[nLeft] - _dTime);
-//		for( unsigned i=0; i<m_nDimensions; ++i )
-//			vRes.push_back( (timePart * m_Data[nLeft-m_nCurrOffset][i] - m_Data[nRight-m_nCurrOffset][i]) / (timePart - 1) );
-//	}
-//	else // point inside - interpolation
-//	{
-//		for( unsigned i=0; i<m_nDimensions; ++i )
-//			vRes.push_back(( m_Data[nRight-m_nCurrOffset][i] - m_Data[nLeft-m_nCurrOffset][i] ) /
-//			( m_vTimePoints[nRight] - m_vTimePoints[nLeft] ) *
-//			( _dTime - m_vTimePoints[nLeft] ) + m_Data[nLeft-m_nCurrOffset][i] );
-//	}
-//
-//	return vRes;
-//}
+void CDenseDistr2D::SetValues(unsigned _nDimension, const std::vector<double>& _vValues)
+{
+	++m_nVersion;
+	if( _nDimension >= m_nDimensions || _vValues.size() != m_vTimePoints.size() ) return;
+
+	if( !m_bCacheEnabled )
+		m_Data[_nDimension] = _vValues;
+	else
+		for( size_t i = 0; i < m_vTimePoints.size(); ++i )
+		{
+			UnCacheData( m_vTimePoints[i] );
+			m_Data[_nDimension][i - m_nCurrOffset] = _vValues[i];
+		}
+	m_bCacheCoherent = false;
+}
 
 double CDenseDistr2D::GetValue( double _dTime, size_t _nDimension ) const
 {
-	if (( _nDimension > m_nDimensions ) || m_vTimePoints.empty() )
+	if (( _nDimension >= m_nDimensions ) || m_vTimePoints.empty() )
 		return 0;
 
+	std::unique_lock<std::mutex> lock = LockForRead();
 	UnCacheData( _dTime );
 
-	if ( m_vTimePoints.size() == 1 ) // just one element - no interpolation will be done
-		//if( m_vTimePoints.front() == _dTime )
-		return m_Data[0][_nDimension];
-	//else
-	//return 0;
-
-	// find indexes where interpolation should be done
-	int nLeft = (int)m_vTimePoints.size()-1;
-	int nRight = 0;
-	while ( nRight < (int)m_vTimePoints.size() )
-		if ( m_vTimePoints[ nRight ] >= _dTime )
-		{
-			nLeft = nRight - 1;
-			break;
-		}
-		else
-			nRight++;
-	if(( nLeft >= 0 ) && ( m_vTimePoints[nLeft] == _dTime ))
-		return m_Data[nLeft-m_nCurrOffset][_nDimension];
-	else if(( nRight < (int)m_vTimePoints.size() ) && ( m_vTimePoints[nRight] == _dTime ))
-		return m_Data[nRight-m_nCurrOffset][_nDimension];
-	else if( nRight == m_vTimePoints.size() ) // point is after the last - extrapolation
-	{
-		//nRight--;
-		//nLeft--;
-		//return ( m_Data[nRight-m_nCurrOffset][_nDimension] - m_Data[nLeft-m_nCurrOffset][_nDimension] ) /
-		//	( m_vTimePoints[nRight] - m_vTimePoints[nLeft] ) *
-		//	( _dTime - m_vTimePoints[nLeft] ) + m_Data[nLeft-m_nCurrOffset][_nDimension];
-		return m_Data.back().at(_nDimension);
-	}
-	else if( nLeft == -1 ) // point at the beginning - extrapolation
-	{
-		/*nRight++;
-		nLeft++;
-		double timePart = (m_vTimePoints[nRight] - _dTime) / (m_vTimePoints[nLeft] - _dTime);
-		return (timePart * m_Data[nLeft-m_nCurrOffset][_nDimension] - m_Data[nRight-m_nCurrOffset][_nDimension]) / (timePart - 1);*/
-		return m_Data.front().at(_nDimension);
-	}
-	else // point inside - interpolation
-	{
-		/*return( m_Data[nRight-m_nCurrOffset][_nDimension] - m_Data[nLeft-m_nCurrOffset][_nDimension] ) /
-			( m_vTimePoints[nRight] - m_vTimePoints[nLeft] ) *
-			( _dTime - m_vTimePoints[nLeft] ) + m_Data[nLeft-m_nCurrOffset][_nDimension];*/
-		//std::vector<double> vY, vX;
-		//if( nLeft > 0 )
-		//{
-		//	UnCacheData( m_vTimePoints[nLeft-1] );
-		//	vX.push_back( m_vTimePoints[nLeft-1] );
-		//	vY.push_back( m_Data[nLeft-1-m_nCurrOffset][_nDimension] );
-		//}
-		//UnCacheData( _dTime );
-		//vX.push_back( m_vTimePoints[nLeft] );
-		//vY.push_back( m_Data[nLeft-m_nCurrOffset][_nDimension] );
-		//vX.push_back( m_vTimePoints[nRight] );
-		//vY.push_back( m_Data[nRight-m_nCurrOffset][_nDimension] );
-		//if( nRight < m_vTimePoints.size() - 1 )
-		//{
-		//	UnCacheData( m_vTimePoints[nRight+1] );
-		//	vX.push_back( m_vTimePoints[nRight+1] );
-		//	vY.push_back( m_Data[nRight+1-m_nCurrOffset][_nDimension] );
-		//}
-		//return Interpolate( vY, vX, _dTime );
-		return Interpolate( m_Data[nLeft-m_nCurrOffset][_nDimension], m_Data[nRight-m_nCurrOffset][_nDimension], m_vTimePoints[nLeft], m_vTimePoints[nRight], _dTime );
-	}
+	size_t iLeft, iRight;
+	GetInterval( _dTime, iLeft, iRight );
+	const std::vector<double>& column = m_Data[_nDimension];
+	if( iLeft == iRight ) // exact time point or out of the defined interval
+		return column[iLeft - m_nCurrOffset];
+	return Interpolate( column[iLeft - m_nCurrOffset], column[iRight - m_nCurrOffset], m_vTimePoints[iLeft], m_vTimePoints[iRight], _dTime );
 }
 
-std::vector<double> CDenseDistr2D::GetValues(std::vector<double> _vTimes, unsigned _nDimension) const
+std::vector<double> CDenseDistr2D::GetValues(const std::vector<double>& _vTimes, unsigned _nDimension) const
 {
-	if (_nDimension > m_nDimensions) return {};
+	if (_nDimension >= m_nDimensions) return {};
 	std::vector<double> res(_vTimes.size());
 	for (size_t i = 0; i < _vTimes.size(); ++i)
 		res[i] = GetValue(_vTimes[i], _nDimension);
@@ -514,39 +392,30 @@ std::vector<double> CDenseDistr2D::GetValues(std::vector<double> _vTimes, unsign
 std::vector<double> CDenseDistr2D::GetValue(double _dTime) const
 {
 	std::vector<double> vRes;
+	GetValue(_dTime, vRes);
+	return vRes;
+}
 
+void CDenseDistr2D::GetValue(double _dTime, std::vector<double>& _vResult) const
+{
+	_vResult.resize(m_nDimensions);
 	if (m_vTimePoints.empty())
-		return std::vector<double>(m_nDimensions, 0);
+	{
+		std::fill(_vResult.begin(), _vResult.end(), 0.);
+		return;
+	}
 
+	std::unique_lock<std::mutex> lock = LockForRead();
 	UnCacheData(_dTime);
 
-	if (m_vTimePoints.size() == 1) // just one element - no interpolation will be done
-		return m_Data[0];
-
-	// find indexes where interpolation should be done
-	int nLeft = static_cast<int>(m_vTimePoints.size()) - 1;
-	int nRight = 0;
-	while (nRight < static_cast<int>(m_vTimePoints.size()))
-		if (m_vTimePoints[nRight] >= _dTime)
-		{
-			nLeft = nRight - 1;
-			break;
-		}
-		else
-			nRight++;
-	if ((nLeft >= 0) && (m_vTimePoints[nLeft] == _dTime))
-		return m_Data[nLeft - m_nCurrOffset];
-	else if ((nRight < static_cast<int>(m_vTimePoints.size())) && (m_vTimePoints[nRight] == _dTime))
-		return m_Data[nRight - m_nCurrOffset];
-	else if (nRight == m_vTimePoints.size()) // point is after the last - extrapolation
-		return m_Data.back();
-	else if (nLeft == -1) // point at the beginning - extrapolation
-		return m_Data.front();
+	size_t iLeft, iRight;
+	GetInterval(_dTime, iLeft, iRight);
+	if (iLeft == iRight) // exact time point or out of the defined interval
+		for (size_t i = 0; i < m_nDimensions; ++i)
+			_vResult[i] = m_Data[i][iLeft - m_nCurrOffset];
 	else // point inside - interpolation
-		for (unsigned i = 0; i < m_nDimensions; ++i)
-			vRes.push_back(Interpolate(m_Data[nLeft - m_nCurrOffset][i], m_Data[nRight - m_nCurrOffset][i], m_vTimePoints[nLeft], m_vTimePoints[nRight], _dTime));
-
-	return vRes;
+		for (size_t i = 0; i < m_nDimensions; ++i)
+			_vResult[i] = Interpolate(m_Data[i][iLeft - m_nCurrOffset], m_Data[i][iRight - m_nCurrOffset], m_vTimePoints[iLeft], m_vTimePoints[iRight], _dTime);
 }
 
 std::vector<unsigned> CDenseDistr2D::GetIndexesForInterval( double _dStartTime, double _dEndTime )
@@ -564,19 +433,22 @@ std::vector<double> CDenseDistr2D::GetValueForIndex( unsigned _nIndex ) const
 		return std::vector<double>( m_nDimensions );
 	else
 	{
+		std::unique_lock<std::mutex> lock = LockForRead();
 		UnCacheData(m_vTimePoints[_nIndex]);
-		return m_Data[ _nIndex - m_nCurrOffset ];
+		return GetRow( _nIndex - m_nCurrOffset );
 	}
 }
 
 std::vector<double> CDenseDistr2D::GetValues(unsigned _nDimension) const
 {
-	if (_nDimension > m_nDimensions) return {};
+	if (_nDimension >= m_nDimensions) return {};
+	if (!m_bCacheEnabled) return m_Data[_nDimension]; // all data are in memory
 	std::vector<double> res(m_vTimePoints.size());
+	std::unique_lock<std::mutex> lock = LockForRead();
 	for (size_t i = 0; i < m_vTimePoints.size(); ++i)
 	{
 		UnCacheData(m_vTimePoints[i]);
-		res[i] = m_Data[i - m_nCurrOffset][_nDimension];
+		res[i] = m_Data[_nDimension][i - m_nCurrOffset];
 	}
 	return res;
 }
@@ -605,21 +477,19 @@ void CDenseDistr2D::SaveToFile(CH5Handler& _h5File, const std::string& _sPath)
 	/// save data
 	if (!m_vTimePoints.empty())
 		UnCacheData(m_vTimePoints.front(), m_vTimePoints.back());
-	if (!m_Data.empty())
+	std::vector<std::vector<double>> vvRows = GetRows();
+	if (!vvRows.empty())
 	{
 		bool bEqual = true;
-		std::vector<std::vector<double>> vFirst;
-		vFirst.push_back(m_Data.front());
-		for (size_t i = 1; i < m_Data.size(); ++i)
-			if (m_Data[i] != vFirst.front())
+		for (size_t i = 1; i < vvRows.size(); ++i)
+			if (vvRows[i] != vvRows.front())
 			{
 				bEqual = false;
 				break;
 			}
 		if (bEqual)
-			_h5File.WriteData(_sPath, StrConst::Distr2D_H5Data, vFirst);
-		else
-			_h5File.WriteData(_sPath, StrConst::Distr2D_H5Data, m_Data);
+			vvRows.resize(1);
+		_h5File.WriteData(_sPath, StrConst::Distr2D_H5Data, vvRows);
 	}
 
 	CheckCacheNeed();
@@ -627,6 +497,7 @@ void CDenseDistr2D::SaveToFile(CH5Handler& _h5File, const std::string& _sPath)
 
 void CDenseDistr2D::LoadFromFile(CH5Handler& _h5File, const std::string& _sPath)
 {
+	++m_nVersion;
 	Clear();
 
 	if (!_h5File.IsValid())	return;
@@ -639,9 +510,12 @@ void CDenseDistr2D::LoadFromFile(CH5Handler& _h5File, const std::string& _sPath)
 	_h5File.ReadData(_sPath, StrConst::Distr2D_H5TimePoints, m_vTimePoints);
 
 	/// load data
-	_h5File.ReadData(_sPath, StrConst::Distr2D_H5Data, m_Data);
-	if (m_Data.size() == 1 && m_Data.size() != m_vTimePoints.size())
-		m_Data.resize(m_vTimePoints.size(), m_Data.front());
+	std::vector<std::vector<double>> vvRows;
+	_h5File.ReadData(_sPath, StrConst::Distr2D_H5Data, vvRows);
+	if (vvRows.size() == 1 && vvRows.size() != m_vTimePoints.size())
+		vvRows.resize(m_vTimePoints.size(), vvRows.front());
+	m_nCurrOffset = 0;
+	SetRows(vvRows);
 
 	if (!m_vTimePoints.empty())
 	{
@@ -660,25 +534,16 @@ void CDenseDistr2D::LoadFromFile(CH5Handler& _h5File, const std::string& _sPath)
 
 void CDenseDistr2D::SetDimensionsNumber( unsigned _nNewNumber )
 {
+	++m_nVersion;
 	if ( m_nDimensions == _nNewNumber ) // old number was equal
 		return;
 	if ( _nNewNumber == 0 ) // delete all data
 		Clear();
 
-	if ( m_nDimensions > _nNewNumber ) // delete unnecessary entries
-		for ( unsigned i=0; i < m_vTimePoints.size(); i++ )
-		{
-			UnCacheData(m_vTimePoints[i]);
-			while ( m_Data[i-m_nCurrOffset].size() > _nNewNumber )
-				m_Data[i-m_nCurrOffset].pop_back();
-		}
-	else // add new entries
-		for ( unsigned i=0; i < m_vTimePoints.size(); i++ )
-		{
-			UnCacheData(m_vTimePoints[i]);
-			while ( m_Data[i-m_nCurrOffset].size() < _nNewNumber )
-				m_Data[i-m_nCurrOffset].push_back( 0 );
-		}
+	// unnecessary entries are deleted, new ones are filled with zeros
+	if( !m_vTimePoints.empty() )
+		UnCacheData( m_vTimePoints.front(), m_vTimePoints.back() );
+	m_Data.resize( _nNewNumber, std::vector<double>( GetStoredNumber(), 0 ) );
 	m_nDimensions = _nNewNumber;
 	m_vLabels.resize( _nNewNumber );
 	m_bCacheCoherent = false;
@@ -710,12 +575,10 @@ std::string CDenseDistr2D::GetLabel( unsigned _nDimension ) const
 
 void CDenseDistr2D::AddDimension()
 {
-	for( unsigned i=0; i<m_vTimePoints.size(); i++ )
-	{
-		UnCacheData(m_vTimePoints[i]);
-		while( m_Data[i-m_nCurrOffset].size() < m_nDimensions+1 )
-			m_Data[i-m_nCurrOffset].push_back( 0 );
-	}
+	++m_nVersion;
+	if( !m_vTimePoints.empty() )
+		UnCacheData( m_vTimePoints.front(), m_vTimePoints.back() );
+	m_Data.emplace_back( GetStoredNumber(), 0 );
 	m_nDimensions++;
 	m_vLabels.resize( m_nDimensions );
 	m_bCacheCoherent = false;
@@ -723,13 +586,12 @@ void CDenseDistr2D::AddDimension()
 
 void CDenseDistr2D::RemoveDimension( unsigned _nIndex )
 {
+	++m_nVersion;
 	if ( _nIndex >= m_nDimensions ) return;
 
-	for (unsigned i=0; i <m_vTimePoints.size(); i++ )
-	{
-		UnCacheData(m_vTimePoints[i]);
-		m_Data[ i-m_nCurrOffset ].erase( m_Data[i-m_nCurrOffset].begin() + _nIndex );
-	}
+	if( !m_vTimePoints.empty() )
+		UnCacheData( m_vTimePoints.front(), m_vTimePoints.back() );
+	m_Data.erase( m_Data.begin() + _nIndex );
 
 	m_vLabels.erase( m_vLabels.begin() + _nIndex );
 	m_nDimensions--;
@@ -757,6 +619,7 @@ void CDenseDistr2D::SetCacheParams( bool _bEnabled, unsigned _nWindow )
 
 void CDenseDistr2D::ExtrapolateToPoint( double _dT1, double _dT2, double _dTExtra )
 {
+	++m_nVersion;
 	UnCacheData( _dT1, _dTExtra );
 
 	std::vector<double> vRes( m_nDimensions );
@@ -765,7 +628,7 @@ void CDenseDistr2D::ExtrapolateToPoint( double _dT1, double _dT2, double _dTExtr
 	{
 		if( m_vTimePoints.size() == 1 )
 		{
-			vRes = m_Data[0];
+			vRes = GetRow( 0 );
 		}
 		else
 		{
@@ -794,6 +657,7 @@ void CDenseDistr2D::ExtrapolateToPoint( double _dT1, double _dT2, double _dTExtr
 
 void CDenseDistr2D::ExtrapolateToPoint( double _dT0, double _dT1, double _dT2, double _dTExtra )
 {
+	++m_nVersion;
 	UnCacheData( _dT0, _dTExtra );
 
 	std::vector<double> vNewVal( m_nDimensions );
@@ -811,7 +675,7 @@ void CDenseDistr2D::ExtrapolateToPoint( double _dT0, double _dT1, double _dT2, d
 		else if( m_vTimePoints.size() == 2 )
 			ExtrapolateToPoint( _dT0, _dT2, _dTExtra );
 		else
-			vNewVal = m_Data[0];
+			vNewVal = GetRow( 0 );
 	}
 
 	SetValue( _dTExtra, vNewVal );
@@ -819,6 +683,12 @@ void CDenseDistr2D::ExtrapolateToPoint( double _dT0, double _dT1, double _dT2, d
 	CheckCacheNeed();
 }
 
+std::unique_lock<std::mutex> CDenseDistr2D::LockForRead() const
+{
+	if( !m_bCacheEnabled ) return {};
+	return std::unique_lock<std::mutex>( m_mutexCache );
+}
+
 void CDenseDistr2D::UnCacheData(double _dTP) const
 {
 	if( !m_bCacheEnabled ) return;
@@ -833,8 +703,9 @@ void CDenseDistr2D::UnCacheData(double _dTP) const
 	//if( ( ( _dTP <= m_dCurrWinStart ) && ( m_nCurrOffset != 0 ) ) || ( _dTP >= m_dCurrWinEnd ) )
 	{
 		FlushToCache();
-		//m_CacheHandler.GetData(_dTP, m_Data, m_dCurrWinStart, m_dCurrWinEnd, m_nCurrOffset);
-		m_pCacheHandler->ReadFromCache(_dTP, m_Data, m_dCurrWinStart, m_dCurrWinEnd, m_nCurrOffset);
+		std::vector<std::vector<double>> vvRows;
+		m_pCacheHandler->ReadFromCache(_dTP, vvRows, m_dCurrWinStart, m_dCurrWinEnd, m_nCurrOffset);
+		SetRows(vvRows);
 		m_bCacheCoherent = true;
 	}
 }
@@ -853,8 +724,9 @@ void CDenseDistr2D::UnCacheData(double _dT1, double _dT2) const
 	//if( ( ( _dT1 <= m_dCurrWinStart ) && ( m_nCurrOffset != 0 ) ) || ( _dT2 >= m_dCurrWinEnd ) )
 	{
 		FlushToCache();
-		//m_CacheHandler.GetData(_dT1, _dT2, m_Data, m_dCurrWinStart, m_dCurrWinEnd, m_nCurrOffset);
-		m_pCacheHandler->ReadFromCache(_dT1, _dT2, m_Data, m_dCurrWinStart, m_dCurrWinEnd, m_nCurrOffset);
+		std::vector<std::vector<double>> vvRows;
+		m_pCacheHandler->ReadFromCache(_dT1, _dT2, vvRows, m_dCurrWinStart, m_dCurrWinEnd, m_nCurrOffset);
+		SetRows(vvRows);
 		m_bCacheCoherent = true;
 	}
 }
@@ -863,7 +735,7 @@ void CDenseDistr2D::CheckCacheNeed()
 {
 	if( !m_bCacheEnabled ) return;
 
-	while( m_Data.size() > m_nCacheWindow*2 )
+	while( GetStoredNumber() > m_nCacheWindow*2 )
 		CacheData();
 }
 
@@ -871,24 +743,23 @@ void CDenseDistr2D::FlushToCache() const
 {
 	if( !m_bCacheEnabled ) return;
 
-	//m_CacheHandler.SaveData(m_Data, m_vTimePoints, m_nCurrOffset, m_Data.size() );
 	if( m_nCurrOffset >= m_vTimePoints.size() ) return;
-	m_pCacheHandler->WriteToCache(m_Data, m_vTimePoints, m_nCurrOffset, m_Data.size(), m_bCacheCoherent );
+	std::vector<std::vector<double>> vvRows = GetRows();
+	m_pCacheHandler->WriteToCache(vvRows, m_vTimePoints, m_nCurrOffset, vvRows.size(), m_bCacheCoherent );
 	m_nCurrOffset = m_vTimePoints.size();
 	m_dCurrWinStart = m_dCurrWinEnd = 0;
-	std::vector<std::vector<double>>(m_Data).swap(m_Data);
+	SetRows( vvRows );
 }
 
 void CDenseDistr2D::CacheData()
 {
 	if( !m_bCacheEnabled ) return;
 
-	//m_CacheHandler.SaveData( m_Data, m_vTimePoints, m_nCurrOffset, m_nCacheWindow );
-	m_pCacheHandler->WriteToCache( m_Data, m_vTimePoints, m_nCurrOffset, m_nCacheWindow, m_bCacheCoherent );
+	std::vector<std::vector<double>> vvRows = GetRows();
+	m_pCacheHandler->WriteToCache( vvRows, m_vTimePoints, m_nCurrOffset, m_nCacheWindow, m_bCacheCoherent );
 	m_nCurrOffset += m_nCacheWindow;
 	m_dCurrWinStart = m_vTimePoints[m_nCurrOffset];
-	//m_dCurrWinEnd = m_vTimePoints[m_nCurrOffset+m_nCacheWindow];
-	std::vector<std::vector<double>>(m_Data).swap(m_Data);
+	SetRows( vvRows );
 }
 
 void CDenseDistr2D::CorrectWinBoundary()
@@ -905,10 +776,10 @@ void CDenseDistr2D::CorrectWinBoundary()
 		if( m_dCurrWinStart < m_vTimePoints[ m_nCurrOffset ] )
 			m_dCurrWinStart = m_vTimePoints[ m_nCurrOffset ];*/
 
-		if( m_nCurrOffset < m_vTimePoints.size() )
+		if( ( m_nCurrOffset < m_vTimePoints.size() ) && ( GetStoredNumber() != 0 ) )
 		{
-			if( m_dCurrWinEnd > m_vTimePoints[ m_nCurrOffset + m_Data.size() - 1 ] )
-				m_dCurrWinEnd = m_vTimePoints[ m_nCurrOffset + m_Data.size() - 1 ];
+			if( m_dCurrWinEnd > m_vTimePoints[ m_nCurrOffset + GetStoredNumber() - 1 ] )
+				m_dCurrWinEnd = m_vTimePoints[ m_nCurrOffset + GetStoredNumber() - 1 ];
 			if( m_dCurrWinStart < m_vTimePoints[ m_nCurrOffset ] )
 				m_dCurrWinStart = m_vTimePoints[ m_nCurrOffset ];
 		}
@@ -950,19 +821,55 @@ unsigned CDenseDistr2D::GetDimensionsNumber() const
 	return m_nDimensions;
 }
 
-size_t CDenseDistr2D::GetIndexByTime(double _dTime)
+size_t CDenseDistr2D::GetIndexByTime(double _dTime) const
 {
-	// binary search
-	size_t nFirst = 0;
-	size_t nLast = m_vTimePoints.size();
-	size_t nMid = (size_t)(nFirst + nLast) >> 1;
-	while( nFirst < nLast )
-	{
-		if ( _dTime <= m_vTimePoints[nMid] )
-			nLast = nMid;
-		else
-			nFirst = nMid + 1;
-		nMid = (size_t)(nFirst + nLast) >> 1;
-	}
-	return nLast;
+	return std::lower_bound(m_vTimePoints.begin(), m_vTimePoints.end(), _dTime) - m_vTimePoints.begin();
+}
+
+void CDenseDistr2D::GetInterval(double _dTime, size_t& _iLeft, size_t& _iRight) const
+{
+	_iRight = GetIndexByTime(_dTime);
+	if (_iRight == m_vTimePoints.size())								// point is after the last - take the last
+		_iLeft = --_iRight;
+	else if (_iRight == 0 || m_vTimePoints[_iRight] == _dTime)	// point at the beginning or exact time point
+		_iLeft = _iRight;
+	else															// point inside - interpolation
+		_iLeft = _iRight - 1;
+}
+
+size_t CDenseDistr2D::GetStoredNumber() const
+{
+	// without dimensions there are no data, so all not cached time points are considered as stored
+	return m_Data.empty() ? m_vTimePoints.size() - m_nCurrOffset : m_Data.front().size();
+}
+
+std::vector<double> CDenseDistr2D::GetRow(size_t _iStored) const
+{
+	std::vector<double> vRes(m_nDimensions);
+	for (size_t i = 0; i < m_nDimensions; ++i)
+		vRes[i] = m_Data[i][_iStored];
+	return vRes;
+}
+
+void CDenseDistr2D::InsertRow(size_t _iStored, const std::vector<double>& _vValues)
+{
+	for (size_t i = 0; i < m_nDimensions; ++i)
+		m_Data[i].insert(m_Data[i].begin() + _iStored, _vValues[i]);
+}
+
+std::vector<std::vector<double>> CDenseDistr2D::GetRows() const
+{
+	std::vector<std::vector<double>> vvRows(GetStoredNumber(), std::vector<double>(m_nDimensions));
+	for (size_t i = 0; i < m_nDimensions; ++i)
+		for (size_t j = 0; j < vvRows.size(); ++j)
+			vvRows[j][i] = m_Data[i][j];
+	return vvRows;
+}
+
+void CDenseDistr2D::SetRows(const std::vector<std::vector<double>>& _vvRows) const
+{
+	m_Data.assign(m_nDimensions, std::vector<double>(_vvRows.size()));
+	for (size_t j = 0; j < _vvRows.size(); ++j)
+		for (size_t i = 0; i < m_nDimensions && i < _vvRows[j].size(); ++i)
+			m_Data[i][j] = _vvRows[j][i];
 }
@@ -4,9 +4,11 @@
 
 #include "H5Handler.h"
 #include "DenseDistrCacher.h"
+#include <mutex>
 
 /** This class is used to describe time dependent distribution of one-dimensional parameter.
- *	Finally data is stored in two dimensional array. Time points are stored separately in vector.*/
+ *	Finally data is stored in two dimensional array column-wise: one contiguous vector of values over time for each dimension. Time points are stored separately in vector.
+ *	All const functions can be called concurrently from several threads, as long as no modifying function is called at the same time.*/
 class CDenseDistr2D
 {
 private:
@@ -14,7 +16,7 @@ private:
 
 	unsigned m_nDimensions;
 	std::vector<double> m_vTimePoints; // the time points
-	mutable std::vector<std::vector<double>> m_Data; // data itself
+	mutable std::vector<std::vector<double>> m_Data; // data itself: [dimension][time point - m_nCurrOffset]
 	//unsigned m_nLastTimePos; // last used index
 	std::vector<std::string> m_vLabels;
 
@@ -26,6 +28,8 @@ private:
 	mutable size_t m_nCurrOffset;
 	unsigned m_nCacheWindow;
 	mutable bool m_bCacheCoherent;
+	mutable std::mutex m_mutexCache; // serializes reading functions if cache is enabled, since they may reload data from cache
+	size_t m_nVersion{ 0 }; // incremented by each modifying function
 
 public:
 	CDenseDistr2D(unsigned _nDimensions = 0);
@@ -37,6 +41,7 @@ public:
 	void RemoveTimePoint( double _dTimePoint ); // deletes specified time point
 	void RemoveTimePoints( double _dStart, double _dEnd ); // removes data from interval
 	void RemoveTimePoints(const std::vector<unsigned>& _vIndexes); // removes values of specified indexes - _vTimePoints. _vTimePoints array in ascending order
+	void RemoveTimePoints(const std::vector<double>& _vTimes); // removes specified time points in one pass. _vTimes array in ascending order, not existing time points are ignored
 	// Removes all data after the specified time point.
 	void RemoveAllDataAfter(double _dStartTime, bool _bIncludeStartTime = false);
 	void ChangeTimePoint( unsigned _nTimePointIndex, double _dNewValue ); // changes specified time point
@@ -44,6 +49,7 @@ public:
 
 	size_t GetTimePointsNumber() const;
 	std::vector<double> GetAllTimePoints() const;
+	size_t GetVersion() const; // returns a number, which changes each time the data is modified
 	// returns indexes of all time points which are situated in this time interval
 	std::vector<unsigned> GetIndexesForInterval( double _dStartTime, double _dEndTime );
 	std::vector<double> GetValueForIndex( unsigned _nIndex ) const;
@@ -51,14 +57,18 @@ public:
 	double GetTimeForIndex(unsigned _nIndex) const;
 	// returns value for specific time point, and for specific property of this dimensions
 	double GetValue( double _dTime, size_t _nDimension ) const;
-	std::vector<double> GetValues(std::vector<double> _vTimes, unsigned _nDimension) const;
+	std::vector<double> GetValues(const std::vector<double>& _vTimes, unsigned _nDimension) const;
 	// Returns vector of values defined for the specified time pointy (or interpolated). If the distribution is empty, returns vector of zeros with the proper size.
 	std::vector<double> GetValue(double _dTime) const;
+	// Writes values defined for the specified time point (or interpolated) into _vResult, reusing its memory. If the distribution is empty, fills it with zeros.
+	void GetValue(double _dTime, std::vector<double>& _vResult) const;
 
 	//***  SETS NEW VALUE of distributed property.
 	void SetValue(double _dT, const std::vector<double>& _newValue);
 	void SetValue( unsigned _nTimeIndex, unsigned _nPropIndex, double _dNewValue );
 	void SetValue( double _dTime, unsigned _nPropIndex, double _dNewValue );
+	// Sets values of the specified dimension for all time points at once. The size of _vValues must be equal to the number of time points.
+	void SetValues(unsigned _nDimension, const std::vector<double>& _vValues);
 
 	//void SaveToFile(std::string _sFileName);
 	//void LoadFromFile(std::string _sFileName);
@@ -95,6 +105,8 @@ public:
 	void ExtrapolateToPoint( double _dT0, double _dT1, double _dT2, double _dTExtra );
 
 private:
+	// Returns a lock, which must be held by reading functions while they access data. Acquired only if cache is enabled.
+	std::unique_lock<std::mutex> LockForRead() const;
 	void UnCacheData(double _dTP) const;
 	void UnCacheData(double _dT1, double _dT2) const;
 	void FlushToCache() const;
@@ -104,5 +116,18 @@ private:
 	void ClearCache() const;
 
 	/** Returns index of the time point with value _dTime. Returns index to paste if there is no such time point.*/
-	size_t GetIndexByTime(double _dTime);
+	size_t GetIndexByTime(double _dTime) const;
+	/** Returns indexes of time points to interpolate between for _dTime. Both are equal for existing time points and outside the defined interval.*/
+	void GetInterval(double _dTime, size_t& _iLeft, size_t& _iRight) const;
+
+	/** Returns the number of time points currently held in memory.*/
+	size_t GetStoredNumber() const;
+	/** Returns values of all dimensions for the time point with the specified in-memory index.*/
+	std::vector<double> GetRow(size_t _iStored) const;
+	/** Inserts values of all dimensions for a new time point at the specified in-memory index.*/
+	void InsertRow(size_t _iStored, const std::vector<double>& _vValues);
+	/** Converts in-memory data into the row-wise layout [time point][dimension], used by cache and files.*/
+	std::vector<std::vector<double>> GetRows() const;
+	/** Sets in-memory data from the row-wise layout [time point][dimension].*/
+	void SetRows(const std::vector<std::vector<double>>& _vvRows) const;
 };
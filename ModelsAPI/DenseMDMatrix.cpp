@@ -2,7 +2,7 @@
 
 #include "DenseMDMatrix.h"
 #include "DyssolUtilities.h"
-#include <functional>
+#include <algorithm>
 
 CDenseMDMatrix::CDenseMDMatrix()
 {
@@ -95,6 +95,18 @@ size_t CDenseMDMatrix::GetDataLength() const
 	return m_vData.size();
 }
 
+size_t CDenseMDMatrix::GetStride(unsigned _nDim) const
+{
+	size_t stride = 1;
+	for (size_t i = 0; i < m_vDimensions.size(); ++i)
+	{
+		if (m_vDimensions[i] == _nDim)
+			return stride;
+		stride *= m_vClasses[i];
+	}
+	return -1;
+}
+
 double CDenseMDMatrix::GetValue(unsigned _nDim, unsigned _nCoord) const
 {
 	return GetValue(std::vector<unsigned>{_nDim}, std::vector<unsigned>{_nCoord});
@@ -119,7 +131,10 @@ double CDenseMDMatrix::GetValue(const std::vector<unsigned>& _vDims, const std::
 {
 	if (_vDims.size() > m_vDimensions.size())	return -1; // _vDims has wrong size
 	if (_vDims.size() != _vCoords.size())		return -1; // wrong size of _vDims or _vCoords
-	return GetValueRecursive(_vDims, _vCoords);
+	std::vector<double> vRes;
+	if (!Reduce(_vDims, _vCoords, vRes))
+		return 0;
+	return vRes.front();
 }
 
 std::vector<double> CDenseMDMatrix::GetVectorValue(unsigned _nDim) const
@@ -158,7 +173,7 @@ bool CDenseMDMatrix::GetVectorValue(const std::vector<unsigned>& _vDims, const s
 {
 	if( _vDims.size() > m_vDimensions.size() )	return false;	// _vDimType has wrong size
 	if (_vDims.size() != _vCoords.size() + 1)	return false;	// _vCoord has wrong size
-	return GetVectorValueRecursive(_vDims, _vCoords, _vResult);
+	return Reduce(_vDims, _vCoords, _vResult);
 }
 
 std::vector<double> CDenseMDMatrix::GetVectorValue(const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords) const
@@ -166,7 +181,7 @@ std::vector<double> CDenseMDMatrix::GetVectorValue(const std::vector<unsigned>&
 	if (_vDims.size() > m_vDimensions.size())	return {};	// _vDimType has wrong size
 	if (_vDims.size() != _vCoords.size() + 1)	return {};	// _vCoord has wrong size
 	std::vector<double> res;
-	const bool success = GetVectorValueRecursive(_vDims, _vCoords, res);
+	const bool success = Reduce(_vDims, _vCoords, res);
 	if (!success) return {};
 	return res;
 }
@@ -390,144 +405,188 @@ bool CDenseMDMatrix::GetIndexAndStep(const std::vector<unsigned>& _vDims, const
 	return true;
 }
 
-double CDenseMDMatrix::GetValueRecursive(std::vector<unsigned> _vDims, std::vector<unsigned> _vCoords) const
+bool CDenseMDMatrix::IsSameShape(const CDenseMDMatrix& _matrix) const
+{
+	return m_vDimensions == _matrix.m_vDimensions && m_vClasses == _matrix.m_vClasses;
+}
+
+bool CDenseMDMatrix::Reduce(const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords, std::vector<double>& _vResult) const
 {
-	if (_vDims.size() < m_vDimensions.size() - 1) // add dimension and call GetValueRecursive for each class recursively
+	const size_t nDims = m_vDimensions.size();
+
+	// positions of requested dimensions in m_vDimensions
+	std::vector<size_t> vPos(_vDims.size());
+	for (size_t i = 0; i < _vDims.size(); ++i)
 	{
-		size_t index = 0;
-		for (size_t i = 0; i < m_vDimensions.size(); ++i)
-		{
-			std::vector<unsigned>::iterator res = std::find(_vDims.begin(), _vDims.end(), m_vDimensions.at(i));
-			if (res == _vDims.end())
-			{
-				_vDims.push_back(m_vDimensions[i]);
-				index = i;
-				break;
-			}
-		}
-		double dRes = 0;
-		_vCoords.push_back(0);
-		for (unsigned i = 0; i < m_vClasses[index]; ++i)
-		{
-			dRes += GetValueRecursive(_vDims, _vCoords);
-			_vCoords.back()++;
-		}
-		return dRes;
+		vPos[i] = std::find(m_vDimensions.begin(), m_vDimensions.end(), _vDims[i]) - m_vDimensions.begin();
+		if (vPos[i] == nDims) return false;											// no such dimension
+		if (i < _vCoords.size() && _vCoords[i] >= m_vClasses[vPos[i]]) return false;	// wrong coordinate
 	}
-	else if (_vDims.size() == m_vDimensions.size() - 1) // add dim and return sum of the vector
+	const size_t iVecPos = _vDims.size() == _vCoords.size() + 1 ? vPos.back() : nDims;
+
+	// strides of all dimensions and offset of fixed coordinates
+	std::vector<size_t> vStrides(nDims);
+	size_t stride = 1;
+	for (size_t i = 0; i < nDims; ++i)
 	{
-		for (size_t i = 0; i < m_vDimensions.size(); ++i)
-		{
-			std::vector<unsigned>::iterator res = std::find(_vDims.begin(), _vDims.end(), m_vDimensions[i]);
-			if (res == _vDims.end())
-			{
-				_vDims.push_back(m_vDimensions[i]);
-				break;
-			}
-		}
-		std::vector<double> vRes;
-		if (!GetVectorValue(_vDims, _vCoords, vRes))
-			return 0;
-		double dRes = 0;
-		for (size_t i = 0; i < vRes.size(); ++i)
-			dRes += vRes[i];
-		return dRes;
+		vStrides[i] = stride;
+		stride *= m_vClasses[i];
 	}
-	else if (_vDims.size() == m_vDimensions.size()) // just return the value
+	size_t offset = 0;
+	for (size_t i = 0; i < _vCoords.size(); ++i)
+		offset += _vCoords[i] * vStrides[vPos[i]];
+
+	// dimensions to loop over: the resulting one and all not listed in _vDims, ordered by increasing stride
+	std::vector<size_t> vLoop;
+	for (size_t i = 0; i < nDims; ++i)
+		if (i == iVecPos || std::find(vPos.begin(), vPos.end(), i) == vPos.end())
+			vLoop.push_back(i);
+
+	_vResult.assign(iVecPos != nDims ? m_vClasses[iVecPos] : 1, 0.);
+	if (vLoop.empty()) // all coordinates are fixed
 	{
-		size_t index = GetIndex(_vDims, _vCoords);
-		if ((index != -1) && (index < m_vData.size()))
-			return m_vData[index];
+		_vResult.front() = m_vData[offset];
+		return true;
 	}
-	return 0;
-}
 
-bool CDenseMDMatrix::GetVectorValueRecursive(std::vector<unsigned> _vDims, std::vector<unsigned> _vCoords, std::vector<double>& _pResult) const
-{
-	if( _vDims.size() < m_vDimensions.size() ) // add dimension and call GetVectorValueRecursive for each class recursively
+	// the innermost loop goes over the dimension with the smallest stride, others are iterated with coordinates
+	const size_t iInner = vLoop.front();
+	const size_t nInner = m_vClasses[iInner];
+	const size_t nInnerStride = vStrides[iInner];
+	std::vector<unsigned> vOuterClasses;
+	for (size_t k = 1; k < vLoop.size(); ++k)
+		vOuterClasses.push_back(m_vClasses[vLoop[k]]);
+	std::vector<unsigned> vOuterCoords(vOuterClasses.size(), 0);
+	do
 	{
-		// find index of dimension that corresponds to a last element of _vDims
-		size_t index = 0;
-		for(size_t i=0; i<m_vDimensions.size(); ++i )
-			if( m_vDimensions[i] == _vDims.back() )
-			{
-				index = i;
-				break;
-			}
-
-		for(size_t i=0; i<m_vDimensions.size(); ++i )
+		size_t index = offset;
+		size_t iRes = 0;
+		for (size_t k = 0; k < vOuterCoords.size(); ++k)
 		{
-			std::vector<unsigned>::iterator res = std::find( _vDims.begin(), _vDims.end(), m_vDimensions[i] );
-			if( res == _vDims.end() )
-			{
-				_vDims.push_back( m_vDimensions[i] );
-				break;
-			}
+			index += vOuterCoords[k] * vStrides[vLoop[k + 1]];
+			if (vLoop[k + 1] == iVecPos)
+				iRes = vOuterCoords[k];
 		}
-		_vCoords.push_back( 0 );
-		_pResult.clear();
-		for(size_t i=0; i<m_vClasses[index]; ++i )
+		const double* pData = m_vData.data() + index;
+		if (iInner == iVecPos)
+			for (size_t i = 0; i < nInner; ++i)
+				_vResult[i] += pData[i * nInnerStride];
+		else
 		{
-			std::vector<double> vTemp;
-			_pResult.push_back( 0 );
-			if( GetVectorValueRecursive( _vDims, _vCoords, vTemp ) )
-				for(size_t j=0; j<vTemp.size(); ++j )
-					_pResult.back() += vTemp[j];
-			_vCoords.back()++;
+			double dSum = 0;
+			for (size_t i = 0; i < nInner; ++i)
+				dSum += pData[i * nInnerStride];
+			_vResult[iRes] += dSum;
 		}
-		return true;
 	}
-	else if( _vDims.size() == m_vDimensions.size() ) // just return the vector value
-	{
-		size_t index;
-		size_t nStep;
-		size_t nVecLength;
-		if( !GetIndexAndStep( _vDims, _vCoords, &index, &nStep, &nVecLength ) )
-			return false;
-		_pResult.resize( nVecLength );
-		for (size_t i = 0; i < nVecLength; ++i)
-			if( index < m_vData.size() )
-			{
-				_pResult[i] = m_vData[index];
-				index += nStep;
-			}
-		return true;
-	}
-	return false;
+	while (IncrementCoords(vOuterCoords, vOuterClasses));
+
+	return true;
 }
 
-CDenseMDMatrix CDenseMDMatrix::operator+(const CDenseMDMatrix& _matrix)
+CDenseMDMatrix CDenseMDMatrix::operator+(const CDenseMDMatrix& _matrix) const
 {
-	if (m_vDimensions.size() != _matrix.m_vDimensions.size())
+	if (!IsSameShape(_matrix))
 		return CDenseMDMatrix();
-	for (size_t i = 0; i < m_vDimensions.size(); ++i)
-		if ((m_vDimensions[i] != _matrix.m_vDimensions[i]) || (m_vClasses[i] != _matrix.m_vClasses[i]))
-			return CDenseMDMatrix();
-
-	CDenseMDMatrix sum;
-	sum.SetDimensions(m_vDimensions, m_vClasses);
-	std::transform(m_vData.begin(), m_vData.end(), _matrix.m_vData.begin(), sum.m_vData.begin(), std::plus<>());
+	CDenseMDMatrix sum(*this);
+	sum += _matrix;
 	return sum;
 }
 
-CDenseMDMatrix CDenseMDMatrix::operator-(const CDenseMDMatrix& _matrix)
+CDenseMDMatrix CDenseMDMatrix::operator-(const CDenseMDMatrix& _matrix) const
 {
-	if (m_vDimensions.size() != _matrix.m_vDimensions.size())
+	if (!IsSameShape(_matrix))
 		return CDenseMDMatrix();
-	for (unsigned i = 0; i < m_vDimensions.size(); ++i)
-		if ((m_vDimensions[i] != _matrix.m_vDimensions[i]) || (m_vClasses[i] != _matrix.m_vClasses[i]))
-			return CDenseMDMatrix();
-
-	CDenseMDMatrix diff;
-	diff.SetDimensions(m_vDimensions, m_vClasses);
-	std::transform(m_vData.begin(), m_vData.end(), _matrix.m_vData.begin(), diff.m_vData.begin(), std::minus<>());
+	CDenseMDMatrix diff(*this);
+	diff -= _matrix;
 	return diff;
 }
 
-CDenseMDMatrix CDenseMDMatrix::operator*(double _dFactor)
+CDenseMDMatrix CDenseMDMatrix::operator*(double _dFactor) const
 {
-	CDenseMDMatrix prod;
-	prod.SetDimensions(m_vDimensions, m_vClasses);
-	std::transform(m_vData.begin(), m_vData.end(), prod.m_vData.begin(), [_dFactor](const double v) { return v * _dFactor; });
+	CDenseMDMatrix prod(*this);
+	prod *= _dFactor;
 	return prod;
 }
+
+CDenseMDMatrix& CDenseMDMatrix::operator+=(const CDenseMDMatrix& _matrix)
+{
+	AddScaled(_matrix, 1.);
+	return *this;
+}
+
+CDenseMDMatrix& CDenseMDMatrix::operator-=(const CDenseMDMatrix& _matrix)
+{
+	AddScaled(_matrix, -1.);
+	return *this;
+}
+
+CDenseMDMatrix& CDenseMDMatrix::operator*=(double _dFactor)
+{
+	double* pData = m_vData.data();
+	const size_t nSize = m_vData.size();
+	for (size_t i = 0; i < nSize; ++i)
+		pData[i] *= _dFactor;
+	return *this;
+}
+
+bool CDenseMDMatrix::AddScaled(const CDenseMDMatrix& _matrix, double _dFactor)
+{
+	if (!IsSameShape(_matrix))
+		return false;
+	double* pDst = m_vData.data();
+	const double* pSrc = _matrix.m_vData.data();
+	const size_t nSize = m_vData.size();
+	for (size_t i = 0; i < nSize; ++i)
+		pDst[i] += _dFactor * pSrc[i];
+	return true;
+}
+
+bool CDenseMDMatrix::SetLinearCombination(double _dFactor1, const CDenseMDMatrix& _matrix1, double _dFactor2, const CDenseMDMatrix& _matrix2)
+{
+	if (!_matrix1.IsSameShape(_matrix2))
+		return false;
+	if (!IsSameShape(_matrix1))
+	{
+		m_vDimensions = _matrix1.m_vDimensions;
+		m_vClasses = _matrix1.m_vClasses;
+		m_vData.resize(_matrix1.m_vData.size());
+	}
+	double* pDst = m_vData.data();
+	const double* pSrc1 = _matrix1.m_vData.data();
+	const double* pSrc2 = _matrix2.m_vData.data();
+	const size_t nSize = m_vData.size();
+	for (size_t i = 0; i < nSize; ++i)
+		pDst[i] = pSrc1[i] * _dFactor1 + pSrc2[i] * _dFactor2;
+	return true;
+}
+
+bool CDenseMDMatrix::SetLinearCombination(double _dFactor1, double _dScale1, const CDenseMDMatrix& _matrix1, double _dFactor2, double _dScale2, const CDenseMDMatrix& _matrix2)
+{
+	if (!_matrix1.IsSameShape(_matrix2))
+		return false;
+	if (!IsSameShape(_matrix1))
+	{
+		m_vDimensions = _matrix1.m_vDimensions;
+		m_vClasses = _matrix1.m_vClasses;
+		m_vData.resize(_matrix1.m_vData.size());
+	}
+	double* pDst = m_vData.data();
+	const double* pSrc1 = _matrix1.m_vData.data();
+	const double* pSrc2 = _matrix2.m_vData.data();
+	const size_t nSize = m_vData.size();
+	// scaling factors are applied one after another, not multiplied beforehand, to keep the rounding of the sequential evaluation
+	for (size_t i = 0; i < nSize; ++i)
+		pDst[i] = pSrc1[i] * _dFactor1 * _dScale1 + pSrc2[i] * _dFactor2 * _dScale2;
+	return true;
+}
+
+double CDenseMDMatrix::Sum() const
+{
+	const double* pData = m_vData.data();
+	const size_t nSize = m_vData.size();
+	double dSum = 0;
+	for (size_t i = 0; i < nSize; ++i)
+		dSum += pData[i];
+	return dSum;
+}
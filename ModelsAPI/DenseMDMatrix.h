@@ -46,6 +46,9 @@ public:
 
 	/** Returns length of the plain array m_vData*/
 	size_t GetDataLength() const;
+	/** Returns distance between neighbor classes of the specified dimension in the plain array m_vData. The first dimension changes fastest.
+	*	Returns -1 if the dimension is not defined.*/
+	size_t GetStride(unsigned _nDim) const;
 
 	// ============= Data GETTERS
 
@@ -114,11 +117,31 @@ public:
 	// ========== Overloaded operators
 
 	/** Adds matrix with the same dimensions. If dimensions are not the same, than the empty matrix will be returned.*/
-	CDenseMDMatrix operator+( const CDenseMDMatrix& _matrix );
+	CDenseMDMatrix operator+( const CDenseMDMatrix& _matrix ) const;
 	/** Subtracts matrix with the same dimensions. If dimensions are not the same, than the empty matrix will be returned.*/
-	CDenseMDMatrix operator-( const CDenseMDMatrix& _matrix );
+	CDenseMDMatrix operator-( const CDenseMDMatrix& _matrix ) const;
 	/** Multiplication of the matrix by a coefficient.*/
-	CDenseMDMatrix operator*( double _dFactor );
+	CDenseMDMatrix operator*( double _dFactor ) const;
+	/** Adds matrix with the same dimensions in place. If dimensions are not the same, the matrix remains unchanged.*/
+	CDenseMDMatrix& operator+=( const CDenseMDMatrix& _matrix );
+	/** Subtracts matrix with the same dimensions in place. If dimensions are not the same, the matrix remains unchanged.*/
+	CDenseMDMatrix& operator-=( const CDenseMDMatrix& _matrix );
+	/** Multiplies the matrix by a coefficient in place.*/
+	CDenseMDMatrix& operator*=( double _dFactor );
+
+	// ========== In-place kernels
+
+	/** Adds matrix with the same dimensions multiplied by a coefficient: this += _dFactor * _matrix. Returns false if dimensions are not the same.*/
+	bool AddScaled( const CDenseMDMatrix& _matrix, double _dFactor );
+	/** Sets the matrix to a linear combination of two matrices with the same dimensions: this = _dFactor1 * _matrix1 + _dFactor2 * _matrix2.
+	*	Does not allocate memory if dimensions of this matrix are already the same. Returns false if dimensions of the matrices are not the same.*/
+	bool SetLinearCombination( double _dFactor1, const CDenseMDMatrix& _matrix1, double _dFactor2, const CDenseMDMatrix& _matrix2 );
+	/** Sets the matrix to a linear combination of two matrices with the same dimensions, each of them scaled by two coefficients one after another:
+	*	this = (_matrix1 * _dFactor1) * _dScale1 + (_matrix2 * _dFactor2) * _dScale2. Gives the same rounding as the equivalent expression with operators.
+	*	Does not allocate memory if dimensions of this matrix are already the same. Returns false if dimensions of the matrices are not the same.*/
+	bool SetLinearCombination( double _dFactor1, double _dScale1, const CDenseMDMatrix& _matrix1, double _dFactor2, double _dScale2, const CDenseMDMatrix& _matrix2 );
+	/** Returns sum of all values in the matrix.*/
+	double Sum() const;
 
 
 private:
@@ -132,10 +155,12 @@ private:
 		in _pResStep will be offset between values in m_vData to work with vector, in _pResVecLength - length of the result vector.*/
 	bool GetIndexAndStep(const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords, size_t* _pResIndex, size_t* _pResStep, size_t* _pResVecLength) const;
 
-	/** Returns value by specified dimension and coordinate. Doesn't check sizes of dimensions and coordinates in parameters.
-	*	Returns 0 if there is no such combination of dimensions and coordinates.*/
-	double GetValueRecursive( std::vector<unsigned> _vDims, std::vector<unsigned> _vCoords ) const;
-	/** Returns vector value by specified dimension and coordinate. Doesn't check sizes of dimensions and coordinates in parameters.
+	/** Returns true if the matrix has the same dimensions and classes as the given one.*/
+	bool IsSameShape( const CDenseMDMatrix& _matrix ) const;
+
+	/** Sums values over all dimensions, which are not listed in _vDims, for coordinates _vCoords of dimensions _vDims.
+	*	If _vDims contains one more element than _vCoords, returns a vector of sums over the classes of the last dimension in _vDims, otherwise - a single sum.
+	*	Walks through m_vData using strides of dimensions, with the innermost loop over the dimension with the smallest stride.
 	*	Returns false if there is no such combination of dimensions and coordinates.*/
-	bool GetVectorValueRecursive( std::vector<unsigned> _vDims, std::vector<unsigned> _vCoords, std::vector<double>& _pResult ) const;
+	bool Reduce( const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords, std::vector<double>& _vResult ) const;
 };
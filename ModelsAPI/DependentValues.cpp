@@ -1,152 +1,195 @@
 /* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
 
 #include "DependentValues.h"
+#include <algorithm>
 #include <ostream>
 
 bool CDependentValues::empty() const
 {
-	return m_data.empty();
+	return m_params.empty();
 }
 
 size_t CDependentValues::size() const
 {
-	return m_data.size();
+	return m_params.size();
 }
 
-std::map<double, double>::iterator CDependentValues::begin()
+CDependentValues::const_iterator CDependentValues::begin() const
 {
-	return m_data.begin();
+	return { m_params.data(), m_values.data() };
 }
 
-std::map<double, double>::const_iterator CDependentValues::begin() const
+CDependentValues::const_iterator CDependentValues::end() const
 {
-	return m_data.begin();
-}
-
-std::map<double, double>::iterator CDependentValues::end()
-{
-	return m_data.end();
-}
-
-std::map<double, double>::const_iterator CDependentValues::end() const
-{
-	return m_data.end();
+	return { m_params.data() + m_params.size(), m_values.data() + m_values.size() };
 }
 
 std::pair<double, double> CDependentValues::front()
 {
-	return *m_data.begin();
+	return { m_params.front(), m_values.front() };
 }
 
 std::pair<double, double> CDependentValues::front() const
 {
-	return *m_data.begin();
+	return { m_params.front(), m_values.front() };
 }
 
 std::pair<double, double> CDependentValues::back()
 {
-	return *m_data.rbegin();
+	return { m_params.back(), m_values.back() };
 }
 
 std::pair<double, double> CDependentValues::back() const
 {
-	return *m_data.rbegin();
+	return { m_params.back(), m_values.back() };
 }
 
 double CDependentValues::GetValue(double _param) const
 {
-	if (m_data.empty()) return 0;							// return zero, if there are no data at all
-	if (m_data.size() == 1) return m_data.begin()->second;	// return const value, if there is only a single value defined
-	return Interpolate(_param);								// return interpolation otherwise
+	return Interpolate(m_params, m_values, _param);
+}
+
+std::vector<double> CDependentValues::GetValues(const std::vector<double>& _params) const
+{
+	return Interpolate(m_params, m_values, _params);
 }
 
 void CDependentValues::SetValue(double _param, double _value)
 {
-	m_data.insert_or_assign(_param, _value);
+	const auto it = std::lower_bound(m_params.begin(), m_params.end(), _param);
+	const auto pos = std::distance(m_params.begin(), it);
+	if (it != m_params.end() && *it == _param)
+		m_values[pos] = _value;
+	else
+	{
+		m_params.insert(it, _param);
+		m_values.insert(m_values.begin() + pos, _value);
+	}
 }
 
 void CDependentValues::RemoveValue(double _param)
 {
-	m_data.erase(_param);
+	const auto it = std::lower_bound(m_params.begin(), m_params.end(), _param);
+	if (it == m_params.end() || *it != _param) return;
+	RemovePairAt(std::distance(m_params.begin(), it));
 }
 
 double CDependentValues::GetParamAt(size_t _index) const
 {
-	return GetPairAt(_index).first;
+	if (_index >= m_params.size()) return 0;
+	return m_params[_index];
 }
 
 double CDependentValues::GetValueAt(size_t _index) const
 {
-	return GetPairAt(_index).second;
+	if (_index >= m_values.size()) return 0;
+	return m_values[_index];
 }
 
 std::pair<double, double> CDependentValues::GetPairAt(size_t _index) const
 {
-	if (_index >= m_data.size()) return { 0, 0 };
-	auto it = m_data.begin();
-	std::advance(it, _index);
-	return *it;
+	if (_index >= m_params.size()) return { 0, 0 };
+	return { m_params[_index], m_values[_index] };
 }
 
 void CDependentValues::RemovePairAt(size_t _index)
 {
-	if (_index >= m_data.size()) return;
-	auto it = m_data.begin();
-	std::advance(it, _index);
-	m_data.erase(it);
+	if (_index >= m_params.size()) return;
+	m_params.erase(m_params.begin() + _index);
+	m_values.erase(m_values.begin() + _index);
 }
 
 std::vector<double> CDependentValues::GetParamsList() const
 {
-	std::vector<double> res;
-	for (const auto& pair : m_data)
-		res.push_back(pair.first);
-	return res;
+	return m_params;
 }
 
 std::vector<double> CDependentValues::GetValuesList() const
 {
-	std::vector<double> res;
-	for (const auto& pair : m_data)
-		res.push_back(pair.second);
-	return res;
+	return m_values;
 }
 
 bool CDependentValues::IsDefined(double _param)
 {
-	return m_data.find(_param) != m_data.end();
+	return std::binary_search(m_params.begin(), m_params.end(), _param);
 }
 
 void CDependentValues::clear()
 {
-	m_data.clear();
+	m_params.clear();
+	m_values.clear();
 }
 
 bool CDependentValues::operator==(const CDependentValues& _v) const
 {
-	return m_data == _v.m_data;
+	return m_params == _v.m_params && m_values == _v.m_values;
+}
+
+double CDependentValues::Interpolate(const std::vector<double>& _params, const std::vector<double>& _values, double _param)
+{
+	const size_t size = _params.size();
+	if (size == 0) return 0;					// return zero, if there are no data at all
+	if (size == 1) return _values.front();		// return const value, if there is only a single value defined
+
+	const size_t i = LastNotGreater(_params, _param);
+	if (_param < _params.front())	return _values.front();	// nearest-neighbor extrapolation to the left
+	if (i == size - 1)				return _values.back();	// nearest-neighbor extrapolation to the right
+
+	return (_values[i + 1] - _values[i]) / (_params[i + 1] - _params[i]) * (_param - _params[i]) + _values[i]; // linearly interpolated value
+}
+
+std::vector<double> CDependentValues::Interpolate(const std::vector<double>& _params, const std::vector<double>& _values, const std::vector<double>& _queries)
+{
+	const size_t size = _params.size();
+	if (size == 0) return std::vector<double>(_queries.size(), 0);				// return zeros, if there are no data at all
+	if (size == 1) return std::vector<double>(_queries.size(), _values.front());	// return const values, if there is only a single value defined
+
+	// find intervals: for sorted queries continue linear search from the previous interval, use binary search otherwise
+	std::vector<size_t> vIntervals(_queries.size());
+	size_t i = 0;
+	for (size_t k = 0; k < _queries.size(); ++k)
+	{
+		if (k != 0 && _queries[k] >= _queries[k - 1])
+			while (i + 1 < size && _params[i + 1] <= _queries[k])
+				++i;
+		else
+			i = LastNotGreater(_params, _queries[k]);
+		vIntervals[k] = i;
+	}
+
+	// interpolate without branches in the same way as for a single value, so that the loop can be vectorized
+	std::vector<double> res(_queries.size());
+	const double* x = _params.data();
+	const double* y = _values.data();
+	for (size_t k = 0; k < _queries.size(); ++k)
+	{
+		const double q = _queries[k];
+		const size_t j = std::min(vIntervals[k], size - 2);
+		const double interpolated = (y[j + 1] - y[j]) / (x[j + 1] - x[j]) * (q - x[j]) + y[j];
+		const double extrapolated = q < x[0] ? y[0] : y[size - 1];
+		res[k] = q < x[0] || vIntervals[k] == size - 1 ? extrapolated : interpolated;
+	}
+	return res;
 }
 
-double CDependentValues::Interpolate(double _param) const
+size_t CDependentValues::LastNotGreater(const std::vector<double>& _params, double _param)
 {
-	auto upper = m_data.upper_bound(_param);
-	if (upper == m_data.end())		return (--upper)->second;	// nearest-neighbor extrapolation to the right
-	if (upper == m_data.begin())	return upper->second;		// nearest-neighbor extrapolation to the left
-
-	auto lower = upper;
-	--lower;
-
-	if (upper->first == _param)	return upper->second;		// exact value found
-	if (lower->first == _param)	return lower->second;		// exact value found
-
-	return (upper->second - lower->second) / (upper->first - lower->first) * (_param - lower->first) + lower->second; // linearly interpolated value
+	const double* base = _params.data();
+	size_t len = _params.size();
+	while (len > 1)
+	{
+		const size_t half = len / 2;
+		base = base[half] <= _param ? base + half : base;
+		len -= half;
+	}
+	return base - _params.data();
 }
 
 std::ostream& operator<<(std::ostream& _os, const CDependentValues& _obj)
 {
-	if (!_obj.m_data.empty())
-		_os << _obj.GetParamAt(0) << " " << _obj.GetValueAt(0);
-	for (size_t i = 1; i < _obj.m_data.size(); ++i)
-		_os << " " << _obj.GetParamAt(i) << " " << _obj.GetValueAt(i);
+	if (!_obj.m_params.empty())
+		_os << _obj.m_params[0] << " " << _obj.m_values[0];
+	for (size_t i = 1; i < _obj.m_params.size(); ++i)
+		_os << " " << _obj.m_params[i] << " " << _obj.m_values[i];
 	return  _os;
 }
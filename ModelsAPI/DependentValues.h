@@ -2,24 +2,52 @@
 
 #pragma once
 
-#include <map>
+#include <iosfwd>
+#include <iterator>
+#include <utility>
 #include <vector>
 
 // Represents a dependent value, described with the list of [param:value]. Implements internal linear interpolation of values between defined parameters and nearest-neighbor extrapolation beyond.
+// Params and values are stored in two flat arrays sorted by params.
 class CDependentValues
 {
-	std::map<double, double> m_data;
+	// Iterator over pairs [param:value]. Pairs are returned by value, use SetValue() to change them.
+	class CIterator
+	{
+		const double* m_param;
+		const double* m_value;
+
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = std::pair<double, double>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = std::pair<double, double>;
+
+		CIterator(const double* _param, const double* _value) : m_param{ _param }, m_value{ _value } {}
+
+		reference operator*() const { return { *m_param, *m_value }; }
+		CIterator& operator++() { ++m_param; ++m_value; return *this; }
+		CIterator operator++(int) { CIterator tmp = *this; ++*this; return tmp; }
+		CIterator& operator--() { --m_param; --m_value; return *this; }
+		CIterator operator--(int) { CIterator tmp = *this; --*this; return tmp; }
+		bool operator==(const CIterator& _other) const { return m_param == _other.m_param; }
+		bool operator!=(const CIterator& _other) const { return m_param != _other.m_param; }
+	};
+
+	std::vector<double> m_params;	// Sorted list of params.
+	std::vector<double> m_values;	// Values for each param.
 
 public:
+	using const_iterator = CIterator;
+
 	// Returns true if no [param:value] pairs have been defined.
 	bool empty() const;
 	// Returns number of defined pairs [param:value].
 	size_t size() const;
 
-	std::map<double, double>::iterator begin();
-	std::map<double, double>::const_iterator begin() const;
-	std::map<double, double>::iterator end();
-	std::map<double, double>::const_iterator end() const;
+	const_iterator begin() const;
+	const_iterator end() const;
 	std::pair<double, double> front();
 	std::pair<double, double> front() const;
 	std::pair<double, double> back();
@@ -27,6 +55,8 @@ public:
 
 	// Returns linearly interpolated value, which corresponds to a specified parameter. Performs nearest-neighbor extrapolation of data: if specified parameter lays out of the limits, returns value at the nearest limit. Returns 0, if there are no data at all.
 	double GetValue(double _param) const;
+	// Returns linearly interpolated values for all specified parameters, the same as GetValue() for each of them. Sorted parameters are processed faster.
+	std::vector<double> GetValues(const std::vector<double>& _params) const;
 	// Sets new point of [_param:_value] to the list. If the specified parameter has already been defined, overwrites its value.
 	void SetValue(double _param, double _value);
 	// Removes point with the given _param from the list if it exists.
@@ -58,7 +88,12 @@ public:
 	// Comparison.
 	bool operator==(const CDependentValues& _v) const;
 
+	// Performs linear interpolation of _values defined for sorted _params. If the parameter is out of defined limits, performs nearest-neighbor extrapolation of data. Returns 0, if there are no data at all.
+	static double Interpolate(const std::vector<double>& _params, const std::vector<double>& _values, double _param);
+	// Performs linear interpolation of _values defined for sorted _params for all _queries. Sorted queries are processed faster.
+	static std::vector<double> Interpolate(const std::vector<double>& _params, const std::vector<double>& _values, const std::vector<double>& _queries);
+
 private:
-	// Performs linear interpolation. If the parameter is out of defined limits, performs nearest-neighbor extrapolation of data.
-	double Interpolate(double _param) const;
+	// Returns index of the last param not greater than _param, or 0 if there is no such param. Uses branch-free binary search.
+	static size_t LastNotGreater(const std::vector<double>& _params, double _param);
 };
@@ -3,6 +3,8 @@
 #include "Holdup.h"
 #include "MaterialStream.h"
 #include "DyssolUtilities.h"
+#include <algorithm>
+#include <memory>
 
 CHoldup::CHoldup(const std::string& _sHoldupKey/*="" */) : CStream(_sHoldupKey)
 {
@@ -56,8 +58,23 @@ void CHoldup::AddStream(const CMaterialStream* _pStream, double _dStart, double
 	if (vTimePoints.size() == 0)
 		return;
 
+	// Inflow of each interval is mixed to all later time points, reading the state of the holdup before this interval.
+	// The state at each time point is read before it is overwritten, so the holdup itself can serve as this state,
+	// as long as all time points exist in it. Otherwise, values at missing points are interpolated and the holdup must be copied.
+	std::vector<bool> vExists(vTimePoints.size());
+	size_t nMissing = 0; // number of time points after the current one, which do not exist in the holdup yet
+	for (size_t j = 1; j < vTimePoints.size(); ++j)
+	{
+		vExists[j] = std::binary_search(m_vTimePoints.begin(), m_vTimePoints.end(), vTimePoints[j]);
+		if (!vExists[j])
+			nMissing++;
+	}
+
 	for (size_t iTime = 1; iTime < vTimePoints.size(); ++iTime)
 	{
+		if (iTime > 1 && !vExists[iTime - 1])
+			nMissing--;
+
 		const double dMassSrc = _pStream->GetMassFlow((vTimePoints[iTime - 1] + vTimePoints[iTime]) / 2) * (vTimePoints[iTime] - vTimePoints[iTime - 1]);
 
 		double dFactorTP = (vTimePoints[iTime] - vTimePoints[iTime - 1]) / std::sqrt(2.);
@@ -66,12 +83,13 @@ void CHoldup::AddStream(const CMaterialStream* _pStream, double _dStart, double
 		else
 			dFactorTP = vTimePoints[iTime] - dFactorTP;
 
-		std::vector<CDenseMDMatrix> vBufSrcPhasesDistrs(m_vpPhases.size());
-		for (size_t iPhase = 0; iPhase < m_vpPhases.size(); ++iPhase)
-			_pStream->GetPhases()->at(iPhase)->distribution.GetDistribution(vTimePoints[iTime], vBufSrcPhasesDistrs[iPhase]);
-
-		CHoldup bufHoldup(*this);
-		bufHoldup.CopyFromHoldup(this, _dStart, _dEnd);
+		std::unique_ptr<CHoldup> pBufHoldup;
+		if (nMissing != 0)
+		{
+			pBufHoldup = std::make_unique<CHoldup>(*this);
+			pBufHoldup->CopyFromHoldup(this, _dStart, _dEnd);
+		}
+		const CHoldup& srcHoldup = pBufHoldup ? *pBufHoldup : *this;
 
 		for (size_t j = iTime; j < vTimePoints.size(); ++j)
 		{
@@ -79,12 +97,17 @@ void CHoldup::AddStream(const CMaterialStream* _pStream, double _dStart, double
 			std::vector<double> vTempPhaseFrac(m_vpPhases.size()); // phase fractions
 			std::vector<CDenseMDMatrix> vTempDistr(m_vpPhases.size()); // MD distributions
 
-			AddTimePoint(vTimePoints[j]);
+			if (!vExists[j])
+			{
+				AddTimePoint(vTimePoints[j]);
+				vExists[j] = true;
+				nMissing--;
+			}
 
 			//// MTP
 
 			// get masses
-			const double dMassDst = bufHoldup.m_StreamMTP.GetValue(vTimePoints[j], MTP_MASS);
+			const double dMassDst = srcHoldup.m_StreamMTP.GetValue(vTimePoints[j], MTP_MASS);
 			const double dMassTot = dMassDst + dMassSrc;
 			if (dMassTot == 0) //  nothing to mix
 				break;
@@ -92,20 +115,20 @@ void CHoldup::AddStream(const CMaterialStream* _pStream, double _dStart, double
 			// get mass
 			vTempMTP[MTP_MASS] = dMassTot;
 			// get pressure
-			vTempMTP[MTP_PRESSURE] = CalcMixPressure(*_pStream, dFactorTP, bufHoldup, vTimePoints[j]);
+			vTempMTP[MTP_PRESSURE] = CalcMixPressure(*_pStream, dFactorTP, srcHoldup, vTimePoints[j]);
 			// get temperature
-			vTempMTP[MTP_TEMPERATURE] = CalcMixTemperature(*_pStream, dFactorTP, dMassSrc, bufHoldup, vTimePoints[j], dMassDst);
+			vTempMTP[MTP_TEMPERATURE] = CalcMixTemperature(*_pStream, dFactorTP, dMassSrc, srcHoldup, vTimePoints[j], dMassDst);
 			// set MTP
 			m_StreamMTP.SetValue(vTimePoints[j], vTempMTP);
 
 			// get phase fractions
 			std::vector<double> vTempPhaseMassSrc, vTempPhaseMassDst;
-			std::tie(vTempPhaseMassSrc, vTempPhaseMassDst, vTempPhaseFrac) = CalcMixPhaseFractions(*_pStream, dFactorTP, dMassSrc, bufHoldup, vTimePoints[j], dMassDst);
+			std::tie(vTempPhaseMassSrc, vTempPhaseMassDst, vTempPhaseFrac) = CalcMixPhaseFractions(*_pStream, dFactorTP, dMassSrc, srcHoldup, vTimePoints[j], dMassDst);
 			// set phase fractions
 			m_PhaseFractions.SetValue(vTimePoints[j], vTempPhaseFrac);
 
 			// get MD distributions
-			vTempDistr = CalcMixMDDistributions(*_pStream, vTimePoints[iTime], dMassSrc, vTempPhaseMassSrc, bufHoldup, vTimePoints[j], dMassDst, vTempPhaseMassDst);
+			vTempDistr = CalcMixMDDistributions(*_pStream, vTimePoints[iTime], dMassSrc, vTempPhaseMassSrc, srcHoldup, vTimePoints[j], dMassDst, vTempPhaseMassDst);
 			// set MD distributions
 			for (size_t iPhase = 0; iPhase < m_vpPhases.size(); ++iPhase)
 			{
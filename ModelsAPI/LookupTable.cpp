@@ -2,9 +2,14 @@
 
 #include "LookupTable.h"
 #include "DyssolUtilities.h"
+#include <numeric>
+
+std::mutex CLookupTable::m_mutexCache;
+std::map<CLookupTable::compounds_key_t, std::shared_ptr<const CLookupTable::SCompoundTables>> CLookupTable::m_compoundsCache;
+std::map<CLookupTable::mixture_key_t, CLookupTable::SCachedMixture> CLookupTable::m_mixturesCache;
+std::list<const CLookupTable::mixture_key_t*> CLookupTable::m_mixturesUsage;
 
 CLookupTable::CLookupTable() :
-	m_bFlippedConsistent(false),
 	m_pMaterialsDB(nullptr),
 	m_dMin(DEFAULT_LOWER_LIMIT),
 	m_dMax(DEFAULT_UPPER_LIMIT),
@@ -15,7 +20,6 @@ CLookupTable::CLookupTable() :
 }
 
 CLookupTable::CLookupTable(const CMaterialsDatabase* _pMaterialsDB, const std::vector<std::string>& _vCompoundKeys, ECompoundTPProperties _nProperty, EDependencyTypes _nDependenceType) :
-	m_bFlippedConsistent(false),
 	m_pMaterialsDB(_pMaterialsDB),
 	m_dMin(DEFAULT_LOWER_LIMIT),
 	m_dMax(DEFAULT_UPPER_LIMIT),
@@ -24,7 +28,6 @@ CLookupTable::CLookupTable(const CMaterialsDatabase* _pMaterialsDB, const std::v
 	m_nProperty(_nProperty),
 	m_vCompoundKeys(_vCompoundKeys)
 {
-	UpdateTableLimits();
 	InitializeCompoundTables();
 }
 
@@ -34,15 +37,13 @@ void CLookupTable::Initialize(const CMaterialsDatabase* _pMaterialsDB, const std
 	m_vCompoundKeys = _vCompoundKeys;
 	m_nProperty = _nProperty;
 	m_nDependenceType = _nDependenceType;
-	UpdateTableLimits();
 	InitializeCompoundTables();
 }
 
 void CLookupTable::Clear()
 {
-	m_table.clear();
-	m_flippedTable.clear();
-	m_bFlippedConsistent = false;
+	m_table.reset();
+	m_vFractions.clear();
 	m_pMaterialsDB = nullptr;
 	m_dMin = DEFAULT_LOWER_LIMIT;
 	m_dMax = DEFAULT_UPPER_LIMIT;
@@ -50,66 +51,64 @@ void CLookupTable::Clear()
 	m_nDependenceType = EDependencyTypes::DEPENDENCE_UNKNOWN;
 	m_nProperty = static_cast<ECompoundTPProperties>(0);
 	m_vCompoundKeys.clear();
-	m_vCompoundTables.clear();
+	m_pCompoundTables.reset();
 }
 
 bool CLookupTable::IsValid() const
 {
-	return !(m_nDependenceType == EDependencyTypes::DEPENDENCE_UNKNOWN || m_nProperty == 0 || m_vCompoundKeys.empty() || m_vCompoundKeys.size() != m_vCompoundTables.size());
+	return !(m_nDependenceType == EDependencyTypes::DEPENDENCE_UNKNOWN || m_nProperty == 0 || m_vCompoundKeys.empty() || !m_pCompoundTables || m_vCompoundKeys.size() != m_pCompoundTables->values.size());
 }
 
 void CLookupTable::SetCompoundFractions(const std::vector<double>& _vFractions)
 {
 	if (_vFractions.size() != m_vCompoundKeys.size()) return;
+	if (!m_pCompoundTables || m_pCompoundTables->values.empty()) return;
 
 	// Normalize mass fractions vector
-	const std::vector<double> vNormFractions = VectorNormalize(_vFractions);
+	std::vector<double> vNormFractions = VectorNormalize(_vFractions);
 
-	// Create m_table from compound lookup tables
-	// set the first...
-	if (!m_vCompoundTables.empty())
-		SetTable(m_vCompoundTables.front(), vNormFractions.front());
-	// ...add the rest
-	for (size_t i = 1; i < m_vCompoundTables.size(); ++i)
-		Add(m_vCompoundTables[i], vNormFractions[i]);
+	// The table is already calculated for this composition
+	if (m_table && vNormFractions == m_vFractions) return;
 
-	// Flipped table not more consistent
-	m_bFlippedConsistent = false;
+	// Take mixture table from compound lookup tables
+	m_table = GetMixtureTable(m_pCompoundTables, vNormFractions);
+	m_vFractions = std::move(vNormFractions);
 }
 
 double CLookupTable::GetValue(double _dParam) const
 {
-	return m_table.GetValue(_dParam);
+	if (!m_table) return 0;
+	return CDependentValues::Interpolate(m_table->params, m_table->values, _dParam);
 }
 
 double CLookupTable::GetParam(double _dValue) const
 {
-	UpdateFlippedTable();
-	return m_flippedTable.GetValue(_dValue);
+	if (!m_table) return 0;
+	return CDependentValues::Interpolate(m_table->flippedParams, m_table->flippedValues, _dValue);
 }
 
 void CLookupTable::SetTable(const CDependentValues& _table, double _dWeight /*= 1.*/)
 {
-	m_table = _table;
-	MultiplyTable(_dWeight);
-	m_bFlippedConsistent = false;
+	STable& table = EditTable();
+	table.params = _table.GetParamsList();
+	table.values = _table.GetValuesList();
+	for (auto& v : table.values)
+		v *= _dWeight;
+	UpdateFlippedTable(table);
 }
 
 void CLookupTable::Add(double _dValue, double _dWeight /*= 1.*/)
 {
-	for (auto& v : m_table)
-		v.second += _dWeight * _dValue;
-	m_bFlippedConsistent = false;
+	if (!m_table) return;
+	STable& table = EditTable();
+	for (auto& v : table.values)
+		v += _dWeight * _dValue;
+	UpdateFlippedTable(table);
 }
 
 void CLookupTable::Add(const CDependentValues& _table, double _dWeight /*= 1.*/)
 {
-	if (!m_table.empty())
-		for (auto& v : m_table)
-			v.second += _dWeight * _table.GetValue(v.first);
-	else
-		SetTable(_table, _dWeight);
-	m_bFlippedConsistent = false;
+	AddTable(_table.GetParamsList(), _table.GetValuesList(), _dWeight);
 }
 
 void CLookupTable::Add(const CLookupTable& _lookupTable, double _dWeight /*= 1.*/)
@@ -117,47 +116,166 @@ void CLookupTable::Add(const CLookupTable& _lookupTable, double _dWeight /*= 1.*
 	if (_lookupTable.m_vCompoundKeys != m_vCompoundKeys || _lookupTable.m_nProperty != m_nProperty || _lookupTable.m_nDependenceType != m_nDependenceType)
 		return;
 
-	Add(_lookupTable.m_table, _dWeight);
-	m_bFlippedConsistent = false;
+	// keep the added table alive, even if it is the own table, which is replaced during modification
+	const std::shared_ptr<STable> table = _lookupTable.m_table ? _lookupTable.m_table : std::make_shared<STable>();
+	AddTable(table->params, table->values, _dWeight);
 }
 
 void CLookupTable::MultiplyTable(double _dWeight)
 {
-	for (auto& v : m_table)
-		v.second *= _dWeight;
-	m_bFlippedConsistent = false;
+	if (!m_table) return;
+	STable& table = EditTable();
+	for (auto& v : table.values)
+		v *= _dWeight;
+	UpdateFlippedTable(table);
+}
+
+void CLookupTable::ClearCache()
+{
+	std::lock_guard<std::mutex> lock(m_mutexCache);
+	m_mixturesCache.clear();
+	m_mixturesUsage.clear();
+	m_compoundsCache.clear();
 }
 
 void CLookupTable::InitializeCompoundTables()
 {
-	m_vCompoundTables.clear();
-	for (const auto& key : m_vCompoundKeys)
+	m_table.reset();
+	m_vFractions.clear();
+	m_pCompoundTables = GetCompoundTables(m_pMaterialsDB, m_vCompoundKeys, m_nProperty, m_nDependenceType);
+	m_dMin = m_pCompoundTables->min;
+	m_dMax = m_pCompoundTables->max;
+	m_dStep = m_pCompoundTables->step;
+}
+
+CLookupTable::STable& CLookupTable::EditTable()
+{
+	if (!m_table)
+		m_table = std::make_shared<STable>();
+	else if (m_table.use_count() > 1)
+	{
+		auto table = std::make_shared<STable>();
+		table->params = m_table->params;
+		table->values = m_table->values;
+		m_table = std::move(table);
+	}
+	m_vFractions.clear();
+	return *m_table;
+}
+
+void CLookupTable::AddTable(const std::vector<double>& _vParams, const std::vector<double>& _vValues, double _dWeight)
+{
+	const bool bEmpty = !m_table || m_table->params.empty();
+	STable& table = EditTable();
+	if (bEmpty)
+	{
+		table.params = _vParams;
+		table.values = _vValues;
+		for (auto& v : table.values)
+			v *= _dWeight;
+	}
+	else if (table.params == _vParams)	// the same parameters - no interpolation needed
+		for (size_t i = 0; i < table.values.size(); ++i)
+			table.values[i] += _dWeight * _vValues[i];
+	else
+	{
+		const std::vector<double> vAdd = CDependentValues::Interpolate(_vParams, _vValues, table.params);
+		for (size_t i = 0; i < table.values.size(); ++i)
+			table.values[i] += _dWeight * vAdd[i];
+	}
+	UpdateFlippedTable(table);
+}
+
+std::shared_ptr<const CLookupTable::SCompoundTables> CLookupTable::GetCompoundTables(const CMaterialsDatabase* _pMaterialsDB, const std::vector<std::string>& _vCompoundKeys, ECompoundTPProperties _nProperty, EDependencyTypes _nDependenceType)
+{
+	compounds_key_t key{ _pMaterialsDB, _vCompoundKeys, _nProperty, _nDependenceType };
+
+	std::lock_guard<std::mutex> lock(m_mutexCache);
+	const auto it = m_compoundsCache.find(key);
+	if (it != m_compoundsCache.end())
+		return it->second;
+
+	auto tables = std::make_shared<SCompoundTables>();
+	UpdateTableLimits(key, *tables);
+	double dParam = tables->min;
+	do
+	{
+		tables->params.push_back(dParam);
+		dParam += tables->step;
+	} while (dParam < tables->max);
+	for (const auto& compound : _vCompoundKeys)
+	{
+		std::vector<double> vValues = GetParametersList(key, compound, *tables);
+		if (vValues.empty()) continue;
+		tables->values.push_back(std::move(vValues));
+	}
+
+	return m_compoundsCache.emplace(std::move(key), std::move(tables)).first->second;
+}
+
+std::shared_ptr<CLookupTable::STable> CLookupTable::GetMixtureTable(const std::shared_ptr<const SCompoundTables>& _pCompoundTables, const std::vector<double>& _vFractions)
+{
+	mixture_key_t key{ _pCompoundTables, _vFractions };
+
 	{
-		const CDependentValues cCompoundTable = GetParametersList(key);
-		if (cCompoundTable.empty())	continue;
-		m_vCompoundTables.push_back(cCompoundTable);
+		std::lock_guard<std::mutex> lock(m_mutexCache);
+		const auto it = m_mixturesCache.find(key);
+		if (it != m_mixturesCache.end())
+		{
+			m_mixturesUsage.splice(m_mixturesUsage.begin(), m_mixturesUsage, it->second.usage);
+			return it->second.table;
+		}
 	}
+
+	// Create table from compound lookup tables
+	auto table = std::make_shared<STable>();
+	const auto& compoundValues = _pCompoundTables->values;
+	table->params = _pCompoundTables->params;
+	// set the first...
+	table->values = compoundValues.front();
+	for (auto& v : table->values)
+		v *= _vFractions.front();
+	// ...add the rest
+	for (size_t i = 1; i < compoundValues.size(); ++i)
+		for (size_t j = 0; j < table->values.size(); ++j)
+			table->values[j] += _vFractions[i] * compoundValues[i][j];
+	// the cached table is only read from now on, so prepare the inverted table in advance
+	UpdateFlippedTable(*table);
+
+	std::lock_guard<std::mutex> lock(m_mutexCache);
+	const auto [it, inserted] = m_mixturesCache.emplace(std::move(key), SCachedMixture{ std::move(table), m_mixturesUsage.end() });
+	if (!inserted)	// calculated concurrently in another thread
+		return it->second.table;
+	m_mixturesUsage.push_front(&it->first);
+	it->second.usage = m_mixturesUsage.begin();
+	if (m_mixturesCache.size() > m_cnMaxCachedMixtures)
+	{
+		m_mixturesCache.erase(*m_mixturesUsage.back());
+		m_mixturesUsage.pop_back();
+	}
+	return it->second.table;
 }
 
-void CLookupTable::UpdateTableLimits()
+void CLookupTable::UpdateTableLimits(const compounds_key_t& _key, SCompoundTables& _tables)
 {
-	if (!m_pMaterialsDB || m_nDependenceType == EDependencyTypes::DEPENDENCE_UNKNOWN) return;
+	const auto& [pMaterialsDB, vCompoundKeys, nProperty, nDependenceType] = _key;
+	if (!pMaterialsDB || nDependenceType == EDependencyTypes::DEPENDENCE_UNKNOWN) return;
 
 	// Initialize temporary minimum and maximum
 	double dMin = -1.;
 	double dMax = -1.;
 
 	// Find minimum and maximum of dependency for each compound
-	for (const auto& key : m_vCompoundKeys)
+	for (const auto& key : vCompoundKeys)
 	{
 		// Initialize variable pair with minimum and maximum value
 		SInterval interval{ -1, -1 };
 
 		// Update variable pair
-		if (m_nDependenceType == EDependencyTypes::DEPENDENCE_TEMP)
-			interval = m_pMaterialsDB->GetTPPropertyTInterval(key, m_nProperty);
+		if (nDependenceType == EDependencyTypes::DEPENDENCE_TEMP)
+			interval = pMaterialsDB->GetTPPropertyTInterval(key, nProperty);
 		else
-			interval = m_pMaterialsDB->GetTPPropertyPInterval(key, m_nProperty);
+			interval = pMaterialsDB->GetTPPropertyPInterval(key, nProperty);
 
 		// Set temporary minimum
 		if (interval.min != -1)	dMin = (dMin == -1) ? interval.min : std::min(dMin, interval.min);
@@ -167,67 +285,69 @@ void CLookupTable::UpdateTableLimits()
 	}
 
 	// Set minimum and maximum
-	if (dMin != -1)	m_dMin = dMin;
-	if (dMax != -1)	m_dMax = dMax;
+	if (dMin != -1)	_tables.min = dMin;
+	if (dMax != -1)	_tables.max = dMax;
 
 	// Check minimum value
-	if (m_dMin < 1)	m_dMin = 1;
+	if (_tables.min < 1)	_tables.min = 1;
 
 	// Check maximum value
-	if (m_dMax < 1)
+	if (_tables.max < 1)
 	{
-		if (m_nDependenceType == EDependencyTypes::DEPENDENCE_TEMP)
-			m_dMax = MAX_TEMPERATURE;
+		if (nDependenceType == EDependencyTypes::DEPENDENCE_TEMP)
+			_tables.max = MAX_TEMPERATURE;
 		else
-			m_dMax = MAX_PRESSURE;
+			_tables.max = MAX_PRESSURE;
 	}
 
 	// Calculate interval size of table
-	if (m_nDependenceType == EDependencyTypes::DEPENDENCE_TEMP)
-		m_dStep = std::min(int((dMax - dMin) / 100), MAX_TEMPERATURE_STEPS);
+	if (nDependenceType == EDependencyTypes::DEPENDENCE_TEMP)
+		_tables.step = std::min(int((dMax - dMin) / 100), MAX_TEMPERATURE_STEPS);
 	else
-		m_dStep = std::min(int((dMax - dMin) / 100), MAX_PRESSURE_STEPS);
+		_tables.step = std::min(int((dMax - dMin) / 100), MAX_PRESSURE_STEPS);
 }
 
-CDependentValues CLookupTable::GetParametersList(const std::string& _sCompoundKey) const
+std::vector<double> CLookupTable::GetParametersList(const compounds_key_t& _key, const std::string& _sCompoundKey, const SCompoundTables& _tables)
 {
-	if (!m_pMaterialsDB) return {};
+	const auto& [pMaterialsDB, vCompoundKeys, nProperty, nDependenceType] = _key;
+	if (!pMaterialsDB) return {};
 
-	CDependentValues table;
-	double dParam = m_dMin;
-	do
+	// Check for dependence type of compound tables
+	std::vector<double> vT(_tables.params.size(), STANDARD_CONDITION_T);
+	std::vector<double> vP(_tables.params.size(), STANDARD_CONDITION_P);
+	switch (nDependenceType)
 	{
-		// Check for dependence type of compound tables
-		double dTemperature, dPressure;
-		switch (m_nDependenceType)
-		{
-		case EDependencyTypes::DEPENDENCE_TEMP:
-			dTemperature = dParam;
-			dPressure = STANDARD_CONDITION_P;
-			break;
-		case EDependencyTypes::DEPENDENCE_PRES:
-			dTemperature = STANDARD_CONDITION_T;
-			dPressure = dParam;
-			break;
-		default:
-			dTemperature = STANDARD_CONDITION_T;
-			dPressure = STANDARD_CONDITION_P;
-		}
-
-		const double dVal = m_pMaterialsDB->GetTPPropertyValue(_sCompoundKey, m_nProperty, dTemperature, dPressure);
-		table.SetValue(dParam, dVal);
-
-		dParam += m_dStep;
-	} while (dParam < m_dMax);
+	case EDependencyTypes::DEPENDENCE_TEMP:
+		vT = _tables.params;
+		break;
+	case EDependencyTypes::DEPENDENCE_PRES:
+		vP = _tables.params;
+		break;
+	default:
+		break;
+	}
 
-	return table;
+	// evaluate all points at once
+	return pMaterialsDB->GetTPPropertyValues(_sCompoundKey, nProperty, vT, vP);
 }
 
-void CLookupTable::UpdateFlippedTable() const
+void CLookupTable::UpdateFlippedTable(STable& _table)
 {
-	if (m_bFlippedConsistent) return;
-	m_flippedTable.clear();
-	for (const auto& v : m_table)
-		m_flippedTable.SetValue(v.second, v.first);
-	m_bFlippedConsistent = true;
+	_table.flippedParams.clear();
+	_table.flippedValues.clear();
+	_table.flippedParams.reserve(_table.values.size());
+	_table.flippedValues.reserve(_table.values.size());
+	// sort by values; for equal values the larger parameter is used
+	std::vector<size_t> vOrder(_table.values.size());
+	std::iota(vOrder.begin(), vOrder.end(), 0);
+	if (!std::is_sorted(_table.values.begin(), _table.values.end()))
+		std::stable_sort(vOrder.begin(), vOrder.end(), [&](size_t i, size_t j) { return _table.values[i] < _table.values[j]; });
+	for (const size_t i : vOrder)
+		if (!_table.flippedParams.empty() && _table.flippedParams.back() == _table.values[i])
+			_table.flippedValues.back() = _table.params[i];
+		else
+		{
+			_table.flippedParams.push_back(_table.values[i]);
+			_table.flippedValues.push_back(_table.params[i]);
+		}
 }
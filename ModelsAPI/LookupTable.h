@@ -3,6 +3,10 @@
 #pragma once
 
 #include "MaterialsDatabase.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <tuple>
 
 #define DEFAULT_LOWER_LIMIT		273
 #define DEFAULT_UPPER_LIMIT		2773
@@ -15,9 +19,46 @@
 class CLookupTable
 {
 private:
-	CDependentValues m_table;
-	mutable CDependentValues m_flippedTable;
-	mutable bool m_bFlippedConsistent;
+	static constexpr size_t m_cnMaxCachedMixtures = 4096;	// Maximum number of mixture tables in the cache.
+
+	// Table of values defined on a sorted list of parameters, together with the inverted table [value -> param].
+	// The inverted table is updated after each modification, so reading of a shared table never modifies it.
+	struct STable
+	{
+		std::vector<double> params;			// Sorted list of parameters.
+		std::vector<double> values;			// Values for each parameter.
+		std::vector<double> flippedParams;	// Sorted list of values, used as parameters of the inverted table.
+		std::vector<double> flippedValues;	// Parameters for each value of the inverted table.
+	};
+
+	// Tables of all compounds calculated from the materials database on a common list of parameters.
+	struct SCompoundTables
+	{
+		double min{ DEFAULT_LOWER_LIMIT };			// Lower limit of the tables.
+		double max{ DEFAULT_UPPER_LIMIT };			// Upper limit of the tables.
+		double step{ DEFAULT_STEP };				// Interval size of the tables.
+		std::vector<double> params;					// Common list of parameters.
+		std::vector<std::vector<double>> values;	// Values of each compound for each parameter.
+	};
+
+	using compounds_key_t = std::tuple<const CMaterialsDatabase*, std::vector<std::string>, ECompoundTPProperties, EDependencyTypes>;
+	using mixture_key_t = std::pair<std::shared_ptr<const SCompoundTables>, std::vector<double>>;
+
+	// Cached mixture table.
+	struct SCachedMixture
+	{
+		std::shared_ptr<STable> table;						// Table of the mixture.
+		std::list<const mixture_key_t*>::iterator usage;	// Position in the list of recently used mixtures.
+	};
+
+	// Cache of compound and mixture tables shared between all lookup tables, e.g. of all streams and holdups of the flowsheet.
+	static std::mutex m_mutexCache;
+	static std::map<compounds_key_t, std::shared_ptr<const SCompoundTables>> m_compoundsCache;
+	static std::map<mixture_key_t, SCachedMixture> m_mixturesCache;
+	static std::list<const mixture_key_t*> m_mixturesUsage;	// Keys of cached mixtures, from the most to the least recently used one.
+
+	std::shared_ptr<STable> m_table;	// Current table. Can be shared with the cache or other lookup tables, then it is copied before modification.
+	std::vector<double> m_vFractions;	// Normalized compound fractions, for which m_table was calculated. Empty if the table was modified in another way.
 
 	const CMaterialsDatabase* m_pMaterialsDB; /// Pointer to a database of materials
 
@@ -28,7 +69,7 @@ private:
 	EDependencyTypes m_nDependenceType;
 	ECompoundTPProperties m_nProperty;
 	std::vector<std::string> m_vCompoundKeys;			// Vector with keys of the chemical compounds which contains this lookuptable
-	std::vector<CDependentValues> m_vCompoundTables;	// Vector with compound lookup tables
+	std::shared_ptr<const SCompoundTables> m_pCompoundTables;	// Compound lookup tables
 
 public:
 	CLookupTable();
@@ -44,6 +85,7 @@ public:
 	bool IsValid() const;
 
 	/** Sets the compound information of the lookup table and calculates the total lookup table from these information.
+	*	Tables for already seen compositions are taken from the cache shared between all lookup tables.
 	*	\param _vFractions Vector with compound fractions. */
 	void SetCompoundFractions(const std::vector<double>& _vFractions);
 
@@ -76,18 +118,41 @@ public:
 	*	\param _dWeight Coefficient with which the table entries are to be multiplied. */
 	void MultiplyTable(double _dWeight);
 
+	/** Removes all compound and mixture tables from the cache shared between all lookup tables.
+	*	Must be called if the materials database may have changed. Called once at the start of each simulation in CFlowsheet::Initialize(). */
+	static void ClearCache();
+
 private:
-	/** Initializes m_vCompoundTables according to the defined m_vCompoundKeys list. */
+	/** Initializes m_pCompoundTables according to the defined m_vCompoundKeys list. */
 	void InitializeCompoundTables();
 
+	/** Returns m_table for modification. Creates the table if it does not exist, copies it if it is shared.
+	*	The inverted table must be updated with UpdateFlippedTable() after modification. */
+	STable& EditTable();
+
+	/** Adds a table, given with sorted parameters and values, with a certain weight to the member table. If member table is not defined sets the given table with respective weight.
+	*	\param _vParams Sorted parameters of the table to be added.
+	*	\param _vValues Values of the table to be added.
+	*	\param _dWeight Coefficient with which the additional table is to be multiplied. */
+	void AddTable(const std::vector<double>& _vParams, const std::vector<double>& _vValues, double _dWeight);
+
+	/** Returns tables of compounds from the cache, calculating them from the materials database if they are not there yet. */
+	static std::shared_ptr<const SCompoundTables> GetCompoundTables(const CMaterialsDatabase* _pMaterialsDB, const std::vector<std::string>& _vCompoundKeys, ECompoundTPProperties _nProperty, EDependencyTypes _nDependenceType);
+
+	/** Returns table of the mixture with the given normalized fractions from the cache, calculating it from compound tables if it is not there yet.
+	*	If the cache is full, the least recently used mixture is removed from it. */
+	static std::shared_ptr<STable> GetMixtureTable(const std::shared_ptr<const SCompoundTables>& _pCompoundTables, const std::vector<double>& _vFractions);
+
 	/** Get upper and lower limits as well as interval size of lookup table from compound lookup tables in material database. */
-	void UpdateTableLimits();
+	static void UpdateTableLimits(const compounds_key_t& _key, SCompoundTables& _tables);
 
-	/** Calculates a lookup table of a compound from values of the material database between the limits m_dMin and m_dMax with interval m_dStep.
+	/** Calculates a lookup table of a compound from values of the material database between the limits and with interval from _tables.
+	*	\param _key Materials database, compounds, property and dependence type.
 	*	\param _sCompoundKey Compound key.
-	*	\return Lookup table*/
-	CDependentValues GetParametersList(const std::string& _sCompoundKey) const;
+	*	\param _tables Compound tables with defined limits and parameters.
+	*	\return Values of the lookup table for each parameter*/
+	static std::vector<double> GetParametersList(const compounds_key_t& _key, const std::string& _sCompoundKey, const SCompoundTables& _tables);
 
-	// Updates a flipped table in the m_flippedTable by swapping [param <-> value].
-	void UpdateFlippedTable() const;
+	// Updates the flipped table by swapping [param <-> value]. Must be called after each modification of the table.
+	static void UpdateFlippedTable(STable& _table);
 };
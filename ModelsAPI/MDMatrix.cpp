@@ -3,6 +3,8 @@
 #include "MDMatrix.h"
 #include "DyssolStringConstants.h"
 #include <cmath>
+#include <algorithm>
+#include <iterator>
 
 const unsigned CMDMatrix::m_cnSaveVersion	= 2;
 
@@ -35,6 +37,7 @@ CMDMatrix::~CMDMatrix(void)
 
 void CMDMatrix::Clear()
 {
+	++m_nVersion;
 	RemoveAllTimePoints();
 	m_vDimensions.clear();
 	m_vClasses.clear();
@@ -43,6 +46,7 @@ void CMDMatrix::Clear()
 
 void CMDMatrix::AddDimension(unsigned _nDim, unsigned _nClasses)
 {
+	++m_nVersion;
 	for( unsigned i=0; i<m_vDimensions.size(); ++i )
 		if( m_vDimensions[i] == _nDim ) // dimension already exists
 			return;
@@ -60,6 +64,7 @@ void CMDMatrix::AddDimension(unsigned _nDim, unsigned _nClasses)
 
 void CMDMatrix::DeleteDimension(unsigned _nDim)
 {
+	++m_nVersion;
 	std::vector<unsigned> vDims;
 	vDims.push_back( _nDim );
 	DeleteDimensions( vDims );
@@ -67,6 +72,7 @@ void CMDMatrix::DeleteDimension(unsigned _nDim)
 
 void CMDMatrix::DeleteDimensions(const std::vector<unsigned>& _vDims)
 {
+	++m_nVersion;
 	std::vector<unsigned> vDimsToKeep;
 	std::vector<unsigned> vClassesToKeep;
 	m_pSortMatr = new CMDMatrix();
@@ -91,6 +97,7 @@ std::vector<unsigned> CMDMatrix::GetClasses() const
 
 void CMDMatrix::SetDimension(unsigned _nDim, unsigned _nClasses)
 {
+	++m_nVersion;
 	if( !m_vDimensions.empty() )
 		Clear();
 	m_vDimensions.push_back( _nDim );
@@ -99,6 +106,7 @@ void CMDMatrix::SetDimension(unsigned _nDim, unsigned _nClasses)
 
 void CMDMatrix::SetDimensions(const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vClasses)
 {
+	++m_nVersion;
 	if( _vDims.size() != _vClasses.size() ) // wrong input data
 		return;
 
@@ -146,6 +154,7 @@ unsigned CMDMatrix::GetDimensionSizeByType(unsigned _nDim) const
 
 void CMDMatrix::UpdateDimensions(const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vClasses)
 {
+	++m_nVersion;
 	if( _vDims.size() != _vClasses.size() )
 		return;
 
@@ -282,6 +291,7 @@ void CMDMatrix::UpdateDimensions(const std::vector<unsigned>& _vDims, const std:
 
 void CMDMatrix::AddClass(unsigned _nDim)
 {
+	++m_nVersion;
 	for( unsigned i=0; i<m_vDimensions.size(); ++i )
 	{
 		if( m_vDimensions[i] == _nDim )
@@ -299,6 +309,7 @@ void CMDMatrix::AddClass(unsigned _nDim)
 
 void CMDMatrix::RemoveClass(unsigned _nDim, unsigned _nClassIndex)
 {
+	++m_nVersion;
 	for( unsigned i=0; i<m_vDimensions.size(); ++i )
 	{
 		if( m_vDimensions[i] == _nDim )
@@ -328,6 +339,7 @@ bool CMDMatrix::CompareDims(const CMDMatrix& _matr) const
 
 void CMDMatrix::AddTimePoint(double _dTime, double _dSrcTimePoint /*= -1 */)
 {
+	++m_nVersion;
 	unsigned index = GetTimeIndex( _dTime, false ); // get new index to insert
 	if( (unsigned)index < m_vTimePoints.size() )
 		if( m_vTimePoints[index] == _dTime ) // time point already exists
@@ -358,6 +370,7 @@ void CMDMatrix::AddTimePoint(double _dTime, double _dSrcTimePoint /*= -1 */)
 
 void CMDMatrix::ChangeTimePoint(unsigned _nTimePointIndex, double _dNewTime)
 {
+	++m_nVersion;
 	if ( _nTimePointIndex >= m_vTimePoints.size() )
 		return;
 
@@ -388,6 +401,7 @@ void CMDMatrix::ChangeTimePoint(unsigned _nTimePointIndex, double _dNewTime)
 
 void CMDMatrix::RemoveTimePoint(double _dTime)
 {
+	++m_nVersion;
 	unsigned index = GetTimeIndex( _dTime );
 	if( index == -1 ) // no such time point
 		return;
@@ -408,6 +422,7 @@ void CMDMatrix::RemoveTimePoint(double _dTime)
 
 void CMDMatrix::RemoveTimePoints(double _dStart, double _dEnd)
 {
+	++m_nVersion;
 	if( _dStart > _dEnd ) // wrong interval
 		return;
 
@@ -440,8 +455,39 @@ void CMDMatrix::RemoveTimePoints(double _dStart, double _dEnd)
 	m_bCacheCoherent = false;
 }
 
+void CMDMatrix::RemoveTimePoints(const std::vector<double>& _vTimes)
+{
+	++m_nVersion;
+	if( m_vTimePoints.empty() || _vTimes.empty() ) // nothing to remove
+		return;
+
+	// select existing time points
+	std::vector<double> vTimes;
+	vTimes.reserve( _vTimes.size() );
+	std::set_intersection( m_vTimePoints.begin(), m_vTimePoints.end(), _vTimes.begin(), _vTimes.end(), std::back_inserter( vTimes ) );
+	if( vTimes.empty() )
+		return;
+	if( vTimes.size() == m_vTimePoints.size() ) // remove all time points
+	{
+		RemoveAllTimePoints();
+		return;
+	}
+
+	UnCacheData( vTimes.front(), vTimes.back() );
+	RemoveTimePointsRecursive( m_data, vTimes );
+	std::vector<double> vRemain;
+	vRemain.reserve( m_vTimePoints.size() - vTimes.size() );
+	std::set_difference( m_vTimePoints.begin(), m_vTimePoints.end(), vTimes.begin(), vTimes.end(), std::back_inserter( vRemain ) );
+	m_vTimePoints.swap( vRemain );
+	m_nNonCachedTPNum -= static_cast<unsigned>( vTimes.size() );
+	CorrectWinBoundary();
+
+	m_bCacheCoherent = false;
+}
+
 void CMDMatrix::RemoveTimePointsAfter(double _dTime, bool _bIncludeTime /*= false */)
 {
+	++m_nVersion;
 	if( m_vTimePoints.empty() ) // nothing to remove
 		return;
 
@@ -465,6 +511,7 @@ void CMDMatrix::RemoveTimePointsAfter(double _dTime, bool _bIncludeTime /*= fals
 
 void CMDMatrix::RemoveAllTimePoints()
 {
+	++m_nVersion;
 	if( !m_vTimePoints.empty() )
 	{
 		m_dTempT1 = m_vTimePoints.front();
@@ -514,6 +561,11 @@ size_t CMDMatrix::GetTimePointsNumber() const
 	return m_vTimePoints.size();
 }
 
+size_t CMDMatrix::GetVersion() const
+{
+	return m_nVersion;
+}
+
 double CMDMatrix::GetMinimalFraction() const
 {
 	return m_dMinFraction;
@@ -588,17 +640,16 @@ double CMDMatrix::GetValue(double _dTime, const std::vector<unsigned>& _vDims, c
 	if( _vDims.size() != _vCoords.size() ) // _vCoords has wrong size
 		return 0;
 
+	std::unique_lock<std::mutex> lock = LockForRead();
 	UnCacheData(_dTime);
-	m_dTempT1 = _dTime;
-	m_vTempDims = _vDims;
-	m_vTempCoords = _vCoords;
 
-	double dValue = GetValueRecursive( m_data );
+	double dValue = GetValueRecursive( m_data, _dTime, _vDims, _vCoords );
 	return dValue >= m_dMinFraction ? dValue : 0;
 }
 
 bool CMDMatrix::SetValue(unsigned _nTimeIndex, unsigned _nDim, unsigned _nCoord, double _dValue, bool _bExternal /*= true*/)
 {
+	++m_nVersion;
 	if( _nTimeIndex >= m_vTimePoints.size() )
 		return false;
 
@@ -611,6 +662,7 @@ bool CMDMatrix::SetValue(unsigned _nTimeIndex, unsigned _nDim, unsigned _nCoord,
 
 bool CMDMatrix::SetValue(double _dTime, unsigned _nDim, unsigned _nCoord, double _dValue, bool _bExternal /*= true*/)
 {
+	++m_nVersion;
 	std::vector<unsigned> vDims(1);
 	vDims[0] = _nDim;
 	std::vector<unsigned> vCoords(1);
@@ -620,6 +672,7 @@ bool CMDMatrix::SetValue(double _dTime, unsigned _nDim, unsigned _nCoord, double
 
 bool CMDMatrix::SetValue(double _dTime, unsigned _nDim1, unsigned _nCoord1, unsigned _nDim2, unsigned _nCoord2, double _dValue, bool _bExternal /*= true*/)
 {
+	++m_nVersion;
 	std::vector<unsigned> vDims(2);
 	vDims[0] = _nDim1;
 	vDims[1] = _nDim2;
@@ -631,6 +684,7 @@ bool CMDMatrix::SetValue(double _dTime, unsigned _nDim1, unsigned _nCoord1, unsi
 
 bool CMDMatrix::SetValue(double _dTime, unsigned _nDim1, unsigned _nCoord1, unsigned _nDim2, unsigned _nCoord2, unsigned _nDim3, unsigned _nCoord3, double _dValue, bool _bExternal /*= true*/)
 {
+	++m_nVersion;
 	std::vector<unsigned> vDims(3);
 	vDims[0] = _nDim1;
 	vDims[1] = _nDim2;
@@ -644,11 +698,13 @@ bool CMDMatrix::SetValue(double _dTime, unsigned _nDim1, unsigned _nCoord1, unsi
 
 bool CMDMatrix::SetValue( double _dTime, const std::vector<unsigned>& _vCoords, double _dValue, bool _bExternal /*= true*/ )
 {
+	++m_nVersion;
 	return SetValue( _dTime, m_vDimensions, _vCoords, _dValue, _bExternal );
 }
 
 bool CMDMatrix::SetValue(double _dTime, const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords, double _dValue, bool _bExternal /*= true*/)
 {
+	++m_nVersion;
 	//int index;
 	if( /* ( index = */ GetTimeIndex( _dTime ) /* ) */ == -1 ) // time point doesn't exist
 		return false;
@@ -729,10 +785,6 @@ std::vector<double> CMDMatrix::GetVectorValue(double _dTime, const std::vector<u
 	if (_vDims.size() != _vCoords.size() + 1) // _vCoords has wrong size
 		return {};
 
-	m_dTempT1 = _dTime;
-	m_vTempDims = _vDims;
-	m_vTempCoords = _vCoords;
-
 	// find index of last element in _vDims
 	size_t iDims;
 	for (iDims = 0; iDims < m_vDimensions.size(); ++iDims)
@@ -749,6 +801,7 @@ std::vector<double> CMDMatrix::GetVectorValue(double _dTime, const std::vector<u
 			break;
 		}
 
+	std::unique_lock<std::mutex> lock = LockForRead();
 	UnCacheData(_dTime);
 
 	std::vector<double> res;
@@ -756,19 +809,20 @@ std::vector<double> CMDMatrix::GetVectorValue(double _dTime, const std::vector<u
 	if (bIsDimsConsecutive)
 	{
 		res.reserve(m_vClasses[iDims]);
-		if (!GetVectorValueRecursive(m_data, res)) // get whole vector
+		if (!GetVectorValueRecursive(m_data, _dTime, _vDims, _vCoords, res)) // get whole vector
 			return std::vector<double>(m_vClasses[iDims], 0);
 	}
 	else
 	{
 		res.resize(m_vClasses[iDims]);
-		m_vTempCoords.push_back(0);
+		std::vector<unsigned> vCoords = _vCoords;
+		vCoords.push_back(0);
 
 		// get data by values
 		for (size_t i = 0; i < m_vClasses[iDims]; ++i)
 		{
-			res[i] = GetValueRecursive(m_data);
-			m_vTempCoords.back()++;
+			res[i] = GetValueRecursive(m_data, _dTime, _vDims, vCoords);
+			vCoords.back()++;
 		}
 	}
 
@@ -800,10 +854,6 @@ bool CMDMatrix::GetVectorValue(double _dTime, const std::vector<unsigned>& _vDim
 
 	_vResult.clear();
 
-	m_dTempT1 = _dTime;
-	m_vTempDims = _vDims;
-	m_vTempCoords = _vCoords;
-
 	// find index of last element in _vDims
 	unsigned iDims;
 	for( iDims=0; iDims<m_vDimensions.size(); ++iDims )
@@ -822,12 +872,13 @@ bool CMDMatrix::GetVectorValue(double _dTime, const std::vector<unsigned>& _vDim
 			break;
 		}
 
+	std::unique_lock<std::mutex> lock = LockForRead();
 	UnCacheData(_dTime);
 	//bool bReturnVal = true;
 	if( bIsDimsConsecutive )
 	{
 		// get whole vector
-		if ( !GetVectorValueRecursive( m_data, _vResult ) )
+		if ( !GetVectorValueRecursive( m_data, _dTime, _vDims, _vCoords, _vResult ) )
 		{
 			_vResult.assign( m_vClasses[iDims], 0 );
 			return false;
@@ -835,13 +886,14 @@ bool CMDMatrix::GetVectorValue(double _dTime, const std::vector<unsigned>& _vDim
 	}
 	else
 	{
-		m_vTempCoords.push_back(0);
+		std::vector<unsigned> vCoords = _vCoords;
+		vCoords.push_back(0);
 
 		// get data by values
 		for( unsigned i=0; i<m_vClasses[iDims]; ++i )
 		{
-			_vResult.push_back( GetValueRecursive( m_data ) );
-			m_vTempCoords.back()++;
+			_vResult.push_back( GetValueRecursive( m_data, _dTime, _vDims, vCoords ) );
+			vCoords.back()++;
 		}
 	}
 
@@ -871,6 +923,7 @@ std::vector<double> CMDMatrix::GetValues(unsigned _nDim, unsigned _nCoord) const
 
 bool CMDMatrix::SetVectorValue(unsigned _nTimeIndex, unsigned _nDim, const std::vector<double>& _vValue, bool _bExternal /*= false*/ )
 {
+	++m_nVersion;
 	if( _nTimeIndex >= m_vTimePoints.size() )
 		return false;
 
@@ -882,6 +935,7 @@ bool CMDMatrix::SetVectorValue(unsigned _nTimeIndex, unsigned _nDim, const std::
 
 bool CMDMatrix::SetVectorValue(double _dTime, unsigned _nDim, const std::vector<double>& _vValue, bool _bExternal /*= false*/ )
 {
+	++m_nVersion;
 	std::vector<unsigned> vDims(1);
 	vDims[0] = _nDim;
 	std::vector<unsigned> vCoords;
@@ -890,6 +944,7 @@ bool CMDMatrix::SetVectorValue(double _dTime, unsigned _nDim, const std::vector<
 
 bool CMDMatrix::SetVectorValue(double _dTime, unsigned _nDim1, unsigned _nCoord1, unsigned _nDim2, const std::vector<double>& _vValue, bool _bExternal /*= false*/ )
 {
+	++m_nVersion;
 	std::vector<unsigned> vDims(2);
 	vDims[0] = _nDim1;
 	vDims[1] = _nDim2;
@@ -900,6 +955,7 @@ bool CMDMatrix::SetVectorValue(double _dTime, unsigned _nDim1, unsigned _nCoord1
 
 bool CMDMatrix::SetVectorValue(double _dTime, const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords, const std::vector<double>& _vValue, bool _bExternal /*= false*/ )
 {
+	++m_nVersion;
 	if( m_vTimePoints.empty() )
 		return false;
 
@@ -1083,6 +1139,7 @@ std::vector<std::vector<double>> CMDMatrix::GetMatrixValue(double _dTime, const
 
 bool CMDMatrix::SetMatrixValue(double _dTime, const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords, const std::vector<std::vector<double>>& _vValue)
 {
+	++m_nVersion;
 	if( m_vTimePoints.empty() )
 		return false;
 
@@ -1423,6 +1480,7 @@ CDenseMDMatrix CMDMatrix::GetDistribution(double _dTime, const std::vector<unsig
 
 bool CMDMatrix::SetDistribution(double _dTime, unsigned _nDim, const std::vector<double>& _vDistr)
 {
+	++m_nVersion;
 	if(GetTimeIndex( _dTime ) == -1) // time point doesn't exist
 		return false;
 
@@ -1443,6 +1501,7 @@ bool CMDMatrix::SetDistribution(double _dTime, unsigned _nDim, const std::vector
 
 bool CMDMatrix::SetDistribution(double _dTime, unsigned _nDim1, unsigned _nDim2, const CMatrix2D& _Distr)
 {
+	++m_nVersion;
 	//int index;
 	if( /* ( index =  */GetTimeIndex( _dTime ) /* ) */ == -1 ) // time point doesn't exist
 		return false;
@@ -1505,6 +1564,7 @@ bool CMDMatrix::SetDistribution(double _dTime, unsigned _nDim1, unsigned _nDim2,
 
 bool CMDMatrix::SetDistribution(double _dTime, const CDenseMDMatrix& _Distr)
 {
+	++m_nVersion;
 	//int index;
 	if( /* ( index = */ GetTimeIndex( _dTime ) /* ) */ == -1 ) // time point doesn't exist
 		return false;
@@ -1553,6 +1613,7 @@ bool CMDMatrix::SetDistribution(double _dTime, const CDenseMDMatrix& _Distr)
 
 bool CMDMatrix::Transform(double _dTime, const CTransformMatrix& _TMatrix)
 {
+	++m_nVersion;
 	std::vector<unsigned> vTDims = _TMatrix.GetDimensions();
 	std::vector<unsigned> vTClasses = _TMatrix.GetClasses();
 	std::vector<unsigned> vNewDims;
@@ -1576,6 +1637,7 @@ bool CMDMatrix::Transform(double _dTime, const CTransformMatrix& _TMatrix)
 		if( j == m_vDimensions.size() ) // dimensions are not similar in types or numbers of classes
 			return false;
 	}
+
 	if( vNewDims.size() != m_vDimensions.size() ) // add missing dimensions
 		for( unsigned i=0; i<m_vDimensions.size(); ++i )
 		{
@@ -1648,29 +1710,24 @@ bool CMDMatrix::Transform(double _dTime, const CTransformMatrix& _TMatrix)
 
 				if( !bIsEmpty )
 				{
-					std::vector<unsigned> vSrcCoord( vTDims.size()-1, 0 );
 					std::vector<unsigned> vDestCoord( vTDims.size(), 0 );
+					const SSparseTransform& sparse = _TMatrix.GetSparse();
 
 					// for each value in vLowerValues
 					bool bResDest;
+					size_t iDest = 0;
 					do
 					{
-						std::fill( vSrcCoord.begin(), vSrcCoord.end(), 0 ); // zeroing coordinates
+						// only non-zero factors, in the order of source classes
 						std::vector<double> vNewValue( vvLowerValues.front().size(), 0 );
-						size_t shift = 0;
-						bool bTransRes;
-						do
+						for( size_t f=sparse.dstStart[iDest]; f<sparse.dstStart[iDest+1]; ++f )
 						{
-							std::vector<double> vTFactors;
-							_TMatrix.GetVectorValue( vSrcCoord, vDestCoord, vTFactors );
-							for( unsigned j=0; j<vTFactors.size(); ++j )
-								if( ( vTFactors[j] != 0 ) && ( vIsNotEmpty[j + shift] ) )
-									for( unsigned k=0; k<vvLowerValues.front().size(); ++k )
-										vNewValue[k] += vvLowerValues[j + shift][k] * vTFactors[j];
-							shift += vTFactors.size();
-							bTransRes = IncrementCoords( vSrcCoord, vTClasses );
+							const size_t iSrc = sparse.src[f];
+							if( ( iSrc < vIsNotEmpty.size() ) && ( vIsNotEmpty[iSrc] ) )
+								for( unsigned k=0; k<vvLowerValues.front().size(); ++k )
+									vNewValue[k] += vvLowerValues[iSrc][k] * sparse.value[f];
 						}
-						while( bTransRes );
+						iDest++;
 
 						// set value
 						std::vector<unsigned> vFullSetCoord;
@@ -1711,6 +1768,7 @@ bool CMDMatrix::Transform(double _dTime, const CTransformMatrix& _TMatrix)
 
 void CMDMatrix::NormalizeMatrix(double _dTime)
 {
+	++m_nVersion;
 	unsigned index = GetTimeIndex( _dTime );
 	if( index != -1 )
 	{
@@ -1725,6 +1783,7 @@ void CMDMatrix::NormalizeMatrix(double _dTime)
 
 void CMDMatrix::NormalizeMatrix(double _dStart, double _dEnd)
 {
+	++m_nVersion;
 	if( m_vTimePoints.size() == 0 ) // nothing to normalize
 		return;
 
@@ -1749,6 +1808,7 @@ void CMDMatrix::NormalizeMatrix(double _dStart, double _dEnd)
 
 void CMDMatrix::NormalizeMatrix()
 {
+	++m_nVersion;
 	m_vTempValues = m_vTimePoints;
 	if( !m_vTimePoints.empty() )
 		UnCacheData(m_vTimePoints.front(),m_vTimePoints.back());
@@ -1788,11 +1848,13 @@ bool CMDMatrix::IsNormalized(double _dTime)
 
 bool CMDMatrix::CopyFrom(const CMDMatrix& _Source, double _dTime)
 {
+	++m_nVersion;
 	return CopyFrom( _Source, _dTime, _dTime );
 }
 
 bool CMDMatrix::CopyFrom(const CMDMatrix& _Source, double _dStart, double _dEnd)
 {
+	++m_nVersion;
 	if( !CompareDims( _Source ) )
 		return false;
 
@@ -1810,6 +1872,7 @@ bool CMDMatrix::CopyFrom(const CMDMatrix& _Source, double _dStart, double _dEnd)
 	m_dTempT1 = vTimePoints.front();
 	m_dTempT2 = vTimePoints.back();
 	UnCacheData(_dStart,_dEnd);
+	std::unique_lock<std::mutex> lockSource = _Source.LockForRead();
 	_Source.UnCacheData(_dStart,_dEnd);
 	m_bCacheCoherent = false;
 	m_data = CopyFromRecursive( m_data, _Source.m_data );
@@ -1823,6 +1886,7 @@ bool CMDMatrix::CopyFrom(const CMDMatrix& _Source, double _dStart, double _dEnd)
 
 bool CMDMatrix::CopyFromTimePoint(const CMDMatrix& _Source, double _dTimeSrc, double _dTimeDest)
 {
+	++m_nVersion;
 	if( !CompareDims( _Source ) )
 		return false;
 
@@ -1830,6 +1894,7 @@ bool CMDMatrix::CopyFromTimePoint(const CMDMatrix& _Source, double _dTimeSrc, do
 	m_dTempT1 = _dTimeSrc;
 	m_dTempT2 = _dTimeDest;
 	UnCacheData(_dTimeDest);
+	std::unique_lock<std::mutex> lockSource = _Source.LockForRead();
 	_Source.UnCacheData(_dTimeSrc);
 	m_bCacheCoherent = false;
 	m_data = CopyFromTimePointRecursive( m_data, _Source.m_data );
@@ -1916,6 +1981,7 @@ void CMDMatrix::SaveMDBlockToFile(CH5Handler& _h5File, const std::string& _sPath
 
 void CMDMatrix::LoadFromFile(CH5Handler& _h5File, const std::string& _sPath)
 {
+	++m_nVersion;
 	Clear();
 
 	if (!_h5File.IsValid())
@@ -1981,6 +2047,7 @@ void CMDMatrix::SetCacheParams( bool _bEnabled, unsigned _nWindow )
 
 void CMDMatrix::CompressData( double _dStartTime, double _dEndTime, double _dATol, double _dRTol )
 {
+	++m_nVersion;
 	if( _dStartTime < _dEndTime )
 	{
 		m_dTempT1 = _dStartTime;
@@ -1994,6 +2061,7 @@ void CMDMatrix::CompressData( double _dStartTime, double _dEndTime, double _dATo
 
 void CMDMatrix::ExtrapolateToPoint( double _dT1, double _dT2, double _dTExtra )
 {
+	++m_nVersion;
 	UnCacheData(_dT1,_dTExtra);
 
 	m_dTempT1 = _dT1;
@@ -2008,6 +2076,7 @@ void CMDMatrix::ExtrapolateToPoint( double _dT1, double _dT2, double _dTExtra )
 
 void CMDMatrix::ExtrapolateToPoint( double _dT0, double _dT1, double _dT2, double _dTExtra )
 {
+	++m_nVersion;
 	UnCacheData(_dT0,_dTExtra);
 
 	m_vTempValues.resize( 4 );
@@ -2388,18 +2457,31 @@ sFraction* CMDMatrix::RemoveTimePointsRecursive(sFraction *_pFraction, unsigned
 	return _pFraction;
 }
 
-double CMDMatrix::GetValueRecursive(sFraction *_pFraction, unsigned _nLevel /*= 1*/, unsigned _nNesting /*= 0 */) const
+void CMDMatrix::RemoveTimePointsRecursive(sFraction *_pFraction, const std::vector<double>& _vTimes, unsigned _nNesting)
+{
+	if(( _nNesting >= m_vDimensions.size() ) || ( _pFraction == NULL ))
+		return;
+
+	for( unsigned i=0; i<m_vClasses[_nNesting]; ++i )
+	{
+		if( _pFraction[i].pNext != NULL ) // go to the next dimension
+			RemoveTimePointsRecursive( _pFraction[i].pNext, _vTimes, _nNesting+1 );
+		_pFraction[i].tdArray.RemoveTimePoints( _vTimes );
+	}
+}
+
+double CMDMatrix::GetValueRecursive(const sFraction *_pFraction, double _dTime, const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords, unsigned _nLevel /*= 1*/, unsigned _nNesting /*= 0 */) const
 {
 	if( ( _nNesting >= m_vDimensions.size() ) || ( _pFraction == NULL ) )
 		return 0;
 
 	// find current index of dimension
 	unsigned index;
-	for( index=0; index<m_vTempDims.size(); ++index )
-		if( m_vTempDims[index] == m_vDimensions[_nNesting] )
+	for( index=0; index<_vDims.size(); ++index )
+		if( _vDims[index] == m_vDimensions[_nNesting] )
 			break;
 
-	if( index == m_vTempDims.size() ) // skip this dimension
+	if( index == _vDims.size() ) // skip this dimension
 	{
 		if( _nNesting+1 == m_vDimensions.size() ) // last level
 			return 0; // no such coordinates
@@ -2407,18 +2489,18 @@ double CMDMatrix::GetValueRecursive(sFraction *_pFraction, unsigned _nLevel /*=
 		double dResult = 0;
 		for( unsigned i=0; i<m_vClasses[_nNesting]; ++i )
 			if( _pFraction[i].pNext != NULL ) // go to the next dimension
-				dResult += _pFraction[i].tdArray.GetValue( m_dTempT1 ) * GetValueRecursive( _pFraction[i].pNext, _nLevel, _nNesting+1 );
+				dResult += _pFraction[i].tdArray.GetValue( _dTime ) * GetValueRecursive( _pFraction[i].pNext, _dTime, _vDims, _vCoords, _nLevel, _nNesting+1 );
 		return dResult;
 	}
 
 	// check out of bounds
-	if( m_vTempCoords[index] >= m_vClasses[_nNesting] )
+	if( _vCoords[index] >= m_vClasses[_nNesting] )
 		return 0;
 
-	unsigned iClassIndex = m_vTempCoords[index];
+	unsigned iClassIndex = _vCoords[index];
 
-	if( _nLevel == m_vTempDims.size() ) // the search is over
-		return _pFraction[iClassIndex].tdArray.GetValue( m_dTempT1 );
+	if( _nLevel == _vDims.size() ) // the search is over
+		return _pFraction[iClassIndex].tdArray.GetValue( _dTime );
 	else
 	{
 		if( _nNesting+1 == m_vDimensions.size() ) // last level
@@ -2426,7 +2508,7 @@ double CMDMatrix::GetValueRecursive(sFraction *_pFraction, unsigned _nLevel /*=
 
 		// go to the next dimension
 		if( _pFraction[iClassIndex].pNext != NULL )
-			return _pFraction[iClassIndex].tdArray.GetValue( m_dTempT1 ) * GetValueRecursive( _pFraction[iClassIndex].pNext, _nLevel+1, _nNesting+1 );
+			return _pFraction[iClassIndex].tdArray.GetValue( _dTime ) * GetValueRecursive( _pFraction[iClassIndex].pNext, _dTime, _vDims, _vCoords, _nLevel+1, _nNesting+1 );
 		else
 			return 0;
 	}
@@ -2607,28 +2689,28 @@ bool CMDMatrix::SetValueRecursive(sFraction *_pFraction, bool _bExternal /*= tru
 	return true;
 }
 
-bool CMDMatrix::GetVectorValueRecursive(sFraction *_pFraction, std::vector<double>& _vRes, unsigned _nNesting /*= 0 */) const
+bool CMDMatrix::GetVectorValueRecursive(const sFraction *_pFraction, double _dTime, const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords, std::vector<double>& _vRes, unsigned _nNesting /*= 0 */) const
 {
 	if( ( _nNesting >= m_vDimensions.size() ) || ( _pFraction == NULL ) )
 		return false;
 
 	// find current index of dimension
 	unsigned index;
-	for ( index=0; index<m_vTempDims.size(); ++index )
-		if ( m_vTempDims[index] == m_vDimensions[_nNesting] )
+	for ( index=0; index<_vDims.size(); ++index )
+		if ( _vDims[index] == m_vDimensions[_nNesting] )
 			break;
 
-	if( index == m_vTempDims.size() ) // skip this dimension
+	if( index == _vDims.size() ) // skip this dimension
 		return false;
 
 
-	if( _nNesting != m_vTempDims.size()-1 ) // go deeper
+	if( _nNesting != _vDims.size()-1 ) // go deeper
 	{
 		// check out of bounds
-		if( m_vTempCoords[index] >= m_vClasses[_nNesting] )
+		if( _vCoords[index] >= m_vClasses[_nNesting] )
 			return false;
 
-		unsigned iClassIndex = m_vTempCoords[index];
+		unsigned iClassIndex = _vCoords[index];
 
 		if( _nNesting+1 == m_vDimensions.size() ) // last level
 			return false; // no such coordinates
@@ -2636,10 +2718,10 @@ bool CMDMatrix::GetVectorValueRecursive(sFraction *_pFraction, std::vector<doubl
 		// go to the next dimension
 		if( _pFraction[iClassIndex].pNext != NULL )
 		{
-			bool bRes = GetVectorValueRecursive( _pFraction[iClassIndex].pNext, _vRes, _nNesting+1 );
+			bool bRes = GetVectorValueRecursive( _pFraction[iClassIndex].pNext, _dTime, _vDims, _vCoords, _vRes, _nNesting+1 );
 			if( bRes )
 				for( unsigned i=0; i<_vRes.size(); ++i )
-					_vRes[i] *= _pFraction[iClassIndex].tdArray.GetValue( m_dTempT1 );
+					_vRes[i] *= _pFraction[iClassIndex].tdArray.GetValue( _dTime );
 			return bRes;
 		}
 		else
@@ -2648,7 +2730,7 @@ bool CMDMatrix::GetVectorValueRecursive(sFraction *_pFraction, std::vector<doubl
 	else // the search is over
 	{
 		for( unsigned i=0; i<m_vClasses[_nNesting]; ++i )
-			_vRes.push_back( _pFraction[i].tdArray.GetValue( m_dTempT1 ) );
+			_vRes.push_back( _pFraction[i].tdArray.GetValue( _dTime ) );
 		return true;
 	}
 }
@@ -2735,30 +2817,20 @@ void CMDMatrix::TransformRecurcive(const CTransformMatrix& _TMatr)
 
 	if( !bIsEmpty )
 	{
+		const SSparseTransform& sparse = _TMatr.GetSparse();
 		bool bResDest;
+		size_t iDest = 0;
 		do // for each value in vCurrValues
 		{
-			std::fill( vSrcCoords.begin(), vSrcCoords.end(), 0 ); // set coords	to zero
-
-			std::vector<double> vTFactors;
-			std::vector<double> vBufTFactors;
+			// only non-zero factors, in the order of source classes
 			double dNewValue = 0;
-			bool bTransRes;
-			do
+			for( size_t f=sparse.dstStart[iDest]; f<sparse.dstStart[iDest+1]; ++f )
 			{
-				_TMatr.GetVectorValue( vDims, vSrcCoords, vDims, vDestCoords, vBufTFactors ); // get current factors
-				vTFactors.insert( vTFactors.end(), vBufTFactors.begin(), vBufTFactors.end() );
-				bTransRes = IncrementCoords( vSrcCoords, vClasses );
-			}
-			while( bTransRes );
-
-			for (unsigned i = 0; i < vCurrValues.size(); ++i)
-			{
-				if ((vTFactors[i] != 0) && (vCurrValues[i] != 0))
-				{
-					dNewValue += vCurrValues[i] * vTFactors[i];
-				}
+				const size_t iSrc = sparse.src[f];
+				if( ( iSrc < vCurrValues.size() ) && ( vCurrValues[iSrc] != 0 ) )
+					dNewValue += vCurrValues[iSrc] * sparse.value[f];
 			}
+			iDest++;
 
 			m_pSortMatr->SetValue( 1, vDims, vDestCoords, dNewValue, false ); // set new value
 
@@ -3187,6 +3259,12 @@ void CMDMatrix::Extrapolate3ToPointRecursive( sFraction *_pFraction, unsigned _n
 	}
 }
 
+std::unique_lock<std::mutex> CMDMatrix::LockForRead() const
+{
+	if( !m_bCacheEnabled ) return {};
+	return std::unique_lock<std::mutex>( m_mutexCache );
+}
+
 void CMDMatrix::UnCacheData(double _dTP) const
 {
 	if( !m_bCacheEnabled ) return;
@@ -8,6 +8,7 @@
 #include "TransformMatrix.h"
 #include "H5Handler.h"
 #include "MDMatrCacher.h"
+#include <mutex>
 
 #define DATA_SAVE_BLOCK	100
 
@@ -18,7 +19,8 @@ struct sFraction
 };
 
 /** This class is used to describe multidimensional distributed data. All data depends on time.
-*	One matrix is defined for all time points.*/
+*	One matrix is defined for all time points.
+*	All const functions can be called concurrently from several threads, as long as no modifying function is called at the same time.*/
 class CMDMatrix
 {
 private:
@@ -49,6 +51,8 @@ private:
 	mutable unsigned m_nNonCachedTPNum;
 	mutable size_t m_nCurrOffset;
 	mutable bool m_bCacheCoherent;
+	mutable std::mutex m_mutexCache;		///< Serializes reading functions if cache is enabled, since they may reload data from cache.
+	size_t m_nVersion{ 0 };					///< Incremented by each modifying function.
 
 public:
 	CMDMatrix( void );
@@ -101,6 +105,8 @@ public:
 	void RemoveTimePoint( double _dTime );
 	/** Removes time points from interval (incl).*/
 	void RemoveTimePoints( double _dStart, double _dEnd );
+	/** Removes all specified time points at once. Times must be sorted in ascending order. Not existing time points are ignored.*/
+	void RemoveTimePoints( const std::vector<double>& _vTimes );
 	/** Removes all time points after the specified time.
 	*	If _bIncludeTime == true, than _dTime will be includede in this time interval.*/
 	void RemoveTimePointsAfter( double _dTime, bool _bIncludeTime = false );
@@ -114,6 +120,8 @@ public:
 	double GetTimeForIndex( unsigned _nIndex ) const;
 	/** Returns number of defined time points.*/
 	size_t GetTimePointsNumber() const;
+	/** Returns a number, which changes each time the data is modified. Allows to validate values derived from the matrix.*/
+	size_t GetVersion() const;
 
 	// ========== Functions to work with MINIMAL FRACTION
 
@@ -342,14 +350,17 @@ private:
 	void ChangeTimePointRecursive( sFraction *_pFraction, unsigned _nNesting = 0 );
 	/** Removes time points from interval [m_dTempT1..m_dTempT2] or single time point m_dTempT1 (if m_dTempT2 == -1)*/
 	sFraction* RemoveTimePointsRecursive( sFraction *_pFraction, unsigned _nNesting = 0 );
-	/** Returns value for time m_dTempT1 according to specified dimensions m_vTempDims and coordinates m_vTempCoords. Dimensions set can be reduced.*/
-	double GetValueRecursive(sFraction *_pFraction, unsigned _nLevel = 1, unsigned _nNesting = 0) const;
+	/** Removes specified time points _vTimes from each fraction in one pass.*/
+	void RemoveTimePointsRecursive( sFraction *_pFraction, const std::vector<double>& _vTimes, unsigned _nNesting = 0 );
+	/** Returns value for time _dTime according to specified dimensions _vDims and coordinates _vCoords. Dimensions set can be reduced.
+	*	Does not use any member variables for temporary data, so can be called concurrently.*/
+	double GetValueRecursive(const sFraction *_pFraction, double _dTime, const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords, unsigned _nLevel = 1, unsigned _nNesting = 0) const;
 	/** Sets value m_dTempValue for time m_dTempT1 according to specified dimensions m_vTempDims and coordinates m_vTempCoords.
 	*	Dimensions set can be reduced. If time point wasn't defined, nothing will be done. Returns false on error.*/
 	bool SetValueRecursive( sFraction *_pFraction, bool _bExternal = true, unsigned _nLevel = 1, unsigned _nNesting = 0 );
-	/** Returns vector value for time m_dTempT1 according to specified dimensions m_vTempDims and coordinates m_vTempCoords.
-	*	Dimensions set can be reduced. Returns false on error.*/
-	bool GetVectorValueRecursive(sFraction *_pFraction, std::vector<double>& _vRes, unsigned _nNesting = 0) const;
+	/** Returns vector value for time _dTime according to specified dimensions _vDims and coordinates _vCoords.
+	*	Dimensions set can be reduced. Returns false on error. Does not use any member variables for temporary data, so can be called concurrently.*/
+	bool GetVectorValueRecursive(const sFraction *_pFraction, double _dTime, const std::vector<unsigned>& _vDims, const std::vector<unsigned>& _vCoords, std::vector<double>& _vRes, unsigned _nNesting = 0) const;
 	/*	Sets vector value m_vTempValues for time m_dTempT1 according to specified dimensions m_vTempDims and coordinates m_vTempCoords.
 	*	Dimensions set can be reduced. Returns false on error.*/
 	bool SetVectorValueRecursive( sFraction *_pFraction, unsigned _nNesting = 0 );
@@ -379,6 +390,9 @@ private:
 	void Extrapolate3ToPointRecursive( sFraction *_pFraction, unsigned _nNesting = 0 );
 
 
+	/** Returns a lock, which must be held by reading functions while they access data. The lock is acquired only if cache is enabled,
+	*	since otherwise reading never changes the matrix and can be performed concurrently without locking.*/
+	std::unique_lock<std::mutex> LockForRead() const;
 	void UnCacheData(double _dTP) const;
 	void UnCacheData(double _dT1, double _dT2) const;
 	void FlushToCache() const;
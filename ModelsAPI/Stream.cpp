@@ -5,6 +5,8 @@
 #include "DyssolStringConstants.h"
 #include "DyssolUtilities.h"
 #include <cfloat>
+#include <algorithm>
+#include <iterator>
 
 const unsigned CStream::m_cnSaveVersion	= 1;
 
@@ -82,6 +84,7 @@ void CStream::Clear()
 	m_vPLookupTables.clear();
 	m_TLookup1.Clear();
 	m_TLookup2.Clear();
+	UpdateCompoundsTable();
 }
 
 std::string CStream::GetStreamKey() const
@@ -171,6 +174,22 @@ void CStream::RemoveTimePoints( double _dStart, double _dEnd )
 	m_vTimePoints.erase( m_vTimePoints.begin() + iFirst, m_vTimePoints.begin() + iLast + 1 );
 }
 
+void CStream::RemoveTimePoints(const std::vector<double>& _vTimes)
+{
+	if( m_vTimePoints.empty() || _vTimes.empty() ) // nothing to remove
+		return;
+
+	for( unsigned i=0; i<m_DistrArrays.size(); i++ )
+		m_DistrArrays[i]->RemoveTimePoints( _vTimes );
+	for( unsigned i=0; i<m_vpPhases.size(); i++ )
+		m_vpPhases[i]->distribution.RemoveTimePoints( _vTimes );
+
+	std::vector<double> vRemain;
+	vRemain.reserve( m_vTimePoints.size() );
+	std::set_difference( m_vTimePoints.begin(), m_vTimePoints.end(), _vTimes.begin(), _vTimes.end(), std::back_inserter( vRemain ) );
+	m_vTimePoints.swap( vRemain );
+}
+
 void CStream::RemoveTimePointsAfter(double _dStart, bool _bIncludeStart /*= false */)
 {
 	for( unsigned i=0; i<m_DistrArrays.size(); i++ )
@@ -440,6 +459,7 @@ void CStream::AddCompound(std::string _sCompoundKey)
 	m_vPLookupTables.clear();
 	m_TLookup1.Clear();
 	m_TLookup2.Clear();
+	UpdateCompoundsTable();
 }
 
 void CStream::RemoveCompound(std::string _sCompoundKey)
@@ -455,6 +475,7 @@ void CStream::RemoveCompound(std::string _sCompoundKey)
 	m_vPLookupTables.clear();
 	m_TLookup1.Clear();
 	m_TLookup2.Clear();
+	UpdateCompoundsTable();
 }
 
 void CStream::SetCompounds(const std::vector<std::string>& _vCompoundsKeys)
@@ -551,10 +572,10 @@ double CStream::GetCompoundPhaseFraction(double _dTime, unsigned _nCompoundIndex
 	{
 		double dRes = 0;
 		for (unsigned i = 0; i < m_vCompoundsKeys.size(); ++i)
-			if (GetCompoundConstant(m_vCompoundsKeys[i], MOLAR_MASS) != 0)
-				dRes += m_vpPhases[nPhaseIndex]->distribution.GetValue(_dTime, DISTR_COMPOUNDS, i) / GetCompoundConstant(m_vCompoundsKeys[i], MOLAR_MASS);
-		if (GetCompoundConstant(m_vCompoundsKeys[_nCompoundIndex], MOLAR_MASS) != 0 && dRes != 0)
-			return m_vpPhases[nPhaseIndex]->distribution.GetValue(_dTime, DISTR_COMPOUNDS, _nCompoundIndex) / GetCompoundConstant(m_vCompoundsKeys[_nCompoundIndex], MOLAR_MASS) / dRes;
+			if (GetCompoundConstant(i, MOLAR_MASS) != 0)
+				dRes += m_vpPhases[nPhaseIndex]->distribution.GetValue(_dTime, DISTR_COMPOUNDS, i) / GetCompoundConstant(i, MOLAR_MASS);
+		if (GetCompoundConstant(_nCompoundIndex, MOLAR_MASS) != 0 && dRes != 0)
+			return m_vpPhases[nPhaseIndex]->distribution.GetValue(_dTime, DISTR_COMPOUNDS, _nCompoundIndex) / GetCompoundConstant(_nCompoundIndex, MOLAR_MASS) / dRes;
 		else
 			return 0;
 	}
@@ -594,8 +615,8 @@ void CStream::SetCompoundPhaseFraction(double _dTime, std::string _sCompoundKey,
 	{
 		double dWholeAmount = 0;
 		for (unsigned i = 0; i < m_vCompoundsKeys.size(); ++i)
-			if (GetCompoundConstant(m_vCompoundsKeys[i], MOLAR_MASS) != 0)
-				dWholeAmount += GetCompoundPhaseFraction(_dTime, i, _nPhase) / GetCompoundConstant(m_vCompoundsKeys[i], MOLAR_MASS);
+			if (GetCompoundConstant(i, MOLAR_MASS) != 0)
+				dWholeAmount += GetCompoundPhaseFraction(_dTime, i, _nPhase) / GetCompoundConstant(i, MOLAR_MASS);
 		double dSetVal = dWholeAmount != 0 ? _dFraction * GetCompoundConstant( _sCompoundKey, MOLAR_MASS ) / dWholeAmount : 0;
 		m_vpPhases[nPhaseIndex]->distribution.SetValue( _dTime, DISTR_COMPOUNDS, nCompoundIndex, dSetVal );
 	}
@@ -747,6 +768,21 @@ double CStream::GetCompoundTPDProp(double _dTime, const std::string& _sCompoundK
 	return GetCompoundTPDProp( _sCompoundKey, _nProperty, dTemperature, dPressure );
 }
 
+double CStream::GetCompoundConstant(size_t _nCompoundIndex, ECompoundConstProperties _nConstProperty) const
+{
+	return m_compoundsTable.GetConstPropertyValue(_nCompoundIndex, _nConstProperty);
+}
+
+double CStream::GetCompoundTPDProp(size_t _nCompoundIndex, unsigned _nProperty, double _dTemperature, double _dPressure) const
+{
+	return m_compoundsTable.GetTPPropertyValue(_nCompoundIndex, static_cast<ECompoundTPProperties>(_nProperty), _dTemperature, _dPressure);
+}
+
+double CStream::GetCompoundTPDProp(double _dTime, size_t _nCompoundIndex, unsigned _nProperty) const
+{
+	return GetCompoundTPDProp(_nCompoundIndex, _nProperty, GetTemperature(_dTime), GetPressure(_dTime));
+}
+
 double CStream::GetCompoundInteractionProp(const std::string& _sCompoundKey1, const std::string& _sCompoundKey2, unsigned _nProperty, const double _dTemperature, const double _dPressure) const
 {
 	if (!m_pMaterialsDB) return 0;
@@ -774,13 +810,24 @@ double CStream::GetCompoundInteractionProp(const std::string& _sCompoundKey1, co
 	case INT_PROP_USER_DEFINED_18:
 	case INT_PROP_USER_DEFINED_19:
 	case INT_PROP_USER_DEFINED_20:
+	{
+		const size_t iCompound1 = m_compoundsTable.GetIndex(_sCompoundKey1);
+		const size_t iCompound2 = m_compoundsTable.GetIndex(_sCompoundKey2);
+		if (iCompound1 != static_cast<size_t>(-1) && iCompound2 != static_cast<size_t>(-1))
+			return m_compoundsTable.GetInteractionPropertyValue(iCompound1, iCompound2, static_cast<EInteractionProperties>(_nProperty), _dTemperature, _dPressure);
 		return m_pMaterialsDB->GetInteractionPropertyValue(_sCompoundKey1, _sCompoundKey2, static_cast<EInteractionProperties>(_nProperty), _dTemperature, _dPressure);
+	}
 	case INT_PROP_NO_PROERTY: break;
 	}
 
 	return 0;
 }
 
+double CStream::GetCompoundInteractionProp(size_t _nCompoundIndex1, size_t _nCompoundIndex2, unsigned _nProperty, double _dTemperature, double _dPressure) const
+{
+	return m_compoundsTable.GetInteractionPropertyValue(_nCompoundIndex1, _nCompoundIndex2, static_cast<EInteractionProperties>(_nProperty), _dTemperature, _dPressure);
+}
+
 double CStream::GetCompoundInteractionProp(const double _dTime, const std::string _sCompoundKey1, const std::string _sCompoundKey2, const unsigned _nProperty) const
 {
 	const double dTemperature = GetTemperature(_dTime);
@@ -790,6 +837,9 @@ double CStream::GetCompoundInteractionProp(const double _dTime, const std::strin
 
 void CStream::AddPhase(std::string _sName, unsigned _nAggrState)
 {
+	m_nStructureVersion++;
+	ClearPropertiesCache();
+
 	// add phase to the structure
 	SPhase *pPhase = new SPhase;
 	pPhase->sName = _sName;
@@ -829,6 +879,9 @@ void CStream::RemovePhase(unsigned _nIndex)
 	if( _nIndex >= m_vpPhases.size() ) // wrong index
 		return;
 
+	m_nStructureVersion++;
+	ClearPropertiesCache();
+
 	m_vpPhases.erase( m_vpPhases.begin() + _nIndex );
 	m_PhaseFractions.RemoveDimension( _nIndex );
 }
@@ -838,6 +891,9 @@ void CStream::ChangePhase(unsigned _nIndex, std::string _sName, unsigned _nAggrS
 	if( _nIndex >= m_vpPhases.size() ) // wrong index
 		return;
 
+	m_nStructureVersion++;
+	ClearPropertiesCache();
+
 	m_vpPhases[_nIndex]->sName = _sName;
 
 	if( ( m_vpPhases[_nIndex]->nAggregationState == SOA_SOLID ) && ( _nAggrState != SOA_SOLID ) )
@@ -866,6 +922,9 @@ void CStream::SetPhases(const std::vector<std::string>& _vNames, const std::vect
 	if( _vNames.size() != _vAggrStates.size() ) // wrong parameters
 		return;
 
+	m_nStructureVersion++;
+	ClearPropertiesCache();
+
 	for( unsigned i=0; i<m_vpPhases.size(); ++i )
 		delete m_vpPhases[i];
 	m_vpPhases.clear();
@@ -986,25 +1045,34 @@ double CStream::GetSinglePhaseProp(double _dTime, unsigned _nProperty, unsigned
 		}
 		else
 		{
+			if (GetCachedProperty(_dTime, { _nProperty, _nPhase, _nBasis }, dRes))
+				break;
 			double dTemp = 0;
 			for (unsigned i = 0; i < m_vpPhases.size(); ++i)
 				if (GetSinglePhaseProp(_dTime, MOLAR_MASS, m_vpPhases[i]->nAggregationState) != 0)
 					dTemp += m_PhaseFractions.GetValue(_dTime, i) / GetSinglePhaseProp(_dTime, MOLAR_MASS, m_vpPhases[i]->nAggregationState);
 			if (GetSinglePhaseProp(_dTime, MOLAR_MASS, _nPhase) != 0 && dTemp != 0)
 				dRes = m_PhaseFractions.GetValue(_dTime, nPhaseIndex) / GetSinglePhaseProp(_dTime, MOLAR_MASS, _nPhase) / dTemp;
+			SetCachedProperty(_dTime, { _nProperty, _nPhase, _nBasis }, dRes);
 		}
 		break;
 	case MOLAR_MASS:
+		if (GetCachedProperty(_dTime, { _nProperty, _nPhase, BASIS_MASS }, dRes))
+			break;
 		for (unsigned i = 0; i < m_vCompoundsKeys.size(); ++i)
-			if (GetCompoundConstant(m_vCompoundsKeys[i], MOLAR_MASS) != 0)
-				dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) / GetCompoundConstant(m_vCompoundsKeys[i], MOLAR_MASS);
+			if (GetCompoundConstant(i, MOLAR_MASS) != 0)
+				dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) / GetCompoundConstant(i, MOLAR_MASS);
 		if (dRes != 0)
 			dRes = 1 / dRes;
+		SetCachedProperty(_dTime, { _nProperty, _nPhase, BASIS_MASS }, dRes);
 		break;
 	case ENTHALPY:
 		if( _nBasis == BASIS_MOLL )
 		{
+			if (GetCachedProperty(_dTime, { _nProperty, _nPhase, _nBasis }, dRes))
+				break;
 			dRes = GetPhaseTPDProp(_dTime, _nProperty, _nPhase) * GetSinglePhaseProp(_dTime, MOLAR_MASS, _nPhase);
+			SetCachedProperty(_dTime, { _nProperty, _nPhase, _nBasis }, dRes);
 		}
 		else
 		{
@@ -1098,6 +1166,158 @@ void CStream::SetSinglePhaseProp(double _dTime, unsigned _nProperty, unsigned _n
 
 /// For single phase mixture
 double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nPhase) const
+{
+	double dRes;
+	if (GetCachedProperty(_dTime, { _nProperty, _nPhase, BASIS_MASS }, dRes))
+		return dRes;
+	dRes = CalculatePhaseTPDProp(_dTime, _nProperty, _nPhase);
+	SetCachedProperty(_dTime, { _nProperty, _nPhase, BASIS_MASS }, dRes);
+	return dRes;
+}
+
+size_t CStream::GetPropertiesCacheHits() const
+{
+	return m_nPropertiesCacheHits;
+}
+
+size_t CStream::GetPropertiesCacheMisses() const
+{
+	return m_nPropertiesCacheMisses;
+}
+
+void CStream::ClearPropertiesCache()
+{
+	std::unique_lock<std::shared_mutex> lock(m_mutexPropertiesCache);
+	m_propertiesCache.clear();
+	m_nCachedProperties = 0;
+}
+
+std::vector<size_t> CStream::GetDataVersions() const
+{
+	std::vector<size_t> vVersions{ m_nStructureVersion };
+	for (const auto& distr : m_DistrArrays)
+		vVersions.push_back(distr->GetVersion());
+	for (const auto& phase : m_vpPhases)
+		vVersions.push_back(phase->distribution.GetVersion());
+	return vVersions;
+}
+
+size_t CStream::GetDataVersion() const
+{
+	// versions of existing data only grow, so their sum changes whenever any of them changes;
+	// phases that are added, removed or changed get new versions, therefore such functions clear the cache explicitly
+	size_t nVersion = m_StreamMTP.GetVersion() + m_PhaseFractions.GetVersion();
+	for (const auto& phase : m_vpPhases)
+		nVersion += phase->distribution.GetVersion();
+	return nVersion;
+}
+
+std::vector<double> CStream::GetPropertiesInputs(double _dTime) const
+{
+	std::vector<double> vInputs{ GetTemperature(_dTime), GetPressure(_dTime) };
+	const std::vector<double> vPhaseFractions = m_PhaseFractions.GetValue(_dTime);
+	vInputs.insert(vInputs.end(), vPhaseFractions.begin(), vPhaseFractions.end());
+	const bool bPorosity = m_pDistributionsGrid && m_pDistributionsGrid->IsDistrTypePresent(DISTR_PART_POROSITY);
+	for (const auto& phase : m_vpPhases)
+	{
+		const std::vector<double> vCompounds = phase->distribution.GetVectorValue(_dTime, DISTR_COMPOUNDS);
+		vInputs.insert(vInputs.end(), vCompounds.begin(), vCompounds.end());
+		// density of solids depends on porosity
+		if (bPorosity && phase->nAggregationState == SOA_SOLID)
+		{
+			CMatrix2D distr;
+			phase->distribution.GetDistribution(_dTime, DISTR_COMPOUNDS, DISTR_PART_POROSITY, distr);
+			for (size_t i = 0; i < distr.Rows(); ++i)
+				vInputs.insert(vInputs.end(), distr[i].begin(), distr[i].end());
+		}
+	}
+	return vInputs;
+}
+
+void CStream::RevalidateCachedProperties(double _dTime, SCachedProperties& _entry, size_t _nVersion) const
+{
+	if (_entry.nVersion == _nVersion) return;
+	// data of the stream have changed somewhere: keep the properties if it was not at this time point
+	std::vector<double> vInputs = GetPropertiesInputs(_dTime);
+	if (vInputs != _entry.vInputs)
+	{
+		m_nCachedProperties -= _entry.values.size();
+		_entry.values.clear();
+		_entry.vInputs = std::move(vInputs);
+	}
+	_entry.nVersion = _nVersion;
+}
+
+bool CStream::GetCachedProperty(double _dTime, const property_cache_key_t& _key, double& _dValue) const
+{
+	const auto Find = [&](SCachedProperties& _entry)
+	{
+		_entry.nLastUse = ++m_nPropertiesCacheClock;
+		const auto it = _entry.values.find(_key);
+		if (it == _entry.values.end())
+		{
+			++m_nPropertiesCacheMisses;
+			return false;
+		}
+		++m_nPropertiesCacheHits;
+		_dValue = it->second;
+		return true;
+	};
+
+	const size_t nVersion = GetDataVersion();
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutexPropertiesCache);
+		const auto itTime = m_propertiesCache.find(_dTime);
+		if (itTime == m_propertiesCache.end())
+		{
+			++m_nPropertiesCacheMisses;
+			return false;
+		}
+		if (itTime->second.nVersion == nVersion)
+			return Find(itTime->second);
+	}
+	// cached properties of this time point must be checked against the changed data
+	std::unique_lock<std::shared_mutex> lock(m_mutexPropertiesCache);
+	const auto itTime = m_propertiesCache.find(_dTime);
+	if (itTime == m_propertiesCache.end())
+	{
+		++m_nPropertiesCacheMisses;
+		return false;
+	}
+	RevalidateCachedProperties(_dTime, itTime->second, nVersion);
+	return Find(itTime->second);
+}
+
+void CStream::SetCachedProperty(double _dTime, const property_cache_key_t& _key, double _dValue) const
+{
+	const size_t nVersion = GetDataVersion();
+	std::unique_lock<std::shared_mutex> lock(m_mutexPropertiesCache);
+	const auto [itTime, bInserted] = m_propertiesCache.try_emplace(_dTime);
+	SCachedProperties& entry = itTime->second;
+	if (bInserted)
+	{
+		entry.nVersion = nVersion;
+		entry.vInputs = GetPropertiesInputs(_dTime);
+	}
+	else
+		RevalidateCachedProperties(_dTime, entry, nVersion);
+	entry.nLastUse = ++m_nPropertiesCacheClock;
+	if (entry.values.insert_or_assign(_key, _dValue).second)
+		++m_nCachedProperties;
+
+	// remove the least recently used time points
+	while (m_nCachedProperties > m_cnMaxCachedProperties && m_propertiesCache.size() > 1)
+	{
+		auto itOldest = m_propertiesCache.end();
+		for (auto it = m_propertiesCache.begin(); it != m_propertiesCache.end(); ++it)
+			if (it != itTime && (itOldest == m_propertiesCache.end() || it->second.nLastUse < itOldest->second.nLastUse))
+				itOldest = it;
+		m_nCachedProperties -= itOldest->second.values.size();
+		m_propertiesCache.erase(itOldest);
+	}
+}
+
+double CStream::CalculatePhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nPhase) const
 {
 	int nPhaseIndex = -1;
 	for( unsigned i=0; i<m_vpPhases.size(); ++i )
@@ -1122,11 +1342,11 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 	{
 	case VAPOR_PRESSURE:
 		//dRes = m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[0], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-		dRes = m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[0], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+		dRes = m_compoundsTable.GetTPPropertyValue(0, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
 		for( unsigned i=1; i<m_vCompoundsKeys.size(); ++i )
 		{
 			//double dNewPressure = m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[0], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-			double dNewPressure = m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[0], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+			double dNewPressure = m_compoundsTable.GetTPPropertyValue(0, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
 			dRes = std::min( dNewPressure, dRes );
 		}
 		break;
@@ -1138,7 +1358,7 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 			for( unsigned i=0; i<m_vCompoundsKeys.size(); ++i )
 			{
 				//double dVisco = m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[i], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-				double dVisco = m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[i], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+				double dVisco = m_compoundsTable.GetTPPropertyValue(i, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
 				if (dVisco != 0)
 					dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) * std::log(dVisco);
 			}
@@ -1151,8 +1371,8 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 			for( unsigned i=0; i<m_vCompoundsKeys.size(); ++i )
 			{
 				//double dVisco = m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[i], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-				double dVisco = m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[i], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
-				double dMollMass = GetCompoundConstant( m_vCompoundsKeys[i], MOLAR_MASS );
+				double dVisco = m_compoundsTable.GetTPPropertyValue(i, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+				double dMollMass = GetCompoundConstant(i, MOLAR_MASS);
 				double dMollFrac = GetCompoundPhaseFraction( _dTime, i, _nPhase, BASIS_MOLL );
 				dNumerator += dMollFrac * dVisco * std::sqrt( dMollMass );
 				dDenominator += dMollFrac * std::sqrt( dMollMass );
@@ -1164,7 +1384,7 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 		default:
 			for( unsigned i=0; i<m_vCompoundsKeys.size(); ++i )
 				//dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) * m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[i], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-				dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) * m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[i], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+				dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) * m_compoundsTable.GetTPPropertyValue(i, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
 			break;
 		}
 		break;
@@ -1176,7 +1396,7 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 			for( unsigned i=0; i<m_vCompoundsKeys.size(); ++i )
 				dRes += GetCompoundPhaseFraction( _dTime, i, _nPhase, BASIS_MOLL )
 				/// std::pow(m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[i], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP), 2.0);
-				/ std::pow(m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[i], static_cast<ECompoundTPProperties>(_nProperty), dT, dP), 2.0);
+				/ std::pow(m_compoundsTable.GetTPPropertyValue(i, static_cast<ECompoundTPProperties>(_nProperty), dT, dP), 2.0);
 			if( dRes != 0 )
 				dRes = 1/ std::sqrt( dRes );
 			break;
@@ -1185,14 +1405,14 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 			{
 				double dNumerator, dDenominator = 0;
 				//double dConductI = m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[i], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-				double dConductI = m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[i], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
-				double dMollMassI = GetCompoundConstant( m_vCompoundsKeys[i], MOLAR_MASS );
+				double dConductI = m_compoundsTable.GetTPPropertyValue(i, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+				double dMollMassI = GetCompoundConstant(i, MOLAR_MASS);
 				dNumerator = GetCompoundPhaseFraction( _dTime, i, _nPhase, BASIS_MOLL ) * dConductI;
 				for( unsigned j=0; j<m_vCompoundsKeys.size(); ++j )
 				{
 					//double dConductJ = m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[j], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-					double dConductJ = m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[j], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
-					double dMollMassJ = GetCompoundConstant( m_vCompoundsKeys[j], MOLAR_MASS );
+					double dConductJ = m_compoundsTable.GetTPPropertyValue(j, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+					double dMollMassJ = GetCompoundConstant(j, MOLAR_MASS);
 					double dF = std::pow( ( 1 + std::sqrt( dConductI/dConductJ ) * std::pow( dMollMassJ/dMollMassI, 1/4 ) ), 2 ) / (std::sqrt( 8*( 1 + dMollMassI/dMollMassJ ) ) );
 					dDenominator += GetCompoundPhaseFraction( _dTime, j, _nPhase, BASIS_MOLL ) * dF;
 				}
@@ -1203,7 +1423,7 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 		default:
 			for( unsigned i=0; i<m_vCompoundsKeys.size(); ++i )
 				//dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) * m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[i], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-				dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) * m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[i], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+				dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) * m_compoundsTable.GetTPPropertyValue(i, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
 			break;
 		}
 		break;
@@ -1217,7 +1437,7 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 			std::vector<double> vPorosities = m_pDistributionsGrid->GetClassMeansByDistr( DISTR_PART_POROSITY );
 			for(size_t iComp=0; iComp<nCompNum; ++iComp )
 			{
-				double dDensity = GetCompoundTPDProp( _dTime, m_vCompoundsKeys[iComp], DENSITY );
+				double dDensity = GetCompoundTPDProp( _dTime, iComp, DENSITY );
 				for(size_t iPoros=0; iPoros<nPorosNum; ++iPoros )
 				{
 					//double d = distr.GetValue( iComp, iPoros );
@@ -1231,7 +1451,7 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 			for( unsigned i=0; i<m_vCompoundsKeys.size(); ++i )
 			{
 				//double dComponentDensity = m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[i], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-				double dComponentDensity = m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[i], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+				double dComponentDensity = m_compoundsTable.GetTPPropertyValue(i, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
 				if( dComponentDensity != 0 )
 					dRes += GetCompoundPhaseFraction( _dTime, i, _nPhase ) / dComponentDensity;
 			}
@@ -1244,7 +1464,7 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 		{
 			double dTempCompFrac = GetCompoundPhaseFraction(_dTime, i, _nPhase);
 			//dRes += dTempCompFrac * m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[i], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-			dRes += dTempCompFrac * m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[i], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+			dRes += dTempCompFrac * m_compoundsTable.GetTPPropertyValue(i, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
 		}
 		//dRes += CalcEnthalpyPressureCorrection(_dTime, _nPhase, MOLAR_MASS);
 		break;
@@ -1271,7 +1491,7 @@ double CStream::GetPhaseTPDProp(double _dTime, unsigned _nProperty, unsigned _nP
 	case TP_PROP_USER_DEFINED_20:
 		for (unsigned i = 0; i < m_vCompoundsKeys.size(); ++i)
 			//dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) * m_pMaterialsDB->GetPropertyValue(m_vCompoundsKeys[i], _nProperty, m_vpPhases[nPhaseIndex]->nAggregationState, dT, dP);
-			dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) * m_pMaterialsDB->GetTPPropertyValue(m_vCompoundsKeys[i], static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
+			dRes += GetCompoundPhaseFraction(_dTime, i, _nPhase) * m_compoundsTable.GetTPPropertyValue(i, static_cast<ECompoundTPProperties>(_nProperty), dT, dP);
 		break;
 	case TP_PROP_NO_PROERTY: break;
 	}
@@ -1299,6 +1519,8 @@ void CStream::SetDistributionsGrid(const CDistributionsGrid* _pGrid)
 	}
 
 	m_pDistributionsGrid = _pGrid;
+	m_nStructureVersion++;
+	ClearPropertiesCache();
 }
 
 std::vector<unsigned> CStream::GetDistributionsTypes() const
@@ -1929,6 +2151,13 @@ void CStream::SetPSD(double _dTime, EPSDTypes _PSDType, const std::string& _sCom
 void CStream::SetMaterialsDatabase(const CMaterialsDatabase* _pDatabase)
 {
 	m_pMaterialsDB = _pDatabase;
+	UpdateCompoundsTable();
+}
+
+void CStream::UpdateCompoundsTable()
+{
+	m_compoundsTable.Update(m_pMaterialsDB, m_vCompoundsKeys);
+	ClearPropertiesCache();
 }
 
 void CStream::SetMinimalFraction( double _dFraction )
@@ -2011,6 +2240,7 @@ void CStream::LoadFromFile(CH5Handler& _h5Loader, const std::string& _sPath)
 
 	/// load compounds
 	_h5Loader.ReadData( _sPath, StrConst::Stream_H5Compounds, m_vCompoundsKeys );
+	UpdateCompoundsTable();
 
 	/// load time points
 	_h5Loader.ReadData( _sPath, StrConst::Stream_H5TimePoints, m_vTimePoints );
@@ -2040,6 +2270,9 @@ void CStream::LoadFromFile(CH5Handler& _h5Loader, const std::string& _sPath)
 
 	for( unsigned i=0; i<m_vpPhases.size(); ++i )
 		m_PhaseFractions.SetDimensionLabel( i, m_vpPhases[i]->sName );
+
+	m_nStructureVersion++;
+	ClearPropertiesCache();
 }
 
 void CStream::ReduceTimePoints(double _dStart, double _dEnd, double _dStep)
@@ -2050,21 +2283,82 @@ void CStream::ReduceTimePoints(double _dStart, double _dEnd, double _dStep)
 	if (vTP.size() <= 3) return;
 	vTP.pop_back();
 
-	size_t iT1 = 0;
-	size_t iT2 = 1;
-	while ((iT1 < vTP.size()) && (iT2 < vTP.size()))
+	// select time points closer than _dStep to the last remaining one
+	std::vector<double> vRemove;
+	double dLast = vTP.front();
+	for (size_t i = 1; i < vTP.size(); ++i)
+		if (std::fabs(dLast - vTP[i]) < _dStep)
+			vRemove.push_back(vTP[i]);
+		else
+			dLast = vTP[i];
+
+	RemoveTimePoints(vRemove);
+}
+
+void CStream::CompressTimePoints(double _dStart, double _dEnd, double _dATol, double _dRTol)
+{
+	const std::vector<double> vTP = GetTimePointsForInterval(_dStart, _dEnd);
+	if (vTP.size() <= 2) return;
+
+	// gather all values for each time point
+	std::vector<std::vector<double>> vvValues(vTP.size());
+	CDenseMDMatrix distr;
+	for (size_t i = 0; i < vTP.size(); ++i)
 	{
-		if (std::fabs(vTP[iT1] - vTP[iT2]) < _dStep)
+		for (const auto& array : m_DistrArrays)
 		{
-			RemoveTimePoint(vTP[iT2]);
-			vTP.erase(vTP.begin() + iT2);
+			const std::vector<double> vArray = array->GetValue(vTP[i]);
+			vvValues[i].insert(vvValues[i].end(), vArray.begin(), vArray.end());
 		}
-		else
+		for (const auto& phase : m_vpPhases)
+			if (phase->distribution.GetDistribution(vTP[i], distr))
+				vvValues[i].insert(vvValues[i].end(), distr.GetDataPtr(), distr.GetDataPtr() + distr.GetDataLength());
+	}
+
+	// returns how much the worst value at time point _i exceeds the tolerance, if interpolated between time points _i1 and _i2
+	const auto Excess = [&](size_t _i1, size_t _i, size_t _i2)
+	{
+		double dMax = -1;
+		for (size_t k = 0; k < vvValues[_i].size() && k < vvValues[_i1].size() && k < vvValues[_i2].size(); ++k)
 		{
-			iT1++;
-			iT2++;
+			const double dValue = vvValues[_i][k];
+			const double dInterp = Interpolate(vvValues[_i1][k], vvValues[_i2][k], vTP[_i1], vTP[_i2], vTP[_i]);
+			dMax = std::max(dMax, std::fabs(dValue - dInterp) - (std::fabs(dValue) * _dRTol + _dATol));
 		}
+		return dMax;
+	};
+
+	// recursively split intervals at the worst point, until all points in between can be interpolated
+	std::vector<bool> vKeep(vTP.size(), false);
+	vKeep.front() = vKeep.back() = true;
+	std::vector<std::pair<size_t, size_t>> vIntervals{ { 0, vTP.size() - 1 } };
+	while (!vIntervals.empty())
+	{
+		const auto interval = vIntervals.back();
+		vIntervals.pop_back();
+		double dMax = 0;
+		size_t iMax = 0;
+		for (size_t i = interval.first + 1; i < interval.second; ++i)
+		{
+			const double dExcess = Excess(interval.first, i, interval.second);
+			if (dExcess > dMax)
+			{
+				dMax = dExcess;
+				iMax = i;
+			}
+		}
+		if (iMax == 0) continue; // all points can be interpolated
+		vKeep[iMax] = true;
+		vIntervals.emplace_back(interval.first, iMax);
+		vIntervals.emplace_back(iMax, interval.second);
 	}
+
+	std::vector<double> vRemove;
+	for (size_t i = 0; i < vTP.size(); ++i)
+		if (!vKeep[i])
+			vRemove.push_back(vTP[i]);
+
+	RemoveTimePoints(vRemove);
 }
 
 void CStream::SetCacheParams( bool _bEnabled, unsigned _nWindow )
@@ -2286,13 +2580,13 @@ std::vector<CDenseMDMatrix> CStream::CalcMixMDDistributions(const CStream& _str1
 	{
 		CDenseMDMatrix distr1 = _str1.m_vpPhases[i]->distribution.GetDistribution(_time1);
 		CDenseMDMatrix distr2 = _str2.m_vpPhases[i]->distribution.GetDistribution(_time2);
-		vDistrsMix[i] = distr2*_mass2*_phaseFracs2[i] + distr1*_mass1*_phaseFracs1[i];
+		vDistrsMix[i].SetLinearCombination(_mass2, _phaseFracs2[i], distr2, _mass1, _phaseFracs1[i], distr1);
 
 		// TODO: more effective solution
 		// hack to save compounds distributions. if all compounds are set to 0, recalculate vResDistr
 		std::vector<double> vCompFracs = vDistrsMix[i].GetVectorValue(DISTR_COMPOUNDS);
 		if (std::all_of(vCompFracs.begin(), vCompFracs.end(), [](double d) { return d == 0; })) // all are equal to 0
-			vDistrsMix[i] = distr2*_mass2 + distr1*_mass1; // TODO: all secondary dimensions will be also recalculated
+			vDistrsMix[i].SetLinearCombination(_mass2, distr2, _mass1, distr1); // TODO: all secondary dimensions will be also recalculated
 
 		vDistrsMix[i].Normalize();
 	}
@@ -2674,7 +2968,7 @@ void CStream::AddPropertyTable(ECompoundTPProperties _nProperty, EDependencyType
 		m_vPLookupTables.insert_or_assign(_nProperty, CLookupTable(m_pMaterialsDB, m_vCompoundsKeys, _nProperty, _nDependenceType));
 }
 
-CLookupTable* CStream::GetLookupTable(ECompoundTPProperties _nProperty, EDependencyTypes _nDependenceType, double _dTime) const
+CLookupTable* CStream::PrepareLookupTable(ECompoundTPProperties _nProperty, EDependencyTypes _nDependenceType, double _dTime) const
 {
 	if (!IsDefined(_nProperty, _nDependenceType))
 		AddPropertyTable(_nProperty, _nDependenceType);
@@ -2689,22 +2983,32 @@ CLookupTable* CStream::GetLookupTable(ECompoundTPProperties _nProperty, EDepende
 	return pTable;
 }
 
+CLookupTable CStream::GetLookupTable(ECompoundTPProperties _nProperty, EDependencyTypes _nDependenceType, double _dTime) const
+{
+	std::lock_guard<std::mutex> lock(m_mutexLookupTables);
+	return *PrepareLookupTable(_nProperty, _nDependenceType, _dTime);
+}
+
 double CStream::CalcTemperatureFromProperty(ECompoundTPProperties _nProperty, double _dTime, double _dValue) const
 {
-	return GetLookupTable(_nProperty, EDependencyTypes::DEPENDENCE_TEMP, _dTime)->GetParam(_dValue);
+	std::lock_guard<std::mutex> lock(m_mutexLookupTables);
+	return PrepareLookupTable(_nProperty, EDependencyTypes::DEPENDENCE_TEMP, _dTime)->GetParam(_dValue);
 }
 
 double CStream::CalcPressureFromProperty(ECompoundTPProperties _nProperty, double _dTime, double _dValue) const
 {
-	return GetLookupTable(_nProperty, EDependencyTypes::DEPENDENCE_PRES, _dTime)->GetParam(_dValue);
+	std::lock_guard<std::mutex> lock(m_mutexLookupTables);
+	return PrepareLookupTable(_nProperty, EDependencyTypes::DEPENDENCE_PRES, _dTime)->GetParam(_dValue);
 }
 
 double CStream::CalcPropertyFromTemperature(ECompoundTPProperties _nProperty, double _dTime, double _dT) const
 {
-	return GetLookupTable(_nProperty, EDependencyTypes::DEPENDENCE_TEMP, _dTime)->GetValue(_dT);
+	std::lock_guard<std::mutex> lock(m_mutexLookupTables);
+	return PrepareLookupTable(_nProperty, EDependencyTypes::DEPENDENCE_TEMP, _dTime)->GetValue(_dT);
 }
 
 double CStream::CalcPropertyFromPressure(ECompoundTPProperties _nProperty, double _dTime, double _dP) const
 {
-	return GetLookupTable(_nProperty, EDependencyTypes::DEPENDENCE_PRES, _dTime)->GetValue(_dP);
+	std::lock_guard<std::mutex> lock(m_mutexLookupTables);
+	return PrepareLookupTable(_nProperty, EDependencyTypes::DEPENDENCE_PRES, _dTime)->GetValue(_dP);
 }
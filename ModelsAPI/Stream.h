@@ -7,8 +7,11 @@
 #include "MDMatrix.h"
 #include "DistributionsGrid.h"
 #include "MaterialsDatabase.h"
+#include "CompoundsTable.h"
 #include "DenseDistr2D.h"
 #include "LookupTable.h"
+#include <atomic>
+#include <shared_mutex>
 
 class CStream;
 class CMaterialStream;
@@ -45,13 +48,33 @@ protected:
 
 	const CDistributionsGrid* m_pDistributionsGrid;	///< Pointer to a grid with size classes
 	const CMaterialsDatabase* m_pMaterialsDB;		///< Pointer to a database of materials
+	CCompoundsTable m_compoundsTable;				///< Compounds of the stream resolved in the database of materials, to access their properties by indices
 
 	std::vector<CDenseDistr2D*> m_DistrArrays;		///< Pointers to all dense distributed properties, to simplify massive make operations
+	size_t m_nStructureVersion{ 0 };				///< Incremented each time phases of the stream are added, removed or replaced
 
 	mutable std::map<ECompoundTPProperties, CLookupTable> m_vTLookupTables;	///< Map with all lookup tables for Temperature (for fast use)
 	mutable std::map<ECompoundTPProperties, CLookupTable> m_vPLookupTables;	///< Map with all lookup tables for Pressure (for fast use)
+	mutable std::mutex m_mutexLookupTables;	///< Guards lookup tables in const functions, which are used concurrently.
 	CLookupTable m_TLookup1, m_TLookup2;	/// Lookup tabel to calculate mixtures (for speed-up).
 
+	using property_cache_key_t = std::tuple<unsigned, unsigned, unsigned>;	///< Property, phase, and basis of a cached mixture property.
+	/** Mixture properties cached for one time point.*/
+	struct SCachedProperties
+	{
+		size_t nVersion{ 0 };								///< Version of the data of the stream, for which the inputs have been checked last.
+		std::vector<double> vInputs;						///< Data of the stream at this time point, which the properties are calculated from.
+		std::map<property_cache_key_t, double> values;		///< Calculated properties.
+		std::atomic<size_t> nLastUse{ 0 };					///< Moment of the last request to these properties, to evict the least recently used time points.
+	};
+	static constexpr size_t m_cnMaxCachedProperties = 10000;	///< Maximum number of mixture properties kept in the cache.
+	mutable std::map<double, SCachedProperties> m_propertiesCache;	///< Calculated mixture properties for each time point, valid as long as the inputs at this time point do not change.
+	mutable size_t m_nCachedProperties{ 0 };				///< Total number of cached properties over all time points.
+	mutable std::atomic<size_t> m_nPropertiesCacheClock{ 0 };	///< Incremented by each request to the cache, to timestamp the usage of time points.
+	mutable std::atomic<size_t> m_nPropertiesCacheHits{ 0 };		///< Number of property requests answered from cache.
+	mutable std::atomic<size_t> m_nPropertiesCacheMisses{ 0 };	///< Number of property requests, which required calculation.
+	mutable std::shared_mutex m_mutexPropertiesCache;		///< Guards the properties cache in const functions: shared by readers, exclusive for updates.
+
 public:
 	/** Basic constructor.
 	 *	\param _sKey Unique key of this stream*/
@@ -101,6 +124,9 @@ public:
 	void RemoveTimePoint( double _dTime );
 	/** Removes time points from specified interval. Returns index of first remaining time point after interval.*/
 	void RemoveTimePoints( double _dStart, double _dEnd );
+	/** Removes all specified time points at once, compacting each underlying distribution in one pass.
+	 *	\param _vTimes Time points to remove, sorted in ascending order. Not existing time points are ignored*/
+	void RemoveTimePoints( const std::vector<double>& _vTimes );
 	/** Removes all data after specified time point.
 	*	\param _dStart All data after this time will be removed
 	*	\param _bIncludeStart Specifies if _dStart will be included into a time interval*/
@@ -244,6 +270,17 @@ public:
 		for specified phase in time point _dTime.*/
 	double GetPhaseTPDProp( double _dTime, unsigned _nProperty, unsigned _nPhase ) const;
 
+	/** Returns number of requests to mixture properties, which were answered from the properties cache.*/
+	size_t GetPropertiesCacheHits() const;
+	/** Returns number of requests to mixture properties, which required calculation.*/
+	size_t GetPropertiesCacheMisses() const;
+	/** Removes all cached mixture properties. They are also discarded automatically for each time point, at which the data of the stream change.*/
+	void ClearPropertiesCache();
+
+	/** Returns versions of all time-dependent data of the stream. They change each time the data, time points or phases of the stream are modified,
+	 *	so the data is the same as long as the returned versions are the same.*/
+	std::vector<size_t> GetDataVersions() const;
+
 	/** Returns pointer to a vector of phases.*/
 	std::vector<SPhase*>* GetPhases();
 	const std::vector<SPhase*>* GetPhases() const;
@@ -449,6 +486,9 @@ public:
 	/** Set database of materials.
 	 *	\param _pDatabase Pointer to a materials database*/
 	void SetMaterialsDatabase( const CMaterialsDatabase* _pDatabase );
+	/** Resolves compounds of the stream and their properties in the database of materials anew. Should be called after the structure of the database has been changed,
+	 *	otherwise properties are still correctly obtained, but by searching for compounds keys. Also clears the cache of mixture properties.*/
+	void UpdateCompoundsTable();
 
 	// ============= Functions to work with MINIMAL FRACTION
 
@@ -465,6 +505,9 @@ public:
 
 	// Removes time points within the specified interval [_dStart; _dEnd), which are closer as _dStep.
 	void ReduceTimePoints(double _dStart, double _dEnd, double _dStep);
+	// Removes time points within the specified interval (_dStart; _dEnd), which can be linearly interpolated from the remaining ones with the given tolerances.
+	// All overall parameters, phase fractions and distributions are checked. Remaining points are selected by recursive splitting of the interval at the worst point.
+	void CompressTimePoints(double _dStart, double _dEnd, double _dATol, double _dRTol);
 
 	void SetCachePath(const std::wstring& _sPath);
 	void SetCacheParams( bool _bEnabled, unsigned _nWindow );
@@ -585,12 +628,19 @@ public:
 		for specified compound with specified temperature [K] and pressure [Pa].*/
 	double GetCompoundTPDProp(const std::string& _sCompoundKey, unsigned _nProperty, double _dTemperature, double _dPressure) const;
 	double GetCompoundTPDProp( double _dTime, const std::string& _sCompoundKey, unsigned _nProperty ) const;
+	/** Get the value of the constant physical property for the compound with the specified index.*/
+	double GetCompoundConstant(size_t _nCompoundIndex, ECompoundConstProperties _nConstProperty) const;
+	/** Return the value of temperature/pressure-dependent physical property for the compound with the specified index with specified temperature [K] and pressure [Pa].*/
+	double GetCompoundTPDProp(size_t _nCompoundIndex, unsigned _nProperty, double _dTemperature, double _dPressure) const;
+	double GetCompoundTPDProp( double _dTime, size_t _nCompoundIndex, unsigned _nProperty ) const;
 	/** Returns the value of interaction property (INTERFACE_TENSION, INT_PROP_USER_DEFINED_01, INT_PROP_USER_DEFINED_02, etc)
 	 * between specified compounds under specified temperature [K] and pressure [Pa].*/
 	double GetCompoundInteractionProp(const std::string& _sCompoundKey1, const std::string& _sCompoundKey2, unsigned _nProperty, double _dTemperature, double _dPressure) const;
 	/** Returns the value of interaction property (INTERFACE_TENSION, INT_PROP_USER_DEFINED_01, INT_PROP_USER_DEFINED_02, etc)
 	 * between specified compounds under current temperature and pressure at the specified time point.*/
 	double GetCompoundInteractionProp(double _dTime, const std::string _sCompoundKey1, const std::string _sCompoundKey2, unsigned _nProperty) const;
+	/** Returns the value of interaction property between compounds with specified indices under specified temperature [K] and pressure [Pa].*/
+	double GetCompoundInteractionProp(size_t _nCompoundIndex1, size_t _nCompoundIndex2, unsigned _nProperty, double _dTemperature, double _dPressure) const;
 
 	// ============= Functions to work with PHASES
 
@@ -622,6 +672,21 @@ private:
 	bool IsPhaseDefined( unsigned _nPhaseType ) const;
 	unsigned GetLiquidPhasesNumber() const;
 
+	/** Calculates the value of temperature/pressure-dependent physical property for specified phase in time point _dTime, see GetPhaseTPDProp().*/
+	double CalculatePhaseTPDProp( double _dTime, unsigned _nProperty, unsigned _nPhase ) const;
+	/** Returns a number, which changes each time MTP, phase fractions or phase distributions of the stream are modified.*/
+	size_t GetDataVersion() const;
+	/** Returns the data of the stream at time point _dTime, which mixture properties are calculated from: temperature, pressure, phase fractions, and compositions of phases.*/
+	std::vector<double> GetPropertiesInputs( double _dTime ) const;
+	/** Makes the cached properties of the time point valid for the data of the stream with version _nVersion, discarding them if their inputs have changed.
+	 *	Must be called with exclusively locked properties cache.*/
+	void RevalidateCachedProperties( double _dTime, SCachedProperties& _entry, size_t _nVersion ) const;
+	/** Reads a mixture property at time point _dTime from the properties cache. Returns false if it has not been cached for the current data of the stream.*/
+	bool GetCachedProperty( double _dTime, const property_cache_key_t& _key, double& _dValue ) const;
+	/** Puts a mixture property at time point _dTime, calculated for the current data of the stream, into the properties cache.
+	 *	If the cache is full, removes the properties of the least recently used time points.*/
+	void SetCachedProperty( double _dTime, const property_cache_key_t& _key, double _dValue ) const;
+
 	/**	Returns a value for the pressure correction of the enthalpy of the stream, i.e. liquid1 and liquid2 phase of stream.
 		The pressure correction only depends on the liquid phase, as gas is assumed with ideal behavior and solids enthalpy doesn't depend on pressure.
 	*	\param _dTime Time point
@@ -648,13 +713,20 @@ private:
 	*	\param _nDependenceType dependence of lookup table (temperature/pressure) */
 	void AddPropertyTable(ECompoundTPProperties _nProperty, EDependencyTypes _nDependenceType) const;
 
+	/**	Returns corresponding lookup table, creating it if necessary, and sets compound fractions at the time point to it. Must be called with m_mutexLookupTables locked.
+	*	\param _nProperty Property of lookup table.
+	*	\param _nDependenceType Dependence of lookup table (temperature/pressure).
+	*	\param _dTime Time point.
+	*	\return Pointer to lookup table. */
+	CLookupTable* PrepareLookupTable(ECompoundTPProperties _nProperty, EDependencyTypes _nDependenceType, double _dTime) const;
+
 public:
 	/**	Returns corresponding lookup table.
 	*	\param _nProperty Property of lookup table.
 	*	\param _nDependenceType Dependence of lookup table (temperature/pressure).
 	*	\param _dTime Time point.
-	*	\return Pointer ot lookup table. */
-	CLookupTable* GetLookupTable(ECompoundTPProperties _nProperty, EDependencyTypes _nDependenceType, double _dTime) const;
+	*	\return Copy of the lookup table. The copy shares the calculated table with the stream until one of them is modified, so it is cheap to make and can be used concurrently with other functions of this stream. */
+	CLookupTable GetLookupTable(ECompoundTPProperties _nProperty, EDependencyTypes _nDependenceType, double _dTime) const;
 
 	/**	Reads the temperature of a lookup table of respective property for a specified value
 	*	\param _nProperty property of lookup table
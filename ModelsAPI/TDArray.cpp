@@ -67,6 +67,25 @@ void CTDArray::RemoveTimePoints(double _dStartTime, double _dEndTime)
 	m_data.erase( m_data.begin() + iFirst, m_data.begin() + (iLast + 1) );
 }
 
+void CTDArray::RemoveTimePoints(const std::vector<double>& _vTimes)
+{
+	if( m_data.empty() || _vTimes.empty() ) // nothing to remove
+		return;
+
+	// merge both sorted sequences and keep only not listed time points
+	size_t iDst = 0;
+	size_t iTime = 0;
+	for( size_t iSrc = 0; iSrc < m_data.size(); ++iSrc )
+	{
+		while( ( iTime < _vTimes.size() ) && ( _vTimes[iTime] < m_data[iSrc].dTime ) )
+			iTime++;
+		if( ( iTime < _vTimes.size() ) && ( _vTimes[iTime] == m_data[iSrc].dTime ) )
+			continue;
+		m_data[iDst++] = m_data[iSrc];
+	}
+	m_data.resize( iDst );
+}
+
 void CTDArray::ChangeTimePoint(double _dOldTime, double _dNewTime)
 {
 	size_t index = GetIndexByTime( _dOldTime );
@@ -84,19 +103,19 @@ void CTDArray::ChangeTimePoint(double _dOldTime, double _dNewTime)
 	SetData( index, _dNewTime, -1 );
 }
 
-double CTDArray::GetValue(double _dTime)
+double CTDArray::GetValue(double _dTime) const
 {
 	if( m_data.size() == 0 ) // no time points
 		return 0;
 
-	size_t index = GetIndexByTime( _dTime );
+	size_t index = FindIndexByTime( _dTime );
 	if( index != -1 ) // time point is found
 		return m_data[index].dValue;
 
 	if( m_data.size() == 1 ) // not enough data for interpolation
 		return m_data.front().dValue;
 
-	size_t indexAfter = GetIndexByTime( _dTime, false );
+	size_t indexAfter = FindIndexByTime( _dTime, false );
 	if(( indexAfter != m_data.size() ) && ( indexAfter != 0 )) // point inside - interpolation
 		//return GetInterpolation( indexAfter-1, indexAfter, _dTime );
 		return Interpolate( m_data[indexAfter].dValue, m_data[indexAfter-1].dValue, m_data[indexAfter].dTime, m_data[indexAfter-1].dTime, _dTime );
@@ -108,7 +127,7 @@ double CTDArray::GetValue(double _dTime)
 		return m_data.front().dValue;
 }
 
-void CTDArray::GetVectorValue(const std::vector<double>& _dTimes, std::vector<double>& _vRes)
+void CTDArray::GetVectorValue(const std::vector<double>& _dTimes, std::vector<double>& _vRes) const
 {
 	_vRes.resize( _dTimes.size() );
 	for(size_t i=0; i<_dTimes.size(); ++i )
@@ -135,18 +154,18 @@ void CTDArray::SetValue(double _dTime, double _dValue)
 	}
 }
 
-void CTDArray::CopyFrom(CTDArray& _source, double _dTime)
+void CTDArray::CopyFrom(const CTDArray& _source, double _dTime)
 {
 	SetValue( _dTime, _source.GetValue( _dTime ) );
 }
 
-void CTDArray::CopyFrom(CTDArray& _source, double _dStartTime, double _dEndTime)
+void CTDArray::CopyFrom(const CTDArray& _source, double _dStartTime, double _dEndTime)
 {
 	if( _dStartTime == _dEndTime ) // for single time point
 		SetValue( _dStartTime, _source.GetValue( _dStartTime ) );
 	else // for time interval
 	{
-		size_t index = _source.GetIndexByTime( _dStartTime, false );
+		size_t index = _source.FindIndexByTime( _dStartTime, false );
 		if( ( index != -1 ) && ( index <_source.m_data.size() ) && ( _source.m_data[index].dTime != _dStartTime ) ) // left boundary of the interval
 			SetValue( _dStartTime, _source.GetValue( _dStartTime ) );
 		while( ( index < _source.m_data.size() ) && ( _source.m_data[index].dTime <= _dEndTime ) ) // interval
@@ -159,7 +178,7 @@ void CTDArray::CopyFrom(CTDArray& _source, double _dStartTime, double _dEndTime)
 	}
 }
 
-void CTDArray::CopyFromTimePoint(CTDArray& _source, double _dTimeSrc, double _dTimeDest)
+void CTDArray::CopyFromTimePoint(const CTDArray& _source, double _dTimeSrc, double _dTimeDest)
 {
 	SetValue( _dTimeDest, _source.GetValue( _dTimeSrc ) );
 }
@@ -278,22 +297,26 @@ void CTDArray::CompressData( double _dStartTime, double _dEndTime, double _dATol
 	if( iEnd - iStart < 3 ) // nothing to compress
 		return;
 
-	size_t i = iStart+1;
-	while( i<iEnd-1 )
+	// each point is checked against the last kept point and the next one; all kept points are compacted in the same pass
+	size_t iDst = iStart+1;
+	for( size_t i = iStart+1; i < iEnd-1; ++i )
 	{
-		//double dInterpVal = GetInterpolation( i-1, i+1, m_data[i].dTime );
-		double dInterpVal = Interpolate( m_data[i-1].dValue, m_data[i+1].dValue, m_data[i-1].dTime, m_data[i+1].dTime, m_data[i].dTime );
-		if(std::fabs( m_data[i].dValue - dInterpVal ) <= std::fabs( m_data[i].dValue ) * _dRTol + _dATol ) // value can be interpolated. remove
-		{
-			m_data.erase( m_data.begin() + i );
-			iEnd--;
-		}
-		else
-			i++;
+		double dInterpVal = Interpolate( m_data[iDst-1].dValue, m_data[i+1].dValue, m_data[iDst-1].dTime, m_data[i+1].dTime, m_data[i].dTime );
+		if(std::fabs( m_data[i].dValue - dInterpVal ) > std::fabs( m_data[i].dValue ) * _dRTol + _dATol ) // value can not be interpolated. keep
+			m_data[iDst++] = m_data[i];
 	}
+	m_data.erase( m_data.begin() + iDst, m_data.begin() + (iEnd-1) );
 }
 
 size_t CTDArray::GetIndexByTime(double _dTime, bool _bIsStrict /*= true */)
+{
+	const size_t index = FindIndexByTime( _dTime, _bIsStrict );
+	if( index != static_cast<size_t>(-1) )
+		m_nLastTimePos = index;
+	return index;
+}
+
+size_t CTDArray::FindIndexByTime(double _dTime, bool _bIsStrict /*= true */) const
 {
 	// check if empty
 	if( m_data.empty() )
@@ -305,14 +328,14 @@ size_t CTDArray::GetIndexByTime(double _dTime, bool _bIsStrict /*= true */)
 	}
 
 	// check last used point
-	if( ( m_nLastTimePos < m_data.size() ) && ( m_data.at( m_nLastTimePos ).dTime == _dTime ) )
+	if( ( m_nLastTimePos < m_data.size() ) && ( m_data[m_nLastTimePos].dTime == _dTime ) )
 		return m_nLastTimePos;
 	// check next of last used point
-	if( ( ( m_nLastTimePos+1 ) < m_data.size() ) && ( m_data.at( m_nLastTimePos+1 ).dTime == _dTime ))
-		return ++m_nLastTimePos;
+	if( ( ( m_nLastTimePos+1 ) < m_data.size() ) && ( m_data[m_nLastTimePos+1].dTime == _dTime ))
+		return m_nLastTimePos+1;
 	// check previous of last used point
-	if( ( m_nLastTimePos > 0 ) && ( ( m_nLastTimePos-1 ) < m_data.size() ) && ( m_data.at( m_nLastTimePos-1 ).dTime == _dTime ))
-		return --m_nLastTimePos;
+	if( ( m_nLastTimePos > 0 ) && ( ( m_nLastTimePos-1 ) < m_data.size() ) && ( m_data[m_nLastTimePos-1].dTime == _dTime ))
+		return m_nLastTimePos-1;
 	// check boundaries
 	if( m_data.front().dTime > _dTime )
 	{
@@ -342,10 +365,7 @@ size_t CTDArray::GetIndexByTime(double _dTime, bool _bIsStrict /*= true */)
 		nMid = (size_t)(nFirst + nLast) >> 1;
 	}
 	if( ( m_data[nLast].dTime == _dTime ) || ( !_bIsStrict ) )
-	{
-		m_nLastTimePos = nLast;
-		return m_nLastTimePos;
-	}
+		return nLast;
 	else
 		return -1;
 }
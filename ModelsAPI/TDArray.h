@@ -9,7 +9,7 @@ class CTDArray
 {
 private:
 	std::vector<STDValue> m_data;	///< Time dependent data
-	size_t m_nLastTimePos;		///< Last used index in m_data
+	size_t m_nLastTimePos;		///< Last index used by modifying functions. Only used as a search hint by const functions, which never change it.
 
 public:
 	CTDArray( void );
@@ -25,26 +25,29 @@ public:
 	void RemoveTimePoint( double _dTime );
 	/** Removes all time points from interval (incl).*/
 	void RemoveTimePoints( double _dStartTime, double _dEndTime );
+	/** Removes all specified time points in one pass. Times must be sorted in ascending order. Not existing time points are ignored.*/
+	void RemoveTimePoints( const std::vector<double>& _vTimes );
 	/** Change time of time point (for UI purposes). Time point should be always bigger than the previous one and smaller than the next one.*/
 	void ChangeTimePoint( double _dOldTime, double _dNewTime );
 
 	// ========== Functions to GET and SET data
 
-	/** Returns value according to a specified time. If there is no such point, returns interpolated value. If data can not be obtained, 0 will be returned.*/
-	double GetValue( double _dTime );
-	/** Returns vector of values according to vector of times with interpolation.*/
-	void GetVectorValue( const std::vector<double>& _dTimes, std::vector<double>& _vRes );
+	/** Returns value according to a specified time. If there is no such point, returns interpolated value. If data can not be obtained, 0 will be returned.
+	*	Does not change the state of the array, so can be called concurrently from several threads.*/
+	double GetValue( double _dTime ) const;
+	/** Returns vector of values according to vector of times with interpolation. Can be called concurrently from several threads.*/
+	void GetVectorValue( const std::vector<double>& _dTimes, std::vector<double>& _vRes ) const;
 	/** Sets new value to a specified time point. If time point doesn't exist, than it will be created. All negative values will be set to 0.*/
 	void SetValue( double _dTime, double _dValue );
 
 	// ========== Functions to work with another arrays
 
 	/** Copy data from another array for time point. If time point wasn't defined in this array, it will be created.*/
-	void CopyFrom( CTDArray& _source, double _dTime );
+	void CopyFrom( const CTDArray& _source, double _dTime );
 	/** Copy data from another array on time interval.*/
-	void CopyFrom( CTDArray& _source, double _dStartTime, double _dEndTime );
+	void CopyFrom( const CTDArray& _source, double _dStartTime, double _dEndTime );
 	/** Copy data from another array to another time point.*/
-	void CopyFromTimePoint( CTDArray& _source, double _dTimeSrc, double _dTimeDest );
+	void CopyFromTimePoint( const CTDArray& _source, double _dTimeSrc, double _dTimeDest );
 
 	// ========== Functions to SAVE / LOAD arrays
 
@@ -73,8 +76,12 @@ public:
 
 
 private:
-	/** Returns index of the time point with value _dTime. Strict search returns -1 if there is no such time, not strict search returns index to paste.*/
+	/** Returns index of the time point with value _dTime. Strict search returns -1 if there is no such time, not strict search returns index to paste.
+	*	Remembers the found index to speed up the subsequent search.*/
 	size_t GetIndexByTime( double _dTime, bool _bIsStrict = true );
+	/** Returns index of the time point with value _dTime. Strict search returns -1 if there is no such time, not strict search returns index to paste.
+	*	Uses the last remembered index only as a hint and does not change it.*/
+	size_t FindIndexByTime( double _dTime, bool _bIsStrict = true ) const;
 
 	/** Sets new data using the data approximation. Not using parameters must be set to -1.*/
 	void SetData(size_t _nIndex, double _dTime, double _dValue);
@@ -31,11 +31,32 @@ CTransformMatrix::CTransformMatrix( const std::vector<unsigned> &_vTypes, const
 	SetDimensions( _vTypes, _vClasses );
 }
 
+CTransformMatrix::CTransformMatrix( const CTransformMatrix& _other )
+{
+	m_pData = NULL;
+	m_nSize = 0;
+	*this = _other;
+}
+
 CTransformMatrix::~CTransformMatrix(void)
 {
 	Clear();
 }
 
+CTransformMatrix& CTransformMatrix::operator=( const CTransformMatrix& _other )
+{
+	if( this == &_other )
+		return *this;
+	Clear();
+	if( !_other.m_vDimensions.empty() )
+	{
+		SetDimensions( _other.m_vDimensions, _other.m_vClasses );
+		std::memcpy( m_pData, _other.m_pData, sizeof( double ) * m_nSize );
+		m_bSparseValid = false;
+	}
+	return *this;
+}
+
 bool CTransformMatrix::SetDimensions( unsigned _nType, unsigned _nClasses )
 {
 	std::vector<unsigned> vDims;
@@ -96,6 +117,7 @@ bool CTransformMatrix::SetDimensions(const std::vector<unsigned>& _vTypes, const
 	for( unsigned i=0; i<_vClasses.size(); ++i )
 		m_nSize *= _vClasses[i]*_vClasses[i];
 	m_pData = new double[m_nSize]();
+	m_bSparseValid = false;
 
 	return true;
 }
@@ -123,6 +145,7 @@ void CTransformMatrix::Clear()
 	m_nSize = 0;
 	m_vDimensions.clear();
 	m_vClasses.clear();
+	m_bSparseValid = false;
 }
 
 void CTransformMatrix::ClearData()
@@ -130,6 +153,7 @@ void CTransformMatrix::ClearData()
 	if( m_pData != NULL )
 		for( unsigned i=0; i<m_nSize; ++i )
 			m_pData[i] = 0;
+	m_bSparseValid = false;
 }
 
 void CTransformMatrix::Normalize()
@@ -176,6 +200,61 @@ void CTransformMatrix::Normalize()
 	while (bSrc);
 }
 
+const SSparseTransform& CTransformMatrix::GetSparse() const
+{
+	std::lock_guard<std::mutex> lock(m_mutexSparse);
+	if (!m_bSparseValid)
+	{
+		m_sparse = BuildSparse();
+		m_bSparseValid = true;
+	}
+	return m_sparse;
+}
+
+SSparseTransform CTransformMatrix::BuildSparse() const
+{
+	SSparseTransform res;
+	if (m_vClasses.empty())
+		return res;
+
+	// in the data, classes are flattened with the first dimension changing fastest: find position of each class flattened with the last dimension changing fastest
+	const size_t nDims = m_vClasses.size();
+	std::vector<size_t> vStrides(nDims, 1);
+	for (size_t i = 1; i < nDims; ++i)
+		vStrides[i] = vStrides[i - 1] * m_vClasses[i - 1];
+	const size_t N = vStrides.back() * m_vClasses.back();
+	std::vector<size_t> vOffsets(N, 0);
+	std::vector<unsigned> vCoords(nDims, 0);
+	for (size_t i = 0; i < N; ++i)
+	{
+		for (size_t j = 0; j < nDims; ++j)
+			vOffsets[i] += vCoords[j] * vStrides[j];
+		for (size_t j = nDims; j-- > 0;)
+		{
+			if (++vCoords[j] < m_vClasses[j])
+				break;
+			vCoords[j] = 0;
+		}
+	}
+
+	res.size = N;
+	res.dstStart.reserve(N + 1);
+	res.dstStart.push_back(0);
+	// data for each destination class are stored continuously with index = iSrc + N*iDst
+	for (size_t iDst = 0; iDst < N; ++iDst)
+	{
+		const double* pCol = m_pData + vOffsets[iDst] * N;
+		for (size_t iSrc = 0; iSrc < N; ++iSrc)
+			if (pCol[vOffsets[iSrc]] != 0)
+			{
+				res.src.push_back(iSrc);
+				res.value.push_back(pCol[vOffsets[iSrc]]);
+			}
+		res.dstStart.push_back(res.src.size());
+	}
+	return res;
+}
+
 double CTransformMatrix::GetValue( unsigned _nCoordSrc, unsigned _nCoordDst ) const
 {
 	std::vector<unsigned> vCoordsSrc( 1, _nCoordSrc );
@@ -313,6 +392,7 @@ bool CTransformMatrix::SetValue(const std::vector<unsigned>& _vCoordsSrc, const
 		return false;
 
 	m_pData[index] = _dValue;
+	m_bSparseValid = false;
 
 	return true;
 }
@@ -330,6 +410,7 @@ bool CTransformMatrix::SetValue(const std::vector<unsigned>& _vDimsSrc, const st
 		return false;
 
 	m_pData[index] = _dValue;
+	m_bSparseValid = false;
 
 	return true;
 }
@@ -353,6 +434,7 @@ bool CTransformMatrix::SetVectorValue(const std::vector<unsigned>& _vCoordsSrc,
 			m_pData[index] = _vValue[i];
 			index += nStep;
 		}
+	m_bSparseValid = false;
 	return true;
 }
 
@@ -378,6 +460,7 @@ bool CTransformMatrix::SetVectorValue(const std::vector<unsigned>& _vDimsSrc, co
 			m_pData[index] = _vValue[i];
 			index += nStep;
 		}
+	m_bSparseValid = false;
 	return true;
 }
 
@@ -396,6 +479,7 @@ bool CTransformMatrix::SetMatrix(const CMatrix2D& _matrix)
 	if (m_vClasses[0] != _matrix.Rows() || m_vClasses[0] != _matrix.Cols()) return false;
 	for (size_t i = 0; i < _matrix.Cols(); ++i)
 		std::memcpy(m_pData + i * m_vClasses[0], _matrix.GetCol(i).data(), sizeof(double)*m_vClasses[0]);
+	m_bSparseValid = false;
 	return true;
 }
 
@@ -4,8 +4,21 @@
 
 #include <vector>
 #include <cstdint>
+#include <mutex>
 #include "Matrix2D.h"
 
+/** Sparse representation of the transformation matrix, compressed by destination classes.
+*	Classes of all dimensions are flattened in the same order as CMDMatrix iterates over coordinates: the last dimension changes fastest.
+*	For each destination class, only non-zero factors are stored, ordered by increasing source class,
+*	so that sums over them are accumulated in the same order as over all factors of the matrix.*/
+struct SSparseTransform
+{
+	size_t size{ 0 };					///< Number of flattened classes.
+	std::vector<size_t> dstStart;		///< Position of the first factor of each destination class in src/value. Has size+1 entries.
+	std::vector<size_t> src;			///< Flattened source class of each factor.
+	std::vector<double> value;			///< Non-zero transformation factors.
+};
+
 /** Class for description of the transformation matrix.*/
 class CTransformMatrix
 {
@@ -14,14 +27,20 @@ private:
 	std::vector<unsigned> m_vClasses;		///< Number of classes of the distributions
 	double *m_pData;						///< Data itself
 	size_t m_nSize;							///< Current matrix size
+	mutable SSparseTransform m_sparse;		///< Cached sparse representation of the matrix, valid if m_bSparseValid
+	mutable bool m_bSparseValid{ false };	///< Whether m_sparse corresponds to the current data; reset by all functions that change the data
+	mutable std::mutex m_mutexSparse;		///< Guards building of m_sparse in const functions, which may be used concurrently
 
 public:
 	CTransformMatrix( void );
 	CTransformMatrix( unsigned _nType, unsigned _nClasses );
 	CTransformMatrix(unsigned _nType1, unsigned _nClasses1, unsigned _nType2, unsigned _nClasses2);
 	CTransformMatrix( const std::vector<unsigned> &_vTypes, const std::vector<unsigned> &_vClasses );
+	CTransformMatrix( const CTransformMatrix& _other );
 	~CTransformMatrix( void );
 
+	CTransformMatrix& operator=( const CTransformMatrix& _other );
+
 	// ============= Functions to work with DIMENSIONS
 
 	/** Sets new dimension with erasing of old data. Returns true if success.*/
@@ -47,6 +66,10 @@ public:
 	/** Normalizes data in matrix: sets sum of material which transfers from each single class to 1.*/
 	void Normalize();
 
+	/** Returns sparse representation of the matrix with all zero factors removed.
+	*	It is built on the first call after the data have been changed and then reused, so repeated applications of the same matrix do not scan it again.*/
+	const SSparseTransform& GetSparse() const;
+
 	// ============= Data GETTERS
 
 	/** Returns value by specified coordinates for 1-dimensional transformation matrix. Returns -1 on error.*/
@@ -99,6 +122,9 @@ public:
 	void ReduceLastDim( CTransformMatrix& _newTMatr ) const;
 
 private:
+	/** Builds sparse representation of the matrix with all zero factors removed.*/
+	SSparseTransform BuildSparse() const;
+
 	/** Checks the duplicates in dimensions vector. Return true if check is passed.*/
 	bool CheckDuplicates( const std::vector<unsigned>& _vDims ) const;
 
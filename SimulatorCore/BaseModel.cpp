@@ -124,6 +124,12 @@ void CBaseModel::ReduceTimePoints(double _dStart, double _dEnd, double _dStep)
 		m_pUnit->ReduceTimePoints(_dStart, _dEnd, _dStep);
 }
 
+void CBaseModel::CompressTimePoints(double _dStart, double _dEnd, double _dATol, double _dRTol)
+{
+	if (m_pUnit)
+		m_pUnit->CompressTimePoints(_dStart, _dEnd, _dATol, _dRTol);
+}
+
 void CBaseModel::SetCompounds( const std::vector<std::string>* _pvCompoundsKeys )
 {
 	if ( m_pUnit != NULL )
@@ -217,13 +223,13 @@ void CBaseModel::SetPortStream( unsigned _nPortIndex, CMaterialStream* _pMateria
 void CBaseModel::Simulate( double _dStartTime, double _dEndTime )
 {
 	if ( m_pUnit == NULL ) return;
-	m_pUnit->Simulate( _dStartTime, _dEndTime );
+	m_pUnit->SimulateUnit( _dStartTime, _dEndTime );
 }
 
 void CBaseModel::Simulate( double _dTime )
 {
 	if ( m_pUnit == NULL ) return;
-	m_pUnit->Simulate( _dTime );
+	m_pUnit->SimulateUnit( _dTime );
 }
 
 void CBaseModel::SaveInternalState(double _dT1, double _dT2)
@@ -314,6 +320,12 @@ bool CBaseModel::IsDynamic()
 	return m_pUnit->IsDynamicUnit();
 }
 
+SSolverStatistics CBaseModel::GetSolverStatistics() const
+{
+	if( m_pUnit == NULL ) return {};
+	return m_pUnit->GetSolverStatistics();
+}
+
 std::vector<double> CBaseModel::GetAllInletTimePoints( double _dStartTime, double _dEndTime, bool _bForceStartBoundary /*= false*/, bool _bForceEndBoundary /*= false*/ )
 {
 	if( m_pUnit == NULL ) return std::vector<double>();
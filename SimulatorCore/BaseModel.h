@@ -53,6 +53,8 @@ public:
 
 	// Removes time points, which are closer as _dStep, from internal holdups and streams within the specified interval [_dStart; _dEnd).
 	void ReduceTimePoints(double _dStart, double _dEnd, double _dStep);
+	// Removes time points, which can be linearly interpolated with the given tolerances, from internal holdups and streams within the specified interval (_dStart; _dEnd).
+	void CompressTimePoints(double _dStart, double _dEnd, double _dATol, double _dRTol);
 
 	/** Sets pointer to a compounds vector.*/
 	void SetCompounds( const std::vector<std::string>* _pvCompoundsKeys );
@@ -102,6 +104,8 @@ public:
 	bool GetStoredStateVariableData( unsigned _nIndex, std::vector<double>* _pvValues, std::vector<double>* _pvTimes );
 
 	bool IsDynamic();
+	/** Returns statistics of all registered equation solvers of the unit, accumulated since their models were set with SetModel(). */
+	SSolverStatistics GetSolverStatistics() const;
 
 	std::vector<double> GetAllInletTimePoints( double _dStartTime, double _dEndTime, bool _bForceStartBoundary = false, bool _bForceEndBoundary = false );
 
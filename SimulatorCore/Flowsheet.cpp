@@ -127,6 +127,11 @@ std::string CFlowsheet::Initialize()
 		if (!m_pMaterialsDatabase->GetCompound(key))
 			return StrConst::Flow_ErrWrongCompound(key);
 
+	// materials database may have changed since the last simulation: resolve property handles and specialize property evaluators anew
+	CLookupTable::ClearCache();
+	for (auto& stream : m_vpStreams)
+		stream->UpdateCompoundsTable();
+
 	// check phases
 	if (m_vPhasesNames.empty())
 		return StrConst::Flow_ErrNoPhases;
@@ -261,7 +266,14 @@ void CFlowsheet::CreateInitTearStreams()
 	m_vvInitTearStreams.resize(m_calculationSequence.PartitionsNumber());
 	for (size_t i = 0; i < m_calculationSequence.PartitionsNumber(); ++i)
 		if (m_calculationSequence.TearStreamsNumber(i))
-			m_vvInitTearStreams[i].resize(m_calculationSequence.TearStreamsNumber(i), CMaterialStream(*m_calculationSequence.PartitionTearStreams(i).front()));
+		{
+			// streams are not assignable, so resize without std::vector::resize()
+			auto& streams = m_vvInitTearStreams[i];
+			while (streams.size() > m_calculationSequence.TearStreamsNumber(i))
+				streams.pop_back();
+			while (streams.size() < m_calculationSequence.TearStreamsNumber(i))
+				streams.emplace_back(*m_calculationSequence.PartitionTearStreams(i).front());
+		}
 	for (auto& partition : m_vvInitTearStreams)
 		for (auto& stream : partition)
 			if (stream.GetPhasesNumber() == 0) 	// TODO: normal check for not initialized stream
@@ -258,6 +258,9 @@ void CSimulator::SimulateUnits(const CCalculationSequence::SPartition& _partitio
 			if (port.nType == OUTPUT_PORT)
 				port.pStream->RemoveTimePointsAfter(_t1);
 
+		// remember statistics of solvers to report the work done on this time window
+		const SSolverStatistics statistics = model->GetSolverStatistics();
+
 		// simulate
 		if (model->IsDynamic())	// for dynamic units
 		{
@@ -280,6 +283,11 @@ void CSimulator::SimulateUnits(const CCalculationSequence::SPartition& _partitio
 				SimulateUnit(*model, t);
 			}
 		}
+
+		// write statistics of solvers
+		const SSolverStatistics statisticsWindow = model->GetSolverStatistics() - statistics;
+		if (!statisticsWindow.IsEmpty())
+			m_log.WriteInfo(StrConst::Sim_InfoUnitSolverStatistics(m_sUnitName, model->GetUnitName(), statisticsWindow.ToString()));
 	}
 }
 
@@ -519,9 +527,15 @@ void CSimulator::ReduceData(const CCalculationSequence::SPartition& _partition,
 		{
 			for (auto& p : model->GetUnitPorts())
 				if (p.nType == OUTPUT_PORT)
+				{
 					p.pStream->ReduceTimePoints(dStart, _t2, m_pParams->saveTimeStep);
+					p.pStream->CompressTimePoints(dStart, _t2, m_pParams->absTol, m_pParams->relTol);
+				}
 			if (m_pParams->saveTimeStepFlagHoldups)
+			{
 				model->ReduceTimePoints(dStart, _t2, m_pParams->saveTimeStep);
+				model->CompressTimePoints(dStart, _t2, m_pParams->absTol, m_pParams->relTol);
+			}
 		}
 	}
 }
@@ -0,0 +1,180 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+// Calls const getters of shared CStream, CMDMatrix, CDenseDistr2D and CTDArray objects from several threads at once.
+// Each thread must obtain the same results as a single thread, which read the objects before.
+
+#include "MaterialStream.h"
+#include "MaterialsDatabase.h"
+#include "DistributionsGrid.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+const size_t THREADS = 8;		// Number of concurrently reading threads
+const size_t REPETITIONS = 50;	// Number of reads of all objects by each thread
+
+/** Time points, at which all objects are read: defined time points, points between them, and points outside the time interval.
+ *	Each thread reads them in a different order, starting from the given one, so that threads request different time points at the same time.*/
+std::vector<double> QueryTimes(size_t _nStart)
+{
+	std::vector<double> vTimes;
+	for (int i = -1; i <= 21; ++i)
+		vTimes.push_back(i * 0.5);
+	std::rotate(vTimes.begin(), vTimes.begin() + _nStart % vTimes.size(), vTimes.end());
+	return vTimes;
+}
+
+std::vector<double> Read(const CTDArray& _array, size_t _nStart)
+{
+	std::vector<double> vRes;
+	for (double t : QueryTimes(_nStart))
+		vRes.push_back(_array.GetValue(t));
+	std::vector<double> vVector;
+	_array.GetVectorValue(QueryTimes(_nStart), vVector);
+	vRes.insert(vRes.end(), vVector.begin(), vVector.end());
+	return vRes;
+}
+
+std::vector<double> Read(const CDenseDistr2D& _distr, size_t _nStart)
+{
+	std::vector<double> vRes;
+	for (double t : QueryTimes(_nStart))
+	{
+		const std::vector<double> vValue = _distr.GetValue(t);
+		vRes.insert(vRes.end(), vValue.begin(), vValue.end());
+		vRes.push_back(_distr.GetValue(t, 1));
+	}
+	const std::vector<double> vValues = _distr.GetValues(QueryTimes(_nStart), 0);
+	vRes.insert(vRes.end(), vValues.begin(), vValues.end());
+	return vRes;
+}
+
+std::vector<double> Read(const CMDMatrix& _matrix, size_t _nStart)
+{
+	std::vector<double> vRes;
+	for (double t : QueryTimes(_nStart))
+	{
+		vRes.push_back(_matrix.GetValue(t, DISTR_SIZE, 1));
+		vRes.push_back(_matrix.GetValue(t, DISTR_COMPOUNDS, 1, DISTR_SIZE, 2));
+		const std::vector<double> vVector = _matrix.GetVectorValue(t, DISTR_SIZE);
+		vRes.insert(vRes.end(), vVector.begin(), vVector.end());
+		const CDenseMDMatrix distr = _matrix.GetDistribution(t);
+		vRes.insert(vRes.end(), distr.GetDataPtr(), distr.GetDataPtr() + distr.GetDataLength());
+	}
+	return vRes;
+}
+
+std::vector<double> Read(const CMaterialStream& _stream, size_t _nStart)
+{
+	std::vector<double> vRes;
+	for (double t : QueryTimes(_nStart))
+	{
+		vRes.push_back(_stream.GetMassFlow(t));
+		vRes.push_back(_stream.GetTemperature(t));
+		vRes.push_back(_stream.GetPressure(t));
+		vRes.push_back(_stream.GetOverallProperty(t, ENTHALPY));
+		vRes.push_back(_stream.GetPhaseTPDProp(t, ENTHALPY, SOA_SOLID));
+		const std::vector<double> vFractions = _stream.GetCompoundsFractions(t);
+		vRes.insert(vRes.end(), vFractions.begin(), vFractions.end());
+		const std::vector<double> vPSD = _stream.GetPSD(t, PSD_MassFrac);
+		vRes.insert(vRes.end(), vPSD.begin(), vPSD.end());
+		const double dEnthalpy = _stream.CalcPropertyFromTemperature(ENTHALPY, t, 320);
+		vRes.push_back(dEnthalpy);
+		vRes.push_back(_stream.CalcTemperatureFromProperty(ENTHALPY, t, dEnthalpy));
+		// a returned lookup table can be modified without affecting the stream
+		CLookupTable table = _stream.GetLookupTable(ENTHALPY, EDependencyTypes::DEPENDENCE_TEMP, t);
+		vRes.push_back(table.GetValue(330));
+		table.MultiplyTable(2.);
+		vRes.push_back(table.GetParam(2 * dEnthalpy));
+	}
+	return vRes;
+}
+
+/** Reads the object from several threads and compares the results with the reference.*/
+template<typename T>
+bool CheckConcurrentRead(const T& _object, const std::string& _sName)
+{
+	std::vector<std::vector<double>> vReferences;
+	for (size_t i = 0; i < THREADS; ++i)
+		vReferences.push_back(Read(_object, i * 3));
+	std::atomic<size_t> nFailed{ 0 };
+	std::vector<std::thread> vThreads;
+	for (size_t i = 0; i < THREADS; ++i)
+		vThreads.emplace_back([&, i]
+		{
+			for (size_t j = 0; j < REPETITIONS; ++j)
+				if (Read(_object, i * 3) != vReferences[i])
+					++nFailed;
+		});
+	for (auto& thread : vThreads)
+		thread.join();
+	if (nFailed != 0)
+		std::cerr << _sName << ": " << nFailed << " of " << THREADS * REPETITIONS << " concurrent reads differ from the single-threaded read" << std::endl;
+	return nFailed == 0;
+}
+
+int main()
+{
+	CTDArray array;
+	for (int i = 0; i <= 10; ++i)
+		array.SetValue(i * 1.0, 1 + i * i * 0.1);
+
+	CDenseDistr2D distr(3);
+	for (int i = 0; i <= 10; ++i)
+		distr.SetValue(i * 1.0, { 1.0 * i, 10.0 - i, 0.1 * i * i });
+
+	CMDMatrix matrix;
+	matrix.SetDimensions({ DISTR_COMPOUNDS, DISTR_SIZE }, { 2, 3 });
+	for (int i = 0; i <= 10; ++i)
+	{
+		matrix.AddTimePoint(i * 1.0);
+		CDenseMDMatrix value({ DISTR_COMPOUNDS, DISTR_SIZE }, { 2, 3 });
+		for (size_t j = 0; j < value.GetDataLength(); ++j)
+			value.GetDataPtr()[j] = (1. + j + 0.1 * i) / (21. + 0.6 * i);
+		matrix.SetDistribution(i * 1.0, value);
+	}
+
+	CMaterialsDatabase database;
+	database.AddCompound("A");
+	database.AddCompound("B");
+	database.GetCompound("A")->GetTPProperty(ENTHALPY)->SetCorrelation(0, ECorrelationTypes::POLYNOMIAL_1, { 0, 1000, 0.5, 0, 0, 0, 0, 0 });
+	database.GetCompound("B")->GetTPProperty(ENTHALPY)->SetCorrelation(0, ECorrelationTypes::POLYNOMIAL_1, { 100, 2000, 0.1, 0, 0, 0, 0, 0 });
+
+	CDistributionsGrid grid;
+	grid.AddDimension(DISTR_COMPOUNDS, EGridEntry::GRID_SYMBOLIC, std::vector<double>(), std::vector<std::string>());
+	grid.AddNamedClass(DISTR_COMPOUNDS, "A");
+	grid.AddNamedClass(DISTR_COMPOUNDS, "B");
+	grid.AddDimension(DISTR_SIZE, EGridEntry::GRID_NUMERIC, { 0, 1e-3, 2e-3, 3e-3 }, std::vector<std::string>());
+
+	CMaterialStream stream("stream");
+	stream.SetMaterialsDatabase(&database);
+	stream.SetDistributionsGrid(&grid);
+	stream.AddCompound("A");
+	stream.AddCompound("B");
+	stream.AddPhase("Solid", SOA_SOLID);
+	stream.AddPhase("Liquid", SOA_LIQUID);
+	for (int i = 0; i <= 10; ++i)
+	{
+		const double t = i * 1.0;
+		stream.AddTimePoint(t);
+		stream.SetMassFlow(t, 1 + 0.3 * i);
+		stream.SetTemperature(t, 300 + i * 3);
+		stream.SetPressure(t, 1e5 + i * 500);
+		stream.SetSinglePhaseProp(t, FRACTION, SOA_SOLID, 0.5 + 0.04 * i);
+		stream.SetSinglePhaseProp(t, FRACTION, SOA_LIQUID, 0.5 - 0.04 * i);
+		stream.SetCompoundPhaseFraction(t, "A", SOA_SOLID, 0.5 + 0.03 * i);
+		stream.SetCompoundPhaseFraction(t, "B", SOA_SOLID, 0.5 - 0.03 * i);
+		stream.SetCompoundPhaseFraction(t, "A", SOA_LIQUID, 0.9);
+		stream.SetCompoundPhaseFraction(t, "B", SOA_LIQUID, 0.1);
+		stream.SetPSD(t, PSD_MassFrac, "A", { 0.5, 0.3 + 0.01 * i, 0.2 - 0.01 * i });
+		stream.SetPSD(t, PSD_MassFrac, "B", { 0.1, 0.8, 0.1 });
+	}
+
+	bool bSuccess = true;
+	bSuccess &= CheckConcurrentRead(array, "CTDArray");
+	bSuccess &= CheckConcurrentRead(distr, "CDenseDistr2D");
+	bSuccess &= CheckConcurrentRead(matrix, "CMDMatrix");
+	bSuccess &= CheckConcurrentRead(stream, "CStream");
+	return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+// Checks evaluation of TP-dependent properties: values calculated for one point, for many points at once, and by specialized evaluators
+// must be equal for all types of correlations, also after the correlations of a property are modified.
+
+#include "TPDProperty.h"
+#include "PropertyKernel.h"
+#include <iostream>
+
+/** Temperatures and pressures, at which properties are evaluated, including points outside of intervals of correlations.*/
+void QueryPoints(std::vector<double>& _vT, std::vector<double>& _vP)
+{
+	for (int i = 0; i <= 40; ++i)
+	{
+		_vT.push_back(i * 25.0);
+		_vP.push_back(5e4 + i * 1e4);
+	}
+	_vT.push_back(0.0);
+	_vP.push_back(1e5);
+}
+
+/** Compares batch evaluation of the property with evaluation for each point.*/
+bool CheckValues(const CTPDProperty& _property, const std::string& _sCase)
+{
+	std::vector<double> vT, vP;
+	QueryPoints(vT, vP);
+	const std::vector<double> vValues = _property.GetValues(vT, vP);
+	CPropertyKernel kernel;
+	const bool bKernel = kernel.Build(_property);
+	size_t nFailed = 0;
+	for (size_t i = 0; i < vT.size(); ++i)
+	{
+		const double dValue = _property.GetValue(vT[i], vP[i]);
+		if (vValues[i] != dValue || bKernel && kernel.GetValue(vT[i], vP[i]) != dValue)
+			++nFailed;
+	}
+	if (nFailed != 0)
+		std::cerr << _sCase << ": " << nFailed << " of " << vT.size() << " values differ" << std::endl;
+	return nFailed == 0;
+}
+
+int main()
+{
+	bool bSuccess = true;
+
+	// single correlations of all types
+	const std::vector<std::pair<ECorrelationTypes, std::vector<double>>> vCorrelations{
+		{ ECorrelationTypes::LIST_OF_T_VALUES, { 200, 1, 400, 3, 600, 2 } },
+		{ ECorrelationTypes::LIST_OF_P_VALUES, { 1e5, 1, 2e5, 5 } },
+		{ ECorrelationTypes::CONSTANT, { 7 } },
+		{ ECorrelationTypes::LINEAR, { 0.5, 1e-5, 3 } },
+		{ ECorrelationTypes::EXPONENT_1, { 2, 1.001, 0.1, 0.01, 1, 2, 0.5, 100, 4 } },
+		{ ECorrelationTypes::EXPONENT_1, { 2, 1.001, 0.1, 0.01, 1, 2, 0, 0, 4 } },
+		{ ECorrelationTypes::POW_1, { 3, 0.7 } },
+		{ ECorrelationTypes::POLYNOMIAL_1, { 1, 1e-1, 1e-3, 1e-6, 1e-9, 1e-12, 1e-15, 1e-18 } },
+		{ ECorrelationTypes::POLYNOMIAL_CP, { 25, 1e-2, 1e-5, 1e-8, 1e5 } },
+		{ ECorrelationTypes::POLYNOMIAL_H, { 25, 1e-2, 1e-5, 1e-8, 1e5, 100, 50 } },
+		{ ECorrelationTypes::POLYNOMIAL_S, { 25, 1e-2, 1e-5, 1e-8, 1e5, 100 } },
+	};
+	for (const auto& [type, params] : vCorrelations)
+	{
+		CTPDProperty property(0, "Property", L"-", CCorrelation{ type, params, { 0, 1000 } });
+		bSuccess &= CheckValues(property, "Correlation of type " + std::to_string(static_cast<unsigned>(type)));
+	}
+
+	// several correlations with overlapping intervals and gaps between them
+	CTPDProperty property(0, "Property", L"-", CCorrelation{ ECorrelationTypes::CONSTANT, { 1 }, { 100, 300 } });
+	property.AddCorrelation(ECorrelationTypes::LINEAR, { 0.5, 0, 3 }, { 250, 500 }, { 1e5, 3e5 });
+	property.AddCorrelation(ECorrelationTypes::POW_1, { 3, 0.7 }, { 250, 500 });
+	property.AddCorrelation(ECorrelationTypes::CONSTANT, { 2 }, { 700, 800 });
+	bSuccess &= CheckValues(property, "Several correlations");
+
+	// modifications of correlations change the choice of correlations for each point
+	property.GetCorrelation(0)->SetTInterval({ 100, 600 });
+	bSuccess &= CheckValues(property, "Modified interval of a correlation");
+	property.GetCorrelation(1)->SetPInterval({ 0, 1e6 });
+	bSuccess &= CheckValues(property, "Modified pressure interval of a correlation");
+	property.ShiftCorrelationUp(2);
+	bSuccess &= CheckValues(property, "Reordered correlations");
+	property.RemoveCorrelation(0);
+	bSuccess &= CheckValues(property, "Removed correlation");
+
+	return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+// Compares in-place arithmetic kernels of CDenseMDMatrix and mixing of distributions in CStream with the original operators,
+// which created a temporary matrix for each operation. Both must produce bit-identical results.
+
+#include "MaterialStream.h"
+#include "MaterialsDatabase.h"
+#include "DistributionsGrid.h"
+#include "DyssolUtilities.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+/** Original implementations of operators of CDenseMDMatrix.*/
+namespace Reference
+{
+	bool IsSameShape(const CDenseMDMatrix& _matrix1, const CDenseMDMatrix& _matrix2)
+	{
+		return _matrix1.GetDimensions() == _matrix2.GetDimensions() && _matrix1.GetClasses() == _matrix2.GetClasses();
+	}
+
+	CDenseMDMatrix Plus(const CDenseMDMatrix& _matrix1, const CDenseMDMatrix& _matrix2)
+	{
+		if (!IsSameShape(_matrix1, _matrix2))
+			return CDenseMDMatrix();
+		CDenseMDMatrix sum;
+		sum.SetDimensions(_matrix1.GetDimensions(), _matrix1.GetClasses());
+		std::transform(_matrix1.GetDataPtr(), _matrix1.GetDataPtr() + _matrix1.GetDataLength(), _matrix2.GetDataPtr(), sum.GetDataPtr(), std::plus<>());
+		return sum;
+	}
+
+	CDenseMDMatrix Minus(const CDenseMDMatrix& _matrix1, const CDenseMDMatrix& _matrix2)
+	{
+		if (!IsSameShape(_matrix1, _matrix2))
+			return CDenseMDMatrix();
+		CDenseMDMatrix diff;
+		diff.SetDimensions(_matrix1.GetDimensions(), _matrix1.GetClasses());
+		std::transform(_matrix1.GetDataPtr(), _matrix1.GetDataPtr() + _matrix1.GetDataLength(), _matrix2.GetDataPtr(), diff.GetDataPtr(), std::minus<>());
+		return diff;
+	}
+
+	CDenseMDMatrix Multiply(const CDenseMDMatrix& _matrix, double _dFactor)
+	{
+		CDenseMDMatrix prod;
+		prod.SetDimensions(_matrix.GetDimensions(), _matrix.GetClasses());
+		std::transform(_matrix.GetDataPtr(), _matrix.GetDataPtr() + _matrix.GetDataLength(), prod.GetDataPtr(), [_dFactor](const double v) { return v * _dFactor; });
+		return prod;
+	}
+
+	/** Original mixing of distributions from CStream::CalcMixMDDistributions().*/
+	std::vector<CDenseMDMatrix> MixDistributions(const CStream& _str1, double _time1, double _mass1, const std::vector<double>& _phaseFracs1, const CStream& _str2, double _time2, double _mass2, const std::vector<double>& _phaseFracs2)
+	{
+		std::vector<CDenseMDMatrix> vDistrsMix(_str2.GetPhasesNumber());
+		for (size_t i = 0; i < _str2.GetPhasesNumber(); ++i)
+		{
+			const CDenseMDMatrix distr1 = _str1.GetPhases()->at(i)->distribution.GetDistribution(_time1);
+			const CDenseMDMatrix distr2 = _str2.GetPhases()->at(i)->distribution.GetDistribution(_time2);
+			vDistrsMix[i] = Plus(Multiply(Multiply(distr2, _mass2), _phaseFracs2[i]), Multiply(Multiply(distr1, _mass1), _phaseFracs1[i]));
+
+			std::vector<double> vCompFracs = vDistrsMix[i].GetVectorValue(DISTR_COMPOUNDS);
+			if (std::all_of(vCompFracs.begin(), vCompFracs.end(), [](double d) { return d == 0; }))
+				vDistrsMix[i] = Plus(Multiply(distr2, _mass2), Multiply(distr1, _mass1));
+
+			vDistrsMix[i].Normalize();
+		}
+		return vDistrsMix;
+	}
+}
+
+/** Gives access to mixing of distributions.*/
+class CStreamAccess : public CMaterialStream
+{
+public:
+	CStreamAccess(const std::string& _sStreamKey) : CMaterialStream(_sStreamKey) {}
+	using CStream::CalcMixMDDistributions;
+};
+
+bool IsEqual(const CDenseMDMatrix& _matrix1, const CDenseMDMatrix& _matrix2, const std::string& _sCase)
+{
+	if (_matrix1.GetDimensions() != _matrix2.GetDimensions() || _matrix1.GetClasses() != _matrix2.GetClasses() ||
+		!std::equal(_matrix1.GetDataPtr(), _matrix1.GetDataPtr() + _matrix1.GetDataLength(), _matrix2.GetDataPtr()))
+	{
+		std::cerr << _sCase << ": results differ" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+CDenseMDMatrix MakeMatrix(double _dSeed)
+{
+	CDenseMDMatrix matrix({ DISTR_COMPOUNDS, DISTR_SIZE }, { 3, 5 });
+	double* pData = matrix.GetDataPtr();
+	for (size_t i = 0; i < matrix.GetDataLength(); ++i)
+		pData[i] = 1. / (i + _dSeed) + _dSeed / 7.;
+	return matrix;
+}
+
+bool CheckOperators()
+{
+	const CDenseMDMatrix matrix1 = MakeMatrix(0.3);
+	const CDenseMDMatrix matrix2 = MakeMatrix(1.7);
+	const CDenseMDMatrix empty;
+
+	bool bSuccess = true;
+	bSuccess &= IsEqual(matrix1 + matrix2, Reference::Plus(matrix1, matrix2), "operator+");
+	bSuccess &= IsEqual(matrix1 - matrix2, Reference::Minus(matrix1, matrix2), "operator-");
+	bSuccess &= IsEqual(matrix1 * 0.37, Reference::Multiply(matrix1, 0.37), "operator*");
+	bSuccess &= IsEqual(matrix1 + empty, Reference::Plus(matrix1, empty), "operator+ with different dimensions");
+
+	CDenseMDMatrix sum = matrix1;
+	sum += matrix2;
+	bSuccess &= IsEqual(sum, Reference::Plus(matrix1, matrix2), "operator+=");
+	CDenseMDMatrix diff = matrix1;
+	diff -= matrix2;
+	bSuccess &= IsEqual(diff, Reference::Minus(matrix1, matrix2), "operator-=");
+	CDenseMDMatrix prod = matrix1;
+	prod *= 0.37;
+	bSuccess &= IsEqual(prod, Reference::Multiply(matrix1, 0.37), "operator*=");
+
+	CDenseMDMatrix comb;
+	comb.SetLinearCombination(3.1, matrix2, 0.7, matrix1);
+	bSuccess &= IsEqual(comb, Reference::Plus(Reference::Multiply(matrix2, 3.1), Reference::Multiply(matrix1, 0.7)), "SetLinearCombination");
+	comb.SetLinearCombination(3.1, 0.13, matrix2, 0.7, 0.87, matrix1);
+	bSuccess &= IsEqual(comb, Reference::Plus(Reference::Multiply(Reference::Multiply(matrix2, 3.1), 0.13), Reference::Multiply(Reference::Multiply(matrix1, 0.7), 0.87)), "SetLinearCombination with scaling");
+
+	return bSuccess;
+}
+
+void SetupStream(CStream& _stream, CMaterialsDatabase& _database, CDistributionsGrid& _grid)
+{
+	_stream.SetMaterialsDatabase(&_database);
+	_stream.SetDistributionsGrid(&_grid);
+	_stream.AddCompound("A");
+	_stream.AddCompound("B");
+	_stream.AddPhase("Solid", SOA_SOLID);
+	_stream.AddPhase("Liquid", SOA_LIQUID);
+}
+
+void FillStream(CMaterialStream& _stream, double _dSeed, bool _bEmptySolid)
+{
+	for (int i = 0; i <= 4; ++i)
+	{
+		const double t = i * 1.3;
+		_stream.AddTimePoint(t);
+		_stream.SetMassFlow(t, 1 + _dSeed * i);
+		_stream.SetTemperature(t, 300 + i);
+		_stream.SetPressure(t, 1e5);
+		_stream.SetSinglePhaseProp(t, FRACTION, SOA_SOLID, _bEmptySolid ? 0 : 0.3 + 0.07 * _dSeed);
+		_stream.SetSinglePhaseProp(t, FRACTION, SOA_LIQUID, _bEmptySolid ? 1 : 0.7 - 0.07 * _dSeed);
+		_stream.SetCompoundPhaseFraction(t, "A", SOA_SOLID, 0.1 + 0.03 * i * _dSeed);
+		_stream.SetCompoundPhaseFraction(t, "B", SOA_SOLID, 0.9 - 0.03 * i * _dSeed);
+		_stream.SetCompoundPhaseFraction(t, "A", SOA_LIQUID, 0.35 + 0.01 * i);
+		_stream.SetCompoundPhaseFraction(t, "B", SOA_LIQUID, 0.65 - 0.01 * i);
+		_stream.SetPSD(t, PSD_MassFrac, "A", { 0.1 * _dSeed, 0.3, 0.7 - 0.1 * _dSeed });
+		_stream.SetPSD(t, PSD_MassFrac, "B", { 0.3, 0.3 + 0.01 * i, 0.4 - 0.01 * i });
+	}
+}
+
+bool CheckMixing()
+{
+	CMaterialsDatabase database;
+	database.AddCompound("A");
+	database.AddCompound("B");
+
+	CDistributionsGrid grid;
+	grid.AddDimension(DISTR_COMPOUNDS, EGridEntry::GRID_SYMBOLIC, std::vector<double>(), std::vector<std::string>());
+	grid.AddNamedClass(DISTR_COMPOUNDS, "A");
+	grid.AddNamedClass(DISTR_COMPOUNDS, "B");
+	grid.AddDimension(DISTR_SIZE, EGridEntry::GRID_NUMERIC, { 0, 1e-3, 2e-3, 3e-3 }, std::vector<std::string>());
+
+	bool bSuccess = true;
+	for (bool bEmptySolid : { false, true })
+	{
+		CStreamAccess stream1("stream1");
+		CStreamAccess stream2("stream2");
+		SetupStream(stream1, database, grid);
+		SetupStream(stream2, database, grid);
+		FillStream(stream1, 0.7, bEmptySolid);
+		FillStream(stream2, 1.9, bEmptySolid);
+
+		for (double t1 : { 0.0, 1.3, 2.1 })
+			for (double t2 : { 0.0, 3.9, 4.4 })
+			{
+				const double dMass1 = stream1.GetMassFlow(t1) * 0.3;
+				const double dMass2 = stream2.GetMassFlow(t2) * 1.1;
+				const std::vector<double> vPhaseFracs1 = stream1.GetDistrPhaseFractions()->GetValue(t1);
+				const std::vector<double> vPhaseFracs2 = stream2.GetDistrPhaseFractions()->GetValue(t2);
+				const std::vector<CDenseMDMatrix> vResult = stream1.CalcMixMDDistributions(stream1, t1, dMass1, vPhaseFracs1, stream2, t2, dMass2, vPhaseFracs2);
+				const std::vector<CDenseMDMatrix> vReference = Reference::MixDistributions(stream1, t1, dMass1, vPhaseFracs1, stream2, t2, dMass2, vPhaseFracs2);
+				for (size_t i = 0; i < vReference.size(); ++i)
+					bSuccess &= IsEqual(vResult[i], vReference[i], "Mixing of phase " + std::to_string(i) + " at t1 = " + std::to_string(t1) + ", t2 = " + std::to_string(t2));
+			}
+	}
+	return bSuccess;
+}
+
+int main()
+{
+	bool bSuccess = true;
+	bSuccess &= CheckOperators();
+	bSuccess &= CheckMixing();
+	return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+// Compares CHoldup::AddStream with its original implementation, which took a full copy of the holdup for each interval.
+// Both must produce bit-identical results.
+
+#include "Holdup.h"
+#include "MaterialStream.h"
+#include "MaterialsDatabase.h"
+#include "DistributionsGrid.h"
+#include "DyssolUtilities.h"
+#include <cmath>
+#include <iostream>
+
+/** Holdup with the original implementation of mixing of streams.*/
+class CHoldupReference : public CHoldup
+{
+public:
+	CHoldupReference(const std::string& _sHoldupKey) : CHoldup(_sHoldupKey) {}
+
+	void AddStreamReference(const CMaterialStream* _pStream, double _dStart, double _dEnd)
+	{
+		if (_dStart > _dEnd) // wrong time interval
+			return;
+
+		if (!CompareStreamStructure(*_pStream)) // wrong structure
+			return;
+
+		if (m_vTimePoints.empty() || m_vTimePoints.back() < _dStart)
+		{
+			AddStream(_pStream, _dStart, _dEnd); // copying of the stream is not changed
+			return;
+		}
+
+		// get all time points
+		std::vector<double> vTimePoints = VectorsUnionSorted(_pStream->GetTimePointsForInterval(_dStart, _dEnd, true), GetTimePointsForInterval(_dStart, _dEnd, true));
+
+		if (vTimePoints.size() == 0)
+			return;
+
+		for (size_t iTime = 1; iTime < vTimePoints.size(); ++iTime)
+		{
+			const double dMassSrc = _pStream->GetMassFlow((vTimePoints[iTime - 1] + vTimePoints[iTime]) / 2) * (vTimePoints[iTime] - vTimePoints[iTime - 1]);
+
+			double dFactorTP = (vTimePoints[iTime] - vTimePoints[iTime - 1]) / std::sqrt(2.);
+			if (_pStream->GetMassFlow(vTimePoints[iTime - 1]) < _pStream->GetMassFlow(vTimePoints[iTime]))
+				dFactorTP = vTimePoints[iTime - 1] + dFactorTP;
+			else
+				dFactorTP = vTimePoints[iTime] - dFactorTP;
+
+			CHoldup bufHoldup(*this);
+			bufHoldup.CopyFromHoldup(this, _dStart, _dEnd);
+
+			for (size_t j = iTime; j < vTimePoints.size(); ++j)
+			{
+				std::vector<double> vTempMTP(3); // MTP
+				std::vector<double> vTempPhaseFrac(m_vpPhases.size()); // phase fractions
+				std::vector<CDenseMDMatrix> vTempDistr(m_vpPhases.size()); // MD distributions
+
+				AddTimePoint(vTimePoints[j]);
+
+				const double dMassDst = bufHoldup.GetDistrStreamMTP()->GetValue(vTimePoints[j], MTP_MASS);
+				const double dMassTot = dMassDst + dMassSrc;
+				if (dMassTot == 0) //  nothing to mix
+					break;
+
+				vTempMTP[MTP_MASS] = dMassTot;
+				vTempMTP[MTP_PRESSURE] = CalcMixPressure(*_pStream, dFactorTP, bufHoldup, vTimePoints[j]);
+				vTempMTP[MTP_TEMPERATURE] = CalcMixTemperature(*_pStream, dFactorTP, dMassSrc, bufHoldup, vTimePoints[j], dMassDst);
+				m_StreamMTP.SetValue(vTimePoints[j], vTempMTP);
+
+				std::vector<double> vTempPhaseMassSrc, vTempPhaseMassDst;
+				std::tie(vTempPhaseMassSrc, vTempPhaseMassDst, vTempPhaseFrac) = CalcMixPhaseFractions(*_pStream, dFactorTP, dMassSrc, bufHoldup, vTimePoints[j], dMassDst);
+				m_PhaseFractions.SetValue(vTimePoints[j], vTempPhaseFrac);
+
+				vTempDistr = CalcMixMDDistributions(*_pStream, vTimePoints[iTime], dMassSrc, vTempPhaseMassSrc, bufHoldup, vTimePoints[j], dMassDst, vTempPhaseMassDst);
+				for (size_t iPhase = 0; iPhase < m_vpPhases.size(); ++iPhase)
+				{
+					m_vpPhases[iPhase]->distribution.AddTimePoint(vTimePoints[j]);
+					m_vpPhases[iPhase]->distribution.SetDistribution(vTimePoints[j], vTempDistr[iPhase]);
+				}
+				for (size_t iPhase = 0; iPhase < m_vpPhases.size(); ++iPhase)
+					m_vpPhases[iPhase]->distribution.NormalizeMatrix(vTimePoints[j]);
+			}
+		}
+	}
+};
+
+/** Scenarios of mixing.*/
+enum class EScenario : unsigned
+{
+	REGULAR,			///< Nonempty holdup and inflow
+	EMPTY_HOLDUP,		///< Holdup is empty at some time point and inflow is empty in the first intervals
+	ZERO_PRESSURE,		///< Pressure of the holdup is zero
+	ZERO_SOLID_PHASE,	///< Inflow contains no solid phase
+	COUNT
+};
+
+void SetupStream(CStream& _stream, CMaterialsDatabase& _database, CDistributionsGrid& _grid)
+{
+	_stream.SetMaterialsDatabase(&_database);
+	_stream.SetDistributionsGrid(&_grid);
+	_stream.AddCompound("A");
+	_stream.AddCompound("B");
+	_stream.AddPhase("Solid", SOA_SOLID);
+	_stream.AddPhase("Liquid", SOA_LIQUID);
+}
+
+void FillHoldup(CHoldup& _holdup, EScenario _scenario)
+{
+	for (double t : { 0.0, 3.0, 10.0 })
+	{
+		_holdup.AddTimePoint(t);
+		_holdup.SetMass(t, _scenario == EScenario::EMPTY_HOLDUP && t == 3.0 ? 0 : 5 + t);
+		_holdup.SetTemperature(t, 300 + t * 2);
+		_holdup.SetPressure(t, _scenario == EScenario::ZERO_PRESSURE ? 0 : 1e5 + t * 100);
+		_holdup.SetSinglePhaseProp(t, FRACTION, SOA_SOLID, 0.3 + t * 0.01);
+		_holdup.SetSinglePhaseProp(t, FRACTION, SOA_LIQUID, 0.7 - t * 0.01);
+		_holdup.SetCompoundPhaseFraction(t, "A", SOA_SOLID, 0.2);
+		_holdup.SetCompoundPhaseFraction(t, "B", SOA_SOLID, 0.8);
+		_holdup.SetCompoundPhaseFraction(t, "A", SOA_LIQUID, 0.6);
+		_holdup.SetCompoundPhaseFraction(t, "B", SOA_LIQUID, 0.4);
+		_holdup.SetPSD(t, PSD_MassFrac, "A", { 0.2, 0.3, 0.5 });
+		_holdup.SetPSD(t, PSD_MassFrac, "B", { 0.6, 0.3, 0.1 });
+	}
+}
+
+void FillStream(CMaterialStream& _stream, EScenario _scenario)
+{
+	for (int i = 0; i <= 8; ++i)
+	{
+		const double t = i * 0.9;
+		_stream.AddTimePoint(t);
+		_stream.SetMassFlow(t, _scenario == EScenario::EMPTY_HOLDUP && i < 3 ? 0 : 1 + 0.3 * i);
+		_stream.SetTemperature(t, 350 - i * 3);
+		_stream.SetPressure(t, 0.99e5 + i * 500);
+		const double dSolid = _scenario == EScenario::ZERO_SOLID_PHASE ? 0 : 0.5 + 0.04 * i;
+		_stream.SetSinglePhaseProp(t, FRACTION, SOA_SOLID, dSolid);
+		_stream.SetSinglePhaseProp(t, FRACTION, SOA_LIQUID, 1 - dSolid);
+		_stream.SetCompoundPhaseFraction(t, "A", SOA_SOLID, 0.5 + 0.1 * i / 8);
+		_stream.SetCompoundPhaseFraction(t, "B", SOA_SOLID, 0.5 - 0.1 * i / 8);
+		_stream.SetCompoundPhaseFraction(t, "A", SOA_LIQUID, 0.9);
+		_stream.SetCompoundPhaseFraction(t, "B", SOA_LIQUID, 0.1);
+		_stream.SetPSD(t, PSD_MassFrac, "A", { 0.5, 0.3 + 0.01 * i, 0.2 - 0.01 * i });
+		_stream.SetPSD(t, PSD_MassFrac, "B", { 0.1, 0.8, 0.1 });
+	}
+}
+
+bool IsEqual(const CHoldup& _holdup1, const CHoldup& _holdup2, const std::string& _sScenario)
+{
+	const std::vector<double> vTimePoints = _holdup1.GetAllTimePoints();
+	if (vTimePoints != _holdup2.GetAllTimePoints())
+	{
+		std::cerr << _sScenario << ": time points differ" << std::endl;
+		return false;
+	}
+	for (double t : vTimePoints)
+	{
+		if (_holdup1.GetDistrStreamMTP()->GetValue(t) != _holdup2.GetDistrStreamMTP()->GetValue(t) ||
+			_holdup1.GetDistrPhaseFractions()->GetValue(t) != _holdup2.GetDistrPhaseFractions()->GetValue(t))
+		{
+			std::cerr << _sScenario << ": overall properties or phase fractions differ at t = " << t << std::endl;
+			return false;
+		}
+		for (size_t iPhase = 0; iPhase < _holdup1.GetPhasesNumber(); ++iPhase)
+		{
+			const CDenseMDMatrix distr1 = _holdup1.GetPhases()->at(iPhase)->distribution.GetDistribution(t);
+			const CDenseMDMatrix distr2 = _holdup2.GetPhases()->at(iPhase)->distribution.GetDistribution(t);
+			if (distr1.GetDataLength() != distr2.GetDataLength() || !std::equal(distr1.GetDataPtr(), distr1.GetDataPtr() + distr1.GetDataLength(), distr2.GetDataPtr()))
+			{
+				std::cerr << _sScenario << ": distributions of phase " << iPhase << " differ at t = " << t << std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main()
+{
+	CMaterialsDatabase database;
+	database.AddCompound("A");
+	database.AddCompound("B");
+	database.GetCompound("A")->GetTPProperty(ENTHALPY)->SetCorrelation(0, ECorrelationTypes::POLYNOMIAL_1, { 0, 1000, 0.5, 0, 0, 0, 0, 0 });
+	database.GetCompound("B")->GetTPProperty(ENTHALPY)->SetCorrelation(0, ECorrelationTypes::POLYNOMIAL_1, { 100, 2000, 0.1, 0, 0, 0, 0, 0 });
+
+	CDistributionsGrid grid;
+	grid.AddDimension(DISTR_COMPOUNDS, EGridEntry::GRID_SYMBOLIC, std::vector<double>(), std::vector<std::string>());
+	grid.AddNamedClass(DISTR_COMPOUNDS, "A");
+	grid.AddNamedClass(DISTR_COMPOUNDS, "B");
+	grid.AddDimension(DISTR_SIZE, EGridEntry::GRID_NUMERIC, { 0, 1e-3, 2e-3, 3e-3 }, std::vector<std::string>());
+
+	bool bSuccess = true;
+	for (unsigned i = 0; i < static_cast<unsigned>(EScenario::COUNT); ++i)
+	{
+		const auto scenario = static_cast<EScenario>(i);
+		CHoldup holdup("holdup");
+		CHoldupReference reference("reference");
+		CMaterialStream stream("stream");
+		SetupStream(holdup, database, grid);
+		SetupStream(reference, database, grid);
+		SetupStream(stream, database, grid);
+		FillHoldup(holdup, scenario);
+		FillHoldup(reference, scenario);
+		FillStream(stream, scenario);
+
+		holdup.AddStream(&stream, 0.5, 7.0);
+		reference.AddStreamReference(&stream, 0.5, 7.0);
+		// mix into already existing time points
+		holdup.AddStream(&stream, 2.0, 7.2);
+		reference.AddStreamReference(&stream, 2.0, 7.2);
+
+		bSuccess &= IsEqual(holdup, reference, "Scenario " + std::to_string(i));
+	}
+
+	return bSuccess ? 0 : 1;
+}
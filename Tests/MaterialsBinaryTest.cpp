@@ -0,0 +1,128 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+// Checks the binary format of the materials database: a database converted from the text format and mapped back from the binary file
+// must contain the same data as the one loaded from the text file, and damaged binary files must be rejected.
+
+#include "MaterialsDatabase.h"
+#include "FileSystem.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+const std::wstring TEXT_FILE = L"MaterialsBinaryTest.dmdb";			// Database in the text format
+const std::wstring BINARY_FILE = L"MaterialsBinaryTest.bin.dmdb";	// Database in the binary format
+const std::wstring RESAVED_FILE = L"MaterialsBinaryTest.res.dmdb";	// Database mapped from the binary file, saved again in the text format
+
+/** Reads the whole file.*/
+std::string ReadFile(const std::wstring& _fileName)
+{
+	std::ifstream file(FileSystem::Convert(_fileName), std::ios::in | std::ios::binary);
+	return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+/** Replaces the whole file.*/
+void WriteFile(const std::wstring& _fileName, const std::string& _data)
+{
+	std::ofstream file(FileSystem::Convert(_fileName), std::ios::out | std::ios::binary | std::ios::trunc);
+	file.write(_data.data(), _data.size());
+}
+
+/** Creates a database with user-defined properties, several correlations per property, descriptions and non-default interactions.*/
+void FillDatabase(CMaterialsDatabase& _database)
+{
+	_database.AddProperty({ MDBDescriptors::EPropertyType::CONSTANT, MDBDescriptors::FIRST_CONST_USER_PROP, 3.5, "User constant", L"-", "Constant defined by user" });
+	_database.AddProperty({ MDBDescriptors::EPropertyType::TP_DEPENDENT, MDBDescriptors::FIRST_TPDEP_USER_PROP, 7, "User TPD", L"kg", "" });
+	_database.AddProperty({ MDBDescriptors::EPropertyType::INTERACTION, MDBDescriptors::FIRST_INTER_USER_PROP, 0.25, "User interaction", L"m", "" });
+
+	CCompound* water = _database.AddCompound("Water");
+	water->SetName("Water");
+	water->SetDescription("Compound with several correlations");
+	water->GetConstProperty(MOLAR_MASS)->SetValue(0.018015);
+	water->GetConstProperty(MOLAR_MASS)->SetDescription("Reference value");
+	water->GetConstProperty(static_cast<ECompoundConstProperties>(MDBDescriptors::FIRST_CONST_USER_PROP))->SetValue(-1.0 / 3);
+	CTPDProperty* density = water->GetTPProperty(DENSITY);
+	density->RemoveAllCorrelations();
+	density->SetDescription("Two intervals");
+	density->AddCorrelation(ECorrelationTypes::POLYNOMIAL_1, { 1000.1, -0.0123456789, 1e-5, 0, 0, 0, 0, 0 }, { 273.15, 373.15 }, { 1e4, 1e7 });
+	density->AddCorrelation(ECorrelationTypes::CONSTANT, { 0.6 }, { 373.15, 1000 });
+	density->GetCorrelation(1)->SetDescription("Vapour");
+	water->GetTPProperty(THERMAL_CONDUCTIVITY)->SetCorrelation(0, ECorrelationTypes::LIST_OF_T_VALUES, { 280, 0.57, 320, 0.62, 360, 0.67 });
+
+	CCompound* sand = _database.AddCompound("Sand");
+	sand->SetName("Quartz sand");
+	sand->GetConstProperty(MOLAR_MASS)->SetValue(0.06008);
+	sand->GetTPProperty(DENSITY)->SetCorrelation(0, ECorrelationTypes::POW_1, { 2650, -0.01 });
+
+	CInteraction* interaction = _database.GetInteraction("Water", "Sand");
+	interaction->GetProperty(INTERFACE_TENSION)->SetCorrelation(0, ECorrelationTypes::LINEAR, { 0.07, -1.5e-4, 0 });
+	interaction->GetProperty(INTERFACE_TENSION)->SetDescription("Measured");
+}
+
+/** Compares values of all properties of both databases at several temperatures and pressures.*/
+bool CompareValues(const CMaterialsDatabase& _database1, const CMaterialsDatabase& _database2)
+{
+	std::vector<std::string> vKeys;
+	for (size_t i = 0; i < _database1.CompoundsNumber(); ++i)
+		vKeys.push_back(_database1.GetCompound(i)->GetKey());
+	for (size_t i = 0; i < _database2.CompoundsNumber(); ++i)
+		if (i >= vKeys.size() || _database2.GetCompound(i)->GetKey() != vKeys[i])
+			return false;
+	const std::vector<double> vT{ 250, 300, 350, 400, 1500 };
+	const std::vector<double> vP{ 1e5, 1e6, 1e5, 1e8, 1e5 };
+	for (const auto& key1 : vKeys)
+	{
+		for (const auto& prop : _database1.ActiveConstProperties())
+			if (_database1.GetConstPropertyValue(key1, prop.first) != _database2.GetConstPropertyValue(key1, prop.first))
+				return false;
+		for (const auto& prop : _database1.ActiveTPDepProperties())
+			if (_database1.GetTPPropertyValues(key1, prop.first, vT, vP) != _database2.GetTPPropertyValues(key1, prop.first, vT, vP))
+				return false;
+		for (const auto& key2 : vKeys)
+			for (const auto& prop : _database1.ActiveInterProperties())
+				for (size_t i = 0; i < vT.size(); ++i)
+					if (_database1.GetInteractionPropertyValue(key1, key2, prop.first, vT[i], vP[i]) != _database2.GetInteractionPropertyValue(key1, key2, prop.first, vT[i], vP[i]))
+						return false;
+	}
+	return true;
+}
+
+bool Check(bool _bCondition, const std::string& _sMessage)
+{
+	if (!_bCondition)
+		std::cerr << _sMessage << std::endl;
+	return _bCondition;
+}
+
+int main()
+{
+	bool bSuccess = true;
+
+	CMaterialsDatabase source;
+	FillDatabase(source);
+	bSuccess &= Check(source.SaveToFile(TEXT_FILE), "Text database cannot be saved");
+
+	// text -> binary -> memory: the same data as loaded from the text file
+	CMaterialsDatabase text;
+	bSuccess &= Check(text.LoadFromFile(TEXT_FILE), "Text database cannot be loaded");
+	bSuccess &= Check(CMaterialsDatabase::ConvertToBinaryFile(TEXT_FILE, BINARY_FILE), "Database cannot be converted to the binary format");
+	bSuccess &= Check(CMaterialsDatabase::IsBinaryFile(BINARY_FILE) && !CMaterialsDatabase::IsBinaryFile(TEXT_FILE), "Format of the database is not detected");
+	CMaterialsDatabase binary;
+	bSuccess &= Check(binary.LoadFromFile(BINARY_FILE), "Binary database cannot be loaded");
+	bSuccess &= Check(binary.CompoundsNumber() == text.CompoundsNumber() && binary.InteractionsNumber() == text.InteractionsNumber(), "Different number of compounds or interactions");
+	bSuccess &= Check(CompareValues(text, binary), "Values of properties differ");
+	bSuccess &= Check(binary.SaveToFile(RESAVED_FILE) && ReadFile(RESAVED_FILE) == ReadFile(TEXT_FILE), "Binary database saved in the text format differs from the text database");
+
+	// damaged binary files are rejected and leave the database empty
+	const std::string data = ReadFile(BINARY_FILE);
+	std::string damaged = data;
+	damaged[damaged.size() / 2] ^= 0x5A;
+	WriteFile(BINARY_FILE, damaged);
+	bSuccess &= Check(!binary.LoadFromBinaryFile(BINARY_FILE) && binary.CompoundsNumber() == 0, "Damaged binary database is loaded");
+	WriteFile(BINARY_FILE, data.substr(0, data.size() - 1));
+	bSuccess &= Check(!binary.LoadFromBinaryFile(BINARY_FILE) && binary.CompoundsNumber() == 0, "Truncated binary database is loaded");
+
+	for (const auto& file : { TEXT_FILE, BINARY_FILE, RESAVED_FILE })
+		FileSystem::RemoveFile(FileSystem::Convert(file));
+
+	return bSuccess ? 0 : 1;
+}
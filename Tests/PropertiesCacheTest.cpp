@@ -0,0 +1,112 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+// Checks the cache of mixture properties of CStream: cached values must be equal to freshly calculated ones,
+// and modification of data at one time point must discard only the properties, which depend on this time point.
+
+#include "MaterialStream.h"
+#include "MaterialsDatabase.h"
+#include "DistributionsGrid.h"
+#include <algorithm>
+#include <iostream>
+
+/** Time points, at which properties are requested: defined time points and points between them.*/
+std::vector<double> QueryTimes()
+{
+	std::vector<double> vTimes;
+	for (int i = 0; i <= 20; ++i)
+		vTimes.push_back(i * 0.5);
+	return vTimes;
+}
+
+/** Requests all cached mixture properties at the given time points.*/
+std::vector<double> Read(const CStream& _stream, const std::vector<double>& _vTimes)
+{
+	std::vector<double> vRes;
+	for (double t : _vTimes)
+		for (unsigned phase : { SOA_SOLID, SOA_LIQUID })
+		{
+			vRes.push_back(_stream.GetPhaseTPDProp(t, ENTHALPY, phase));
+			vRes.push_back(_stream.GetSinglePhaseProp(t, MOLAR_MASS, phase));
+			vRes.push_back(_stream.GetSinglePhaseProp(t, ENTHALPY, phase, BASIS_MOLL));
+			vRes.push_back(_stream.GetSinglePhaseProp(t, FRACTION, phase, BASIS_MOLL));
+		}
+	return vRes;
+}
+
+bool Check(bool _bCondition, const std::string& _sMessage)
+{
+	if (!_bCondition)
+		std::cerr << _sMessage << std::endl;
+	return _bCondition;
+}
+
+int main()
+{
+	CMaterialsDatabase database;
+	database.AddCompound("A");
+	database.AddCompound("B");
+	database.GetCompound("A")->GetTPProperty(ENTHALPY)->SetCorrelation(0, ECorrelationTypes::POLYNOMIAL_1, { 0, 1000, 0.5, 0, 0, 0, 0, 0 });
+	database.GetCompound("B")->GetTPProperty(ENTHALPY)->SetCorrelation(0, ECorrelationTypes::POLYNOMIAL_1, { 100, 2000, 0.1, 0, 0, 0, 0, 0 });
+	database.GetCompound("A")->GetConstProperty(MOLAR_MASS)->SetValue(0.02);
+	database.GetCompound("B")->GetConstProperty(MOLAR_MASS)->SetValue(0.05);
+
+	CDistributionsGrid grid;
+	grid.AddDimension(DISTR_COMPOUNDS, EGridEntry::GRID_SYMBOLIC, std::vector<double>(), std::vector<std::string>());
+	grid.AddNamedClass(DISTR_COMPOUNDS, "A");
+	grid.AddNamedClass(DISTR_COMPOUNDS, "B");
+
+	CMaterialStream stream("stream");
+	stream.SetMaterialsDatabase(&database);
+	stream.SetDistributionsGrid(&grid);
+	stream.AddCompound("A");
+	stream.AddCompound("B");
+	stream.AddPhase("Solid", SOA_SOLID);
+	stream.AddPhase("Liquid", SOA_LIQUID);
+	for (int i = 0; i <= 10; ++i)
+	{
+		const double t = i * 1.0;
+		stream.AddTimePoint(t);
+		stream.SetMassFlow(t, 1 + 0.3 * i);
+		stream.SetTemperature(t, 300 + i * 3);
+		stream.SetPressure(t, 1e5);
+		stream.SetSinglePhaseProp(t, FRACTION, SOA_SOLID, 0.5 + 0.04 * i);
+		stream.SetSinglePhaseProp(t, FRACTION, SOA_LIQUID, 0.5 - 0.04 * i);
+		stream.SetCompoundPhaseFraction(t, "A", SOA_SOLID, 0.5 + 0.03 * i);
+		stream.SetCompoundPhaseFraction(t, "B", SOA_SOLID, 0.5 - 0.03 * i);
+		stream.SetCompoundPhaseFraction(t, "A", SOA_LIQUID, 0.9);
+		stream.SetCompoundPhaseFraction(t, "B", SOA_LIQUID, 0.1);
+	}
+
+	const std::vector<double> vTimes = QueryTimes();
+	bool bSuccess = true;
+
+	// the first read calculates, the second one is answered from cache
+	const std::vector<double> vFirst = Read(stream, vTimes);
+	size_t nMisses = stream.GetPropertiesCacheMisses();
+	size_t nHits = stream.GetPropertiesCacheHits();
+	bSuccess &= Check(Read(stream, vTimes) == vFirst, "Cached properties differ from calculated ones");
+	bSuccess &= Check(stream.GetPropertiesCacheMisses() == nMisses, "Properties are recalculated without changes of data");
+	bSuccess &= Check(stream.GetPropertiesCacheHits() > nHits, "Properties are not taken from cache");
+
+	// change of data at t = 5 affects only time points between its neighbours t = 4 and t = 6
+	stream.SetTemperature(5, 400);
+	stream.SetCompoundPhaseFraction(5, "A", SOA_SOLID, 0.2);
+	stream.SetCompoundPhaseFraction(5, "B", SOA_SOLID, 0.8);
+	nMisses = stream.GetPropertiesCacheMisses();
+	const std::vector<double> vChanged = Read(stream, vTimes);
+	const size_t nRecalculated = stream.GetPropertiesCacheMisses() - nMisses;
+	bSuccess &= Check(nRecalculated > 0, "Properties are not recalculated after modification of data");
+	bSuccess &= Check(nRecalculated <= 3 * 2 * 5, "Properties at not affected time points are recalculated: " + std::to_string(nRecalculated) + " misses");
+	const size_t nPerTime = vFirst.size() / vTimes.size();
+	for (size_t i = 0; i < vTimes.size(); ++i)
+		if (vTimes[i] <= 4 || vTimes[i] >= 6)
+			bSuccess &= Check(std::equal(vChanged.begin() + i * nPerTime, vChanged.begin() + (i + 1) * nPerTime, vFirst.begin() + i * nPerTime), "Properties at t = " + std::to_string(vTimes[i]) + " are changed");
+
+	// after explicit clearing, everything is recalculated from scratch
+	stream.ClearPropertiesCache();
+	nMisses = stream.GetPropertiesCacheMisses();
+	bSuccess &= Check(Read(stream, vTimes) == vChanged, "Cached properties are not updated after modification of data");
+	bSuccess &= Check(stream.GetPropertiesCacheMisses() > nMisses, "Properties are not recalculated after clearing of cache");
+
+	return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+// Checks the explicit Runge-Kutta solver of DAE models against exact solutions: accuracy of integration, event location,
+// state-dependent coefficients of derivatives, and calculation of algebraic variables in IMEX mode.
+
+#include "RKSolver.h"
+#include <cmath>
+#include <iostream>
+
+const double RTOL = 1e-8;	// Relative tolerance of the solver
+const double ATOL = 1e-10;	// Absolute tolerance of the solver
+const double K = 1.5;		// Rate constant
+
+/** Exponential decay y' = -k*y, y(0) = 1. Optionally, the equation is multiplied with a state-dependent coefficient: (1 + y^2) * (y' + k*y) = 0.*/
+class CDecayModel : public CDAEModel
+{
+	bool m_bStateCoeff;
+
+public:
+	double dMaxError{ 0 };	// Maximum relative error over all output time points
+	size_t nOutputs{ 0 };	// Number of output time points
+
+	CDecayModel(bool _bStateCoeff) : m_bStateCoeff{ _bStateCoeff }
+	{
+		AddDAEVariable(true, 1.0, -K);
+		SetTolerance(RTOL, ATOL);
+	}
+
+	void CalculateResiduals(double /*_dTime*/, double* _pVars, double* _pDerivs, double* _pRes, void* /*_pUserData*/) override
+	{
+		const double dCoeff = m_bStateCoeff ? 1 + _pVars[0] * _pVars[0] : 1.0;
+		_pRes[0] = dCoeff * (_pDerivs[0] + K * _pVars[0]);
+	}
+
+	void ResultsHandler(double _dTime, double* _pVars, double* /*_pDerivs*/, void* /*_pUserData*/) override
+	{
+		const double dExact = std::exp(-K * _dTime);
+		dMaxError = std::max(dMaxError, std::abs(_pVars[0] - dExact) / dExact);
+		nOutputs++;
+	}
+};
+
+/** Uniform motion y' = v, y(0) = 0, with an event at y = Y. At the event, y is reset to 0.*/
+class CEventModel : public CDAEModel
+{
+public:
+	static constexpr double V = 2.0;	// Velocity
+	static constexpr double Y = 0.75;	// Position of the event
+
+	std::vector<double> vEvents;		// Times of found events
+
+	CEventModel()
+	{
+		AddDAEVariable(true, 0.0, V);
+		SetTolerance(RTOL, ATOL);
+		SetRootsNumber(1);
+	}
+
+	void CalculateResiduals(double /*_dTime*/, double* /*_pVars*/, double* _pDerivs, double* _pRes, void* /*_pUserData*/) override
+	{
+		_pRes[0] = _pDerivs[0] - V;
+	}
+
+	void ResultsHandler(double /*_dTime*/, double* /*_pVars*/, double* /*_pDerivs*/, void* /*_pUserData*/) override {}
+
+	void CalculateRoots(double /*_dTime*/, double* _pVars, double* /*_pDerivs*/, double* _pRoots, void* /*_pUserData*/) override
+	{
+		_pRoots[0] = _pVars[0] - Y;
+	}
+
+	bool EventHandler(double _dTime, double* _pVars, double* /*_pDerivs*/, const int* _pRootsFound, void* /*_pUserData*/) override
+	{
+		if (_pRootsFound[0] != 1) return false;
+		vEvents.push_back(_dTime);
+		_pVars[0] = 0;
+		return true;
+	}
+};
+
+/** Index-1 DAE y' = -z, 0 = z - k*y, y(0) = 1, with the exact solution y = exp(-k*t), z = k*exp(-k*t).*/
+class CIndex1Model : public CDAEModel
+{
+public:
+	double dMaxError{ 0 };	// Maximum relative error over all output time points and variables
+
+	CIndex1Model()
+	{
+		AddDAEVariable(true, 1.0, -K);
+		AddDAEVariable(false, 0.5, 0.0);	// inconsistent initial value, must be corrected by the solver
+		SetTolerance(RTOL, ATOL);
+	}
+
+	void CalculateResiduals(double /*_dTime*/, double* _pVars, double* _pDerivs, double* _pRes, void* /*_pUserData*/) override
+	{
+		_pRes[0] = _pDerivs[0] + _pVars[1];
+		_pRes[1] = _pVars[1] - K * _pVars[0];
+	}
+
+	void ResultsHandler(double _dTime, double* _pVars, double* /*_pDerivs*/, void* /*_pUserData*/) override
+	{
+		const double dExact = std::exp(-K * _dTime);
+		dMaxError = std::max(dMaxError, std::abs(_pVars[0] - dExact) / dExact);
+		dMaxError = std::max(dMaxError, std::abs(_pVars[1] - K * dExact) / (K * dExact));
+	}
+};
+
+bool Check(bool _bCondition, const std::string& _sMessage)
+{
+	if (!_bCondition)
+		std::cerr << _sMessage << std::endl;
+	return _bCondition;
+}
+
+bool CheckDecay(bool _bStateCoeff)
+{
+	const std::string sCase = _bStateCoeff ? "Decay with state-dependent coefficient" : "Decay";
+	CDecayModel model{ _bStateCoeff };
+	CRKSolver solver;
+	if (!Check(solver.SetModel(&model, false), sCase + ": " + solver.GetError())) return false;
+	bool bSuccess = true;
+	// several time windows, as in dynamic simulation
+	for (double t : { 0.0, 1.0, 2.0 })
+		bSuccess &= Check(solver.Calculate(t, t + 1.0), sCase + ": " + solver.GetError());
+	bSuccess &= Check(model.nOutputs > 3, sCase + ": no intermediate results");
+	bSuccess &= Check(model.dMaxError < 1e-5, sCase + ": error " + std::to_string(model.dMaxError) + " is too large");
+	return bSuccess;
+}
+
+bool CheckEvents()
+{
+	CEventModel model;
+	CRKSolver solver;
+	if (!Check(solver.SetModel(&model, false), "Events: " + solver.GetError())) return false;
+	bool bSuccess = Check(solver.Calculate(0.0, 1.0), "Events: " + solver.GetError());
+	// y reaches Y each Y/V, since it is reset to 0 at each event
+	const double dPeriod = CEventModel::Y / CEventModel::V;
+	bSuccess &= Check(model.vEvents.size() == static_cast<size_t>(1.0 / dPeriod), "Events: wrong number of events " + std::to_string(model.vEvents.size()));
+	for (size_t i = 0; i < model.vEvents.size(); ++i)
+		bSuccess &= Check(std::abs(model.vEvents[i] - (i + 1) * dPeriod) < 1e-8, "Events: event " + std::to_string(i) + " is found at t = " + std::to_string(model.vEvents[i]));
+	return bSuccess;
+}
+
+bool CheckIMEX()
+{
+	CIndex1Model model;
+	CRKSolver solver;
+	if (!Check(!solver.SetModel(&model, false), "IMEX: model with algebraic variables is accepted by the explicit method")) return false;
+	if (!Check(solver.SetModel(&model, true), "IMEX: " + solver.GetError())) return false;
+	bool bSuccess = Check(solver.Calculate(0.0, 2.0), "IMEX: " + solver.GetError());
+	bSuccess &= Check(model.dMaxError < 1e-5, "IMEX: error " + std::to_string(model.dMaxError) + " is too large");
+	return bSuccess;
+}
+
+int main()
+{
+	bool bSuccess = true;
+	bSuccess &= CheckDecay(false);
+	bSuccess &= CheckDecay(true);
+	bSuccess &= CheckEvents();
+	bSuccess &= CheckIMEX();
+	return bSuccess ? 0 : 1;
+}
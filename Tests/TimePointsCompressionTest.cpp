@@ -0,0 +1,88 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+// Checks removal of time points from a stream by CStream::CompressTimePoints(), as done by the simulator after each time window:
+// all removed points must be restored by interpolation within the given tolerances, and points that cannot be interpolated must be kept.
+
+#include "MaterialStream.h"
+#include "MaterialsDatabase.h"
+#include "DistributionsGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+const double ATOL = 1e-6;	// Absolute tolerance
+const double RTOL = 1e-3;	// Relative tolerance
+
+/** All values of the stream at the given time point.*/
+std::vector<double> Read(const CMaterialStream& _stream, double _dTime)
+{
+	std::vector<double> vRes{ _stream.GetMassFlow(_dTime), _stream.GetTemperature(_dTime), _stream.GetPressure(_dTime) };
+	const std::vector<double> vFractions = _stream.GetCompoundsFractions(_dTime);
+	vRes.insert(vRes.end(), vFractions.begin(), vFractions.end());
+	const std::vector<double> vPSD = _stream.GetPSD(_dTime, PSD_MassFrac);
+	vRes.insert(vRes.end(), vPSD.begin(), vPSD.end());
+	return vRes;
+}
+
+bool Check(bool _bCondition, const std::string& _sMessage)
+{
+	if (!_bCondition)
+		std::cerr << _sMessage << std::endl;
+	return _bCondition;
+}
+
+int main()
+{
+	CMaterialsDatabase database;
+	database.AddCompound("A");
+	database.AddCompound("B");
+
+	CDistributionsGrid grid;
+	grid.AddDimension(DISTR_COMPOUNDS, EGridEntry::GRID_SYMBOLIC, std::vector<double>(), std::vector<std::string>());
+	grid.AddNamedClass(DISTR_COMPOUNDS, "A");
+	grid.AddNamedClass(DISTR_COMPOUNDS, "B");
+	grid.AddDimension(DISTR_SIZE, EGridEntry::GRID_NUMERIC, { 0, 1e-3, 2e-3, 3e-3 }, std::vector<std::string>());
+
+	CMaterialStream stream("stream");
+	stream.SetMaterialsDatabase(&database);
+	stream.SetDistributionsGrid(&grid);
+	stream.AddCompound("A");
+	stream.AddCompound("B");
+	stream.AddPhase("Solid", SOA_SOLID);
+	// mass flow and PSD change linearly, temperature has a kink at t = 5 and grows quadratically after t = 8
+	std::vector<double> vTimes;
+	for (int i = 0; i <= 20; ++i)
+		vTimes.push_back(i * 0.5);
+	for (double t : vTimes)
+	{
+		stream.AddTimePoint(t);
+		stream.SetMassFlow(t, 1 + 0.3 * t);
+		stream.SetTemperature(t, 300 + 10 * std::fabs(t - 5) + (t > 8 ? 50 * (t - 8) * (t - 8) : 0));
+		stream.SetPressure(t, 1e5);
+		stream.SetSinglePhaseProp(t, FRACTION, SOA_SOLID, 1);
+		stream.SetCompoundPhaseFraction(t, "A", SOA_SOLID, 0.5);
+		stream.SetCompoundPhaseFraction(t, "B", SOA_SOLID, 0.5);
+		stream.SetPSD(t, PSD_MassFrac, "A", { 0.5, 0.3 + 0.01 * t, 0.2 - 0.01 * t });
+		stream.SetPSD(t, PSD_MassFrac, "B", { 0.1, 0.8, 0.1 });
+	}
+	std::vector<std::vector<double>> vvReference;
+	for (double t : vTimes)
+		vvReference.push_back(Read(stream, t));
+
+	stream.CompressTimePoints(vTimes.front(), vTimes.back(), ATOL, RTOL);
+
+	bool bSuccess = true;
+	const std::vector<double> vRemaining = stream.GetAllTimePoints();
+	bSuccess &= Check(vRemaining.size() < vTimes.size() / 2, "Too few time points are removed: " + std::to_string(vRemaining.size()) + " of " + std::to_string(vTimes.size()) + " remain");
+	for (double t : { vTimes.front(), 5.0, 8.5, vTimes.back() })
+		bSuccess &= Check(std::find(vRemaining.begin(), vRemaining.end(), t) != vRemaining.end(), "Required time point " + std::to_string(t) + " is removed");
+	for (size_t i = 0; i < vTimes.size(); ++i)
+	{
+		const std::vector<double> vValues = Read(stream, vTimes[i]);
+		for (size_t j = 0; j < vValues.size(); ++j)
+			bSuccess &= Check(std::fabs(vValues[j] - vvReference[i][j]) <= std::fabs(vvReference[i][j]) * RTOL + ATOL,
+				"Value " + std::to_string(j) + " at t = " + std::to_string(vTimes[i]) + " is restored with too large error");
+	}
+
+	return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+// Checks saving and loading of the state of a unit, as done by the simulator in each iteration of a time window:
+// loading must restore all modified holdups and material streams, and must not copy those, which have not been modified.
+
+#include "DynamicUnit.h"
+#include "MaterialStream.h"
+#include "MaterialsDatabase.h"
+#include "DistributionsGrid.h"
+#include <iostream>
+
+/** Dynamic unit with one holdup and one internal stream. Simulation changes either the holdup or the stream, as selected.*/
+class CTestUnit : public CDynamicUnit
+{
+public:
+	CHoldup* pHoldup{ nullptr };
+	CMaterialStream* pStream{ nullptr };
+	bool bChangeHoldup{ true };		// Simulate() changes the holdup
+	bool bChangeStream{ true };		// Simulate() changes the stream
+
+	CTestUnit()
+	{
+		AddHoldup("Holdup");
+		AddMaterialStream("Stream");
+	}
+
+	void Initialize(double _dTime) override
+	{
+		pHoldup = GetHoldup("Holdup");
+		pStream = GetMaterialStream("Stream");
+		pStream->AddTimePoint(_dTime);
+		pStream->SetMassFlow(_dTime, 1);
+		pStream->SetTemperature(_dTime, 300);
+	}
+
+	void Simulate(double _dStartTime, double _dEndTime) override
+	{
+		for (double t : { _dStartTime, (_dStartTime + _dEndTime) / 2, _dEndTime })
+		{
+			if (bChangeHoldup)
+			{
+				pHoldup->AddTimePoint(t);
+				pHoldup->SetMass(t, 10 + t);
+			}
+			if (bChangeStream)
+			{
+				pStream->AddTimePoint(t);
+				pStream->SetMassFlow(t, 2 + t);
+			}
+		}
+	}
+};
+
+/** Data of the holdup and the stream of the unit, which must be restored by loading.*/
+std::vector<double> Read(const CTestUnit& _unit)
+{
+	std::vector<double> vRes;
+	for (double t : _unit.pHoldup->GetAllTimePoints())
+		vRes.insert(vRes.end(), { t, _unit.pHoldup->GetMass(t), _unit.pHoldup->GetTemperature(t) });
+	vRes.push_back(-1);
+	for (double t : _unit.pStream->GetAllTimePoints())
+		vRes.insert(vRes.end(), { t, _unit.pStream->GetMassFlow(t), _unit.pStream->GetTemperature(t) });
+	return vRes;
+}
+
+bool Check(bool _bCondition, const std::string& _sMessage)
+{
+	if (!_bCondition)
+		std::cerr << _sMessage << std::endl;
+	return _bCondition;
+}
+
+int main()
+{
+	CMaterialsDatabase database;
+	database.AddCompound("A");
+	const std::vector<std::string> vCompounds{ "A" };
+	const std::vector<std::string> vPhases{ "Solid" };
+	const std::vector<unsigned> vPhasesSOA{ SOA_SOLID };
+	CDistributionsGrid grid;
+
+	CTestUnit unit;
+	unit.SetMaterialsDatabase(&database);
+	unit.SetDistributionsGrid(&grid);
+	unit.SetCompounds(&vCompounds);
+	unit.SetPhases(&vPhases, &vPhasesSOA);
+	CHoldup* pInit = unit.GetHoldupsInit().front();
+	pInit->AddTimePoint(0);
+	pInit->SetMass(0, 5);
+	pInit->SetTemperature(0, 320);
+
+	bool bSuccess = true;
+	unit.InitializeUnit(0);
+	unit.SimulateUnit(0, 1);
+	unit.SaveStateUnit(1, 2);
+	const std::vector<double> vSaved = Read(unit);
+
+	// first iteration of the time window: nothing to restore
+	unit.LoadStateUnit();
+	bSuccess &= Check(Read(unit) == vSaved, "Data are changed by loading right after saving");
+
+	// both the holdup and the stream are modified and restored
+	unit.SimulateUnit(1, 2);
+	unit.LoadStateUnit();
+	bSuccess &= Check(Read(unit) == vSaved, "Modified holdup and stream are not restored");
+
+	// only the stream is modified, so the holdup must not be copied
+	unit.bChangeHoldup = false;
+	unit.SimulateUnit(1, 2);
+	const std::vector<size_t> vHoldupVersions = unit.pHoldup->GetDataVersions();
+	unit.LoadStateUnit();
+	bSuccess &= Check(Read(unit) == vSaved, "Modified stream is not restored");
+	bSuccess &= Check(unit.pHoldup->GetDataVersions() == vHoldupVersions, "Not modified holdup is copied by loading");
+
+	// saving for the same time window does not copy data, saving for a new one does
+	const std::vector<size_t> vStreamVersions = unit.pStream->GetDataVersions();
+	unit.SaveStateUnit(1, 2);
+	unit.LoadStateUnit();
+	bSuccess &= Check(unit.pStream->GetDataVersions() == vStreamVersions, "Not modified stream is copied by saving and loading");
+	unit.bChangeHoldup = true;
+	unit.SimulateUnit(1, 2);
+	unit.SaveStateUnit(2, 3);
+	const std::vector<double> vSavedNext = Read(unit);
+	unit.SimulateUnit(2, 3);
+	unit.LoadStateUnit();
+	bSuccess &= Check(Read(unit) == vSavedNext, "Data of a new time window are not restored");
+
+	return bSuccess ? 0 : 1;
+}
@@ -35,6 +35,9 @@ CAgglomerator::CAgglomerator()
 
 	/// Set this unit as user data of model ///
 	m_Model.SetUserData(this);
+
+	/// Register solver to collect its statistics ///
+	RegisterSolver(&m_Solver);
 }
 
 void CAgglomerator::Initialize(double _dTime)
@@ -34,6 +34,9 @@ CBunker::CBunker()
 
 	/// Set this unit as user data of model ///
 	m_Model.SetUserData(this);
+
+	/// Register solver to collect its statistics ///
+	RegisterSolver(&m_Solver);
 }
 
 void CBunker::Initialize(double _dTime)
@@ -132,23 +132,31 @@ void CCrusher::SimulateBondNormal(double _time)
 		if (meanOut <= 0)
 			RaiseWarning("Unable to calculate parameters of output distribution. Try to decrease 'P' or 'Deviation' parameter.");
 
-		// calculate output distribution
-		std::vector<double> q3Out(m_classesNumber, 0);
-		const double A = 1 / (sigma * std::sqrt(2 * MATH_PI));
-		for (unsigned i = 0; i < m_classesNumber; ++i)
+		// calculate transformation matrix only if inlet distribution or parameters have changed
+		std::vector<double> params{ meanOut, sigma };
+		params.insert(params.end(), psdIn.begin(), psdIn.end());
+		const CTransformMatrix* transform = GetCachedTM("Bond", params, compound);
+		if (!transform)
 		{
-			q3Out[i] = A * std::exp(-std::pow(m_diameters[i] - meanOut, 2) / (2 * sigma * sigma));
-			if (q3Out[i] < 0)
-				RaiseWarning("Unable to calculate output distribution. Try to decrease 'P' or 'Deviation' parameter.");
-		}
+			// calculate output distribution
+			std::vector<double> q3Out(m_classesNumber, 0);
+			const double A = 1 / (sigma * std::sqrt(2 * MATH_PI));
+			for (unsigned i = 0; i < m_classesNumber; ++i)
+			{
+				q3Out[i] = A * std::exp(-std::pow(m_diameters[i] - meanOut, 2) / (2 * sigma * sigma));
+				if (q3Out[i] < 0)
+					RaiseWarning("Unable to calculate output distribution. Try to decrease 'P' or 'Deviation' parameter.");
+			}
 
-		// calculate transformation matrix
-		m_transform.Clear();
-		const std::vector<double> psdOut = Convertq3ToMassFractions(m_grid, q3Out);
-		CalculateTM(DISTR_SIZE, psdIn, psdOut, m_transform);
+			// calculate transformation matrix
+			m_transform.Clear();
+			const std::vector<double> psdOut = Convertq3ToMassFractions(m_grid, q3Out);
+			CalculateTM(DISTR_SIZE, psdIn, psdOut, m_transform);
+			transform = &SetCachedTM("Bond", params, m_transform, compound);
+		}
 
 		// apply transformation matrix to output
-		m_outlet->ApplyTM(_time, compound, m_transform);
+		m_outlet->ApplyTM(_time, compound, *transform);
 	}
 
 	// component-wise correction of compounds fractions
@@ -204,6 +212,19 @@ void CCrusher::SimulateBondBimodal(double _time)
 		const double x80Out = 1. / std::pow(workInput / (10 * bondIndex) + 1. / std::sqrt(x80In * 1000), 2) / 1000;
 		double x80New = x80In;
 
+		// reuse the transformations if inlet distribution and target x80 have not changed:
+		// the search is deterministic, so the same parameters always result in the same sequence of transformations, which ends at the first missing entry
+		std::vector<double> params{ x80Out };
+		params.insert(params.end(), psdIn.begin(), psdIn.end());
+		if (GetCachedTM("BondBimodal", params, compound))
+		{
+			for (size_t i = 0; const CTransformMatrix* transform = GetCachedTM("BondBimodal", params, compound, i); ++i)
+				m_outlet->ApplyTM(_time, compound, *transform);
+			continue;
+		}
+
+		std::vector<CTransformMatrix> applied; // all transformations applied to the outlet during the search, in order of application
+
 		// iterative search for suitable transformation
 		size_t iteration = 0;
 		double currentFraction = 1;                        // currently assumed mass fraction of material which will be crushed
@@ -242,7 +263,10 @@ void CCrusher::SimulateBondBimodal(double _time)
 			if (x80New > x80Out)
 			{
 				if (currentFraction == 1) // directly perform total transformation
+				{
 					m_outlet->ApplyTM(_time, compound, m_transform);
+					applied.push_back(m_transform);
+				}
 				else
 				{
 					if (stepFactor < 0)
@@ -265,6 +289,9 @@ void CCrusher::SimulateBondBimodal(double _time)
 		}
 		// set result to output
 		m_outlet->ApplyTM(_time, compound, m_transform); // apply rest
+		applied.push_back(m_transform);
+		for (size_t i = 0; i < applied.size(); ++i)
+			SetCachedTM("BondBimodal", params, applied[i], compound, i);
 	}
 
 	// component-wise correction of compounds fractions
@@ -347,21 +374,29 @@ void CCrusher::SimulateConst(double _time)
 	if (x50 <= 0)	RaiseError("Parameter 'Mean' has to be larger than 0.");
 	if (sigma <= 0)	RaiseError("Parameter 'Deviation' has to be larger than 0.");
 
-	// calculate output q3
-	std::vector<double> q3(m_classesNumber, 0);
-	for (unsigned i = 0; i < m_classesNumber; ++i)
-		q3[i] = 1 / (sigma * std::pow(2 * MATH_PI, 0.5)) * std::exp(-std::pow(m_diameters[i] - x50, 2) / (2 * sigma * sigma));
-
 	// get current inlet
 	const std::vector<double> psdIn = m_inlet->GetPSD(_time, PSD_MassFrac);
 	if (psdIn.empty())
 		RaiseWarning("No size distribution in input stream.");
 
-	// calculate transformation matrix
-	m_transform.Clear();
-	const std::vector<double> psdOut = Convertq3ToMassFractions(m_grid, q3);
-	CalculateTM(DISTR_SIZE, psdIn, psdOut, m_transform);
+	// calculate transformation matrix only if inlet distribution or parameters have changed
+	std::vector<double> params{ x50, sigma };
+	params.insert(params.end(), psdIn.begin(), psdIn.end());
+	const CTransformMatrix* transform = GetCachedTM("Const", params);
+	if (!transform)
+	{
+		// calculate output q3
+		std::vector<double> q3(m_classesNumber, 0);
+		for (unsigned i = 0; i < m_classesNumber; ++i)
+			q3[i] = 1 / (sigma * std::pow(2 * MATH_PI, 0.5)) * std::exp(-std::pow(m_diameters[i] - x50, 2) / (2 * sigma * sigma));
+
+		// calculate transformation matrix
+		m_transform.Clear();
+		const std::vector<double> psdOut = Convertq3ToMassFractions(m_grid, q3);
+		CalculateTM(DISTR_SIZE, psdIn, psdOut, m_transform);
+		transform = &SetCachedTM("Const", params, m_transform);
+	}
 
 	// set result to output
-	m_outlet->ApplyTM(_time, m_transform);
+	m_outlet->ApplyTM(_time, *transform);
 }
@@ -33,6 +33,9 @@ CSimpleGranulator::CSimpleGranulator()
 
 	/// Set this unit as user data of model ///
 	m_Model.SetUserData(this);
+
+	/// Register solver to collect its statistics ///
+	RegisterSolver(&m_Solver);
 }
 
 void CSimpleGranulator::Initialize(double _dTime)
@@ -70,135 +70,117 @@ void CScreen::Simulate(double _time)
 	m_outletC->CopyFromStream(m_inlet, _time);
 	m_outletF->CopyFromStream(m_inlet, _time);
 
-	const double massFactor = CreateTransformMatrix(_time);
-	if (massFactor == -1) return; // cannot calculate transformation matrix
+	const std::vector<double> params = GetModelParameters(_time);
+	if (CheckError()) return; // wrong parameters
+
+	// calculate transformation matrices only if parameters have changed
+	const CTransformMatrix* transformC = GetCachedTM("Coarse", params);
+	const CTransformMatrix* transformF = GetCachedTM("Fine", params);
+	if (!transformC || !transformF)
+	{
+		CreateTransformMatrix(params);
+		transformC = &SetCachedTM("Coarse", params, m_transformC);
+		transformF = &SetCachedTM("Fine", params, m_transformF);
+	}
 
 	// apply transformation matrices
-	m_outletC->ApplyTM(_time, m_transformC);
-	m_outletF->ApplyTM(_time, m_transformF);
+	m_outletC->ApplyTM(_time, *transformC);
+	m_outletF->ApplyTM(_time, *transformF);
 
 	// recalculate and apply mass flows
+	double massFactor = 0;
+	const std::vector<double> psd = m_inlet->GetDistribution(_time, DISTR_SIZE);
+	for (unsigned i = 0; i < psd.size(); ++i)
+		massFactor += transformC->GetValue(i, i) * psd[i];
 	const double massFlowIn = m_inlet->GetMassFlow(_time);
 	m_outletC->SetMassFlow(_time, massFlowIn * massFactor);
 	m_outletF->SetMassFlow(_time, massFlowIn * (1 - massFactor));
 }
 
-double CScreen::CreateTransformMatrix(double _time)
+std::vector<double> CScreen::GetModelParameters(double _time)
 {
 	switch (m_model)
 	{
-	case Plitt:			return CreateTransformMatrixPlitt(_time);
-	case Molerus:		return CreateTransformMatrixMolerus(_time);
-	case Teipel:		return CreateTransformMatrixTeipel(_time);
-	case Probability:	return CreateTransformMatrixProbability(_time);
+	case Plitt:
+	case Molerus:
+	{
+		const double xcut  = GetTDParameterValue("Xcut", _time);
+		const double alpha = GetTDParameterValue("Alpha", _time);
+		if (xcut == 0)	RaiseError("Parameter 'Xcut' may not be equal to 0");
+		return { xcut, alpha };
+	}
+	case Teipel:
+	{
+		const double xcut   = GetTDParameterValue("Xcut", _time);
+		const double alpha  = GetTDParameterValue("Alpha", _time);
+		const double beta   = GetTDParameterValue("Beta", _time);
+		const double offset = GetTDParameterValue("Offset", _time);
+		if (xcut == 0)	RaiseError("Parameter 'Xcut' may not be equal to 0");
+		return { xcut, alpha, beta, offset };
 	}
-	return -1;
+	case Probability:
+	{
+		const double mu    = GetTDParameterValue("Mean", _time);
+		const double sigma = GetTDParameterValue("Deviation", _time);
+		if (sigma == 0)	RaiseError("Parameter 'Deviation' may not be equal to 0");
+		return { mu, sigma };
+	}
+	}
+	return {};
 }
 
-double CScreen::CreateTransformMatrixPlitt(double _time)
+void CScreen::CreateTransformMatrix(const std::vector<double>& _params)
 {
-	// get parameters
-	const double xcut  = GetTDParameterValue("Xcut", _time);
-	const double alpha = GetTDParameterValue("Alpha", _time);
-
-	// check parameters
-	if (xcut == 0)		RaiseError("Parameter 'Xcut' may not be equal to 0");
-
-	// return if any error occured
-	if (CheckError()) return -1;
+	switch (m_model)
+	{
+	case Plitt:			CreateTransformMatrixPlitt(_params[0], _params[1]);							break;
+	case Molerus:		CreateTransformMatrixMolerus(_params[0], _params[1]);						break;
+	case Teipel:		CreateTransformMatrixTeipel(_params[0], _params[1], _params[2], _params[3]);	break;
+	case Probability:	CreateTransformMatrixProbability(_params[0], _params[1]);					break;
+	}
+}
 
-	// calculate transformations matrices
-	double factor = 0;
-	const std::vector<double> psd = m_inlet->GetDistribution(_time, DISTR_SIZE);
-	for (unsigned i = 0; i < psd.size(); ++i)
+void CScreen::CreateTransformMatrixPlitt(double _xcut, double _alpha)
+{
+	for (unsigned i = 0; i < m_classesNumber; ++i)
 	{
-		const double value = 1 - std::exp(-0.693 * std::pow(m_diameters[i] / xcut, alpha));
-		factor += value * psd[i];
+		const double value = 1 - std::exp(-0.693 * std::pow(m_diameters[i] / _xcut, _alpha));
 		m_transformC.SetValue(i, i, value);
 		m_transformF.SetValue(i, i, 1 - value);
 	}
-	return factor;
 }
 
-double CScreen::CreateTransformMatrixMolerus(double _time)
+void CScreen::CreateTransformMatrixMolerus(double _xcut, double _alpha)
 {
-	// get parameters
-	const double xcut  = GetTDParameterValue("Xcut", _time);
-	const double alpha = GetTDParameterValue("Alpha", _time);
-
-	// Check parameters
-	if (xcut == 0)		RaiseError("Parameter 'Xcut' may not be equal to 0");
-
-	// return if any error occured
-	if (CheckError()) return -1;
-
-	// calculate transformations matrices
-	double factor = 0;
-	std::vector<double> psd = m_inlet->GetDistribution(_time, DISTR_SIZE);
-	for (unsigned i = 0; i < psd.size(); ++i)
+	for (unsigned i = 0; i < m_classesNumber; ++i)
 	{
-		const double value = 1 / (1 + std::pow(xcut / m_diameters[i], 2.) * std::exp(alpha * (1 - std::pow(m_diameters[i] / xcut, 2.0))));
-		factor += value * psd[i];
+		const double value = 1 / (1 + std::pow(_xcut / m_diameters[i], 2.) * std::exp(_alpha * (1 - std::pow(m_diameters[i] / _xcut, 2.0))));
 		m_transformC.SetValue(i, i, value);
 		m_transformF.SetValue(i, i, 1 - value);
 	}
-	return factor;
 }
 
-double CScreen::CreateTransformMatrixTeipel(double _time)
+void CScreen::CreateTransformMatrixTeipel(double _xcut, double _alpha, double _beta, double _offset)
 {
-	// get parameters
-	const double xcut   = GetTDParameterValue("Xcut", _time);
-	const double alpha  = GetTDParameterValue("Alpha", _time);
-	const double beta   = GetTDParameterValue("Beta", _time);
-	const double offset = GetTDParameterValue("Offset", _time);
-
-	// check parameters
-	if (xcut == 0)		RaiseError("Parameter 'Xcut' may not be equal to 0");
-
-	// return if any error occured
-	if (CheckError()) return -1;
-
-	// calculate transformations matrices
-	double factor = 0;
-	std::vector<double> psd = m_inlet->GetDistribution(_time, DISTR_SIZE);
-	for (unsigned i = 0; i < psd.size(); ++i)
+	for (unsigned i = 0; i < m_classesNumber; ++i)
 	{
-		const double value = (1 - std::pow(1 + 3 * std::pow(m_diameters[i] / xcut, (m_diameters[i] / xcut + alpha) * beta), -0.5)) * (1 - offset) + offset;
-		factor += value * psd[i];
+		const double value = (1 - std::pow(1 + 3 * std::pow(m_diameters[i] / _xcut, (m_diameters[i] / _xcut + _alpha) * _beta), -0.5)) * (1 - _offset) + _offset;
 		m_transformC.SetValue(i, i, value);
 		m_transformF.SetValue(i, i, 1 - value);
 	}
-	return factor;
 }
 
-double CScreen::CreateTransformMatrixProbability(double _time)
+void CScreen::CreateTransformMatrixProbability(double _mu, double _sigma)
 {
-	// get parameters
-	const double mu    = GetTDParameterValue("Mean", _time);
-	const double sigma = GetTDParameterValue("Deviation", _time);
-
-	// check parameters
-	if (sigma == 0)	RaiseError("Parameter 'Deviation' may not be equal to 0");
-
-	// return if any error occured.
-	if (CheckError()) return -1;
-
-	// calculate transformations matrices
-	double factor = 0;
-	std::vector<double> psd = m_inlet->GetDistribution(_time, DISTR_SIZE);
 	double totalSum = 0;
-	for (unsigned i = 0; i < psd.size(); ++i)
-		totalSum += std::exp(-std::pow(m_diameters[i] - mu, 2) / (2 * sigma * sigma));
+	for (unsigned i = 0; i < m_classesNumber; ++i)
+		totalSum += std::exp(-std::pow(m_diameters[i] - _mu, 2) / (2 * _sigma * _sigma));
 	double currSum = 0;
-	for (unsigned i = 0; i < psd.size(); ++i)
+	for (unsigned i = 0; i < m_classesNumber; ++i)
 	{
-		currSum += std::exp(-std::pow(m_diameters[i] - mu, 2) / (2 * sigma * sigma));
+		currSum += std::exp(-std::pow(m_diameters[i] - _mu, 2) / (2 * _sigma * _sigma));
 		const double value = currSum / totalSum;
-		factor += value * psd[i];
 		m_transformC.SetValue(i, i, value);
 		m_transformF.SetValue(i, i, 1 - value);
 	}
-
-	return factor;
 }
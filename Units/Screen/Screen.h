@@ -25,10 +25,12 @@ public:
 	void Simulate(double _time) override;
 
 private:
-	double CreateTransformMatrix(double _time);
+	std::vector<double> GetModelParameters(double _time);
 
-	double CreateTransformMatrixPlitt(double _time);
-	double CreateTransformMatrixMolerus(double _time);
-	double CreateTransformMatrixTeipel(double _time);
-	double CreateTransformMatrixProbability(double _time);
+	void CreateTransformMatrix(const std::vector<double>& _params);
+
+	void CreateTransformMatrixPlitt(double _xcut, double _alpha);
+	void CreateTransformMatrixMolerus(double _xcut, double _alpha);
+	void CreateTransformMatrixTeipel(double _xcut, double _alpha, double _beta, double _offset);
+	void CreateTransformMatrixProbability(double _mu, double _sigma);
 };
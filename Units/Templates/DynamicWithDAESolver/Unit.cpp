@@ -32,6 +32,9 @@ CUnit::CUnit()
 
 	/// Set this unit as user data of model ///
 	m_Model.SetUserData(this);
+
+	/// Register solver to collect its statistics ///
+	RegisterSolver(&m_Solver);
 }
 
 CUnit::~CUnit()
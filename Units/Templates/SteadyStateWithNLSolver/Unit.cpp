@@ -29,6 +29,9 @@ CUnit::CUnit()
 
 	/// Add user data to model ///
 	m_NLModel.SetUserData(this);
+
+	/// Register solver to collect its statistics ///
+	RegisterSolver(&m_NLSolver);
 }
 
 CUnit::~CUnit()
@@ -27,6 +27,9 @@ CTimeDelay::CTimeDelay()
 
 	/// Set this unit as user data of model ///
 	m_Model.SetUserData(this);
+
+	/// Register solver to collect its statistics ///
+	RegisterSolver(&m_Solver);
 }
 
 void CTimeDelay::Initialize(double _dTime)
@@ -233,6 +233,8 @@ namespace StrConst
 		return std::string("Initialization of " + unit + " (" + model + ")..."); }
 	inline std::string  Sim_InfoUnitSimulation(const std::string& unit, const std::string& model, double t1, double t2) {
 		return std::string("Simulation of " + unit + " (" + model + "): [" + StringFunctions::Double2String(t1) + ", " + StringFunctions::Double2String(t2) + "]..."); }
+	inline std::string  Sim_InfoUnitSolverStatistics(const std::string& unit, const std::string& model, const std::string& statistics) {
+		return std::string("Solvers of " + unit + " (" + model + "): " + statistics); }
 	inline std::string  Sim_InfoUnitFinalization(const std::string& unit, const std::string& model) {
 		return std::string("Finalization of " + unit + " (" + model + ")..."); }
 	inline std::string  Sim_WarningParamOutOfRange(const std::string& unit, const std::string& model, const std::string& param) {
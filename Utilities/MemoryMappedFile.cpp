@@ -0,0 +1,137 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#include "MemoryMappedFile.h"
+#ifdef _MSC_VER
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+CMemoryMappedFile::~CMemoryMappedFile()
+{
+	Close();
+}
+
+#ifdef _MSC_VER
+bool CMemoryMappedFile::Open(const std::string& _filePath)
+{
+	Close();
+	m_hFile = CreateFileA(_filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+	{
+		m_hFile = nullptr;
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_hFile, &size) || size.QuadPart == 0) // empty files can not be mapped
+	{
+		Close();
+		return false;
+	}
+	m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_hMapping)
+	{
+		Close();
+		return false;
+	}
+	m_pData = static_cast<const char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_pData)
+	{
+		Close();
+		return false;
+	}
+	m_nSize = static_cast<uint64_t>(size.QuadPart);
+	return true;
+}
+
+bool CMemoryMappedFile::Open(const std::wstring& _filePath)
+{
+	Close();
+	m_hFile = CreateFileW(_filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+	{
+		m_hFile = nullptr;
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_hFile, &size) || size.QuadPart == 0) // empty files can not be mapped
+	{
+		Close();
+		return false;
+	}
+	m_hMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_hMapping)
+	{
+		Close();
+		return false;
+	}
+	m_pData = static_cast<const char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_pData)
+	{
+		Close();
+		return false;
+	}
+	m_nSize = static_cast<uint64_t>(size.QuadPart);
+	return true;
+}
+
+void CMemoryMappedFile::Close()
+{
+	if (m_pData)	UnmapViewOfFile(m_pData);
+	if (m_hMapping)	CloseHandle(m_hMapping);
+	if (m_hFile)	CloseHandle(m_hFile);
+	m_pData = nullptr;
+	m_hMapping = nullptr;
+	m_hFile = nullptr;
+	m_nSize = 0;
+}
+#else
+bool CMemoryMappedFile::Open(const std::string& _filePath)
+{
+	Close();
+	m_hFile = open(_filePath.c_str(), O_RDONLY);
+	if (m_hFile == -1) return false;
+	struct stat info {};
+	if (fstat(m_hFile, &info) != 0 || info.st_size == 0) // empty files can not be mapped
+	{
+		Close();
+		return false;
+	}
+	void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, m_hFile, 0);
+	if (data == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+	m_pData = static_cast<const char*>(data);
+	m_nSize = static_cast<uint64_t>(info.st_size);
+	return true;
+}
+
+void CMemoryMappedFile::Close()
+{
+	if (m_pData)		munmap(const_cast<char*>(m_pData), static_cast<size_t>(m_nSize));
+	if (m_hFile != -1)	close(m_hFile);
+	m_pData = nullptr;
+	m_hFile = -1;
+	m_nSize = 0;
+}
+#endif
+
+bool CMemoryMappedFile::IsOpen() const
+{
+	return m_pData != nullptr;
+}
+
+const char* CMemoryMappedFile::Data() const
+{
+	return m_pData;
+}
+
+uint64_t CMemoryMappedFile::Size() const
+{
+	return m_nSize;
+}
@@ -0,0 +1,44 @@
+/* Copyright (c) 2020, Dyssol Development Team. All rights reserved. This file is part of Dyssol. See LICENSE file for license information. */
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+/* Read-only view of a whole file mapped into memory.
+ * The path should be wrapped in UnicodePath() to select the proper version depending on the current OS, as for FileSystem functions. */
+class CMemoryMappedFile
+{
+#ifdef _MSC_VER
+	void* m_hFile{ nullptr };		// Handle of the opened file.
+	void* m_hMapping{ nullptr };	// Handle of the file mapping object.
+#else
+	int m_hFile{ -1 };				// Descriptor of the opened file.
+#endif
+	const char* m_pData{ nullptr };	// Pointer to the beginning of the mapped data.
+	uint64_t m_nSize{ 0 };			// Size of the mapped data in bytes.
+
+public:
+	CMemoryMappedFile() = default;
+	~CMemoryMappedFile();
+	CMemoryMappedFile(const CMemoryMappedFile& _other) = delete;
+	CMemoryMappedFile& operator=(const CMemoryMappedFile& _other) = delete;
+	CMemoryMappedFile(CMemoryMappedFile&& _other) = delete;
+	CMemoryMappedFile& operator=(CMemoryMappedFile&& _other) = delete;
+
+	// Maps the specified file into memory for reading. Returns true on success.
+	bool Open(const std::string& _filePath);
+#ifdef _MSC_VER
+	// Maps the specified file into memory for reading. Returns true on success.
+	bool Open(const std::wstring& _filePath);
+#endif
+	// Unmaps and closes the file.
+	void Close();
+
+	// Returns true if a file is currently mapped.
+	bool IsOpen() const;
+	// Returns pointer to the beginning of the mapped data or nullptr if nothing is mapped.
+	const char* Data() const;
+	// Returns size of the mapped data in bytes.
+	uint64_t Size() const;
+};
@@ -5,6 +5,7 @@
 #include <future>
 
 size_t ThreadPool::CThreadPool::m_threadsLimit = std::numeric_limits<size_t>::max();
+thread_local bool ThreadPool::CThreadPool::m_isWorker = false;
 
 ThreadPool::CThreadPool::CThreadPool(size_t _threads)
 {
@@ -54,6 +55,14 @@ void ThreadPool::CThreadPool::SubmitParallelJobs(size_t _count, const std::funct
 {
 	using FunType = std::function<void()>;
 
+	// nested call from a worker thread: run in this thread, since waiting for other workers may block all of them
+	if (m_isWorker)
+	{
+		for (size_t i = 0; i < _count; ++i)
+			_fun(i);
+		return;
+	}
+
 	// number of available threads
 	const size_t threadsNumber = m_threads.size();
 	// number of tasks per thread
@@ -114,6 +123,7 @@ void ThreadPool::CThreadPool::SubmitParallelJobs(size_t _count, const std::funct
 
 void ThreadPool::CThreadPool::Worker()
 {
+	m_isWorker = true;
 	while (true)
 	{
 		std::unique_ptr<IThreadTask> task{ nullptr };
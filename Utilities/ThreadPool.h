@@ -14,6 +14,7 @@ namespace ThreadPool
 		static size_t m_threadsLimit;								/// Maximum number of threads available for tyhis instance.
 		CThreadSafeQueue<std::unique_ptr<IThreadTask>> m_workQueue;	/// Queue of submitted works.
 		std::vector<std::thread> m_threads;							/// List of available threads.
+		static thread_local bool m_isWorker;						/// Whether the current thread is a worker of a thread pool.
 
 	public:
 		explicit CThreadPool(size_t _threads = 0);
@@ -31,7 +32,7 @@ namespace ThreadPool
 		/// Returns number of defined threads.
 		size_t GetThreadsNumber() const;
 
-		/// Submits _count of identical jobs, running _fun(i) _count times with i = [0; count).
+		/// Submits _count of identical jobs, running _fun(i) _count times with i = [0; count). Nested calls from worker threads are executed sequentially.
 		void SubmitParallelJobs(size_t _count, const std::function<void(size_t)>& _fun);
 
 		/// Submits a job _fun with arguments _args.